@@ -0,0 +1,220 @@
+// aoosp_benchtele.ino - benchmarks telegram types, chain lengths and logging on the target
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#include <aospi.h>
+#include <aoosp.h>
+
+
+/*
+DESCRIPTION
+This demo benchmarks the library on the target. For every workload (one
+per telegram type, and a mixed frame), every configured chain length, and
+with logging off and on, it sends telegrams for RUNMS and measures
+  - telegrams per second
+  - CPU time per telegram (time not spent in the SPI transfer)
+  - bus utilization (fraction of time spent in SPI transfers)
+The log level is a column of the output (0 none, 2 tele).
+The SPI time comes from the aoosp_send hooks (aoosp_hooks_set), so it
+encloses exactly the aospi calls; set AOOSP_HOOKS_ENABLED to 1 (in
+aoosp_send.h or with -D), otherwise bus_pct is 0. aoosp_time.ino
+measures one fixed sequence; this sketch covers floods of PWM telegrams,
+read heavy scans, and runs with logging, over the chain lengths in
+LENGTHS[].
+
+Results are printed as CSV lines starting with "bench," (one header line,
+then one line per run), so they can be grepped from the Serial capture
+and tracked across library releases; other output (e.g. the log) does not
+start with "bench,".
+
+Edit LENGTHS[] for the chain lengths to measure (0 means the whole chain;
+lengths longer than the chain are clipped), and WORKLOADS[] to select.
+
+HARDWARE
+The demo runs on the OSP32 board, but a longer chain is more interesting.
+In Arduino select board "ESP32S3 Dev Module".
+
+BEHAVIOR
+LEDs flash dimly during the PWM workloads.
+
+OUTPUT
+No capture on the OSP32 board is included, so there are no reference
+numbers here; take a baseline by running the sketch on your own board.
+The shape of the output is below; the "bench," line is illustrative, its
+values are placeholders, not a measurement.
+
+chain: 9 nodes (loop)
+bench,osp,workload,loglevel,nodes,telegrams,tele_per_s,cpu_us_per_tele,bus_pct,errors
+bench,0.5.0,setpwmchn,0,1,<telegrams>,<tele_per_s>,<cpu_us>,<bus_pct>,0
+...
+done
+*/
+
+
+#define BAUD      921600  // logging runs depend on the Serial speed
+#define RUNMS     1000    // duration of one run
+
+
+// Chain lengths to benchmark (0 is the whole chain)
+static const uint16_t LENGTHS[] = { 1, 8, 0 };
+// Log levels to benchmark
+#if AOOSP_LOG_ENABLED
+static const int LOGLEVELS[] = { aoosp_loglevel_none, aoosp_loglevel_tele };
+#else
+static const int LOGLEVELS[] = { 0 };
+#endif
+
+
+// === WORKLOADS ==========================================
+
+
+// A workload sends telegram(s) to node `addr`; returns the number of telegrams sent and counts errors
+typedef int (*workload_fn_t)(uint16_t addr, int * errors);
+
+
+static int workload_setpwmchn(uint16_t addr, int * errors) {
+  static uint16_t val;
+  val = (val+0x0101) & 0x0FFF;
+  *errors+= aoosp_send_setpwmchn(addr, 0, val, val, val)!=aoresult_ok;
+  return 1;
+}
+
+
+static int workload_readstat(uint16_t addr, int * errors) {
+  uint8_t stat;
+  *errors+= aoosp_send_readstat(addr, &stat)!=aoresult_ok;
+  return 1;
+}
+
+
+static int workload_readtempstat(uint16_t addr, int * errors) {
+  uint8_t temp, stat;
+  *errors+= aoosp_send_readtempstat(addr, &temp, &stat)!=aoresult_ok;
+  return 1;
+}
+
+
+static int workload_readpwmchn(uint16_t addr, int * errors) {
+  uint16_t red, green, blue;
+  *errors+= aoosp_send_readpwmchn(addr, 0, &red, &green, &blue)!=aoresult_ok;
+  return 1;
+}
+
+
+static int workload_identify(uint16_t addr, int * errors) {
+  uint32_t id;
+  *errors+= aoosp_send_identify(addr, &id)!=aoresult_ok;
+  return 1;
+}
+
+
+// A frame as in an animation: three channels set, one status read
+static int workload_frame(uint16_t addr, int * errors) {
+  uint8_t temp, stat;
+  for( uint8_t chn=0; chn<3; chn++ ) *errors+= aoosp_send_setpwmchn(addr, chn, 0x0100, 0x0080, 0x0040)!=aoresult_ok;
+  *errors+= aoosp_send_readtempstat(addr, &temp, &stat)!=aoresult_ok;
+  return 4;
+}
+
+
+typedef struct workload_s { const char * name; workload_fn_t fn; } workload_t;
+static const workload_t WORKLOADS[] = {
+  { "setpwmchn",    workload_setpwmchn    },
+  { "readstat",     workload_readstat     },
+  { "readtempstat", workload_readtempstat },
+  { "readpwmchn",   workload_readpwmchn   },
+  { "identify",     workload_identify     },
+  { "frame",        workload_frame        },
+};
+
+
+// === MEASUREMENT ========================================
+
+
+static uint32_t spicycles; // cycles spent in SPI transfers
+
+
+// Post-receive hook: accumulates the SPI time
+static void bench_postrx(const uint8_t * resp, int size, uint8_t tid, uint32_t txcycles, uint32_t rxcycles, aoresult_t result) {
+  (void)resp; (void)size; (void)tid; (void)result;
+  spicycles+= rxcycles-txcycles;
+}
+
+
+// Runs workload `wl` round robin over nodes 1..nodes for RUNMS, then prints the CSV line
+static void bench_run(const workload_t * wl, uint16_t nodes, int level) {
+  int      telegrams = 0;
+  int      errors = 0;
+  uint16_t addr = 1;
+  aoosp_loglevel_set((aoosp_loglevel_t)level);
+  spicycles = 0;
+  uint32_t ms0 = millis();
+  uint32_t c0 = aoosp_cycles();
+  while( millis()-ms0 < RUNMS ) {
+    telegrams+= wl->fn(addr, &errors);
+    addr = addr>=nodes ? 1 : addr+1;
+  }
+  uint32_t cycles = aoosp_cycles()-c0;
+  aoosp_loglevel_set(aoosp_loglevel_none);
+  Serial.flush();
+  float us = cycles / (float)aoosp_cycles_per_us();
+  Serial.printf("\nbench,%s,%s,%d,%u,%d,%.0f,%.2f,%.1f,%d\n", AOOSP_VERSION, wl->name, level, nodes, telegrams,
+    telegrams*1e6f/us, (cycles-spicycles)/(float)aoosp_cycles_per_us()/telegrams, spicycles*100.0f/cycles, errors );
+}
+
+
+void setup() {
+  Serial.begin(BAUD);
+  Serial.printf("\n\nWelcome to aoosp_benchtele.ino\n");
+  Serial.printf("version: result %s spi %s osp %s\n", AORESULT_VERSION, AOSPI_VERSION, AOOSP_VERSION );
+  #if !AOOSP_HOOKS_ENABLED
+    Serial.printf("WARNING: AOOSP_HOOKS_ENABLED is 0 in aoosp_send.h, SPI time is not measured\n");
+  #endif
+
+  aospi_init();
+  aoosp_init();
+
+  uint16_t   last;
+  int        loop;
+  aoresult_t result = aoosp_exec_resetinit(&last, &loop);
+  if( result!=aoresult_ok ) Serial.printf("ERROR %s in resetinit\n", aoresult_to_str(result) );
+  result = aoosp_send_clrerror(0x000);
+  if( result!=aoresult_ok ) Serial.printf("ERROR %s in clrerror\n", aoresult_to_str(result) );
+  result = aoosp_send_goactive(0x000);
+  if( result!=aoresult_ok ) Serial.printf("ERROR %s in goactive\n", aoresult_to_str(result) );
+  Serial.printf("\nchain: %d nodes (%s)\n", last, loop?"loop":"bidir" );
+  if( last==0 ) return;
+
+  aoosp_hooks_set(0, bench_postrx);
+  Serial.printf("bench,osp,workload,loglevel,nodes,telegrams,tele_per_s,cpu_us_per_tele,bus_pct,errors\n");
+  for( size_t w=0; w<sizeof WORKLOADS/sizeof WORKLOADS[0]; w++ ) {
+    for( size_t l=0; l<sizeof LENGTHS/sizeof LENGTHS[0]; l++ ) {
+      uint16_t nodes = LENGTHS[l]==0 || LENGTHS[l]>last ? last : LENGTHS[l];
+      for( size_t g=0; g<sizeof LOGLEVELS/sizeof LOGLEVELS[0]; g++ ) bench_run(&WORKLOADS[w], nodes, LOGLEVELS[g]);
+    }
+  }
+  aoosp_hooks_set(0, 0);
+  aoosp_send_setpwmchn(0x000, 0, 0, 0, 0);
+  Serial.printf("done\n");
+}
+
+
+void loop() {
+  delay(1000);
+}
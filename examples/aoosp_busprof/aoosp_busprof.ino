@@ -0,0 +1,166 @@
+// aoosp_busprof.ino - profiles where the bus time goes (PWM, diagnostics, I2C polling)
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#include <aospi.h>
+#include <aoosp.h>
+
+
+/*
+DESCRIPTION
+This demo runs a typical application mix on the chain and shows with
+aoosp_busprof where the bus time goes. The mix is
+  - PWM frames: SETPWMCHN (SAID) or SETPWM (RGBI) to every node, as fast
+    as possible
+  - diagnostics: a READTEMPSTAT scan of all nodes every DIAGEVERY frames
+  - I2C: a one byte read every I2CEVERY frames from a device on the I2C
+    bus of the first SAID with I2C bridge (aoosp_exec_i2cread8 polls
+    READI2CCFG until the transaction is done)
+  - retries: a failed READTEMPSTAT is repeated; those telegrams are
+    attributed to the retry category with aoosp_busprof_ctx_set()
+Every second the profile of the last second (10 buckets of 100 ms) is
+printed: per category the number of telegrams, the time in aospi split in
+wire time and waiting, and the share of the window; also the idle gaps
+between telegrams.
+
+HARDWARE
+The demo runs on the OSP32 board, with any chain. For the I2C part, a SAID
+with I2C bridge and an I2C device is needed (e.g. the I2C EEPROM stick on
+SAIDbasic); I2CDADDR7 is the device address.
+In Arduino select board "ESP32S3 Dev Module".
+Set AOOSP_BUSPROF_ENABLED to 1 in aoosp_busprof.h (it is 0 by default), otherwise
+aoosp_send does not feed the profile.
+
+BEHAVIOR
+All nodes show a slowly changing dim white.
+
+OUTPUT
+The run below is the sketch unchanged on a PC, not on the OSP32 board:
+the Arduino shim of extras/host, an aospi_sim chain "RSS" as on the
+board (I2C enabled on node 002, with an EEPROM at 0x50), and the virtual
+bus clock of aospi_sim with aoosp_tmodel_default(). Times are simulated
+bus time, and the welcome lines are left out. Shown is the last of three
+prints.
+
+chain: 3 nodes, I2C at 002
+busprof: window 900303 us, busy 864416 us (96.0%), 7393 gaps mean 4 us max 100 us
+  category  telegrams   busy_us   wire_us   wait_us  usage
+  pwm            5412    637392    204432    432960  70.8%
+  i2c             721     85619     27650     57969   9.5%
+  i2cpoll         720     79773     21597     58176   8.9%
+  diag            540     61630     17998     43632   6.8%
+*/
+
+
+#define DIAGEVERY   10    // frames between diagnostic scans
+#define I2CEVERY    5     // frames between I2C reads
+#define I2CDADDR7   0x50  // I2C device address
+#define RETRIES     2     // retries of a failed READTEMPSTAT
+#define PRINTMS     1000  // time between profile prints
+
+
+// Print result if it is not ok
+#define CHECK_RESULT(msg) do { if( result!=aoresult_ok ) Serial.printf("ERROR %d in %s (%s)\n", result, msg, aoresult_to_str(result) ); } while( 0 )
+
+
+static uint16_t last;
+static uint16_t i2caddr; // first SAID with I2C bridge, 0 for none
+static uint8_t  issaid[1024];
+
+
+static void chain_init() {
+  aoresult_t result;
+  result= aoosp_exec_resetinit(&last); CHECK_RESULT("resetinit");
+  result= aoosp_send_clrerror(0x000); CHECK_RESULT("clrerror(000)");
+  result= aoosp_send_goactive(0x000); CHECK_RESULT("goactive(000)");
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    uint32_t id;
+    int      enable;
+    result= aoosp_send_identify(addr,&id); CHECK_RESULT("identify");
+    issaid[addr] = result==aoresult_ok && AOOSP_IDENTIFY_IS_SAID(id);
+    if( issaid[addr] && i2caddr==0 && aoosp_exec_i2cenable_get(addr,&enable)==aoresult_ok && enable ) {
+      if( aoosp_exec_i2cpower(addr)==aoresult_ok ) i2caddr = addr;
+    }
+  }
+  if( i2caddr ) Serial.printf("chain: %u nodes, I2C at %03X\n", last, i2caddr);
+  else Serial.printf("chain: %u nodes, no I2C bridge\n", last);
+}
+
+
+static void frame(uint16_t level) {
+  aoresult_t result;
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    if( issaid[addr] ) { result= aoosp_send_setpwmchn(addr, 0, level, level, level); CHECK_RESULT("setpwmchn"); }
+    else { result= aoosp_send_setpwm(addr, level, level, level, 0b000); CHECK_RESULT("setpwm"); }
+  }
+}
+
+
+static void diag() {
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    uint8_t temp, stat;
+    aoresult_t result= aoosp_send_readtempstat(addr, &temp, &stat);
+    if( result==aoresult_ok ) continue;
+    // Retries count as retry, not as diagnostics
+    uint8_t prev = aoosp_busprof_ctx_set(AOOSP_BUSPROF_CAT_RETRY);
+    for( int i=0; i<RETRIES && result!=aoresult_ok; i++ ) result= aoosp_send_readtempstat(addr, &temp, &stat);
+    aoosp_busprof_ctx_set(prev);
+    CHECK_RESULT("readtempstat");
+  }
+}
+
+
+static void i2c() {
+  uint8_t byte;
+  aoresult_t result= aoosp_exec_i2cread8(i2caddr, I2CDADDR7, 0x00, &byte, 1); CHECK_RESULT("i2cread8");
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial.printf("\n\nWelcome to aoosp_busprof.ino\n");
+  Serial.printf("version: result %s spi %s osp %s\n", AORESULT_VERSION, AOSPI_VERSION, AOOSP_VERSION );
+  #if !AOOSP_BUSPROF_ENABLED
+    Serial.printf("WARNING: AOOSP_BUSPROF_ENABLED is 0 in aoosp_busprof.h, the profile stays empty\n");
+  #endif
+
+  aospi_init();
+  aoosp_init();
+  Serial.printf("\n");
+
+  chain_init();
+  aoosp_busprof_reset();
+}
+
+
+static uint32_t frames;
+static uint32_t lastprintms;
+
+
+void loop() {
+  frame( 0x0100 + (frames/64)%0x0100 );
+  if( frames%DIAGEVERY==0 ) diag();
+  if( i2caddr && frames%I2CEVERY==0 ) i2c();
+  frames++;
+
+  if( millis()-lastprintms >= PRINTMS ) {
+    aoosp_busprof_print( PRINTMS/AOOSP_BUSPROF_BUCKETMS );
+    lastprintms = millis();
+  }
+}
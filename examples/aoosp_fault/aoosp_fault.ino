@@ -0,0 +1,174 @@
+// aoosp_fault.ino - measures recovery from injected faults (retry, re-init, resetinit)
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#include <aospi.h>
+#include <aoosp.h>
+
+
+/*
+DESCRIPTION
+This demo measures how fast the recovery logic of an application gets the
+chain working again after a fault. aoosp_fault injects faults between
+aoosp_send and aospi per a schedule: dropped responses, corrupted CRCs in
+both directions, flipped status bits, and a chain break. The application
+scans the chain with READSTAT, like a diagnostics task, and recovers in
+three escalating steps:
+  - retry      repeat the telegram (up to RETRIES times)
+  - re-init    partial re-init of the node: clear its error flags and make
+               it active again (for flags set in the status)
+  - resetinit  aoosp_exec_resetinit() of the whole chain
+The steps report their success with aoosp_fault_recovered() (resetinit
+reports itself), so aoosp_fault measures the time to recover per step, from
+the first injected fault of an episode. After each pass of the schedule the
+statistics are printed.
+
+HARDWARE
+The demo runs on the OSP32 board, with any chain (e.g. the SAIDs and RGBI
+on the board). In Arduino select board "ESP32S3 Dev Module".
+Set AOOSP_FAULT_ENABLED to 1 in aoosp_fault.h (it is 0 by default), otherwise
+nothing is injected.
+
+BEHAVIOR
+No LEDs are switched on; the chain is scanned continuously.
+
+OUTPUT
+The run below is the sketch unchanged on a PC, not on the OSP32 board:
+the Arduino shim of extras/host, an aospi_sim chain "RSS" as on the
+board, and the virtual bus clock of aospi_sim with aoosp_tmodel_default().
+Times are simulated bus time, and the welcome lines are left out.
+
+chain: 3 nodes (loop)
+pass 1: 629 transfers, 10 episodes
+  injected  txcrc 2, rxcrc 2, drop 7, statflip 1, break 4
+  recovery    count   min_us  mean_us   max_us transfers
+  response       10      110      294      937         2
+  retry           7      110      110      110         1
+  reinit          3      186      371      519         3
+  resetinit       2      936      936      937         6
+*/
+
+
+#define RETRIES     2   // retries before escalating to resetinit
+#define SCANS       200 // READSTAT scans of the chain per pass
+
+
+// Print result if it is not ok
+#define CHECK_RESULT(msg) do { if( result!=aoresult_ok ) Serial.printf("ERROR %d in %s (%s)\n", result, msg, aoresult_to_str(result) ); } while( 0 )
+
+
+static uint16_t last;
+
+
+// The fault schedule; transfers count from aoosp_fault_arm()
+static void schedule_init() {
+  // kind, tid, addr, mask, start, count, period
+  const aoosp_fault_rule_t rules[] = {
+    { AOOSP_FAULT_DROP,     0x40,                0x001,               0x00,  20, 3,  2 }, // every other READSTAT to node 1 loses its response, 3 times
+    { AOOSP_FAULT_RXCRC,    AOOSP_FAULT_ANYTID,  AOOSP_FAULT_ANYADDR, 0x00, 100, 2, 10 }, // two responses with bad CRC
+    { AOOSP_FAULT_STATFLIP, 0x40,                0x002,               0x08, 200, 1,  1 }, // node 2 reports a CE (CRC error) flag
+    { AOOSP_FAULT_TXCRC,    AOOSP_FAULT_ANYTID,  AOOSP_FAULT_ANYADDR, 0x00, 300, 2, 50 }, // two telegrams with bad CRC
+    { AOOSP_FAULT_BREAK,    AOOSP_FAULT_ANYTID,  0x002,               0x00, 400, 4,  1 }, // chain broken before node 2, for 4 lost transfers
+    { AOOSP_FAULT_DROP,     AOOSP_FAULT_ANYTID,  AOOSP_FAULT_ANYADDR, 0x00, 500, 4,  1 }, // 4 responses in a row lost (resetinit falls back to BiDir)
+  };
+  aoosp_fault_rules_clear();
+  for( size_t i=0; i<sizeof rules/sizeof rules[0]; i++ ) aoosp_fault_rule_add(&rules[i]);
+}
+
+
+static void chain_init() {
+  aoresult_t result;
+  int        loop;
+  result= aoosp_exec_resetinit(&last,&loop); CHECK_RESULT("resetinit");
+  result= aoosp_send_clrerror(0x000); CHECK_RESULT("clrerror(000)");
+  result= aoosp_send_goactive(0x000); CHECK_RESULT("goactive(000)");
+  Serial.printf("chain: %u nodes (%s)\n", last, loop==1 ? "loop" : "bidir");
+}
+
+
+// Reads the status of node `addr`, with the escalating recovery steps
+static void scan_node(uint16_t addr) {
+  aoresult_t result;
+  uint8_t    stat;
+  // Step 1: retry
+  int tries = 0;
+  do {
+    result= aoosp_send_readstat(addr,&stat);
+  } while( result!=aoresult_ok && tries++<RETRIES );
+  if( result==aoresult_ok && tries>0 ) aoosp_fault_recovered(AOOSP_FAULT_REC_RETRY);
+  // Step 3: resetinit (reports itself)
+  if( result!=aoresult_ok ) {
+    uint16_t last_;
+    result= aoosp_exec_resetinit(&last_); CHECK_RESULT("resetinit");
+    if( result==aoresult_ok ) result= aoosp_send_clrerror(0x000);
+    if( result==aoresult_ok ) result= aoosp_send_goactive(0x000);
+    return;
+  }
+  // Step 2: partial re-init of the node when it reports errors
+  if( stat & AOOSP_STAT_FLAGS_SAID_ERRORS ) {
+    result= aoosp_send_clrerror(addr);
+    if( result==aoresult_ok ) result= aoosp_send_goactive(addr);
+    if( result==aoresult_ok ) aoosp_fault_recovered(AOOSP_FAULT_REC_REINIT);
+  }
+}
+
+
+static void stats_print(int pass) {
+  aoosp_fault_stat_t st;
+  aoosp_fault_stat_get(&st);
+  Serial.printf("pass %d: %lu transfers, %lu episodes\n", pass, st.transfers, st.episodes);
+  Serial.printf("  injected ");
+  for( int kind=1; kind<AOOSP_FAULT_KINDS; kind++ ) Serial.printf(" %s %lu%s", aoosp_fault_kind_str(kind), st.injected[kind], kind<AOOSP_FAULT_KINDS-1 ? "," : "\n");
+  Serial.printf("  recovery    count   min_us  mean_us   max_us transfers\n");
+  for( int rec=0; rec<AOOSP_FAULT_RECS; rec++ ) {
+    const aoosp_fault_ttr_t * t = &st.ttr[rec];
+    Serial.printf("  %-10s %6lu %8lu %8lu %8lu %9lu\n", aoosp_fault_rec_str(rec), t->count, t->minus, t->meanus, t->maxus, t->transfers);
+  }
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial.printf("\n\nWelcome to aoosp_fault.ino\n");
+  Serial.printf("version: result %s spi %s osp %s\n", AORESULT_VERSION, AOSPI_VERSION, AOOSP_VERSION );
+  #if !AOOSP_FAULT_ENABLED
+    Serial.printf("WARNING: AOOSP_FAULT_ENABLED is 0 in aoosp_fault.h, nothing is injected\n");
+  #endif
+
+  aospi_init();
+  aoosp_init();
+  Serial.printf("\n");
+
+  chain_init();
+  schedule_init();
+}
+
+
+static int pass;
+
+
+void loop() {
+  aoosp_fault_arm();
+  for( int scan=0; scan<SCANS; scan++ ) {
+    for( uint16_t addr=1; addr<=last; addr++ ) scan_node(addr);
+  }
+  aoosp_fault_disarm();
+  stats_print(++pass);
+  delay(5000);
+}
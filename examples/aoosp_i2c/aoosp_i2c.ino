@@ -28,6 +28,8 @@ This demo first performs an I2C scan using the I2C bridge in a SAID.
 Then it issues I2C read and write transactions to an EEPROM memory,
 assumed to have I2C device address 0x50 connected to the first SAID.
 Finally it polls the INT line and shows its status on SAID1.RGB0.
+The INT line is polled via the INT dispatcher (module aoosp_i2cint), which
+slows down polling when there is no activity on INT.
 
 HARDWARE
 The demo runs on the OSP32 board. Have a cable from the OUT connector to 
@@ -208,6 +210,23 @@ void i2c_eeprom() {
 
 // Poll the INT pin
 #define ADDR_LED 0x001
+
+
+// Called by the INT dispatcher on every edge of the INT line
+void i2c_int_edge(uint16_t addr, int level, uint32_t latencyus) {
+  aoresult_t result;
+  (void)addr;
+  if( level ) {
+    result= aoosp_send_setpwmchn(ADDR_LED, 0/*chn*/, 0x7FFF/*red*/, 0x0000/*green*/, 0x0000/*blue*/);
+    if( result!=aoresult_ok ) { Serial.printf("setpwmchn %s\n", aoresult_to_str(result) ); return; }
+  } else {
+    result= aoosp_send_setpwmchn(ADDR_LED, 0/*chn*/, 0x0000/*red*/, 0x7FFF/*green*/, 0x0000/*blue*/);
+    if( result!=aoresult_ok ) { Serial.printf("setpwmchn %s\n", aoresult_to_str(result) ); return; }
+  }
+  Serial.printf("INT %d (latency <%luus)\n", level, latencyus);
+}
+
+
 void i2c_int_setup() {
   aoresult_t result;
   int        enable;
@@ -235,6 +254,14 @@ void i2c_int_setup() {
   if( result!=aoresult_ok ) { Serial.printf("clrerror %s\n", aoresult_to_str(result) ); return; }
   result= aoosp_send_goactive(ADDR_LED);
   if( result!=aoresult_ok ) { Serial.printf("goactive %s\n", aoresult_to_str(result) ); return; }
+  // Initial color (INT not pressed)
+  result= aoosp_send_setpwmchn(ADDR_LED, 0/*chn*/, 0x0000/*red*/, 0x7FFF/*green*/, 0x0000/*blue*/);
+  if( result!=aoresult_ok ) { Serial.printf("setpwmchn %s\n", aoresult_to_str(result) ); return; }
+
+  // Register the I2C bridge with the INT dispatcher
+  aoosp_i2cint_clear();
+  result= aoosp_i2cint_add(ADDR,i2c_int_edge);
+  if( result!=aoresult_ok ) { Serial.printf("i2cint_add %s\n", aoresult_to_str(result) ); return; }
 
   // Instruct user
   Serial.printf("\nPress INT button and check L1.0\n");
@@ -244,17 +271,9 @@ void i2c_int_setup() {
 void i2c_int_loop() {
   aoresult_t result;
 
-  uint8_t flags, speed;
-  result= aoosp_send_readi2ccfg(ADDR, &flags, &speed);
-  if( result!=aoresult_ok ) { Serial.printf("readi2ccfg %s\n", aoresult_to_str(result) ); return; }
-  uint8_t intstate= flags & AOOSP_I2CCFG_FLAGS_INT;
-  if( intstate ) {
-    result= aoosp_send_setpwmchn(ADDR_LED, 0/*chn*/, 0x7FFF/*red*/, 0x0000/*green*/, 0x0000/*blue*/);
-    if( result!=aoresult_ok ) { Serial.printf("setpwmchn %s\n", aoresult_to_str(result) ); return; }
-  } else {
-    result= aoosp_send_setpwmchn(ADDR_LED, 0/*chn*/, 0x0000/*red*/, 0x7FFF/*green*/, 0x0000/*blue*/);
-    if( result!=aoresult_ok ) { Serial.printf("setpwmchn %s\n", aoresult_to_str(result) ); return; }
-  }
+  // Poll the INT lines that are due, spending at most 500us bus time per 'frame'
+  result= aoosp_i2cint_poll(500);
+  if( result!=aoresult_ok ) { Serial.printf("i2cint_poll %s\n", aoresult_to_str(result) ); return; }
 
   delay(1);
 }
@@ -0,0 +1,196 @@
+// aoosp_syncmeas.ino - measures latency and skew of SYNC telegram versus SYNC pin
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#include <aospi.h>
+#include <aoosp.h>
+
+
+/*
+DESCRIPTION
+This demo measures how fast, and how simultaneously, nodes activate staged
+PWM settings after a commit, for the two commit methods of aoosp_sync.ino:
+the broadcast SYNC telegram and the SYNC pin. Each round stages a new PWM
+level (channel 0 of all nodes, configured with AOOSP_CURCHN_FLAGS_SYNCEN),
+and commits it with aoosp_syncmeas_commit(), which takes a time stamp of
+the commit request. Loopback observers time stamp when the LEDs actually
+switch: each observer is a GPIO with an interrupt on both edges.
+aoosp_syncmeas computes per method
+  - latency: commit request to activation (min, mean, max), its spread
+    over all observed nodes, and the jitter of a node from commit to commit
+  - skew: last minus first observed activation of one commit
+Every PRINTEVERY rounds the statistics are printed (in us).
+
+For other chain lengths than the one at hand, extras/host/aoosp_syncsim
+runs the same measurement against a simulated chain.
+
+HARDWARE
+The demo runs on the OSP32 board. Add a loopback observer for the nodes
+in OBSERVERS[]: e.g. a photo transistor at the LED, or a level shifted tap
+of the driver output, that changes the level of the GPIO when the LED
+switches. Observe the first and the last node of the chain for the skew.
+For the SYNC pin method set USE_HARDWARE_SYNC to 1, and wire the SYNC pins
+as in aoosp_sync.ino (jumper J8, SAID-2 only on OSP32); this writes OTP, so
+the OTP password must be known and installed.
+In Arduino select board "ESP32S3 Dev Module".
+
+BEHAVIOR
+Channel 0 of all nodes toggles between dim and off every ROUNDMS.
+
+OUTPUT
+No capture on the board is available yet. Below is the same measurement
+by extras/host/aoosp_syncsim (simulated chain, virtual clock, default
+timing model), `aoosp_syncsim -N 2 -N 1000 -n 100`, in its own format;
+times are in us, as in the table this sketch prints. On the board the
+observers add their own latency.
+
+model: 3333 ns/byte, 80000 ns/transfer, 200 ns/hop, 50 ns node clock, 5 ns/node pin wiring
+ nodes method     commits    lat_min   lat_mean    lat_max     spread     jitter  skew_mean   skew_max
+     2 telegram       100      93.33      93.46      93.58      0.101      0.015       0.20       0.25
+     2 pin            100       0.16       0.18       0.21      0.015      0.013       0.02       0.04
+  1000 telegram       100      93.33     193.26     293.18     57.735      0.014     199.80     199.84
+  1000 pin            100       0.15       2.68       5.20      1.443      0.008       5.01       5.04
+*/
+
+
+// Set to 1 to also measure the SYNC pin (see HARDWARE)
+#define USE_HARDWARE_SYNC 0
+#define SYNC_PIN          9    // GPIO wired to the SYNC pins (OSP32: GPIO9, jumper J8)
+#define ROUNDMS           20   // time per round (window for the observers)
+#define PRINTEVERY        100  // rounds between statistics prints
+#define PWMLEVEL          0x0100
+
+
+// Loopback observers: node address and the GPIO that sees its channel 0 switch
+typedef struct observer_s { uint16_t addr; uint8_t gpio; } observer_t;
+static const observer_t OBSERVERS[] = { { 0x001, 4 }, { 0x002, 5 } };
+#define OBSERVERS_NUM ( (int)(sizeof OBSERVERS / sizeof OBSERVERS[0]) )
+
+
+// Print result if it is not ok
+#define CHECK_RESULT(msg) do { if( result!=aoresult_ok ) Serial.printf("ERROR %d in %s (%s)\n", result, msg, aoresult_to_str(result) ); } while( 0 )
+
+
+// Observer time stamps, written by the ISR, read after the round
+static volatile uint32_t obs_cycles[OBSERVERS_NUM];
+static volatile uint8_t  obs_seen[OBSERVERS_NUM];
+
+
+// Keeps the first edge of a round per observer
+static void IRAM_ATTR obs_isr(void * arg) {
+  int ix = (int)(intptr_t)arg;
+  if( obs_seen[ix] ) return;
+  obs_cycles[ix] = aoosp_cycles();
+  obs_seen[ix] = 1;
+}
+
+
+static void obs_init() {
+  for( int ix=0; ix<OBSERVERS_NUM; ix++ ) {
+    pinMode(OBSERVERS[ix].gpio, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(OBSERVERS[ix].gpio), obs_isr, (void*)(intptr_t)ix, CHANGE);
+  }
+}
+
+
+static void obs_arm() {
+  for( int ix=0; ix<OBSERVERS_NUM; ix++ ) obs_seen[ix] = 0;
+}
+
+
+// Passes the edges of this round to aoosp_syncmeas
+static void obs_report() {
+  for( int ix=0; ix<OBSERVERS_NUM; ix++ ) {
+    if( obs_seen[ix] ) aoosp_syncmeas_observe(OBSERVERS[ix].addr, obs_cycles[ix]);
+  }
+}
+
+
+static const aoosp_syncmeas_method_t METHODS[] = {
+  aoosp_syncmeas_method_telegram,
+  #if USE_HARDWARE_SYNC
+    aoosp_syncmeas_method_pin,
+  #endif
+};
+#define METHODS_NUM ( (int)(sizeof METHODS / sizeof METHODS[0]) )
+
+
+static void stats_print() {
+  Serial.printf("method   commits missed  lat_min lat_mean  lat_max   spread   jitter skew_mean skew_max\n");
+  float cpu = aoosp_cycles_per_us();
+  for( int m=0; m<METHODS_NUM; m++ ) {
+    aoosp_syncmeas_stat_t st;
+    aoosp_syncmeas_get(METHODS[m], &st);
+    Serial.printf("%-8s %7lu %6lu %8.2f %8.2f %8.2f %8.3f %8.3f %8.2f %8.2f\n", aoosp_syncmeas_method_str(METHODS[m]), st.commits, st.missed,
+      st.latmin/cpu, st.latmean/cpu, st.latmax/cpu, st.latspread/cpu, st.jitter/cpu, st.skewmean/cpu, st.skewmax/cpu);
+  }
+}
+
+
+static void chain_init() {
+  aoresult_t result;
+  uint16_t   last;
+  int        loop;
+  result= aoosp_exec_resetinit(&last,&loop); CHECK_RESULT("resetinit");
+  result= aoosp_send_clrerror(0x000); CHECK_RESULT("clrerror(000)");
+  result= aoosp_send_goactive(0x000); CHECK_RESULT("goactive(000)");
+  // Channel 0 of all nodes waits for SYNC (RGBIs have no SYNCEN; this demo is for SAIDs)
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    result= aoosp_send_setcurchn(addr, 0, AOOSP_CURCHN_FLAGS_SYNCEN, AOOSP_CURCHN_CUR_DEFAULT, AOOSP_CURCHN_CUR_DEFAULT, AOOSP_CURCHN_CUR_DEFAULT); CHECK_RESULT("setcurchn");
+  }
+  #if USE_HARDWARE_SYNC
+    aoosp_syncmeas_pin_set(SYNC_PIN);
+    for( int ix=0; ix<OBSERVERS_NUM; ix++ ) aoosp_exec_syncpinenable_set(OBSERVERS[ix].addr,1);
+  #endif
+  Serial.printf("chain: %u nodes, %d observers\n", last, OBSERVERS_NUM);
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial.printf("\n\nWelcome to aoosp_syncmeas.ino\n");
+  Serial.printf("version: result %s spi %s osp %s\n", AORESULT_VERSION, AOSPI_VERSION, AOOSP_VERSION );
+
+  aospi_init();
+  aoosp_init();
+  Serial.printf("\n");
+
+  chain_init();
+  obs_init();
+  aoosp_syncmeas_reset();
+}
+
+
+static int round_num;
+
+
+void loop() {
+  aoresult_t result;
+  // Stage the next level (toggles between dim and off), then commit with the next method
+  uint16_t level = round_num%2 ? 0 : PWMLEVEL;
+  result= aoosp_send_setpwmchn(0x000, 0, level, level, level); CHECK_RESULT("setpwmchn");
+  obs_arm();
+  result= aoosp_syncmeas_commit(METHODS[(round_num/2)%METHODS_NUM]); CHECK_RESULT("commit");
+  delay(ROUNDMS);
+  obs_report();
+  aoosp_syncmeas_close();
+
+  round_num++;
+  if( round_num%PRINTEVERY==0 ) stats_print();
+}
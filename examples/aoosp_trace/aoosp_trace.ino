@@ -0,0 +1,130 @@
+// aoosp_trace.ino - traces telegrams at frame rate, dumps the trace on command
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#include <aospi.h>
+#include <aoosp.h>
+
+
+/*
+DESCRIPTION
+This demo runs a running-light animation over the whole chain at frame
+rate, while aoosp_trace records every telegram and response in a RAM ring.
+Recording does not format anything, so it does not change the timing of
+the animation (compare with aoosp_loglevel_tele). The ring keeps the most
+recent traffic. Type a command in the Serial monitor:
+  d   dumps the trace raw (to be decoded on a PC)
+  D   dumps the trace decoded (on the target)
+  s   restarts the trace (clears the ring)
+The raw dump can be captured and decoded on a PC with the host tool
+  extras/host/aoosp_tracedump capture.txt
+
+HARDWARE
+The demo runs on the OSP32 board, but a longer chain is more interesting.
+In Arduino select board "ESP32S3 Dev Module".
+Set AOOSP_TRACE_ENABLED to 1 in aoosp_trace.h (it is 0 by default), otherwise
+nothing is recorded.
+
+BEHAVIOR
+A dim light runs over the chain; on every command the trace is printed.
+
+OUTPUT
+The run below is the sketch unchanged on a PC, not on the OSP32 board:
+the Arduino shim of extras/host, an aospi_sim chain "RSS" as on the
+board, and the virtual bus clock of aospi_sim with aoosp_tmodel_default().
+Times are simulated bus time, and the welcome lines are left out.
+The dump is the one of command D after 2 seconds.
+
+chain: 3 nodes
+commands: d (dump raw), D (dump decoded), s (restart trace)
+trace cycles/us 1000 records 512 lost 82
+       0.0 tx 003 readtempstat A0 0C 42 CA
+     114.1 rx 003 readtempstat A0 0D 42 6F 80 27 temp=0x6F=25 stat=0x80=active-tv-clou (-6, active-ol-clou)
+   19714.1 tx 003 setpwm A0 0F CF 00 FF 00 00 00 00 00 00 3C
+   19834.1 rx -
+   19834.1 tx 001 setpwm A0 07 CF 00 FF 0F FF 0F FF 0F FF 85
+   19954.1 rx -
+   19954.1 tx 001 readtempstat A0 04 42 4F
+   20068.3 rx 001 readtempstat A0 05 42 8C 80 D1 temp=0x8C=54 stat=0x80=active-tv-clou (25, active-ol-clou)
+   39768.3 tx 001 setpwm A0 07 CF 00 FF 00 00 00 00 00 00 64
+   39888.2 rx -
+   39888.2 tx 002 setpwm A0 0B CF 00 FF 0F FF 0F FF 0F FF F1
+   40008.2 rx -
+   40008.2 tx 002 readtempstat A0 08 42 1F
+   40122.4 rx 002 readtempstat A0 09 42 6F 80 AD temp=0x6F=25 stat=0x80=active-tv-clou (-6, active-ol-clou)
+   59722.4 tx 002 setpwm A0 0B CF 00 FF 00 00 00 00 00 00 10
+   59842.4 rx -
+(496 more lines)
+*/
+
+
+#define FRAMEMS 20 // one animation step per frame
+
+
+static uint16_t last;
+
+
+// One frame: the previous node off, the next node on
+void frame() {
+  static uint16_t addr = 1;
+  aoosp_send_setpwmchn(addr, 0, 0x0000, 0x0000, 0x0000);
+  addr = addr>=last ? 1 : addr+1;
+  aoosp_send_setpwmchn(addr, 0, 0x0FFF, 0x0FFF, 0x0FFF);
+  uint8_t temp, stat;
+  aoosp_send_readtempstat(addr, &temp, &stat);
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial.printf("\n\nWelcome to aoosp_trace.ino\n");
+  Serial.printf("version: result %s spi %s osp %s\n", AORESULT_VERSION, AOSPI_VERSION, AOOSP_VERSION );
+  #if !AOOSP_TRACE_ENABLED
+    Serial.printf("WARNING: AOOSP_TRACE_ENABLED is 0 in aoosp_trace.h, nothing is recorded\n");
+  #endif
+
+  aospi_init();
+  aoosp_init();
+
+  aoresult_t result = aoosp_exec_resetinit(&last);
+  if( result!=aoresult_ok ) Serial.printf("ERROR %s in resetinit\n", aoresult_to_str(result) );
+  result = aoosp_send_clrerror(0x000);
+  if( result!=aoresult_ok ) Serial.printf("ERROR %s in clrerror\n", aoresult_to_str(result) );
+  result = aoosp_send_goactive(0x000);
+  if( result!=aoresult_ok ) Serial.printf("ERROR %s in goactive\n", aoresult_to_str(result) );
+  Serial.printf("\nchain: %d nodes\n", last );
+  Serial.printf("commands: d (dump raw), D (dump decoded), s (restart trace)\n");
+
+  aoosp_trace_start();
+}
+
+
+void loop() {
+  static uint32_t t0;
+  if( millis()-t0 >= FRAMEMS ) {
+    t0 = millis();
+    frame();
+  }
+  // Commands from Serial
+  switch( Serial.read() ) {
+    case 'd': aoosp_trace_dump(0); break;
+    case 'D': aoosp_trace_dump(1); break;
+    case 's': aoosp_trace_start(); Serial.printf("trace restarted\n"); break;
+  }
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+# aoosp_telem.py - converts an aoosp_telem binary record stream to CSV or JSON
+#
+# Usage
+#   aoosp_telem.py [--json] [--bench] [--tcp HOST:PORT | --serial DEV | FILE]
+#
+#   FILE           binary stream captured to a file ("-" or absent is stdin)
+#   --tcp H:P      connects to a host build streaming with aoosp_telem_sink_fd
+#   --serial DEV   reads a serial port (requires pyserial), e.g. /dev/ttyUSB0
+#   --json         one JSON object per line instead of CSV
+#   --bench        decodes only, and reports records/s and MB/s on stderr
+#
+# The record layout is documented in aoosp_telem.h: sync (0xA5), type,
+# payload size, payload (little endian, starting with a u32 micros time
+# stamp), and the OSP CRC over all preceding bytes of the record. On a CRC
+# error the decoder resynchronizes on the next sync byte; the number of
+# skipped bytes is reported on stderr.
+
+import json
+import socket
+import struct
+import sys
+import time
+
+
+SYNC = 0xA5
+# type: (name, struct format of the payload after the time stamp, field names)
+TYPES = {
+  0x01: ("node", "<HBBI", ("addr", "temp", "stat", "agems")),
+  0x02: ("stat", "<HBB",  ("addr", "oldstat", "newstat")),
+  0x03: ("temp", "<HB",   ("addr", "temp")),
+  0x04: ("data", "<HB",   ("addr", "id")),  # followed by raw bytes
+  0x05: ("drop", "<I",    ("dropped",)),
+}
+
+
+def crc_table():
+  # OSP CRC: polynomial 0x2F, init 0, no reflection (same table as aoosp_crc.cpp)
+  table = []
+  for i in range(256):
+    c = i
+    for _ in range(8):
+      c = ((c << 1) ^ 0x2F) & 0xFF if c & 0x80 else (c << 1) & 0xFF
+    table.append(c)
+  return table
+
+
+CRC_TABLE = crc_table()
+
+
+def crc(buf):
+  c = 0
+  for b in buf:
+    c = CRC_TABLE[c ^ b]
+  return c
+
+
+class Decoder:
+  """Incremental decoder; feed() bytes, yields records as dicts."""
+  def __init__(self):
+    self.buf = bytearray()
+    self.skipped = 0
+
+  def feed(self, data):
+    self.buf += data
+    pos = 0
+    buf = self.buf
+    while True:
+      # Find sync
+      if pos < len(buf) and buf[pos] != SYNC:
+        nxt = buf.find(SYNC, pos)
+        nxt = len(buf) if nxt < 0 else nxt
+        self.skipped += nxt - pos
+        pos = nxt
+      if len(buf) - pos < 3:
+        break
+      size = buf[pos + 2]
+      end = pos + 3 + size + 1
+      if len(buf) < end:
+        break
+      if size < 4 or crc(buf[pos:end - 1]) != buf[end - 1]:
+        self.skipped += 1
+        pos += 1
+        continue
+      rtype = buf[pos + 1]
+      payload = bytes(buf[pos + 3:end - 1])
+      pos = end
+      rec = self.record(rtype, payload)
+      if rec is not None:
+        yield rec
+    del buf[:pos]
+
+  @staticmethod
+  def record(rtype, payload):
+    (timeus,) = struct.unpack_from("<I", payload, 0)
+    if rtype not in TYPES:
+      return {"type": "unknown-%02X" % rtype, "timeus": timeus}
+    name, fmt, fields = TYPES[rtype]
+    n = struct.calcsize(fmt)
+    if len(payload) < 4 + n:
+      return None
+    rec = {"type": name, "timeus": timeus}
+    rec.update(zip(fields, struct.unpack_from(fmt, payload, 4)))
+    if name == "data":
+      rec["data"] = payload[4 + n:].hex()
+    return rec
+
+
+CSV_COLUMNS = ("type", "timeus", "addr", "temp", "stat", "agems", "oldstat", "newstat", "id", "data", "dropped")
+
+
+def open_source(args):
+  if args.tcp:
+    host, port = args.tcp.rsplit(":", 1)
+    sock = socket.create_connection((host, int(port)))
+    return lambda: sock.recv(65536)
+  if args.serial:
+    import serial  # pyserial
+    ser = serial.Serial(args.serial, args.baud, timeout=0.1)
+    return lambda: ser.read(65536)
+  f = sys.stdin.buffer if args.file in (None, "-") else open(args.file, "rb")
+  return lambda: f.read(65536)
+
+
+def main():
+  import argparse
+  ap = argparse.ArgumentParser(description="Converts an aoosp_telem binary stream to CSV or JSON")
+  ap.add_argument("file", nargs="?", help="captured stream (default stdin)")
+  ap.add_argument("--tcp", help="HOST:PORT to connect to")
+  ap.add_argument("--serial", help="serial port to read")
+  ap.add_argument("--baud", type=int, default=921600, help="baud rate for --serial")
+  ap.add_argument("--json", action="store_true", help="output JSON lines instead of CSV")
+  ap.add_argument("--bench", action="store_true", help="decode only, report throughput")
+  args = ap.parse_args()
+
+  read = open_source(args)
+  dec = Decoder()
+  out = sys.stdout
+  if not args.json and not args.bench:
+    out.write(",".join(CSV_COLUMNS) + "\n")
+  records = 0
+  nbytes = 0
+  t0 = time.perf_counter()
+  while True:
+    chunk = read()
+    if not chunk:
+      if args.serial:
+        continue  # read timeout, keep listening
+      break
+    nbytes += len(chunk)
+    for rec in dec.feed(chunk):
+      records += 1
+      if args.bench:
+        continue
+      if args.json:
+        out.write(json.dumps(rec) + "\n")
+      else:
+        out.write(",".join(str(rec.get(c, "")) for c in CSV_COLUMNS) + "\n")
+  dt = time.perf_counter() - t0
+  if dec.skipped:
+    sys.stderr.write("aoosp_telem: skipped %d bytes (resync)\n" % dec.skipped)
+  if args.bench and dt > 0:
+    sys.stderr.write("aoosp_telem: %d records, %d bytes in %.3f s: %.0f records/s, %.2f MB/s\n"
+                     % (records, nbytes, dt, records / dt, nbytes / dt / 1e6))
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,102 @@
+// Arduino.cpp - minimal Arduino API for building aoosp on a Linux host
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <stdarg.h>   // va_list
+#include <time.h>     // clock_gettime, nanosleep
+#include <Arduino.h>  // own API
+
+
+HostSerial Serial;
+
+
+int HostSerial::printf(const char * format, ...) {
+  va_list args;
+  va_start(args, format);
+  int n = vprintf(format, args);
+  va_end(args);
+  return n;
+}
+
+
+size_t HostSerial::write(const uint8_t * buf, size_t size) {
+  return fwrite(buf, 1, size, stdout);
+}
+
+
+static host_clock_now_t  host_clock_now;
+static host_clock_wait_t host_clock_wait;
+
+
+void host_clock_set(host_clock_now_t now, host_clock_wait_t wait) {
+  host_clock_now  = now;
+  host_clock_wait = wait;
+}
+
+
+uint64_t host_ns() {
+  if( host_clock_now ) return host_clock_now();
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+
+uint32_t micros() {
+  return (uint32_t)(host_ns()/1000);
+}
+
+
+uint32_t millis() {
+  return (uint32_t)(host_ns()/1000000);
+}
+
+
+void delay(uint32_t ms) {
+  if( host_clock_wait ) { host_clock_wait(ms*1000000ULL); return; }
+  struct timespec ts = { (time_t)(ms/1000), (long)(ms%1000)*1000000L };
+  nanosleep(&ts, 0);
+}
+
+
+void delayMicroseconds(uint32_t us) {
+  if( host_clock_wait ) { host_clock_wait(us*1000ULL); return; }
+  uint64_t t0 = host_ns();
+  while( host_ns()-t0 < us*1000ULL ) ;
+}
+
+
+static host_pin_hook_t host_pin_hook;
+
+
+void host_pin_hook_set(host_pin_hook_t hook) {
+  host_pin_hook = hook;
+}
+
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin; (void)mode;
+}
+
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if( host_pin_hook ) host_pin_hook(pin, val);
+}
@@ -0,0 +1,77 @@
+// Arduino.h - minimal Arduino API for building aoosp on a Linux host
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _ARDUINO_H_
+#define _ARDUINO_H_
+
+
+// Host builds (extras/host) compile the library sources unchanged; this
+// header provides the few Arduino functions they use. Serial prints to
+// stdout. Time is the steady clock of the host, or a virtual clock installed
+// by a tool (see host_clock_set). Not for use on a target.
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+// Serial, printing to stdout
+class HostSerial {
+  public:
+    void   begin(unsigned long baud) { (void)baud; }
+    int    printf(const char * format, ...) __attribute__((format(printf,2,3)));
+    size_t write(const uint8_t * buf, size_t size);
+    int    available() { return 0; }
+    int    availableForWrite() { return 1<<16; }
+    int    read() { return -1; }
+    void   flush() { fflush(stdout); }
+};
+extern HostSerial Serial;
+
+
+// Time (steady clock of the host, or the installed virtual clock)
+uint32_t micros();
+uint32_t millis();
+void     delay(uint32_t ms);
+void     delayMicroseconds(uint32_t us);
+// Time in ns; also the time base of aoosp_cycles() on the host
+uint64_t host_ns();
+// Installs a virtual clock: `now` returns its time in ns, `wait` lets it advance by ns (delays); 0,0 restores the host clock
+typedef uint64_t (*host_clock_now_t)();
+typedef void     (*host_clock_wait_t)(uint64_t ns);
+void     host_clock_set(host_clock_now_t now, host_clock_wait_t wait);
+
+
+// Digital pins; there are none, but a tool may observe writes with host_pin_hook_set()
+#define LOW     0
+#define HIGH    1
+#define INPUT   0x01
+#define OUTPUT  0x03
+void     pinMode(uint8_t pin, uint8_t mode);
+void     digitalWrite(uint8_t pin, uint8_t val);
+typedef void (*host_pin_hook_t)(uint8_t pin, uint8_t val);
+void     host_pin_hook_set(host_pin_hook_t hook);
+
+
+#endif
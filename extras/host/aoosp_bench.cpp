@@ -0,0 +1,364 @@
+// aoosp_bench.cpp - micro benchmarks of codec, CRC, pretty print and exec on a PC
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+// Usage
+//   aoosp_bench [-f FILTER] [-m MS]
+//
+//   -f FILTER   only runs benchmarks whose name contains FILTER
+//   -m MS       minimal measuring time per benchmark in ms (default 20)
+//
+// Prints one CSV line per benchmark (stable names and columns, to be
+// tracked across releases):
+//   name,ns_per_op,allocs_per_op,iterations
+// Groups (name prefixes)
+//   crc_    aoosp_crc on telegram sized buffers
+//   con_    construct (encode) function of a telegram
+//   des_    destruct (decode) function of a response
+//   prt_    aoosp_prt_xxx pretty printers
+//   send_   complete aoosp_send_xxx (encode, stand-in SPI, decode, observers)
+//   exec_   aoosp_exec_xxx routines against a simulated chain
+//   dlog_   aoosp_send log record capture (what logging costs the bus task) and formatting
+//
+// The con and des functions are static in aoosp_send.cpp; this file
+// includes that source to reach them, so the benchmark links the library
+// without aoosp_send.cpp. The simulated chain is a transfer handler of
+// the stand-in aospi (aospi_host) that answers every telegram with a
+// well formed response of a chain of BENCH_NODES SAIDs. Each benchmark
+// is calibrated to run at least -m ms; of 5 runs the fastest is reported.
+// Allocations (malloc, calloc, realloc, new) are counted with wrappers
+// around the glibc allocator.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>                   // getopt
+#include <aospi_host.h>               // aospi_host_set
+#include <aoosp.h>                    // all modules
+#include "../../src/aoosp_send.cpp"   // static aoosp_con_xxx and aoosp_des_xxx
+
+
+// === ALLOCATIONS ========================================
+
+
+extern "C" void * __libc_malloc(size_t size);
+extern "C" void * __libc_calloc(size_t num, size_t size);
+extern "C" void * __libc_realloc(void * ptr, size_t size);
+extern "C" void   __libc_free(void * ptr);
+
+
+static volatile uint32_t bench_allocs;
+
+
+extern "C" void * malloc(size_t size)                { bench_allocs++; return __libc_malloc(size); }
+extern "C" void * calloc(size_t num, size_t size)    { bench_allocs++; return __libc_calloc(num,size); }
+extern "C" void * realloc(void * ptr, size_t size)   { bench_allocs++; return __libc_realloc(ptr,size); }
+extern "C" void   free(void * ptr)                   { __libc_free(ptr); }
+
+
+// === SIMULATED CHAIN ====================================
+
+
+#define BENCH_NODES 8
+
+
+// Answers every telegram with a response of the expected size (last node for INIT, not busy for I2CCFG)
+static aoresult_t bench_chain(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize) {
+  (void)txsize;
+  if( rx==0 ) return aoresult_ok;
+  uint8_t  tid  = tx[2] & 0x7F;
+  uint16_t addr = (tx[0]&0x0F)<<6 | tx[1]>>2;
+  if( tid==AOOSP_TID_INITBIDIR || tid==AOOSP_TID_INITLOOP ) addr = BENCH_NODES;
+  int psize = rxsize-4;
+  int psi   = psize<8 ? psize : 7;
+  rx[0] = 0xA0 | addr>>6;
+  rx[1] = (addr&0x3F)<<2 | psi>>1;
+  rx[2] = (psi&1)<<7 | tid;
+  for( int i=0; i<psize; i++ ) rx[3+i] = 0x50;
+  if( tid==AOOSP_TID_READI2CCFG ) rx[3] = 0x01; // flags 0 (not busy, no nack), speed 1
+  if( tid==AOOSP_TID_IDENTIFY   ) { rx[3]=0x00; rx[4]=0x00; rx[5]=0x00; rx[6]=0x40; } // SAID
+  rx[rxsize-1] = aoosp_crc(rx, rxsize-1);
+  return aoresult_ok;
+}
+
+
+// === BENCHMARKS =========================================
+
+
+static volatile uint32_t bench_sink;  // results go here, so they are not optimized away
+static aoosp_tele_t      bench_tele;  // telegram for con benchmarks
+static aoosp_tele_t      bench_resp;  // response for des benchmarks (see bench_resp_make)
+static uint8_t           bench_buf[16];
+
+
+// Makes a valid response for the telegram in bench_tele of `size` bytes in bench_resp
+static void bench_resp_make(uint8_t size) {
+  bench_resp.size = size;
+  bench_chain(bench_tele.data, bench_tele.size, bench_resp.data, size);
+}
+
+
+// Unicast address that varies with the iteration
+#define ADDR(i) ( 1 + (i)%BENCH_NODES )
+
+
+typedef aoresult_t (*bench_fn_t)(uint32_t i);
+typedef void (*bench_setup_t)();
+
+
+// CRC
+static aoresult_t bench_crc_4(uint32_t i)  { bench_buf[0]=i; bench_sink+= aoosp_crc(bench_buf,4);  return aoresult_ok; }
+static aoresult_t bench_crc_12(uint32_t i) { bench_buf[0]=i; bench_sink+= aoosp_crc(bench_buf,12); return aoresult_ok; }
+
+// Construct
+static uint8_t bench_rs;
+static aoresult_t bench_con_reset(uint32_t i)        { return aoosp_con_reset(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_clrerror(uint32_t i)     { return aoosp_con_clrerror(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_initbidir(uint32_t i)    { return aoosp_con_initbidir(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_initloop(uint32_t i)     { return aoosp_con_initloop(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_gosleep(uint32_t i)      { return aoosp_con_gosleep(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_goactive(uint32_t i)     { return aoosp_con_goactive(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_godeepsleep(uint32_t i)  { return aoosp_con_godeepsleep(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_identify(uint32_t i)     { return aoosp_con_identify(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_asktinfo(uint32_t i)     { return aoosp_con_asktinfo(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_asktinfo_init(uint32_t i){ return aoosp_con_asktinfo_init(&bench_tele,ADDR(i),0x00,0xFF,&bench_rs); }
+static aoresult_t bench_con_readmult(uint32_t i)     { return aoosp_con_readmult(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_setmult(uint32_t i)      { return aoosp_con_setmult(&bench_tele,ADDR(i),i&0x7FFF); }
+static aoresult_t bench_con_sync(uint32_t i)         { return aoosp_con_sync(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_idle(uint32_t i)         { return aoosp_con_idle(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_foundry(uint32_t i)      { return aoosp_con_foundry(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_cust(uint32_t i)         { return aoosp_con_cust(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_burn(uint32_t i)         { return aoosp_con_burn(&bench_tele,ADDR(i)); }
+static aoresult_t bench_con_i2cread8(uint32_t i)     { return aoosp_con_i2cread8(&bench_tele,ADDR(i),0x50,i,4); }
+static aoresult_t bench_con_i2cwrite8(uint32_t i)    { return aoosp_con_i2cwrite8(&bench_tele,ADDR(i),0x50,i,bench_buf,4); }
+static aoresult_t bench_con_readlast(uint32_t i)     { return aoosp_con_readlast(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_goactive_sr(uint32_t i)  { return aoosp_con_goactive_sr(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readstat(uint32_t i)     { return aoosp_con_readstat(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readtempstat(uint32_t i) { return aoosp_con_readtempstat(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readcomst(uint32_t i)    { return aoosp_con_readcomst(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readledst(uint32_t i)    { return aoosp_con_readledst(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readledstchn(uint32_t i) { return aoosp_con_readledstchn(&bench_tele,ADDR(i),i%3,&bench_rs); }
+static aoresult_t bench_con_readtemp(uint32_t i)     { return aoosp_con_readtemp(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readsetup(uint32_t i)    { return aoosp_con_readsetup(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_setsetup(uint32_t i)     { return aoosp_con_setsetup(&bench_tele,ADDR(i),i); }
+static aoresult_t bench_con_readpwm(uint32_t i)      { return aoosp_con_readpwm(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_readpwmchn(uint32_t i)   { return aoosp_con_readpwmchn(&bench_tele,ADDR(i),i%3,&bench_rs); }
+static aoresult_t bench_con_setpwm(uint32_t i)       { return aoosp_con_setpwm(&bench_tele,ADDR(i),i&0x7FFF,0x1234,0x7FFF,i&7); }
+static aoresult_t bench_con_setpwmchn(uint32_t i)    { return aoosp_con_setpwmchn(&bench_tele,ADDR(i),i%3,i&0xFFFF,0x1234,0xFFFF); }
+static aoresult_t bench_con_readcurchn(uint32_t i)   { return aoosp_con_readcurchn(&bench_tele,ADDR(i),i%3,&bench_rs); }
+static aoresult_t bench_con_setcurchn(uint32_t i)    { return aoosp_con_setcurchn(&bench_tele,ADDR(i),i%3,i&7,0,0,0); }
+static aoresult_t bench_con_readi2ccfg(uint32_t i)   { return aoosp_con_readi2ccfg(&bench_tele,ADDR(i),&bench_rs); }
+static aoresult_t bench_con_seti2ccfg(uint32_t i)    { return aoosp_con_seti2ccfg(&bench_tele,ADDR(i),i&0x0F,1); }
+static aoresult_t bench_con_readotp(uint32_t i)      { return aoosp_con_readotp(&bench_tele,ADDR(i),i&0x1F,&bench_rs); }
+static aoresult_t bench_con_setotp(uint32_t i)       { return aoosp_con_setotp(&bench_tele,ADDR(i),i&0x1F,bench_buf,7); }
+static aoresult_t bench_con_settestdata(uint32_t i)  { return aoosp_con_settestdata(&bench_tele,ADDR(i),i&0xFFFF); }
+static aoresult_t bench_con_settestpw(uint32_t i)    { return aoosp_con_settestpw(&bench_tele,ADDR(i),0x123456789ABCULL^i); }
+static aoresult_t bench_con_settestpw_sr(uint32_t i) { return aoosp_con_settestpw_sr(&bench_tele,ADDR(i),0x123456789ABCULL^i,&bench_rs); }
+
+// Destruct (setup constructs the telegram and a matching response)
+static uint16_t bench_u16a, bench_u16b, bench_u16c;
+static uint8_t  bench_u8a, bench_u8b, bench_u8c, bench_u8d;
+static uint32_t bench_u32;
+#define SETUP(name,...) static void bench_setup_##name() { aoosp_con_##name(&bench_tele,1,##__VA_ARGS__,&bench_rs); bench_resp_make(bench_rs); }
+SETUP(initbidir)
+SETUP(initloop)
+SETUP(identify)
+SETUP(asktinfo)
+SETUP(readmult)
+SETUP(readlast)
+SETUP(goactive_sr)
+SETUP(readstat)
+SETUP(readtempstat)
+SETUP(readcomst)
+SETUP(readledst)
+SETUP(readledstchn,1)
+SETUP(readtemp)
+SETUP(readsetup)
+SETUP(readpwm)
+SETUP(readpwmchn,1)
+SETUP(readcurchn,1)
+SETUP(readi2ccfg)
+SETUP(readotp,0x0D)
+SETUP(settestpw_sr,0x123456789ABCULL)
+#undef SETUP
+static aoresult_t bench_des_initbidir(uint32_t i)    { (void)i; return aoosp_des_initbidir(&bench_resp,&bench_u16a,&bench_u8a,&bench_u8b); }
+static aoresult_t bench_des_initloop(uint32_t i)     { (void)i; return aoosp_des_initloop(&bench_resp,&bench_u16a,&bench_u8a,&bench_u8b); }
+static aoresult_t bench_des_identify(uint32_t i)     { (void)i; return aoosp_des_identify(&bench_resp,&bench_u32); }
+static aoresult_t bench_des_asktinfo(uint32_t i)     { (void)i; return aoosp_des_asktinfo(&bench_resp,&bench_u8a,&bench_u8b); }
+static aoresult_t bench_des_readmult(uint32_t i)     { (void)i; return aoosp_des_readmult(&bench_resp,&bench_u16a); }
+static aoresult_t bench_des_readlast(uint32_t i)     { (void)i; return aoosp_des_readlast(&bench_resp,bench_buf,8); }
+static aoresult_t bench_des_goactive_sr(uint32_t i)  { (void)i; return aoosp_des_goactive_sr(&bench_resp,&bench_u8a,&bench_u8b); }
+static aoresult_t bench_des_readstat(uint32_t i)     { (void)i; return aoosp_des_readstat(&bench_resp,&bench_u8a); }
+static aoresult_t bench_des_readtempstat(uint32_t i) { (void)i; return aoosp_des_readtempstat(&bench_resp,&bench_u8a,&bench_u8b); }
+static aoresult_t bench_des_readcomst(uint32_t i)    { (void)i; return aoosp_des_readcomst(&bench_resp,&bench_u8a); }
+static aoresult_t bench_des_readledst(uint32_t i)    { (void)i; return aoosp_des_readledst(&bench_resp,&bench_u8a); }
+static aoresult_t bench_des_readledstchn(uint32_t i) { (void)i; return aoosp_des_readledstchn(&bench_resp,&bench_u8a); }
+static aoresult_t bench_des_readtemp(uint32_t i)     { (void)i; return aoosp_des_readtemp(&bench_resp,&bench_u8a); }
+static aoresult_t bench_des_readsetup(uint32_t i)    { (void)i; return aoosp_des_readsetup(&bench_resp,&bench_u8a); }
+static aoresult_t bench_des_readpwm(uint32_t i)      { (void)i; return aoosp_des_readpwm(&bench_resp,&bench_u16a,&bench_u16b,&bench_u16c,&bench_u8a); }
+static aoresult_t bench_des_readpwmchn(uint32_t i)   { (void)i; return aoosp_des_readpwmchn(&bench_resp,&bench_u16a,&bench_u16b,&bench_u16c); }
+static aoresult_t bench_des_readcurchn(uint32_t i)   { (void)i; return aoosp_des_readcurchn(&bench_resp,&bench_u8a,&bench_u8b,&bench_u8c,&bench_u8d); }
+static aoresult_t bench_des_readi2ccfg(uint32_t i)   { (void)i; return aoosp_des_readi2ccfg(&bench_resp,&bench_u8a,&bench_u8b); }
+static aoresult_t bench_des_readotp(uint32_t i)      { (void)i; return aoosp_des_readotp(&bench_resp,bench_buf,8); }
+static aoresult_t bench_des_settestpw_sr(uint32_t i) { (void)i; return aoosp_des_settestpw_sr(&bench_resp,&bench_u8a,&bench_u8b); }
+
+// Pretty print
+#define PRT(expr) do { bench_sink+= (uintptr_t)(expr); } while(0)
+static aoresult_t bench_prt_temp_said(uint32_t i)    { PRT(aoosp_prt_temp_said(i)); return aoresult_ok; }
+static aoresult_t bench_prt_temp_rgbi(uint32_t i)    { PRT(aoosp_prt_temp_rgbi(i)); return aoresult_ok; }
+static aoresult_t bench_prt_stat_state(uint32_t i)   { PRT(aoosp_prt_stat_state(i)); return aoresult_ok; }
+static aoresult_t bench_prt_stat_rgbi(uint32_t i)    { PRT(aoosp_prt_stat_rgbi(i)); return aoresult_ok; }
+static aoresult_t bench_prt_stat_said(uint32_t i)    { PRT(aoosp_prt_stat_said(i)); return aoresult_ok; }
+static aoresult_t bench_prt_ledst(uint32_t i)        { PRT(aoosp_prt_ledst(i)); return aoresult_ok; }
+static aoresult_t bench_prt_pwm_rgbi(uint32_t i)     { PRT(aoosp_prt_pwm_rgbi(i&0x7FFF,0x1234,0x7FFF,i&7)); return aoresult_ok; }
+static aoresult_t bench_prt_pwm_said(uint32_t i)     { PRT(aoosp_prt_pwm_said(i&0xFFFF,0x1234,0xFFFF)); return aoresult_ok; }
+static aoresult_t bench_prt_com_sio1(uint32_t i)     { PRT(aoosp_prt_com_sio1(i)); return aoresult_ok; }
+static aoresult_t bench_prt_com_sio2(uint32_t i)     { PRT(aoosp_prt_com_sio2(i)); return aoresult_ok; }
+static aoresult_t bench_prt_com_rgbi(uint32_t i)     { PRT(aoosp_prt_com_rgbi(i)); return aoresult_ok; }
+static aoresult_t bench_prt_com_said(uint32_t i)     { PRT(aoosp_prt_com_said(i)); return aoresult_ok; }
+static aoresult_t bench_prt_setup(uint32_t i)        { PRT(aoosp_prt_setup(i)); return aoresult_ok; }
+static aoresult_t bench_prt_bytes_12(uint32_t i)     { bench_buf[0]=i; PRT(aoosp_prt_bytes(bench_buf,12)); return aoresult_ok; }
+static aoresult_t bench_prt_curchn(uint32_t i)       { PRT(aoosp_prt_curchn(i&0x0F)); return aoresult_ok; }
+static aoresult_t bench_prt_i2ccfg(uint32_t i)       { PRT(aoosp_prt_i2ccfg(i&0x0F)); return aoresult_ok; }
+static aoresult_t bench_prt_i2ccfg_speed(uint32_t i) { PRT(aoosp_prt_i2ccfg_speed(i&0x0F)); return aoresult_ok; }
+static char bench_prtbuf[48];
+static aoresult_t bench_prt_stat_state_str(uint32_t i) { PRT(aoosp_prt_stat_state_str(i)); return aoresult_ok; }
+static aoresult_t bench_prt_stat_said_r(uint32_t i)    { PRT(aoosp_prt_stat_said_r(bench_prtbuf,sizeof bench_prtbuf,i)); return aoresult_ok; }
+static aoresult_t bench_prt_pwm_said_r(uint32_t i)     { PRT(aoosp_prt_pwm_said_r(bench_prtbuf,sizeof bench_prtbuf,i&0xFFFF,0x1234,0xFFFF)); return aoresult_ok; }
+static aoresult_t bench_prt_bytes_12_r(uint32_t i)     { bench_buf[0]=i; PRT(aoosp_prt_bytes_r(bench_prtbuf,sizeof bench_prtbuf,bench_buf,12)); return aoresult_ok; }
+static aoresult_t bench_prt_curchn_str(uint32_t i)     { PRT(aoosp_prt_curchn_str(i&0x0F)); return aoresult_ok; }
+#undef PRT
+
+// Complete send (against the simulated chain)
+static aoresult_t bench_send_setpwmchn(uint32_t i)    { return aoosp_send_setpwmchn(ADDR(i),i%3,i&0xFFFF,0x1234,0xFFFF); }
+static aoresult_t bench_send_readtempstat(uint32_t i) { return aoosp_send_readtempstat(ADDR(i),&bench_u8a,&bench_u8b); }
+static aoresult_t bench_send_readstat(uint32_t i)     { return aoosp_send_readstat(ADDR(i),&bench_u8a); }
+static aoresult_t bench_send_identify(uint32_t i)     { return aoosp_send_identify(ADDR(i),&bench_u32); }
+static aoresult_t bench_send_readotp(uint32_t i)      { return aoosp_send_readotp(ADDR(i),0x0D,bench_buf,8); }
+
+// Exec (against the simulated chain; includes their delays, e.g. 150us after RESET)
+static aoresult_t bench_exec_resetinit(uint32_t i)         { (void)i; return aoosp_exec_resetinit(&bench_u16a); }
+static aoresult_t bench_exec_i2cenable_get(uint32_t i)     { int en; return aoosp_exec_i2cenable_get(ADDR(i),&en); }
+static aoresult_t bench_exec_syncpinenable_get(uint32_t i) { int en; return aoosp_exec_syncpinenable_get(ADDR(i),&en); }
+static aoresult_t bench_exec_i2cwrite8(uint32_t i)         { return aoosp_exec_i2cwrite8(ADDR(i),0x50,i,bench_buf,4); }
+static aoresult_t bench_exec_i2cread8(uint32_t i)          { return aoosp_exec_i2cread8(ADDR(i),0x50,i,bench_buf,4); }
+
+// Deferred log (setup constructs a READTEMPSTAT; capture is the log block of aoosp_send_readtempstat, the ring is restarted when full)
+static aoosp_dlog_rec_t bench_dlog_rec;
+static char             bench_dlog_line[AOOSP_DLOG_LINESIZE];
+static void bench_setup_dlog() { bench_setup_readtempstat(); aoosp_dlog_deferred_set(1); }
+static aoresult_t bench_dlog_capture(aoosp_loglevel_t level, uint32_t i) {
+  if( aoosp_dlog_count()==AOOSP_DLOG_RECS ) aoosp_dlog_deferred_set(1);
+  aoosp_loglevel = level;
+  aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readtempstat,&bench_tele,&bench_resp,aoresult_ok,aoresult_ok,aoresult_ok);
+  rec->arg[0]=ADDR(i); rec->arg[1]=bench_resp.data[3]; rec->arg[2]=bench_resp.data[4];
+  aoosp_dlog_commit(rec);
+  aoosp_loglevel = aoosp_loglevel_none;
+  return aoresult_ok;
+}
+static aoresult_t bench_dlog_capture_args(uint32_t i) { return bench_dlog_capture(aoosp_loglevel_args,i); }
+static aoresult_t bench_dlog_capture_tele(uint32_t i) { return bench_dlog_capture(aoosp_loglevel_tele,i); }
+static aoresult_t bench_dlog_format(uint32_t i) {
+  if( i==0 ) { bench_dlog_capture_tele(0); aoosp_dlog_pop(&bench_dlog_rec); }
+  bench_dlog_rec.arg[2] = i;
+  bench_sink+= aoosp_dlog_format(&bench_dlog_rec,bench_dlog_line,sizeof bench_dlog_line);
+  return aoresult_ok;
+}
+
+
+typedef struct bench_s { const char * name; bench_fn_t fn; bench_setup_t setup; } bench_t;
+#define B(name)  { #name, bench_##name, 0 }
+#define BD(name) { "des_" #name, bench_des_##name, bench_setup_##name }
+static const bench_t bench_all[] = {
+  B(crc_4), B(crc_12),
+  B(con_reset), B(con_clrerror), B(con_initbidir), B(con_initloop), B(con_gosleep), B(con_goactive), B(con_godeepsleep),
+  B(con_identify), B(con_asktinfo), B(con_asktinfo_init), B(con_readmult), B(con_setmult), B(con_sync), B(con_idle),
+  B(con_foundry), B(con_cust), B(con_burn), B(con_i2cread8), B(con_i2cwrite8), B(con_readlast), B(con_goactive_sr),
+  B(con_readstat), B(con_readtempstat), B(con_readcomst), B(con_readledst), B(con_readledstchn), B(con_readtemp),
+  B(con_readsetup), B(con_setsetup), B(con_readpwm), B(con_readpwmchn), B(con_setpwm), B(con_setpwmchn),
+  B(con_readcurchn), B(con_setcurchn), B(con_readi2ccfg), B(con_seti2ccfg), B(con_readotp), B(con_setotp),
+  B(con_settestdata), B(con_settestpw), B(con_settestpw_sr),
+  BD(initbidir), BD(initloop), BD(identify), BD(asktinfo), BD(readmult), BD(readlast), BD(goactive_sr), BD(readstat),
+  BD(readtempstat), BD(readcomst), BD(readledst), BD(readledstchn), BD(readtemp), BD(readsetup), BD(readpwm),
+  BD(readpwmchn), BD(readcurchn), BD(readi2ccfg), BD(readotp), BD(settestpw_sr),
+  B(prt_temp_said), B(prt_temp_rgbi), B(prt_stat_state), B(prt_stat_rgbi), B(prt_stat_said), B(prt_ledst),
+  B(prt_pwm_rgbi), B(prt_pwm_said), B(prt_com_sio1), B(prt_com_sio2), B(prt_com_rgbi), B(prt_com_said), B(prt_setup),
+  B(prt_bytes_12), B(prt_curchn), B(prt_i2ccfg), B(prt_i2ccfg_speed),
+  B(prt_stat_state_str), B(prt_stat_said_r), B(prt_pwm_said_r), B(prt_bytes_12_r), B(prt_curchn_str),
+  B(send_setpwmchn), B(send_readtempstat), B(send_readstat), B(send_identify), B(send_readotp),
+  B(exec_resetinit), B(exec_i2cenable_get), B(exec_syncpinenable_get), B(exec_i2cwrite8), B(exec_i2cread8),
+  { "dlog_capture_args", bench_dlog_capture_args, bench_setup_dlog }, { "dlog_capture_tele", bench_dlog_capture_tele, bench_setup_dlog },
+  { "dlog_format", bench_dlog_format, bench_setup_dlog },
+};
+#undef B
+#undef BD
+
+
+// === HARNESS ============================================
+
+
+// Runs `fn` `n` times; returns ns, sets allocations and errors
+static uint64_t bench_run(bench_fn_t fn, uint32_t n, uint32_t * allocs, uint32_t * errors) {
+  uint32_t a0 = bench_allocs;
+  uint32_t e  = 0;
+  uint32_t c0 = aoosp_cycles();
+  for( uint32_t i=0; i<n; i++ ) e+= fn(i)!=aoresult_ok;
+  uint32_t c1 = aoosp_cycles();
+  *allocs = bench_allocs-a0;
+  *errors = e;
+  return (uint64_t)(c1-c0)*1000/aoosp_cycles_per_us();
+}
+
+
+int main(int argc, char * argv[]) {
+  const char * filter = 0;
+  uint32_t     minms = 20;
+  int          opt;
+  while( (opt=getopt(argc, argv, "f:m:"))!=-1 ) {
+    switch( opt ) {
+      case 'f': filter = optarg; break;
+      case 'm': minms = atoi(optarg); break;
+      default : fprintf(stderr, "usage: %s [-f FILTER] [-m MS]\n", argv[0]); return 2;
+    }
+  }
+
+  aospi_host_set(bench_chain);
+  printf("name,ns_per_op,allocs_per_op,iterations\n");
+  for( size_t b=0; b<sizeof bench_all/sizeof bench_all[0]; b++ ) {
+    const bench_t * bench = &bench_all[b];
+    if( filter && strstr(bench->name, filter)==0 ) continue;
+    if( bench->setup ) bench->setup();
+    // Calibrate: double the iterations until the run takes minms (ms fit in 32 bits of ns cycles)
+    uint32_t n = 1, allocs, errors;
+    while( bench_run(bench->fn, n, &allocs, &errors) < minms*1000000ULL && n<(1U<<28) ) n*= 2;
+    // Fastest of 5 runs
+    uint64_t best = 0;
+    for( int r=0; r<5; r++ ) {
+      uint64_t ns = bench_run(bench->fn, n, &allocs, &errors);
+      if( r==0 || ns<best ) best = ns;
+    }
+    if( errors ) fprintf(stderr, "%s: %lu of %lu operations failed\n", bench->name, (unsigned long)errors, (unsigned long)n);
+    printf("%s,%.2f,%.2f,%lu\n", bench->name, (double)best/n, (double)allocs/n, (unsigned long)n);
+    fflush(stdout);
+  }
+  return 0;
+}
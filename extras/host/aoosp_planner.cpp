@@ -0,0 +1,134 @@
+// aoosp_planner.cpp - frame rate capacity planner for an OSP chain (command line)
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+// Usage
+//   aoosp_planner [-s SAIDS] [-r RGBIS] [-c CHANS] [-d DIAG] [-y] [-l]
+//                 [-f FPS]... [-p PERCENT] [-g GROUPS]
+//                 [-B BYTENS] [-G GAPNS] [-H HOPNS] [-T TURNNS]
+//
+//   -s SAIDS       number of SAIDs in the chain (default 0)
+//   -r RGBIS       number of RGBIs in the chain (default 0)
+//   -c CHANS       channels in use per SAID (default 3)
+//   -d DIAG        diagnostics budget: status reads per frame (default 1)
+//   -y             each frame is latched with a broadcast SYNC
+//   -l             the chain is in Loop (default BiDir)
+//   -f FPS         target frame rate; repeat for several (default 50 and 100)
+//   -p PERCENT     sample workload for "dirty": channels changing per frame (default 25)
+//   -g GROUPS      sample workload for "groups": number of groups (default 4)
+//   -B, -G, -H, -T timing model: ns per byte, per transfer (gap), per hop,
+//                  and turnaround (default: aoosp_tmodel_default, 3333 80000 200 0)
+//
+// Prints, per strategy (see aoosp_plan.h), the telegrams and bytes per
+// frame, the predicted frame time and achievable frame rate, and the bus
+// utilization and headroom at each target frame rate. The gain column
+// compares the achievable frame rate with sending every channel ("all").
+// The exit code is 1 when "all" does not sustain the first target.
+//
+// The default timing model (aoosp_tmodel_default, as aoosp_syncsim and
+// aoosp_simchain) adds a time per transfer and a hop delay to the wire time,
+// roughly as measured by aoosp_time.ino. Use the parameters found by
+// aoosp_tmodel_calibrate() on a real chain (aoosp_tmodel_get) for the chain
+// at hand.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>       // getopt
+#include <aoresult.h>     // aoresult_t
+#include <aoosp.h>        // aoosp_plan_frame, aoosp_tmodel_xxx
+
+
+#define PLANNER_FPS_MAX 4
+
+
+int main(int argc, char * argv[]) {
+  aoosp_plan_chain_t chain = { 0, 0, 3, 1, 0, 0 };
+  aoosp_tmodel_t     model;
+  float              fps[PLANNER_FPS_MAX];
+  int                fpsnum = 0;
+  int                dirtypct = 25;
+  int                groups = 4;
+  int                opt;
+  aoosp_tmodel_init(0, 0);
+  aoosp_tmodel_get(&model);
+  while( (opt=getopt(argc, argv, "s:r:c:d:ylf:p:g:B:G:H:T:"))!=-1 ) {
+    switch( opt ) {
+      case 's': chain.saids = atoi(optarg); break;
+      case 'r': chain.rgbis = atoi(optarg); break;
+      case 'c': chain.chans = atoi(optarg); break;
+      case 'd': chain.diag = atoi(optarg); break;
+      case 'y': chain.sync = 1; break;
+      case 'l': chain.loop = 1; break;
+      case 'f': if( fpsnum<PLANNER_FPS_MAX ) fps[fpsnum++] = atof(optarg); break;
+      case 'p': dirtypct = atoi(optarg); break;
+      case 'g': groups = atoi(optarg); break;
+      case 'B': model.bytens = atoi(optarg); break;
+      case 'G': model.gapns = atoi(optarg); break;
+      case 'H': model.hopns = atoi(optarg); break;
+      case 'T': model.turnns[0] = model.turnns[1] = atoi(optarg); break;
+      default : optind = argc+1; break;
+    }
+  }
+  if( optind!=argc || chain.saids+chain.rgbis==0 ) {
+    fprintf(stderr, "usage: %s [-s SAIDS] [-r RGBIS] [-c CHANS] [-d DIAG] [-y] [-l] [-f FPS]... [-p PERCENT] [-g GROUPS] [-B BYTENS] [-G GAPNS] [-H HOPNS] [-T TURNNS]\n", argv[0]);
+    return 2;
+  }
+  if( fpsnum==0 ) { fps[0] = 50; fps[1] = 100; fpsnum = 2; }
+
+  printf("chain: %u SAIDs (%u channels), %u RGBIs, %s, %u status reads/frame%s\n",
+    chain.saids, chain.chans, chain.rgbis, chain.loop?"Loop":"BiDir", chain.diag, chain.sync?", SYNC":"");
+  printf("model: %u ns/byte, %u ns/transfer, %u ns/hop, %u ns turnaround\n",
+    model.bytens, model.gapns, model.hopns, model.turnns[chain.loop]);
+  printf("%-16s %6s %7s %10s %8s %6s", "strategy", "tele", "bytes", "frame_us", "fps_max", "gain");
+  for( int f=0; f<fpsnum; f++ ) {
+    char use[16], room[16];
+    snprintf(use, sizeof use, "use@%g", fps[f]);
+    snprintf(room, sizeof room, "room@%g", fps[f]);
+    printf("  %8s %8s", use, room);
+  }
+  printf("\n");
+
+  // One line per strategy; the first (all) is the reference for the gain
+  int   result = 0;
+  float fpsall = 0;
+  for( int s=0; s<AOOSP_PLAN_STRATEGY_COUNT; s++ ) {
+    aoosp_plan_strategy_t strategy = (aoosp_plan_strategy_t)s;
+    int param = strategy==aoosp_plan_strategy_dirty ? dirtypct : strategy==aoosp_plan_strategy_groups ? groups : 0;
+    char name[32];
+    if( strategy==aoosp_plan_strategy_dirty ) snprintf(name, sizeof name, "%s %d%%", aoosp_plan_strategy_str(strategy), param);
+    else if( strategy==aoosp_plan_strategy_groups ) snprintf(name, sizeof name, "%s %d", aoosp_plan_strategy_str(strategy), param);
+    else snprintf(name, sizeof name, "%s", aoosp_plan_strategy_str(strategy));
+    aoosp_plan_t plan;
+    aoresult_t ar = aoosp_plan_frame(&chain, strategy, param, fps[0], &plan, &model);
+    if( ar!=aoresult_ok ) { printf("%-16s %s\n", name, aoresult_to_str(ar)); if( s==0 ) return 2; continue; }
+    if( s==0 ) fpsall = plan.fpsmax;
+    printf("%-16s %6u %7u %10.1f %8.1f %5.1fx", name, plan.telegrams, plan.bytes, plan.framens/1000.0, plan.fpsmax, fpsall>0 ? plan.fpsmax/fpsall : 0);
+    for( int f=0; f<fpsnum; f++ ) {
+      aoosp_plan_frame(&chain, strategy, param, fps[f], &plan, &model);
+      printf("  %7.1f%% %7.1f%%", plan.usage*100, plan.headroom*100);
+      if( s==0 && f==0 && plan.usage>1 ) result = 1;
+    }
+    printf("\n");
+  }
+  return result;
+}
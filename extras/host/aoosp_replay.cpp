@@ -0,0 +1,339 @@
+// aoosp_replay.cpp - replays a trace through aoosp_send on a PC, and benchmarks it per layer
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+// Usage
+//   aoosp_replay [-n ITER] [-b BASELINE] [-s BASELINE] [-t PERCENT] [-v] TRACE
+//
+//   TRACE          capture of the raw aoosp_trace_dump() output (see aoosp_tracedump)
+//   -n ITER        number of times the trace is replayed (default 100)
+//   -b BASELINE    compares the result with a baseline file; exits with 1 on a regression
+//   -s BASELINE    saves the result as baseline file
+//   -t PERCENT     regression threshold for -b (default 10)
+//   -v             also prints the per TID table
+//
+// Every recorded telegram (TX record) is replayed by calling the
+// aoosp_send_xxx() that produces it, with the arguments taken from the
+// telegram. So the real construct (encode) path runs. The stand-in aospi
+// (aospi_host) checks that the bytes sent are those of the trace (an encode
+// regression is reported as mismatch), and returns the recorded response
+// (RX record) and SPI result, so the real destruct (decode) path runs,
+// including the observers enabled in aoosp_send (AOOSP_TIDSTAT_ENABLED, ...).
+//
+// Time per telegram is split into layers with the aoosp_send hooks:
+//   encode  from the call of aoosp_send_xxx() to the pre-send hook
+//   spi     between the hooks (the stand-in aospi, i.e. a copy)
+//   decode  from the post-receive hook to the return of aoosp_send_xxx()
+// Of all iterations, the fastest is reported (least disturbed by the OS).
+// A baseline file has one "layer ns" line per layer; comparing against it
+// turns the replay of production traffic into a regression benchmark.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>       // getopt
+#include <aoresult.h>     // aoresult_t
+#include <aospi_host.h>   // aospi_host_set
+#include <aoosp.h>        // aoosp_send_xxx, aoosp_trace_parse, aoosp_hooks_set
+
+
+// === TRACE ==============================================
+
+
+// One recorded transaction: telegram and (possibly empty) response
+typedef struct replay_tx_s {
+  aoosp_trace_rec_t tx;
+  aoosp_trace_rec_t rx;
+} replay_tx_t;
+
+
+static replay_tx_t * replay_txs;
+static int           replay_num;
+
+
+// Loads the TX/RX record pairs from a raw dump; returns the number of pairs (or -1)
+static int replay_load(const char * path) {
+  FILE * file = fopen(path, "r");
+  if( file==0 ) { perror(path); return -1; }
+  char              line[256];
+  aoosp_trace_rec_t rec;
+  int               size = 0;
+  int               havetx = 0;
+  replay_num = 0;
+  while( fgets(line, sizeof line, file) ) {
+    if( aoosp_trace_parse(line, &rec)!=aoresult_ok ) continue;
+    if( rec.dir==AOOSP_TRACE_TX ) {
+      if( replay_num==size ) {
+        size = size ? 2*size : 1024;
+        replay_txs = (replay_tx_t *)realloc(replay_txs, size*sizeof(replay_tx_t));
+      }
+      replay_txs[replay_num].tx = rec;
+      havetx = 1;
+    } else if( havetx ) { // RX without TX (ring wrapped) is skipped
+      replay_txs[replay_num].rx = rec;
+      replay_num++;
+      havetx = 0;
+    }
+  }
+  fclose(file);
+  return replay_num;
+}
+
+
+// === STAND-IN SPI =======================================
+
+
+static const replay_tx_t * replay_cur;        // transaction being replayed
+static int                 replay_mismatches; // telegrams sent that differ from the trace
+
+
+// Checks the telegram against the trace, and returns the recorded response
+static aoresult_t replay_handler(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize) {
+  const replay_tx_t * cur = replay_cur;
+  if( txsize!=cur->tx.size || memcmp(tx, cur->tx.data, txsize)!=0 ) replay_mismatches++;
+  if( rx && cur->rx.size>0 ) memcpy(rx, cur->rx.data, rxsize<cur->rx.size ? rxsize : cur->rx.size);
+  return (aoresult_t)cur->rx.result;
+}
+
+
+// === DISPATCH ===========================================
+
+
+// Calls the aoosp_send_xxx() that produces telegram `d` (size bytes); returns 0 when not supported
+static int replay_send(const uint8_t * d, int size) {
+  uint16_t addr = (d[0]&0x0F)<<6 | d[1]>>2;
+  uint8_t  tid  = d[2]&0x7F;
+  int      psize = size-4; // payload size
+  uint16_t last, groups, r, g, b;
+  uint8_t  temp, stat, t2, flags, c1, c2, c3, buf[8];
+  uint32_t id;
+  switch( tid ) {
+    case AOOSP_TID_RESET:        aoosp_send_reset(addr); break;
+    case AOOSP_TID_CLRERROR:     aoosp_send_clrerror(addr); break;
+    case AOOSP_TID_INITBIDIR:    aoosp_send_initbidir(addr, &last, &temp, &stat); break;
+    case AOOSP_TID_INITLOOP:     aoosp_send_initloop(addr, &last, &temp, &stat); break;
+    case AOOSP_TID_GOSLEEP:      aoosp_send_gosleep(addr); break;
+    case AOOSP_TID_GOACTIVE:     aoosp_send_goactive(addr); break;
+    case AOOSP_TID_GODEEPSLEEP:  aoosp_send_godeepsleep(addr); break;
+    case AOOSP_TID_IDENTIFY:     aoosp_send_identify(addr, &id); break;
+    case AOOSP_TID_ASKTINFO:     aoosp_send_asktinfo(addr, &temp, &t2); break;
+    case AOOSP_TID_READMULT:     aoosp_send_readmult(addr, &groups); break;
+    case AOOSP_TID_SETMULT:      aoosp_send_setmult(addr, d[3]<<8 | d[4]); break;
+    case AOOSP_TID_SYNC:         aoosp_send_sync(addr); break;
+    case AOOSP_TID_IDLE:         aoosp_send_idle(addr); break;
+    case AOOSP_TID_I2CREAD:      aoosp_send_i2cread8(addr, d[3]>>1, d[4], d[5]); break;
+    case AOOSP_TID_I2CWRITE:     aoosp_send_i2cwrite8(addr, d[3]>>1, d[4], d+5, psize-2); break;
+    case AOOSP_TID_READLAST:     aoosp_send_readlast(addr, buf, sizeof buf); break;
+    case AOOSP_TID_GOACTIVE_SR:  aoosp_send_goactive_sr(addr, &temp, &stat); break;
+    case AOOSP_TID_READSTAT:     aoosp_send_readstat(addr, &stat); break;
+    case AOOSP_TID_READTEMPSTAT: aoosp_send_readtempstat(addr, &temp, &stat); break;
+    case AOOSP_TID_READCOMST:    aoosp_send_readcomst(addr, &stat); break;
+    case AOOSP_TID_READLEDST:    if( psize==0 ) aoosp_send_readledst(addr, &stat); else aoosp_send_readledstchn(addr, d[3], &stat); break;
+    case AOOSP_TID_READTEMP:     aoosp_send_readtemp(addr, &temp); break;
+    case AOOSP_TID_READSETUP:    aoosp_send_readsetup(addr, &flags); break;
+    case AOOSP_TID_SETSETUP:     aoosp_send_setsetup(addr, d[3]); break;
+    case AOOSP_TID_READPWM:      if( psize==0 ) aoosp_send_readpwm(addr, &r, &g, &b, &flags); else aoosp_send_readpwmchn(addr, d[3], &r, &g, &b); break;
+    case AOOSP_TID_SETPWM:
+      if( psize==6 ) aoosp_send_setpwm(addr, (d[3]&0x7F)<<8 | d[4], (d[5]&0x7F)<<8 | d[6], (d[7]&0x7F)<<8 | d[8], (d[3]>>7)<<2 | (d[5]>>7)<<1 | d[7]>>7 );
+      else aoosp_send_setpwmchn(addr, d[3], d[5]<<8 | d[6], d[7]<<8 | d[8], d[9]<<8 | d[10]);
+      break;
+    case AOOSP_TID_READCURCHN:   aoosp_send_readcurchn(addr, d[3], &flags, &c1, &c2, &c3); break;
+    case AOOSP_TID_SETCURCHN:    aoosp_send_setcurchn(addr, d[3], d[4]>>4, d[4]&0x0F, d[5]>>4, d[5]&0x0F); break;
+    case AOOSP_TID_READI2CCFG:   aoosp_send_readi2ccfg(addr, &flags, &c1); break;
+    case AOOSP_TID_SETI2CCFG:    aoosp_send_seti2ccfg(addr, d[3]>>4, d[3]&0x0F); break;
+    case AOOSP_TID_READOTP:      aoosp_send_readotp(addr, d[3], buf, sizeof buf); break;
+    case AOOSP_TID_SETTESTDATA:  aoosp_send_settestdata(addr, d[3]<<8 | d[4]); break;
+    default                    : return 0; // e.g. OTP writes and test passwords are not replayed
+  }
+  return 1;
+}
+
+
+// === TIMING =============================================
+
+
+#define REPLAY_LAYERS 3
+static const char * replay_layernames[REPLAY_LAYERS+1] = { "encode", "spi", "decode", "total" };
+
+
+static uint32_t replay_cpre;   // time stamp of pre-send hook
+static uint32_t replay_ctx;    // time stamps of post-receive hook
+static uint32_t replay_crx;
+static int      replay_hooked; // hooks were called for the current telegram
+
+
+static void replay_pretx(const uint8_t * tele, int size, uint8_t tid, uint32_t cycles) {
+  (void)tele; (void)size; (void)tid;
+  replay_cpre = cycles;
+}
+
+
+static void replay_postrx(const uint8_t * resp, int size, uint8_t tid, uint32_t txcycles, uint32_t rxcycles, aoresult_t result) {
+  (void)resp; (void)size; (void)tid; (void)result;
+  replay_ctx = txcycles;
+  replay_crx = rxcycles;
+  replay_hooked = 1;
+}
+
+
+// Per TID sums over all iterations
+typedef struct replay_tidsum_s {
+  uint32_t count;
+  double   ns[REPLAY_LAYERS];
+} replay_tidsum_t;
+static replay_tidsum_t replay_tidsums[128];
+
+
+// Replays the trace once; adds the ns per layer to `ns`; returns the number of telegrams replayed
+static int replay_run(double ns[REPLAY_LAYERS], int * skipped) {
+  int replayed = 0;
+  *skipped = 0;
+  for( int i=0; i<replay_num; i++ ) {
+    replay_cur = &replay_txs[i];
+    const aoosp_trace_rec_t * tx = &replay_cur->tx;
+    if( tx->size<4 || tx->size>AOOSP_TRACE_DATASIZE ) { (*skipped)++; continue; }
+    replay_hooked = 0;
+    uint32_t c0 = aoosp_cycles();
+    int ok = replay_send(tx->data, tx->size);
+    uint32_t c3 = aoosp_cycles();
+    if( !ok || !replay_hooked ) { (*skipped)++; continue; }
+    double layer[REPLAY_LAYERS] = { (double)(replay_cpre-c0), (double)(replay_crx-replay_ctx), (double)(c3-replay_crx) };
+    replay_tidsum_t * sum = &replay_tidsums[tx->data[2]&0x7F];
+    sum->count++;
+    for( int l=0; l<REPLAY_LAYERS; l++ ) { ns[l]+= layer[l]; sum->ns[l]+= layer[l]; }
+    replayed++;
+  }
+  return replayed;
+}
+
+
+// === BASELINE ===========================================
+
+
+// Reads "layer ns" lines into `ns` (layers not in the file are 0); returns 0 on error
+static int replay_baseline_load(const char * path, double ns[REPLAY_LAYERS+1]) {
+  FILE * file = fopen(path, "r");
+  if( file==0 ) { perror(path); return 0; }
+  char   line[128], name[32];
+  double value;
+  for( int l=0; l<=REPLAY_LAYERS; l++ ) ns[l] = 0;
+  while( fgets(line, sizeof line, file) ) {
+    if( line[0]=='#' || sscanf(line, "%31s %lf", name, &value)!=2 ) continue;
+    for( int l=0; l<=REPLAY_LAYERS; l++ ) if( strcmp(name, replay_layernames[l])==0 ) ns[l] = value;
+  }
+  fclose(file);
+  return 1;
+}
+
+
+static int replay_baseline_save(const char * path, const char * trace, const double ns[REPLAY_LAYERS+1]) {
+  FILE * file = fopen(path, "w");
+  if( file==0 ) { perror(path); return 0; }
+  fprintf(file, "# aoosp_replay baseline of %s (ns per telegram)\n", trace);
+  for( int l=0; l<=REPLAY_LAYERS; l++ ) fprintf(file, "%s %.1f\n", replay_layernames[l], ns[l]);
+  fclose(file);
+  return 1;
+}
+
+
+// === MAIN ===============================================
+
+
+int main(int argc, char * argv[]) {
+  int          iters = 100;
+  const char * basefile = 0;
+  const char * savefile = 0;
+  double       threshold = 10;
+  int          verbose = 0;
+  int          opt;
+  while( (opt=getopt(argc, argv, "n:b:s:t:v"))!=-1 ) {
+    switch( opt ) {
+      case 'n': iters = atoi(optarg); break;
+      case 'b': basefile = optarg; break;
+      case 's': savefile = optarg; break;
+      case 't': threshold = atof(optarg); break;
+      case 'v': verbose = 1; break;
+      default : optind = argc+1; break;
+    }
+  }
+  if( optind!=argc-1 || iters<1 ) {
+    fprintf(stderr, "usage: %s [-n ITER] [-b BASELINE] [-s BASELINE] [-t PERCENT] [-v] TRACE\n", argv[0]);
+    return 2;
+  }
+  const char * tracefile = argv[optind];
+  if( replay_load(tracefile)<=0 ) { fprintf(stderr, "%s: no telegrams in trace\n", tracefile); return 1; }
+
+  aoosp_init();
+  aospi_host_set(replay_handler);
+  aoosp_hooks_set(replay_pretx, replay_postrx);
+  aoosp_trace_stop(); // do not trace the replay itself
+
+  // Replay; keep the fastest iteration
+  double best[REPLAY_LAYERS+1];
+  int    replayed = 0, skipped = 0;
+  for( int it=0; it<iters; it++ ) {
+    double ns[REPLAY_LAYERS] = {0};
+    replayed = replay_run(ns, &skipped);
+    double total = ns[0]+ns[1]+ns[2];
+    if( it==0 || total<best[REPLAY_LAYERS] ) {
+      for( int l=0; l<REPLAY_LAYERS; l++ ) best[l] = ns[l];
+      best[REPLAY_LAYERS] = total;
+    }
+  }
+  if( replayed==0 ) { fprintf(stderr, "%s: no telegram could be replayed\n", tracefile); return 1; }
+  for( int l=0; l<=REPLAY_LAYERS; l++ ) best[l]/= replayed;
+
+  printf("replay: %s, %d telegrams, %d replayed, %d skipped, %d encode mismatches, %d iterations\n",
+    tracefile, replay_num, replayed, skipped, replay_mismatches/iters, iters);
+
+  // Compare with baseline
+  double base[REPLAY_LAYERS+1];
+  int    havebase = basefile && replay_baseline_load(basefile, base);
+  int    regressions = 0;
+  printf("%-8s %12s", "layer", "ns/telegram");
+  if( havebase ) printf(" %12s %8s", "baseline", "delta");
+  printf("\n");
+  for( int l=0; l<=REPLAY_LAYERS; l++ ) {
+    printf("%-8s %12.1f", replay_layernames[l], best[l]);
+    if( havebase && base[l]>0 ) {
+      double delta = (best[l]-base[l])*100/base[l];
+      int    regress = delta>threshold;
+      regressions+= regress;
+      printf(" %12.1f %+7.1f%%%s", base[l], delta, regress?" REGRESSION":"");
+    }
+    printf("\n");
+  }
+
+  // Per TID means over all iterations
+  if( verbose ) {
+    printf("\n%-4s %8s %10s %10s %10s\n", "tid", "count", "encode", "spi", "decode");
+    for( int tid=0; tid<128; tid++ ) {
+      replay_tidsum_t * sum = &replay_tidsums[tid];
+      if( sum->count==0 ) continue;
+      printf("%02X   %8lu %10.1f %10.1f %10.1f\n", tid, (unsigned long)(sum->count/iters), sum->ns[0]/sum->count, sum->ns[1]/sum->count, sum->ns[2]/sum->count);
+    }
+  }
+
+  if( savefile && !replay_baseline_save(savefile, tracefile, best) ) return 1;
+  if( havebase && regressions>0 ) { printf("%d layer(s) regressed more than %.0f%%\n", regressions, threshold); return 1; }
+  return 0;
+}
@@ -0,0 +1,282 @@
+// aoosp_simchain.cpp - runs the library against a simulated chain of up to 1000 nodes
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+// Usage
+//   aoosp_simchain [-n NODES] [-t TYPES] [-l] [-f FRAMES] [-s SECONDS]
+//                  [-v] [-B BYTENS] [-G GAPNS] [-H HOPNS] [-T TURNNS] [-E EXECNS]
+//
+//   -n NODES       chain length (default 1000)
+//   -t TYPES       node types, pattern repeated over the chain: S for SAID,
+//                  R for RGBI (default S; "RSS" is the OSP32 board)
+//   -l             chain is not cabled as loop (resetinit falls back to BiDir)
+//   -f FRAMES      number of PWM frames in the pwm phase (default 1)
+//   -s SECONDS     length of the tseries phase (default 0, skipped); implies -v
+//   -v             virtual clock: phases take simulated bus time, not host time
+//   -B, -G, -H, -T, -E  timing model of the virtual clock: ns per byte (default
+//                  3333), per transfer (gap, 80000), per hop (200), turnaround
+//                  (0) and execution of telegrams with response (0); the
+//                  defaults are aoosp_tmodel_default(), as in aoosp_planner
+//
+// Runs typical application phases with the real library (aoosp_send,
+// aoosp_exec) against the simulated chain of aospi_sim.h:
+//   init      aoosp_exec_resetinit, clrerror and goactive
+//   identify  IDENTIFY of every node, checked against the configured type
+//   pwm       frames of SETPWM(CHN) to every node, then SYNC; checked in the model
+//   stat      READSTAT of every node
+//   i2c       aoosp_exec_i2ceeprom_write/read of an I2C EEPROM (with write
+//             cycle) on the first SAID
+//   tseries   READTEMP of every node once per second (1 tick) for SECONDS,
+//             with temperatures warming up and flickering; checks that
+//             aoosp_tseries kept every sample of every node (-n 1000 -s 3600
+//             checks one hour of 1000 nodes; the Makefile sizes the store
+//             for that, with 4096 blocks)
+// Prints per phase the telegrams sent, responses received, time and
+// telegrams/s. With -v the time is bus time from the virtual clock (see
+// aospi_sim_clock_enable), deterministic and independent of the host, and the
+// pwm phase also reports the bus time per frame and the resulting frame rate.
+// At the end aoosp_busprof_print() shows the bus time per category. The exit
+// code is 1 when a phase fails, so the tool doubles as an end to end check of
+// the library on the host.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Arduino.h>      // host_ns
+#include <unistd.h>       // getopt
+#include <aoresult.h>     // aoresult_t
+#include <aospi.h>        // aospi_txcount_get
+#include <aospi_sim.h>    // aospi_sim_init
+#include <aoosp.h>        // aoosp_send_xxx, aoosp_exec_xxx
+
+
+static int simchain_fails;
+
+
+// Time in s; the virtual clock when enabled
+static double simchain_now() {
+  return host_ns()/1e9;
+}
+
+
+static double simchain_t0;
+
+
+static void simchain_begin() {
+  aospi_txcount_reset();
+  aospi_rxcount_reset();
+  simchain_t0 = simchain_now();
+}
+
+
+static void simchain_end(const char * phase, aoresult_t result) {
+  double dt = simchain_now() - simchain_t0;
+  int    tx = aospi_txcount_get();
+  printf("%-9s %-12s %8d %8d %10.3f %12.0f\n", phase, aoresult_to_str(result), tx, aospi_rxcount_get(), dt*1000, dt>0 ? tx/dt : 0 );
+  if( result!=aoresult_ok ) simchain_fails++;
+}
+
+
+static aoresult_t simchain_identify(uint16_t last) {
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    uint32_t   id;
+    aoresult_t result = aoosp_send_identify(addr, &id);
+    if( result!=aoresult_ok ) return result;
+    int said = aospi_sim_node(addr)->type==AOSPI_SIM_SAID;
+    if( said ? !AOOSP_IDENTIFY_IS_SAID(id) : !AOOSP_IDENTIFY_IS_RGBI(id) ) return aoresult_sys_id;
+  }
+  return aoresult_ok;
+}
+
+
+static aoresult_t simchain_frame(uint16_t last) {
+  aoresult_t result;
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    uint16_t v = addr & 0x7FFF;
+    if( aospi_sim_node(addr)->type==AOSPI_SIM_SAID ) result = aoosp_send_setpwmchn(addr, 0, v, v, v);
+    else result = aoosp_send_setpwm(addr, v, v, v, 0b000);
+    if( result!=aoresult_ok ) return result;
+  }
+  result = aoosp_send_sync(0x000);
+  if( result!=aoresult_ok ) return result;
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    if( aospi_sim_node(addr)->pwmact[0][1]!=(addr & 0x7FFF) ) return aoresult_sys_id;
+  }
+  return aoresult_ok;
+}
+
+
+static aoresult_t simchain_stat(uint16_t last) {
+  for( uint16_t addr=1; addr<=last; addr++ ) {
+    uint8_t    stat;
+    aoresult_t result = aoosp_send_readstat(addr, &stat);
+    if( result!=aoresult_ok ) return result;
+    if( (stat>>6)!=2 ) return aoresult_sys_id; // not active
+  }
+  return aoresult_ok;
+}
+
+
+static aospi_sim_eeprom_t simchain_eeprom;
+static aospi_sim_i2cdev_t simchain_eeprom_dev;
+
+
+static aoresult_t simchain_i2c(uint16_t last) {
+  uint16_t addr = 1;
+  while( addr<=last && aospi_sim_node(addr)->type!=AOSPI_SIM_SAID ) addr++;
+  if( addr>last ) return aoresult_ok; // no SAID, nothing to test
+  // Enable the I2C bridge in the OTP mirror, and attach an EEPROM with a write cycle
+  aospi_sim_node(addr)->otp[0x0D] |= 0x01;
+  simchain_eeprom.busyaccesses = 2;
+  simchain_eeprom_dev = aospi_sim_eeprom_dev(&simchain_eeprom, 0x50);
+  aoresult_t result = aospi_sim_i2cdev_add(addr, &simchain_eeprom_dev);
+  if( result!=aoresult_ok ) return result;
+  result = aoosp_exec_i2cpower(addr);
+  if( result!=aoresult_ok ) return result;
+  uint8_t wbuf[32], rbuf[32];
+  for( int i=0; i<32; i++ ) wbuf[i] = 0x30+i;
+  result = aoosp_exec_i2ceeprom_write(addr, 0x50, 0x04, wbuf, sizeof wbuf, 8); // not page aligned
+  if( result!=aoresult_ok ) return result;
+  result = aoosp_exec_i2ceeprom_read(addr, 0x50, 0x04, rbuf, sizeof rbuf);
+  if( result!=aoresult_ok ) return result;
+  if( memcmp(wbuf,rbuf,sizeof wbuf)!=0 ) return aoresult_sys_id;
+  if( memcmp(simchain_eeprom.mem+0x04,wbuf,sizeof wbuf)!=0 ) return aoresult_sys_id;
+  return aoresult_ok;
+}
+
+
+// Raw temperature of node `addr` in second `s` of the tseries phase: warms up one step per minute for 30 minutes, flickers one step every 5 minutes
+static uint8_t simchain_temp(uint16_t addr, uint32_t s) {
+  uint32_t warm = s/60;
+  if( warm>30 ) warm = 30;
+  return 0x50 + warm + ((s/300 + addr) & 1);
+}
+
+
+static aoresult_t simchain_tseries(uint16_t last, int seconds) {
+  aoresult_t result;
+  aoosp_tseries_init(1000);
+  // Start at a tick boundary
+  uint64_t t0ns = (aospi_sim_clock_ns()/1000000000 + 1) * 1000000000;
+  aospi_sim_clock_advance( t0ns - aospi_sim_clock_ns() );
+  uint32_t tick0 = aoosp_tseries_tick();
+  for( int s=0; s<seconds; s++ ) {
+    uint64_t ns = aospi_sim_clock_ns(), tns = t0ns + s*1000000000ULL;
+    if( ns<tns ) aospi_sim_clock_advance( tns - ns );
+    for( uint16_t addr=1; addr<=last; addr++ ) {
+      uint8_t temp;
+      aospi_sim_node(addr)->temp = simchain_temp(addr,s);
+      result = aoosp_send_readtemp(addr, &temp);
+      if( result!=aoresult_ok ) return result;
+    }
+  }
+  // Every node must have every sample
+  uint32_t * ticks = (uint32_t*)malloc(seconds*sizeof(uint32_t));
+  uint8_t  * temps = (uint8_t*)malloc(seconds);
+  result = aoresult_ok;
+  for( uint16_t addr=1; addr<=last && result==aoresult_ok; addr++ ) {
+    int count;
+    result = aoosp_tseries_query(addr, tick0, tick0+seconds-1, ticks, temps, seconds, &count);
+    if( result==aoresult_ok && count!=seconds ) { printf("  node %03X: %d of %d samples\n", addr, count, seconds); result = aoresult_sys_id; }
+    for( int s=0; s<count && result==aoresult_ok; s++ ) {
+      if( ticks[s]!=tick0+s || temps[s]!=simchain_temp(addr,s) ) { printf("  node %03X: sample %d differs\n", addr, s); result = aoresult_sys_id; }
+    }
+  }
+  free(ticks);
+  free(temps);
+  return result;
+}
+
+
+int main(int argc, char * argv[]) {
+  int          nodes = 1000;
+  const char * types = "S";
+  int          loopcabled = 1;
+  int          frames = 1;
+  int          seconds = 0;
+  int          virt = 0;
+  aoosp_tmodel_t model;
+  aoosp_tmodel_default(&model);
+  int          execns = 0;
+  int          opt;
+  while( (opt=getopt(argc,argv,"n:t:lf:s:vB:G:H:T:E:"))!=-1 ) {
+    switch( opt ) {
+      case 'n': nodes = atoi(optarg); break;
+      case 't': types = optarg; break;
+      case 'l': loopcabled = 0; break;
+      case 'f': frames = atoi(optarg); break;
+      case 's': seconds = atoi(optarg); virt = 1; break;
+      case 'v': virt = 1; break;
+      case 'B': model.bytens = atoi(optarg); break;
+      case 'G': model.gapns = atoi(optarg); break;
+      case 'H': model.hopns = atoi(optarg); break;
+      case 'T': model.turnns[0] = model.turnns[1] = atoi(optarg); break;
+      case 'E': execns = atoi(optarg); break;
+      default : fprintf(stderr,"usage: %s [-n NODES] [-t TYPES] [-l] [-f FRAMES] [-s SECONDS] [-v] [-B BYTENS] [-G GAPNS] [-H HOPNS] [-T TURNNS] [-E EXECNS]\n",argv[0]); return 2;
+    }
+  }
+
+  aospi_init();
+  aoosp_init();
+  if( aospi_sim_init(nodes,types,loopcabled)!=aoresult_ok ) { fprintf(stderr,"%s: bad -n or -t\n",argv[0]); return 2; }
+  if( frames<1 ) frames = 1;
+  for( int tid=0; tid<128; tid++ ) model.execns[tid] = execns;
+  if( virt ) aospi_sim_clock_enable(&model);
+  printf("chain: %d nodes, types %s, %s cabled\n", nodes, types, loopcabled ? "loop" : "bidir");
+  if( virt ) printf("virtual clock: %u ns/byte, %u ns/transfer, %u ns/hop, %u ns turn, %d ns exec\n", model.bytens, model.gapns, model.hopns, model.turnns[0], execns);
+  printf("%-9s %-12s %8s %8s %10s %12s\n", "phase", "result", "tx", "rx", "ms", "telegrams/s");
+
+  uint16_t   last = 0;
+  int        loop = 0;
+  aoresult_t result;
+  aoosp_busprof_reset();
+  simchain_begin();
+  result = aoosp_exec_resetinit(&last, &loop);
+  if( result==aoresult_ok ) result = aoosp_send_clrerror(0x000);
+  if( result==aoresult_ok ) result = aoosp_send_goactive(0x000);
+  if( result==aoresult_ok && last!=nodes ) result = aoresult_sys_cabling;
+  simchain_end("init", result);
+  if( result!=aoresult_ok ) return 1;
+  printf("  last %03X, %s\n", last, loop ? "loop" : "bidir");
+
+  simchain_begin(); result = simchain_identify(last); simchain_end("identify", result);
+  simchain_begin();
+  result = aoresult_ok;
+  for( int f=0; f<frames && result==aoresult_ok; f++ ) result = simchain_frame(last);
+  double framess = (simchain_now()-simchain_t0) / frames;
+  simchain_end("pwm", result);
+  if( virt ) printf("  %.1f us bus time per frame, %.1f fps\n", framess*1e6, framess>0 ? 1/framess : 0 );
+  simchain_begin(); result = simchain_stat(last);     simchain_end("stat", result);
+  simchain_begin(); result = simchain_i2c(last);      simchain_end("i2c", result);
+  if( seconds>0 ) {
+    simchain_begin(); result = simchain_tseries(last,seconds); simchain_end("tseries", result);
+    aoosp_tseries_stats_t stats;
+    aoosp_tseries_stats_get(&stats);
+    printf("  %u samples in %u blocks, %u bytes encoded, %u blocks evicted, %u bytes RAM\n", stats.samples, stats.blocks, stats.bytes, stats.evicted, stats.memory );
+  }
+
+  // Where the bus time went (the window covers the run when it is shorter than the profiler history)
+  printf("\n");
+  aoosp_busprof_print();
+
+  return simchain_fails ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+// aoosp_syncsim.cpp - simulates SYNC telegram versus SYNC pin latency and skew for chain lengths
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+// Usage
+//   aoosp_syncsim [-N NODES]... [-n COMMITS] [-B BYTENS] [-G GAPNS] [-H HOPNS]
+//                 [-C CLOCKNS] [-W WIRENS] [-S SEED]
+//
+//   -N NODES       chain length; repeat for several (default 1 8 64 256 1000)
+//   -n COMMITS     commits per method and chain length (default 200)
+//   -B BYTENS      wire time per telegram byte (default 3333, 2.4 MHz)
+//   -G GAPNS       fixed time per transfer, e.g. SPI setup (default 80000)
+//   -H HOPNS       forwarding delay of one node (default 200)
+//   -C CLOCKNS     period of the node clock; activation is sampled on it (default 50)
+//   -W WIRENS      propagation delay of the SYNC pin wiring per node (default 5)
+//   -S SEED        seed of the random node clock phases (default 1)
+//
+// Runs aoosp_syncmeas_commit() for both methods against a simulated chain,
+// so the library code path (construct and send of the SYNC telegram, the
+// pin pulse) and the statistics of aoosp_syncmeas are the real ones. The
+// simulator plays the observer:
+//   telegram  the stand-in aospi sees the SYNC telegram at SPI time t; node
+//             i activates when it received the telegram completely, at
+//             t + gap + size*byte + (i-1)*hop, sampled on its clock
+//   pin       the pin hook sees the falling edge at time t; node i
+//             activates at t + i*wire + 3 clocks (minimum pulse), sampled
+//             on its clock
+// Node clock phases are random, which gives the jitter. Byte, gap and hop
+// default to aoosp_tmodel_default(), as in aoosp_planner; the hop delay is
+// an assumption, use the one from aoosp_tmodel_calibrate().
+//
+// Time is the virtual clock of aospi_sim (aospi_sim_clock_enable), not the
+// host clock: the stand-in aospi advances it by the transfer (gap and
+// bytes), the pin pulse by its delayMicroseconds(). So the results only
+// depend on the model and the seed, not on the speed or load of the host;
+// the MCU time of the library (constructing the telegram) counts as 0.
+//
+// Prints per chain length and method the latency (commit request to
+// activation, min/mean/max), its spread over all nodes (standard deviation,
+// mostly the chain), the jitter (standard deviation per node over the
+// commits, see aoosp_syncmeas_get) and the skew along the chain (last minus
+// first activation, mean/max), all in us.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>       // getopt
+#include <Arduino.h>      // LOW, host_pin_hook_set
+#include <aoresult.h>     // aoresult_t
+#include <aospi_host.h>   // aospi_host_set
+#include <aospi_sim.h>    // aospi_sim_clock_enable, aospi_sim_clock_advance
+#include <aoosp.h>        // aoosp_syncmeas_xxx, aoosp_cycles
+
+
+#define SYNCSIM_LENGTHS_MAX 8
+#define SYNCSIM_PIN         9   // as on the OSP32 board
+
+
+static int      syncsim_nodes;
+static uint32_t syncsim_bytens  = AOOSP_TMODEL_BYTENS_DEFAULT;
+static uint32_t syncsim_gapns   = AOOSP_TMODEL_GAPNS_DEFAULT;
+static uint32_t syncsim_hopns   = AOOSP_TMODEL_HOPNS_DEFAULT;
+static uint32_t syncsim_clockns = 50;
+static uint32_t syncsim_wirens  = 5;
+
+
+// Converts ns to aoosp_cycles() units
+static uint32_t syncsim_cycles(double ns) {
+  return (uint32_t)( ns * aoosp_cycles_per_us() / 1000 );
+}
+
+
+// Time until the next edge of a node clock with random phase
+static double syncsim_phase() {
+  return syncsim_clockns * ( rand() / (RAND_MAX+1.0) );
+}
+
+
+// Stand-in aospi: a SYNC telegram activates the nodes one after the other; the transfer advances the virtual clock
+static aoresult_t syncsim_spi(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize) {
+  (void)rx; (void)rxsize;
+  uint32_t t = aoosp_cycles();
+  aospi_sim_clock_advance(syncsim_gapns + txsize*(uint64_t)syncsim_bytens);
+  if( (tx[2]&0x7F)!=AOOSP_TID_SYNC ) return aoresult_ok;
+  for( int i=1; i<=syncsim_nodes; i++ ) {
+    double ns = syncsim_gapns + txsize*syncsim_bytens + (i-1)*syncsim_hopns + syncsim_phase();
+    aoosp_syncmeas_observe(i, t + syncsim_cycles(ns));
+  }
+  return aoresult_ok;
+}
+
+
+// Pin hook: the falling edge of the SYNC pin reaches all nodes via the wiring
+static void syncsim_pin(uint8_t pin, uint8_t val) {
+  uint32_t t = aoosp_cycles();
+  if( pin!=SYNCSIM_PIN || val!=LOW ) return;
+  for( int i=1; i<=syncsim_nodes; i++ ) {
+    double ns = i*syncsim_wirens + 3*syncsim_clockns + syncsim_phase();
+    aoosp_syncmeas_observe(i, t + syncsim_cycles(ns));
+  }
+}
+
+
+// Converts cycles to us
+static double syncsim_us(double cycles) {
+  return cycles / aoosp_cycles_per_us();
+}
+
+
+int main(int argc, char * argv[]) {
+  int lengths[SYNCSIM_LENGTHS_MAX];
+  int lengthnum = 0;
+  int commits = 200;
+  int seed = 1;
+  int opt;
+  while( (opt=getopt(argc, argv, "N:n:B:G:H:C:W:S:"))!=-1 ) {
+    switch( opt ) {
+      case 'N': if( lengthnum<SYNCSIM_LENGTHS_MAX ) lengths[lengthnum++] = atoi(optarg); break;
+      case 'n': commits = atoi(optarg); break;
+      case 'B': syncsim_bytens = atoi(optarg); break;
+      case 'G': syncsim_gapns = atoi(optarg); break;
+      case 'H': syncsim_hopns = atoi(optarg); break;
+      case 'C': syncsim_clockns = atoi(optarg); break;
+      case 'W': syncsim_wirens = atoi(optarg); break;
+      case 'S': seed = atoi(optarg); break;
+      default : optind = argc+1; break;
+    }
+  }
+  if( optind!=argc || commits<1 ) {
+    fprintf(stderr, "usage: %s [-N NODES]... [-n COMMITS] [-B BYTENS] [-G GAPNS] [-H HOPNS] [-C CLOCKNS] [-W WIRENS] [-S SEED]\n", argv[0]);
+    return 2;
+  }
+  if( lengthnum==0 ) { int d[]={1,8,64,256,1000}; for( int i=0; i<5; i++ ) lengths[lengthnum++] = d[i]; }
+  srand(seed);
+
+  aoosp_init();
+  aoosp_tmodel_t model;
+  aoosp_tmodel_default(&model);
+  model.bytens = syncsim_bytens;
+  model.gapns  = syncsim_gapns;
+  model.hopns  = syncsim_hopns;
+  aospi_sim_clock_enable(&model); // virtual time: aoosp_cycles() and delays follow the simulation
+  aospi_host_set(syncsim_spi);
+  host_pin_hook_set(syncsim_pin);
+  aoosp_syncmeas_pin_set(SYNCSIM_PIN);
+
+  printf("model: %u ns/byte, %u ns/transfer, %u ns/hop, %u ns node clock, %u ns/node pin wiring\n",
+    syncsim_bytens, syncsim_gapns, syncsim_hopns, syncsim_clockns, syncsim_wirens);
+  printf("%6s %-9s %8s %10s %10s %10s %10s %10s %10s %10s\n", "nodes", "method", "commits", "lat_min", "lat_mean", "lat_max", "spread", "jitter", "skew_mean", "skew_max");
+  for( int l=0; l<lengthnum; l++ ) {
+    syncsim_nodes = lengths[l];
+    aoosp_syncmeas_reset();
+    for( int c=0; c<commits; c++ ) {
+      for( int m=0; m<AOOSP_SYNCMEAS_METHODS; m++ ) {
+        aoresult_t result = aoosp_syncmeas_commit((aoosp_syncmeas_method_t)m);
+        if( result!=aoresult_ok ) { fprintf(stderr, "commit: %s\n", aoresult_to_str(result)); return 1; }
+        aoosp_syncmeas_close();
+      }
+    }
+    for( int m=0; m<AOOSP_SYNCMEAS_METHODS; m++ ) {
+      aoosp_syncmeas_stat_t st;
+      aoosp_syncmeas_get((aoosp_syncmeas_method_t)m, &st);
+      printf("%6d %-9s %8u %10.2f %10.2f %10.2f %10.3f %10.3f %10.2f %10.2f\n", syncsim_nodes, aoosp_syncmeas_method_str((aoosp_syncmeas_method_t)m), st.commits,
+        syncsim_us(st.latmin), syncsim_us(st.latmean), syncsim_us(st.latmax), syncsim_us(st.latspread), syncsim_us(st.jitter), syncsim_us(st.skewmean), syncsim_us(st.skewmax));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+// aoosp_tracedump.cpp - decodes a trace dumped by aoosp_trace_dump on a PC
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+// Usage
+//   aoosp_tracedump [FILE]
+//
+// Reads a capture of the Serial output of aoosp_trace_dump() (raw mode)
+// from FILE or stdin; other lines in the capture are skipped. Prints one
+// line per record: time (us since the first record), time since the
+// previous record (us), and the record decoded by aoosp_trace_decode(),
+// so the PC uses the same decoder as the target.
+
+
+#include <stdio.h>
+#include <aoresult.h>     // aoresult_ok
+#include <aoosp_trace.h>  // aoosp_trace_parse, aoosp_trace_decode
+
+
+int main(int argc, char * argv[]) {
+  FILE * file = stdin;
+  if( argc>2 ) { fprintf(stderr, "usage: %s [FILE]\n", argv[0]); return 2; }
+  if( argc==2 ) {
+    file = fopen(argv[1], "r");
+    if( file==0 ) { perror(argv[1]); return 1; }
+  }
+
+  char              line[256];
+  unsigned long     cyclesperus = 1000; // ns, overruled by the dump header
+  aoosp_trace_rec_t rec;
+  uint32_t          c0 = 0, cprev = 0;
+  int               records = 0;
+  while( fgets(line, sizeof line, file) ) {
+    unsigned long cpu;
+    if( sscanf(line, "trace cycles/us %lu", &cpu)==1 && cpu>0 ) { cyclesperus = cpu; records = 0; continue; }
+    if( aoosp_trace_parse(line, &rec)!=aoresult_ok ) continue;
+    if( records==0 ) c0 = cprev = rec.cycles;
+    printf("%12.1f %8.1f %s\n", (rec.cycles-c0)/(double)cyclesperus, (rec.cycles-cprev)/(double)cyclesperus, aoosp_trace_decode(&rec) );
+    cprev = rec.cycles;
+    records++;
+  }
+  if( file!=stdin ) fclose(file);
+  return 0;
+}
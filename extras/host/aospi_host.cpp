@@ -0,0 +1,69 @@
+// aospi_host.cpp - stand-in for the aospi library on a Linux host
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <aospi.h>       // API implemented here
+#include <aospi_host.h>  // own API
+
+
+static aospi_host_handler_t aospi_host_handler;
+static int                  aospi_host_loop;
+static int                  aospi_host_txcount;
+static int                  aospi_host_rxcount;
+
+
+void aospi_host_set(aospi_host_handler_t handler) {
+  aospi_host_handler = handler;
+}
+
+
+void aospi_init() {
+  aospi_host_loop = 0;
+  aospi_host_txcount = 0;
+  aospi_host_rxcount = 0;
+}
+
+
+aoresult_t aospi_tx(const uint8_t * txbuf, int txsize) {
+  if( aospi_host_handler==0 ) return aoresult_spi_noclock;
+  aospi_host_txcount++;
+  return aospi_host_handler(txbuf, txsize, 0, 0);
+}
+
+
+aoresult_t aospi_txrx(const uint8_t * txbuf, int txsize, uint8_t * rxbuf, int rxsize) {
+  if( aospi_host_handler==0 ) return aoresult_spi_noclock;
+  aospi_host_txcount++;
+  aoresult_t result = aospi_host_handler(txbuf, txsize, rxbuf, rxsize);
+  if( result==aoresult_ok ) aospi_host_rxcount++;
+  return result;
+}
+
+
+void aospi_dirmux_set_bidir() { aospi_host_loop = 0; }
+void aospi_dirmux_set_loop()  { aospi_host_loop = 1; }
+int  aospi_dirmux_is_loop()   { return aospi_host_loop; }
+
+
+int  aospi_txcount_get()      { return aospi_host_txcount; }
+int  aospi_rxcount_get()      { return aospi_host_rxcount; }
+void aospi_txcount_reset()    { aospi_host_txcount = 0; }
+void aospi_rxcount_reset()    { aospi_host_rxcount = 0; }
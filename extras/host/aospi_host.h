@@ -0,0 +1,44 @@
+// aospi_host.h - stand-in for the aospi library on a Linux host
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOSPI_HOST_H_
+#define _AOSPI_HOST_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Host builds link aospi_host.cpp instead of the aospi library. It
+// implements the aospi functions used by aoosp and the examples (declared
+// in aospi.h of the aospi library), and passes each transfer to a handler
+// set by the host tool, e.g. one that replays a trace, or the simulated
+// chain (aospi_sim.h).
+
+
+// Handles one transfer; rx is NULL (and rxsize 0) for aospi_tx.
+typedef aoresult_t (*aospi_host_handler_t)(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize);
+
+
+// Sets the handler for all transfers (NULL: transfers fail with aoresult_spi_noclock).
+void aospi_host_set(aospi_host_handler_t handler);
+
+
+#endif
@@ -0,0 +1,670 @@
+// aospi_sim.cpp - simulated OSP chain (SAID and RGBI register models) behind the host aospi
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>       // memset, memcpy
+#include <aospi.h>        // aospi_dirmux_is_loop
+#include <aoosp_crc.h>    // aoosp_crc
+#include <aoosp_send.h>   // AOOSP_TID_xxx
+#include <Arduino.h>      // host_clock_set
+#include <aospi_host.h>   // aospi_host_set
+#include <aospi_sim.h>    // own API
+
+
+// Simulated chain
+// ===============
+// The nodes are kept in an array indexed by position (1 is the node next to
+// the MCU); a table maps addresses to positions, so a unicast telegram costs
+// the same for 1 or 1000 nodes. Broadcast and group telegrams visit all
+// nodes.
+//
+// The register models follow the telegram descriptions in aoosp_send.cpp
+// (payload layouts of the aoosp_con_xxx and aoosp_des_xxx functions). Where
+// the real node behavior is not documented, the model is simple:
+//   - a telegram with wrong preamble, size or CRC is dropped; the first
+//     node sets its CE flag
+//   - SAIDs power on (and RESET) with the OV flag set, as real SAIDs do
+//   - a telegram with response to a group or broadcast address is answered
+//     by the last addressed node
+//   - I2C transactions complete immediately, but READI2CCFG reports BUSY
+//     for aospi_sim_i2cbusypolls_set() polls
+//   - SETOTP needs a test password (any non-zero one), like real SAIDs need
+//     the correct one
+//   - PWM of a SAID channel with SYNCEN is staged until SYNC (telegram or
+//     aospi_sim_syncpin() for nodes with SYNC_PIN_EN)
+
+
+// Bit fields (same as aoosp_send.cpp)
+#define BITS_MASK(n)         ((1<<(n))-1)
+#define BITS_SLICE(v,lo,hi)  ( ((v)>>(lo)) & BITS_MASK((hi)-(lo)) )
+
+
+// Registers and flags used by the models (see aoosp_send.h for the library names)
+#define AOSPI_SIM_STAT_OV          0x10  // SAID: over voltage; RGBI: direction is Loop
+#define AOSPI_SIM_STAT_CE          0x08
+#define AOSPI_SIM_STAT_TESTMODE    0x20
+#define AOSPI_SIM_SETUP_SAID       0x13  // AOOSP_SETUP_FLAGS_SAID_DFLT
+#define AOSPI_SIM_SETUP_RGBI       0x13  // AOOSP_SETUP_FLAGS_RGBI_DFLT
+#define AOSPI_SIM_COMST_LOOP       0x10
+#define AOSPI_SIM_CURCHN_SYNCEN    0x04
+#define AOSPI_SIM_I2CCFG_BUSY      0x10  // flags are bits 7..4
+#define AOSPI_SIM_I2CCFG_NACK      0x20
+#define AOSPI_SIM_I2CCFG_INT       0x80
+#define AOSPI_SIM_I2CCFG_DEFAULT   0x0C  // flags 0, speed 100kHz
+#define AOSPI_SIM_OTP_ROW          0x0D  // I2C_BRIDGE_EN (bit 0) and SYNC_PIN_EN (bit 2)
+#define AOSPI_SIM_OTP_I2CEN        0x01
+#define AOSPI_SIM_OTP_SYNCPIN      0x04
+#define AOSPI_SIM_ID_SAID          0x00000040
+#define AOSPI_SIM_ID_RGBI          0x00000000
+#define AOSPI_SIM_TEMP_SAID        111   // 25C (aoosp_prt_temp_said)
+#define AOSPI_SIM_TEMP_RGBI        140   // 25C (aoosp_prt_temp_rgbi)
+
+
+typedef struct aospi_sim_i2cslot_s {
+  int                        pos;
+  const aospi_sim_i2cdev_t * dev;
+} aospi_sim_i2cslot_t;
+
+
+static aospi_sim_node_t    aospi_sim_chain[AOSPI_SIM_NODES_MAX+1]; // index is position, [0] unused
+static int                 aospi_sim_num;
+static int                 aospi_sim_loopcabled;
+static int16_t             aospi_sim_pos[1024];                    // address to position, 0 for none
+static int                 aospi_sim_i2cpolls = 1;
+static aospi_sim_i2cslot_t aospi_sim_i2cdevs[AOSPI_SIM_I2CDEVS_MAX];
+static int                 aospi_sim_i2cdevnum;
+
+
+// === NODE MODEL =========================================
+
+
+// Puts a node in its state after RESET (the OTP mirror survives)
+static void aospi_sim_reset(aospi_sim_node_t * node) {
+  int said = node->type==AOSPI_SIM_SAID;
+  node->addr     = 0;
+  node->state    = 0;
+  node->flags    = said ? AOSPI_SIM_STAT_OV : 0;
+  node->comst    = 0;
+  node->ledst    = 0;
+  node->setup    = said ? AOSPI_SIM_SETUP_SAID : AOSPI_SIM_SETUP_RGBI;
+  node->mult     = 0;
+  memset( node->pwm, 0, sizeof node->pwm );
+  memset( node->pwmact, 0, sizeof node->pwmact );
+  node->daytimes = 0;
+  memset( node->curchn, 0, sizeof node->curchn );
+  node->i2ccfg   = AOSPI_SIM_I2CCFG_DEFAULT;
+  node->i2clastn = 0;
+  node->i2cbusy  = 0;
+  node->testdata = 0;
+  node->testpw   = 0;
+}
+
+
+static uint8_t aospi_sim_stat(const aospi_sim_node_t * node) {
+  return node->state<<6 | node->flags | (node->testpw ? AOSPI_SIM_STAT_TESTMODE : 0);
+}
+
+
+// Finds the virtual I2C device `daddr7` on the bus of the node at `pos`
+static const aospi_sim_i2cdev_t * aospi_sim_i2cdev(int pos, uint8_t daddr7) {
+  for( int i=0; i<aospi_sim_i2cdevnum; i++ ) {
+    if( aospi_sim_i2cdevs[i].pos==pos && aospi_sim_i2cdevs[i].dev->daddr7==daddr7 ) return aospi_sim_i2cdevs[i].dev;
+  }
+  return 0;
+}
+
+
+// Runs an I2C transaction (write when wbuf, otherwise read into the last buffer)
+static void aospi_sim_i2c(aospi_sim_node_t * node, uint8_t daddr7, uint8_t raddr, const uint8_t * wbuf, int count) {
+  const aospi_sim_i2cdev_t * dev = aospi_sim_i2cdev(node-aospi_sim_chain, daddr7);
+  int nack;
+  if( wbuf ) {
+    nack = dev==0 || dev->write==0 || dev->write(dev->ctx, raddr, wbuf, count)!=0;
+  } else {
+    nack = dev==0 || dev->read==0 || dev->read(dev->ctx, raddr, node->i2clast, count)!=0;
+    node->i2clastn = nack ? 0 : count;
+  }
+  node->i2ccfg = ( node->i2ccfg & ~AOSPI_SIM_I2CCFG_NACK ) | ( nack ? AOSPI_SIM_I2CCFG_NACK : 0 );
+  node->i2cbusy = aospi_sim_i2cpolls;
+}
+
+
+// Current I2CCFG, with BUSY while polls are left and INT from the attached devices
+static uint8_t aospi_sim_i2ccfg(aospi_sim_node_t * node) {
+  uint8_t cfg = node->i2ccfg & ~(AOSPI_SIM_I2CCFG_BUSY|AOSPI_SIM_I2CCFG_INT);
+  if( node->i2cbusy>0 ) { node->i2cbusy--; cfg |= AOSPI_SIM_I2CCFG_BUSY; }
+  int pos = node-aospi_sim_chain;
+  for( int i=0; i<aospi_sim_i2cdevnum; i++ ) {
+    const aospi_sim_i2cdev_t * dev = aospi_sim_i2cdevs[i].dev;
+    if( aospi_sim_i2cdevs[i].pos==pos && dev->intline && dev->intline(dev->ctx) ) cfg |= AOSPI_SIM_I2CCFG_INT;
+  }
+  return cfg;
+}
+
+
+// Latches the PWM of channel chn, unless it waits for SYNC
+static void aospi_sim_pwm_latch(aospi_sim_node_t * node, int chn) {
+  if( node->type==AOSPI_SIM_SAID && (node->curchn[chn][0]>>4) & AOSPI_SIM_CURCHN_SYNCEN ) return;
+  memcpy( node->pwmact[chn], node->pwm[chn], sizeof node->pwm[chn] );
+}
+
+
+static void aospi_sim_sync(aospi_sim_node_t * node) {
+  memcpy( node->pwmact, node->pwm, sizeof node->pwm );
+}
+
+
+// Executes telegram `tid` (without SR bit) with payload `p` of `size` bytes on `node`;
+// fills the response payload `r` and returns its size, or -1 when the telegram has no response
+static int aospi_sim_exec(aospi_sim_node_t * node, uint8_t tid, const uint8_t * p, int size, uint8_t * r) {
+  int said = node->type==AOSPI_SIM_SAID;
+  switch( tid ) {
+    case AOOSP_TID_CLRERROR:
+      node->flags = 0;
+      return -1;
+    case AOOSP_TID_GOSLEEP: node->state = 1; return -1;
+    case AOOSP_TID_GOACTIVE: node->state = 2; return -1;
+    case AOOSP_TID_GODEEPSLEEP: node->state = 3; return -1;
+    case AOOSP_TID_IDENTIFY: {
+      uint32_t id = said ? AOSPI_SIM_ID_SAID : AOSPI_SIM_ID_RGBI;
+      r[0] = id>>24; r[1] = id>>16; r[2] = id>>8; r[3] = id;
+      return 4;
+    }
+    case AOOSP_TID_READMULT:
+      r[0] = node->mult>>8; r[1] = node->mult;
+      return 2;
+    case AOOSP_TID_SETMULT:
+      if( size==2 ) node->mult = (p[0]<<8 | p[1]) & 0x7FFF;
+      return -1;
+    case AOOSP_TID_SYNC:
+      aospi_sim_sync(node);
+      return -1;
+    case AOOSP_TID_I2CREAD:
+      if( !said || !(node->otp[AOSPI_SIM_OTP_ROW] & AOSPI_SIM_OTP_I2CEN) || size!=3 || p[2]<1 || p[2]>8 ) return -1;
+      aospi_sim_i2c(node, p[0]>>1, p[1], 0, p[2]);
+      return -1;
+    case AOOSP_TID_I2CWRITE:
+      if( !said || !(node->otp[AOSPI_SIM_OTP_ROW] & AOSPI_SIM_OTP_I2CEN) || size<3 ) return -1;
+      aospi_sim_i2c(node, p[0]>>1, p[1], p+2, size-2);
+      return -1;
+    case AOOSP_TID_READLAST: // bytes are right aligned
+      if( !said ) return -1;
+      memset( r, 0, 8 );
+      for( int i=0; i<node->i2clastn; i++ ) r[8-node->i2clastn+i] = node->i2clast[i];
+      return 8;
+    case AOOSP_TID_READSTAT:
+      r[0] = aospi_sim_stat(node);
+      return 1;
+    case AOOSP_TID_READTEMPSTAT:
+      r[0] = node->temp; r[1] = aospi_sim_stat(node);
+      return 2;
+    case AOOSP_TID_READCOMST:
+      r[0] = node->comst;
+      return 1;
+    case AOOSP_TID_READLEDST: // also READLEDSTCHN
+      r[0] = node->ledst;
+      return 1;
+    case AOOSP_TID_READTEMP:
+      r[0] = node->temp;
+      return 1;
+    case AOOSP_TID_READSETUP:
+      r[0] = node->setup;
+      return 1;
+    case AOOSP_TID_SETSETUP:
+      if( size==1 ) node->setup = p[0];
+      return -1;
+    case AOOSP_TID_READPWM: // READPWM (RGBI) or READPWMCHN (SAID)
+      if( !said && size==0 ) {
+        for( int c=0; c<3; c++ ) { r[2*c] = BITS_SLICE(node->daytimes,2-c,3-c)<<7 | BITS_SLICE(node->pwm[0][c],8,15); r[2*c+1] = node->pwm[0][c]; }
+        return 6;
+      }
+      if( said && size==1 && p[0]<3 ) {
+        for( int c=0; c<3; c++ ) { r[2*c] = node->pwm[p[0]][c]>>8; r[2*c+1] = node->pwm[p[0]][c]; }
+        return 6;
+      }
+      return -1;
+    case AOOSP_TID_SETPWM: // SETPWM (RGBI) or SETPWMCHN (SAID)
+      if( !said && size==6 ) {
+        node->daytimes = BITS_SLICE(p[0],7,8)<<2 | BITS_SLICE(p[2],7,8)<<1 | BITS_SLICE(p[4],7,8);
+        for( int c=0; c<3; c++ ) node->pwm[0][c] = BITS_SLICE(p[2*c],0,7)<<8 | p[2*c+1];
+        aospi_sim_pwm_latch(node, 0);
+      }
+      if( said && size==8 && p[0]<3 ) {
+        for( int c=0; c<3; c++ ) node->pwm[p[0]][c] = p[2+2*c]<<8 | p[3+2*c];
+        aospi_sim_pwm_latch(node, p[0]);
+      }
+      return -1;
+    case AOOSP_TID_READCURCHN:
+      if( !said || size!=1 || p[0]>=3 ) return -1;
+      r[0] = node->curchn[p[0]][0]; r[1] = node->curchn[p[0]][1];
+      return 2;
+    case AOOSP_TID_SETCURCHN:
+      if( said && size==3 && p[0]<3 ) { node->curchn[p[0]][0] = p[1]; node->curchn[p[0]][1] = p[2]; }
+      return -1;
+    case AOOSP_TID_READI2CCFG:
+      if( !said ) return -1;
+      r[0] = aospi_sim_i2ccfg(node);
+      return 1;
+    case AOOSP_TID_SETI2CCFG:
+      if( said && size==1 ) node->i2ccfg = p[0] & ~(AOSPI_SIM_I2CCFG_BUSY|AOSPI_SIM_I2CCFG_INT);
+      return -1;
+    case AOOSP_TID_READOTP: // bytes in reverse order
+      if( size!=1 || p[0]>0x1F ) return -1;
+      for( int i=0; i<8; i++ ) r[7-i] = node->otp[p[0]+i];
+      return 8;
+    case AOOSP_TID_SETOTP: // 7 bytes in reverse order, then the OTP address
+      if( !node->testpw || size!=8 || p[7]>0x1F ) return -1;
+      for( int i=0; i<7; i++ ) node->otp[p[7]+i] = p[6-i];
+      return -1;
+    case AOOSP_TID_SETTESTDATA:
+      if( size==2 ) node->testdata = p[0]<<8 | p[1];
+      return -1;
+    case AOOSP_TID_SETTESTPW: { // little endian
+      uint64_t pw = 0;
+      if( size!=6 ) return -1;
+      for( int i=0; i<6; i++ ) pw |= (uint64_t)p[i]<<(8*i);
+      node->testpw = pw!=0;
+      return -1;
+    }
+    default: // not modeled (e.g. OTP burn procedure, ADC): accepted without effect
+      return -1;
+  }
+}
+
+
+// === CHAIN ==============================================
+
+
+// Whether a response makes it back to the MCU with the current direction mux and cabling
+static int aospi_sim_returns() {
+  return !aospi_dirmux_is_loop() || aospi_sim_loopcabled;
+}
+
+
+// Whether `node` is addressed by `addr` (unicast, group or broadcast)
+static int aospi_sim_match(const aospi_sim_node_t * node, uint16_t addr) {
+  if( node->addr==0 ) return 0;
+  if( addr==0x000 ) return 1;
+  if( addr>=0x3F0 ) return addr<0x3FF && (node->mult>>(addr-0x3F0)) & 1;
+  return node->addr==addr;
+}
+
+
+// Makes a response telegram from node `addr` in `resp`; returns its size
+static int aospi_sim_resp(uint8_t * resp, uint16_t addr, uint8_t tid, const uint8_t * payload, int size) {
+  int psi = size<8 ? size : 7;
+  resp[0] = 0xA0 | BITS_SLICE(addr,6,10);
+  resp[1] = BITS_SLICE(addr,0,6)<<2 | BITS_SLICE(psi,1,3);
+  resp[2] = BITS_SLICE(psi,0,1)<<7 | tid;
+  memcpy( resp+3, payload, size );
+  resp[3+size] = aoosp_crc(resp, 3+size);
+  return 4+size;
+}
+
+
+// Assigns addresses from `addr` on (INITBIDIR/INITLOOP); returns the position of the last node
+static int aospi_sim_init_addrs(uint16_t addr, int loop) {
+  memset( aospi_sim_pos, 0, sizeof aospi_sim_pos );
+  for( int pos=1; pos<=aospi_sim_num; pos++ ) {
+    aospi_sim_node_t * node = &aospi_sim_chain[pos];
+    uint16_t a = addr+pos-1;
+    if( a>0x3EF ) { node->addr = 0; continue; }
+    node->addr  = a;
+    node->state = 1; // sleep
+    node->comst = loop ? AOSPI_SIM_COMST_LOOP : 0;
+    if( node->type==AOSPI_SIM_RGBI ) node->flags = ( node->flags & ~AOSPI_SIM_STAT_OV ) | ( loop ? AOSPI_SIM_STAT_OV : 0 ); // RGBI: DIRLOOP
+    aospi_sim_pos[a] = pos;
+  }
+  int last = aospi_sim_num;
+  while( last>0 && aospi_sim_chain[last].addr==0 ) last--;
+  return last;
+}
+
+
+// Virtual clock
+static int                    aospi_sim_clocked;
+static aoosp_tmodel_t         aospi_sim_model;
+static uint64_t               aospi_sim_nowns;
+static aospi_sim_clock_stat_t aospi_sim_clockstat;
+static uint64_t               aospi_sim_txendns; // end of the telegram on the wire (of the transfer in progress)
+static uint32_t               aospi_sim_execns;  // execution time of its TID
+static int                    aospi_sim_far;     // farthest node it reached
+
+
+// Records that the node at `pos` executed the telegram in progress
+static void aospi_sim_visit(int pos) {
+  if( pos>aospi_sim_far ) aospi_sim_far = pos;
+  if( aospi_sim_clocked ) aospi_sim_chain[pos].donens = aospi_sim_txendns + pos*(uint64_t)aospi_sim_model.hopns + aospi_sim_execns;
+}
+
+
+// Parses and executes telegram `tx`; returns the size of the response in `resp` (0 for none)
+// and the position of the responding node in `resppos`, or -1 for a malformed telegram
+static int aospi_sim_execute(const uint8_t * tx, int txsize, uint8_t * resp, int * resppos) {
+  int      respsize = 0;
+  // Parse; nodes drop malformed telegrams
+  if( txsize<4 || txsize>12 || BITS_SLICE(tx[0],4,8)!=0xA ) return -1;
+  uint16_t addr = BITS_SLICE(tx[0],0,4)<<6 | BITS_SLICE(tx[1],2,8);
+  int      psi  = BITS_SLICE(tx[1],0,2)*2 + BITS_SLICE(tx[2],7,8);
+  int      size = psi<7 ? psi : 8;
+  uint8_t  tid  = BITS_SLICE(tx[2],0,7);
+  if( txsize!=4+size || aoosp_crc(tx,txsize)!=0 ) {
+    if( aospi_sim_num>0 ) aospi_sim_chain[1].flags |= AOSPI_SIM_STAT_CE;
+    return -1;
+  }
+  aospi_sim_execns = aospi_sim_model.execns[tid];
+  const uint8_t * p = tx+3;
+  uint8_t  r[8];
+
+  if( tid==AOOSP_TID_RESET ) {
+    for( int pos=1; pos<=aospi_sim_num; pos++ ) { aospi_sim_reset(&aospi_sim_chain[pos]); aospi_sim_visit(pos); }
+    memset( aospi_sim_pos, 0, sizeof aospi_sim_pos );
+  } else if( tid==AOOSP_TID_INITBIDIR || tid==AOOSP_TID_INITLOOP ) { // response from the last node
+    int last = aospi_sim_init_addrs(addr, tid==AOOSP_TID_INITLOOP);
+    for( int pos=1; pos<=aospi_sim_num; pos++ ) aospi_sim_visit(pos);
+    int back = tid==AOOSP_TID_INITLOOP ? aospi_dirmux_is_loop() && aospi_sim_loopcabled : !aospi_dirmux_is_loop();
+    if( last>0 && back ) {
+      r[0] = aospi_sim_chain[last].temp; r[1] = aospi_sim_stat(&aospi_sim_chain[last]);
+      respsize = aospi_sim_resp(resp, aospi_sim_chain[last].addr, tid, r, 2);
+      *resppos = last;
+    }
+  } else if( tid==AOOSP_TID_ASKTINFO ) { // aggregated over the addressed nodes
+    uint8_t tmax = size==2 ? p[0] : 0x00;
+    uint8_t tmin = size==2 ? p[1] : 0xFF;
+    int     responder = 0;
+    for( int pos=1; pos<=aospi_sim_num; pos++ ) {
+      aospi_sim_node_t * node = &aospi_sim_chain[pos];
+      if( !aospi_sim_match(node,addr) ) continue;
+      if( node->temp>tmax ) tmax = node->temp;
+      if( node->temp<tmin ) tmin = node->temp;
+      aospi_sim_visit(pos);
+      responder = pos;
+    }
+    r[0] = tmax; r[1] = tmin;
+    if( responder ) { respsize = aospi_sim_resp(resp, aospi_sim_chain[responder].addr, tid, r, 2); *resppos = responder; }
+  } else {
+    // Unicast goes straight to the node, group and broadcast visit all
+    int sr = tid & AOOSP_TID_SR;
+    uint8_t base = tid & ~AOOSP_TID_SR;
+    int first = 1, last = aospi_sim_num;
+    if( addr>=0x001 && addr<=0x3EF ) first = last = aospi_sim_pos[addr];
+    int responder = 0, rsize = -1;
+    for( int pos=first; pos>0 && pos<=last; pos++ ) {
+      aospi_sim_node_t * node = &aospi_sim_chain[pos];
+      if( !aospi_sim_match(node,addr) ) continue;
+      rsize = aospi_sim_exec(node, base, p, size, r);
+      aospi_sim_visit(pos);
+      responder = pos;
+    }
+    if( responder && sr ) {
+      r[0] = aospi_sim_chain[responder].temp; r[1] = aospi_sim_stat(&aospi_sim_chain[responder]);
+      rsize = 2;
+    }
+    if( responder && rsize>=0 ) { respsize = aospi_sim_resp(resp, aospi_sim_chain[responder].addr, tid, r, rsize); *resppos = responder; }
+  }
+
+  return respsize;
+}
+
+
+/*!
+    @brief  Handles one transfer of the host aospi.
+    @param  tx
+            The telegram.
+    @param  txsize
+            Size of the telegram.
+    @param  rx
+            Buffer for the response (0 for aospi_tx).
+    @param  rxsize
+            Expected size of the response.
+    @return aoresult_ok, or aoresult_spi_noclock when no response returns
+            (no node answers, or the mux is Loop without loop cabling).
+    @note   With the virtual clock, the transfer takes gap, telegram bytes,
+            hops to the responding node, its execution, turnaround, hops
+            back (BiDir) or onward to the MCU (Loop), and response bytes;
+            without response the MCU is free when the telegram is sent.
+*/
+aoresult_t aospi_sim_transfer(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize) {
+  uint8_t  resp[12];
+  int      resppos = 0;
+  uint64_t t0 = aospi_sim_nowns;
+  aospi_sim_txendns = t0 + aospi_sim_model.gapns + txsize*(uint64_t)aospi_sim_model.bytens;
+  aospi_sim_far = 0;
+  int respsize = aospi_sim_execute(tx, txsize, resp, &resppos);
+  int returns = respsize>0 && aospi_sim_returns();
+
+  // Advance the virtual clock
+  if( aospi_sim_clocked ) {
+    int loop = aospi_dirmux_is_loop();
+    aospi_sim_nowns = aospi_sim_txendns;
+    aospi_sim_clockstat.hops += aospi_sim_far;
+    aospi_sim_clockstat.bytes += txsize;
+    if( rx && returns ) {
+      int back = loop ? aospi_sim_num+1-resppos : resppos;
+      aospi_sim_nowns = aospi_sim_chain[resppos].donens + aospi_sim_model.turnns[loop] + back*(uint64_t)aospi_sim_model.hopns + respsize*(uint64_t)aospi_sim_model.bytens;
+      aospi_sim_clockstat.hops += back;
+      aospi_sim_clockstat.bytes += respsize;
+    } else if( rx ) {
+      aospi_sim_nowns += rxsize*(uint64_t)aospi_sim_model.bytens; // clocks out the response that does not come
+    }
+    aospi_sim_clockstat.transfers++;
+    aospi_sim_clockstat.busns += aospi_sim_nowns - t0;
+  }
+
+  // Return the response
+  if( rx==0 ) return aoresult_ok;
+  if( !returns ) return aoresult_spi_noclock;
+  memcpy( rx, resp, respsize<rxsize ? respsize : rxsize );
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Pulses the SYNC pin of all nodes.
+    @note   Nodes with SYNC_PIN_EN in their OTP mirror activate their
+            staged PWM settings.
+*/
+void aospi_sim_syncpin() {
+  for( int pos=1; pos<=aospi_sim_num; pos++ ) {
+    aospi_sim_node_t * node = &aospi_sim_chain[pos];
+    if( node->otp[AOSPI_SIM_OTP_ROW] & AOSPI_SIM_OTP_SYNCPIN ) aospi_sim_sync(node);
+  }
+}
+
+
+// === API ================================================
+
+
+/*!
+    @brief  Creates a simulated chain (power on) and installs it in aospi_host.
+    @param  nodes
+            Number of nodes (1..AOSPI_SIM_NODES_MAX).
+    @param  types
+            Node types, repeated over the chain: AOSPI_SIM_SAID ('S') and
+            AOSPI_SIM_RGBI ('R'), e.g. "RSS" for the OSP32 board.
+    @param  loopcabled
+            1 when the last node is cabled back to the MCU (Loop possible).
+    @return aoresult_ok, or aoresult_osp_arg for a bad nodes or types.
+    @note   Removes all virtual I2C devices; OTP mirrors are zero.
+*/
+aoresult_t aospi_sim_init(int nodes, const char * types, int loopcabled) {
+  if( nodes<1 || nodes>AOSPI_SIM_NODES_MAX || types==0 || *types==0 ) return aoresult_osp_arg;
+  int len = strlen(types);
+  for( int i=0; i<len; i++ ) if( types[i]!=AOSPI_SIM_SAID && types[i]!=AOSPI_SIM_RGBI ) return aoresult_osp_arg;
+  aospi_sim_num = nodes;
+  aospi_sim_loopcabled = loopcabled;
+  aospi_sim_i2cdevnum = 0;
+  memset( aospi_sim_pos, 0, sizeof aospi_sim_pos );
+  for( int pos=1; pos<=nodes; pos++ ) {
+    aospi_sim_node_t * node = &aospi_sim_chain[pos];
+    memset( node, 0, sizeof *node );
+    node->type = types[(pos-1)%len];
+    node->temp = node->type==AOSPI_SIM_SAID ? AOSPI_SIM_TEMP_SAID : AOSPI_SIM_TEMP_RGBI;
+    aospi_sim_reset(node);
+  }
+  aospi_host_set(aospi_sim_transfer);
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Returns the number of nodes of the simulated chain.
+    @return Number of nodes.
+*/
+int aospi_sim_nodes() {
+  return aospi_sim_num;
+}
+
+
+/*!
+    @brief  Returns the register model of a node.
+    @param  pos
+            Position in the chain (1..aospi_sim_nodes()).
+    @return The node, or 0 when pos is out of range.
+*/
+aospi_sim_node_t * aospi_sim_node(int pos) {
+  if( pos<1 || pos>aospi_sim_num ) return 0;
+  return &aospi_sim_chain[pos];
+}
+
+
+/*!
+    @brief  Sets how long I2C transactions appear busy.
+    @param  polls
+            Number of READI2CCFG after a transaction that report BUSY.
+*/
+void aospi_sim_i2cbusypolls_set(int polls) {
+  aospi_sim_i2cpolls = polls<0 ? 0 : polls;
+}
+
+
+/*!
+    @brief  Attaches a virtual I2C device to a SAID.
+    @param  pos
+            Position of the SAID in the chain.
+    @param  dev
+            The device; must stay valid during the simulation.
+    @return aoresult_ok, or aoresult_osp_arg (no SAID at pos, no room, or no dev).
+    @note   The I2C bridge must also be enabled in OTP (I2C_BRIDGE_EN), e.g.
+            aospi_sim_node(pos)->otp[0x0D] |= 0x01.
+*/
+aoresult_t aospi_sim_i2cdev_add(int pos, const aospi_sim_i2cdev_t * dev) {
+  aospi_sim_node_t * node = aospi_sim_node(pos);
+  if( node==0 || node->type!=AOSPI_SIM_SAID || dev==0 || aospi_sim_i2cdevnum==AOSPI_SIM_I2CDEVS_MAX ) return aoresult_osp_arg;
+  aospi_sim_i2cdevs[aospi_sim_i2cdevnum].pos = pos;
+  aospi_sim_i2cdevs[aospi_sim_i2cdevnum].dev = dev;
+  aospi_sim_i2cdevnum++;
+  return aoresult_ok;
+}
+
+
+// === VIRTUAL CLOCK ======================================
+
+
+/*!
+    @brief  Enables (or disables) the virtual clock.
+    @param  model
+            The timing model (copied), e.g. from aoosp_tmodel_get() after a
+            calibration on hardware, or 0 to return to host time.
+    @note   Starts the clock at 0, resets the accounting, and installs the
+            clock as host time (micros, delays, aoosp_cycles).
+*/
+void aospi_sim_clock_enable(const aoosp_tmodel_t * model) {
+  aospi_sim_clocked = model!=0;
+  if( model ) aospi_sim_model = *model; else memset( &aospi_sim_model, 0, sizeof aospi_sim_model );
+  aospi_sim_nowns = 0;
+  memset( &aospi_sim_clockstat, 0, sizeof aospi_sim_clockstat );
+  if( model ) host_clock_set(aospi_sim_clock_ns, aospi_sim_clock_advance); else host_clock_set(0, 0);
+}
+
+
+/*!
+    @brief  Returns the time of the virtual clock.
+    @return Time in ns since aospi_sim_clock_enable().
+*/
+uint64_t aospi_sim_clock_ns() {
+  return aospi_sim_nowns;
+}
+
+
+/*!
+    @brief  Advances the virtual clock.
+    @param  ns
+            Time to add, e.g. MCU work between transfers.
+    @note   Installed as the wait of the host clock, so delay() and
+            delayMicroseconds() (e.g. I2C BUSY polls) advance the clock.
+*/
+void aospi_sim_clock_advance(uint64_t ns) {
+  aospi_sim_nowns += ns;
+  aospi_sim_clockstat.idlens += ns;
+}
+
+
+/*!
+    @brief  Gets the bus time accounting.
+    @param  stat
+            Receives the accounting since enable or the last reset.
+*/
+void aospi_sim_clock_stat_get(aospi_sim_clock_stat_t * stat) {
+  if( stat ) *stat = aospi_sim_clockstat;
+}
+
+
+/*!
+    @brief  Resets the bus time accounting (the clock keeps running).
+*/
+void aospi_sim_clock_stat_reset() {
+  memset( &aospi_sim_clockstat, 0, sizeof aospi_sim_clockstat );
+}
+
+
+// === EEPROM =============================================
+
+
+static int aospi_sim_eeprom_write(void * ctx, uint8_t raddr, const uint8_t * buf, int count) {
+  aospi_sim_eeprom_t * ee = (aospi_sim_eeprom_t *)ctx;
+  if( ee->busy>0 ) { ee->busy--; return 1; }
+  for( int i=0; i<count; i++ ) ee->mem[ (raddr&~7) | ((raddr+i)&7) ] = buf[i]; // wraps within the page
+  ee->busy = ee->busyaccesses;
+  return 0;
+}
+
+
+static int aospi_sim_eeprom_read(void * ctx, uint8_t raddr, uint8_t * buf, int count) {
+  aospi_sim_eeprom_t * ee = (aospi_sim_eeprom_t *)ctx;
+  if( ee->busy>0 ) { ee->busy--; return 1; }
+  for( int i=0; i<count; i++ ) buf[i] = ee->mem[ (uint8_t)(raddr+i) ]; // sequential read wraps at the end
+  return 0;
+}
+
+
+/*!
+    @brief  Makes a virtual I2C device of an EEPROM model.
+    @param  eeprom
+            The EEPROM model (memory, and write cycle behavior).
+    @param  daddr7
+            The I2C address (0x50 for a 24C02 with address pins low).
+    @return The device, to pass to aospi_sim_i2cdev_add().
+*/
+aospi_sim_i2cdev_t aospi_sim_eeprom_dev(aospi_sim_eeprom_t * eeprom, uint8_t daddr7) {
+  aospi_sim_i2cdev_t dev = { daddr7, aospi_sim_eeprom_write, aospi_sim_eeprom_read, 0, eeprom };
+  return dev;
+}
@@ -0,0 +1,141 @@
+// aospi_sim.h - simulated OSP chain (SAID and RGBI register models) behind the host aospi
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOSPI_SIM_H_
+#define _AOSPI_SIM_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+#include <aoosp_tmodel.h> // aoosp_tmodel_t
+
+
+// The simulated chain is a transfer handler for the host aospi (aospi_host).
+// Every telegram is parsed (preamble, address, PSI, TID, CRC) and executed
+// on register models of the nodes it addresses (unicast, group or
+// broadcast); telegrams with response get one from the addressed node, as
+// produced by a real node. Unaddressed nodes only accept RESET and INIT.
+// The direction mux of aospi (aospi_dirmux_set_xxx) and the cabling decide
+// whether responses return: in Loop only when the chain is cabled as loop.
+//
+// With the virtual clock enabled (aospi_sim_clock_enable), every transfer
+// advances a clock in ns instead of taking host time: the gap, each byte on
+// the wire, each hop forward, the execution in the node and the way back of
+// the response, per an aoosp_tmodel_t. The clock is also the time of the
+// host (micros, delays, aoosp_cycles), so the library, its timeouts and its
+// statistics run in bus time, deterministically and independent of the host.
+
+
+// Maximum number of nodes in the simulated chain
+#define AOSPI_SIM_NODES_MAX   1000
+// Maximum number of virtual I2C devices (over all nodes)
+#define AOSPI_SIM_I2CDEVS_MAX 32
+// Size of the simulated OTP mirror (rows 0x00..0x1F are readable, a read returns 8 bytes)
+#define AOSPI_SIM_OTP_SIZE    0x28
+
+
+// Node types
+#define AOSPI_SIM_SAID 'S'
+#define AOSPI_SIM_RGBI 'R'
+
+
+// Register model of one node; tools may inspect it, and change it (e.g. inject flags or temperature)
+typedef struct aospi_sim_node_s {
+  char     type;                    // AOSPI_SIM_SAID or AOSPI_SIM_RGBI
+  uint16_t addr;                    // Address, 0 when not initialized
+  uint8_t  state;                   // State (bits 7..6 of the status): 0 uninitialized, 1 sleep, 2 active, 3 deepsleep
+  uint8_t  flags;                   // Flags (bits 5..0 of the status), see AOOSP_STAT_FLAGS_xxx
+  uint8_t  temp;                    // Raw temperature (see aoosp_prt_temp_said/rgbi)
+  uint8_t  comst;                   // Communication status (direction and SIO types)
+  uint8_t  ledst;                   // LED status (open/short per color)
+  uint8_t  setup;                   // Setup register
+  uint16_t mult;                    // Group membership (bit g for group 3F0+g)
+  uint16_t pwm[3][3];               // PWM per channel and color as set (staged when the channel waits for SYNC)
+  uint16_t pwmact[3][3];            // PWM per channel and color as driven
+  uint8_t  daytimes;                // RGBI daytimes bits of SETPWM
+  uint8_t  curchn[3][2];            // Current per channel, as SETCURCHN payload: flags<<4|red, green<<4|blue
+  uint8_t  i2ccfg;                  // I2C flags<<4|speed (BUSY and NACK maintained by the simulator)
+  uint8_t  i2clast[8];              // Bytes of the last I2C read
+  uint8_t  i2clastn;                // Number of bytes of the last I2C read
+  uint8_t  i2cbusy;                 // Number of READI2CCFG that still report BUSY
+  uint16_t testdata;                // Test register
+  uint8_t  testpw;                  // 1 when a (correct) test password is set
+  uint8_t  otp[AOSPI_SIM_OTP_SIZE]; // OTP mirror
+  uint64_t donens;                  // Virtual time the node completed its last telegram (arrival plus execution)
+} aospi_sim_node_t;
+
+
+// A virtual I2C device attached to the I2C bus of a SAID; a handler returns 0 for ACK and non-zero for NACK
+typedef struct aospi_sim_i2cdev_s {
+  uint8_t daddr7;                                                           // 7 bits I2C address
+  int   (*write)(void * ctx, uint8_t raddr, const uint8_t * buf, int count); // Write of count bytes at raddr
+  int   (*read)(void * ctx, uint8_t raddr, uint8_t * buf, int count);        // Read of count bytes from raddr
+  int   (*intline)(void * ctx);                                             // Level of the INT line (1 asserted), may be 0
+  void  * ctx;                                                              // Passed to the handlers
+} aospi_sim_i2cdev_t;
+
+
+// A 24C02 type I2C EEPROM (256 bytes, 8 byte pages, write cycle NACKs a number of accesses)
+typedef struct aospi_sim_eeprom_s {
+  uint8_t mem[256];
+  int     busyaccesses;             // Accesses to NACK after a write (models tWR), default 0
+  int     busy;                     // Accesses still to NACK
+} aospi_sim_eeprom_t;
+
+
+// Creates a chain of `nodes` nodes, types from the repeated pattern `types` (e.g. "S", "RS"), cabled as loop or not; installs it in aospi_host.
+aoresult_t         aospi_sim_init(int nodes, const char * types="S", int loopcabled=1);
+// Returns the number of nodes of the simulated chain.
+int                aospi_sim_nodes();
+// Returns the register model of the node at position `pos` (1 is the node next to the MCU), or 0.
+aospi_sim_node_t * aospi_sim_node(int pos);
+// Sets the number of READI2CCFG that report BUSY after each I2C transaction (default 1).
+void               aospi_sim_i2cbusypolls_set(int polls);
+// Attaches a virtual I2C device to the SAID at position `pos`; the device struct must outlive the simulation.
+aoresult_t         aospi_sim_i2cdev_add(int pos, const aospi_sim_i2cdev_t * dev);
+// Makes an I2C device (at daddr7) of an EEPROM model.
+aospi_sim_i2cdev_t aospi_sim_eeprom_dev(aospi_sim_eeprom_t * eeprom, uint8_t daddr7);
+// Pulses the SYNC pin: activates staged PWM of nodes with SYNC_PIN_EN in OTP.
+void               aospi_sim_syncpin();
+// Bus time accounting of the virtual clock
+typedef struct aospi_sim_clock_stat_s {
+  uint32_t transfers;               // Number of transfers (aospi_tx and aospi_txrx)
+  uint32_t bytes;                   // Bytes on the wire (telegrams and responses)
+  uint32_t hops;                    // Node to node forwards (of telegrams up to the addressed node, and of responses)
+  uint64_t busns;                   // Time the MCU was busy with transfers
+  uint64_t idlens;                  // Time the clock advanced otherwise (aospi_sim_clock_advance, delays)
+} aospi_sim_clock_stat_t;
+
+
+// Enables the virtual clock with timing `model` (copied), starting at 0; 0 disables it (host time again).
+void               aospi_sim_clock_enable(const aoosp_tmodel_t * model);
+// Returns the time of the virtual clock in ns.
+uint64_t           aospi_sim_clock_ns();
+// Advances the virtual clock by `ns` (e.g. MCU work between transfers); also called for delays.
+void               aospi_sim_clock_advance(uint64_t ns);
+// Gets the bus time accounting since enable or reset.
+void               aospi_sim_clock_stat_get(aospi_sim_clock_stat_t * stat);
+// Resets the bus time accounting (not the clock).
+void               aospi_sim_clock_stat_reset();
+// Handles one transfer (installed by aospi_sim_init; exposed for tools that wrap it).
+aoresult_t         aospi_sim_transfer(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize);
+
+
+#endif
@@ -27,10 +27,27 @@
 
 
 // Include the (headers of the) modules of this app
-#include <aoosp_crc.h>  // computes CRC for OSP telegrams
-#include <aoosp_prt.h>  // helpers to pretty print OSP telegrams in human readable form
-#include <aoosp_send.h> // send command telegrams (and receive response telegrams)
-#include <aoosp_exec.h> // execute high level OSP routines (several telegrams)
+#include <aoosp_crc.h>      // computes CRC for OSP telegrams
+#include <aoosp_prt.h>      // helpers to pretty print OSP telegrams in human readable form
+#include <aoosp_send.h>     // send command telegrams (and receive response telegrams)
+#include <aoosp_exec.h>     // execute high level OSP routines (several telegrams)
+#include <aoosp_i2cint.h>   // dispatches edges on the INT line of I2C bridges (adaptive polling)
+#include <aoosp_i2csched.h> // schedules periodic sensor reads over I2C bridges
+#include <aoosp_therm.h>    // monitors chain temperature with ASKTINFO, drills down to hot nodes
+#include <aoosp_sweep.h>    // reads node status round robin, a few nodes per frame
+#include <aoosp_errmap.h>   // per flag bit sets of node status, updated by aoosp_send
+#include <aoosp_tseries.h>  // compressed temperature history per node, fed by aoosp_send
+#include <aoosp_linkstat.h> // communication error statistics per node and per hop
+#include <aoosp_derate.h>   // thermal derating of brightness per node or zone
+#include <aoosp_telem.h>    // binary telemetry record stream with pluggable sink
+#include <aoosp_tidstat.h>  // per telegram type counters and latency histograms
+#include <aoosp_trace.h>    // records telegrams into a RAM ring, to dump and decode later
+#include <aoosp_tmodel.h>   // timing model of the chain, calibrated from measurements
+#include <aoosp_plan.h>     // frame rate capacity planner (uses the timing model)
+#include <aoosp_syncmeas.h> // measures latency and skew of SYNC telegram versus SYNC pin
+#include <aoosp_fault.h>    // injects faults between aoosp_send and aospi, measures time to recover
+#include <aoosp_busprof.h>  // attributes bus time to categories (pwm, diag, i2c polling, ...) over sliding windows
+#include <aoosp_dlog.h>     // formats the aoosp_send log now or deferred (binary records in a lock-free ring)
 
 
 // Get the SAID test password - returns AOOSP_SAID_TESTPW_UNKNOWN unless set with eg `aoosp_said_testpw_set()`.
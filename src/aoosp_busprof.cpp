@@ -0,0 +1,288 @@
+// aoosp_busprof.cpp - bus utilization profiler: SPI time per category over sliding windows
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>         // memset
+#include <Arduino.h>        // micros, Serial
+#include <aoosp_send.h>     // aoosp_cycles_per_us
+#include <aoosp_tmodel.h>   // AOOSP_TMODEL_BYTENS_DEFAULT
+#include <aoosp_busprof.h>  // own API
+
+
+// Bus profiler
+// ============
+// aoosp_tidstat tells how long each TID takes, not where the bus time of a
+// running application goes. The profiler attributes the SPI time of every
+// transfer (aospi_tx or aospi_txrx, as timed by aoosp_send) to a category:
+// the one set by the caller context (aoosp_busprof_ctx_set, e.g. RETRY
+// around a retry loop), or else the one derived from the TID. The READI2CCFG
+// polls of aoosp_exec_i2cwait get their own category, so their share of a
+// busy chain is visible.
+//
+// Time is kept in a ring of buckets of AOOSP_BUSPROF_BUCKETMS; the bucket of
+// a transfer is determined by micros() at its end. A report sums the most
+// recent buckets (a sliding window): utilization per category, split in wire
+// time (bytes at the configured byte time) and wait time (the chain
+// forwarding, executing and turning around), and the idle gaps between
+// transfers. Buckets with no transfer are simply empty, so windows are
+// correct after idle periods (up to the micros() wrap after 71 minutes).
+// Gaps are measured in cycles, but gaps of AOOSP_BUSPROF_LONGGAPUS or more
+// with micros(): the cycle counter wraps after 17.9 s on a 240 MHz ESP32,
+// and a duration in ns no longer fits 32 bits after 4.3 s.
+//
+// Recording is a few additions on the bus task; reports can be made from the
+// same task at any time.
+
+
+typedef struct aoosp_busprof_bucket_s {
+  uint32_t id;                              // micros()/bucket length; AOOSP_BUSPROF_NOID for an unused bucket
+  uint32_t busyns[AOOSP_BUSPROF_CATS];
+  uint32_t bytes[AOOSP_BUSPROF_CATS];
+  uint16_t telegrams[AOOSP_BUSPROF_CATS];
+  uint16_t gaps;
+  uint32_t gapmaxus;
+  uint64_t gapns;
+} aoosp_busprof_bucket_t;
+
+
+#define AOOSP_BUSPROF_NOID      0xFFFFFFFF
+#define AOOSP_BUSPROF_BUCKETUS  ( AOOSP_BUSPROF_BUCKETMS*1000UL )
+#define AOOSP_BUSPROF_LONGGAPUS 1000000UL // gaps from this length on are measured with micros()
+
+
+static aoosp_busprof_bucket_t aoosp_busprof_ring[AOOSP_BUSPROF_BUCKETS];
+static uint8_t                aoosp_busprof_ctx    = AOOSP_BUSPROF_CAT_AUTO;
+static uint32_t               aoosp_busprof_bytens = AOOSP_TMODEL_BYTENS_DEFAULT;
+static uint32_t               aoosp_busprof_startus;     // micros() at reset
+static uint32_t               aoosp_busprof_lastc2;      // aoosp_cycles() at the end of the previous transfer
+static uint32_t               aoosp_busprof_lastus;      // micros() at the end of the previous transfer
+static uint8_t                aoosp_busprof_haslast;     // aoosp_busprof_lastc2 is valid
+static uint8_t                aoosp_busprof_started;     // aoosp_busprof_startus is valid
+
+
+static const char * const aoosp_busprof_names[AOOSP_BUSPROF_CATS] = { "pwm", "diag", "i2c", "i2cpoll", "config", "retry", "app" };
+
+
+/*!
+    @brief  Clears the profile.
+    @note   The window of the next reports starts now.
+*/
+void aoosp_busprof_reset() {
+  memset( aoosp_busprof_ring, 0, sizeof aoosp_busprof_ring );
+  for( int ix=0; ix<AOOSP_BUSPROF_BUCKETS; ix++ ) aoosp_busprof_ring[ix].id = AOOSP_BUSPROF_NOID;
+  aoosp_busprof_startus = micros();
+  aoosp_busprof_started = 1;
+  aoosp_busprof_haslast = 0;
+}
+
+
+/*!
+    @brief  Sets the category of the following telegrams.
+    @param  cat
+            AOOSP_BUSPROF_CAT_xxx, or AOOSP_BUSPROF_CAT_AUTO to derive the
+            category from the TID (the default).
+    @return The previous category, to restore it afterwards.
+    @note   Example: prev=aoosp_busprof_ctx_set(AOOSP_BUSPROF_CAT_RETRY);
+            (retries); aoosp_busprof_ctx_set(prev);
+*/
+uint8_t aoosp_busprof_ctx_set(uint8_t cat) {
+  uint8_t prev = aoosp_busprof_ctx;
+  aoosp_busprof_ctx = cat<AOOSP_BUSPROF_CATS ? cat : AOOSP_BUSPROF_CAT_AUTO;
+  return prev;
+}
+
+
+/*!
+    @brief  Sets the wire time per byte.
+    @param  ns
+            Time of one byte on the wire, e.g. bytens of a calibrated
+            aoosp_tmodel_t.
+    @note   Only splits the busy time in wire and wait; busy time is measured.
+*/
+void aoosp_busprof_bytens_set(uint32_t ns) {
+  aoosp_busprof_bytens = ns;
+}
+
+
+/*!
+    @brief  Returns the category of a telegram.
+    @param  tid
+            The telegram ID (with or without SR bit).
+    @return AOOSP_BUSPROF_CAT_PWM, _DIAG, _I2C, _I2CPOLL or _CONFIG.
+*/
+uint8_t aoosp_busprof_tid2cat(uint8_t tid) {
+  tid &= ~AOOSP_TID_SR; // SR variants count as their base telegram
+  switch( tid ) {
+    case AOOSP_TID_SYNC:     case AOOSP_TID_SETPWM:    return AOOSP_BUSPROF_CAT_PWM;    // SETPWM(CHN)
+    case AOOSP_TID_CLRERROR: case AOOSP_TID_ASKTINFO:  return AOOSP_BUSPROF_CAT_DIAG;
+    case AOOSP_TID_I2CREAD:  case AOOSP_TID_I2CWRITE:
+    case AOOSP_TID_READLAST: case AOOSP_TID_SETI2CCFG: return AOOSP_BUSPROF_CAT_I2C;
+    case AOOSP_TID_READI2CCFG:                         return AOOSP_BUSPROF_CAT_I2CPOLL;
+  }
+  if( tid>=AOOSP_TID_READSTAT && tid<=0x4B ) return AOOSP_BUSPROF_CAT_DIAG; // READSTAT .. READOTTH (4B, not sent by the library)
+  return AOOSP_BUSPROF_CAT_CONFIG;
+}
+
+
+/*!
+    @brief  Returns the name of a category.
+    @param  cat
+            AOOSP_BUSPROF_CAT_xxx.
+    @return Name, e.g. "i2cpoll"; "?" for an unknown category.
+*/
+const char * aoosp_busprof_cat_str(uint8_t cat) {
+  if( cat>=AOOSP_BUSPROF_CATS ) return "?";
+  return aoosp_busprof_names[cat];
+}
+
+
+// Converts a duration in aoosp_cycles() to ns
+static uint32_t aoosp_busprof_ns(uint32_t cycles) {
+  return (uint32_t)( (uint64_t)cycles*1000 / aoosp_cycles_per_us() );
+}
+
+
+/*!
+    @brief  Records one transfer.
+    @param  tid
+            The telegram ID.
+    @param  txsize
+            Size of the telegram.
+    @param  rxsize
+            Size of the response clocked in (0 for none).
+    @param  c1
+            aoosp_cycles() at the start of the aospi call.
+    @param  c2
+            aoosp_cycles() at the end of the aospi call.
+    @note   Called by aoosp_send for every transfer (AOOSP_BUSPROF_ENABLED).
+*/
+void aoosp_busprof_record(uint8_t tid, uint8_t txsize, uint8_t rxsize, uint32_t c1, uint32_t c2) {
+  if( !aoosp_busprof_started ) aoosp_busprof_reset();
+  uint32_t nowus = micros();
+  uint32_t id = nowus / AOOSP_BUSPROF_BUCKETUS;
+  aoosp_busprof_bucket_t * b = &aoosp_busprof_ring[id % AOOSP_BUSPROF_BUCKETS];
+  if( b->id!=id ) {
+    memset( b, 0, sizeof *b );
+    b->id = id;
+  }
+  uint8_t cat = aoosp_busprof_ctx!=AOOSP_BUSPROF_CAT_AUTO ? aoosp_busprof_ctx : aoosp_busprof_tid2cat(tid);
+  uint32_t busyns = aoosp_busprof_ns(c2-c1);
+  b->busyns[cat] += busyns;
+  b->bytes[cat] += txsize + rxsize;
+  b->telegrams[cat]++;
+  if( aoosp_busprof_haslast ) {
+    uint32_t sinceus = nowus - aoosp_busprof_lastus;
+    uint64_t gapns;
+    if( sinceus<AOOSP_BUSPROF_LONGGAPUS ) gapns = aoosp_busprof_ns(c1-aoosp_busprof_lastc2);
+    else gapns = (uint64_t)sinceus*1000 - busyns; // long idle: the cycles may have wrapped
+    b->gaps++;
+    b->gapns += gapns;
+    if( gapns/1000>b->gapmaxus ) b->gapmaxus = (uint32_t)(gapns/1000);
+  }
+  aoosp_busprof_lastc2 = c2;
+  aoosp_busprof_lastus = nowus;
+  aoosp_busprof_haslast = 1;
+}
+
+
+/*!
+    @brief  Computes the profile of a sliding window.
+    @param  buckets
+            Number of most recent buckets (1..AOOSP_BUSPROF_BUCKETS) in the
+            window; the current (partial) bucket is included.
+    @param  report
+            Receives the profile.
+    @return aoresult_ok, aoresult_outargnull, or aoresult_osp_arg for a bad
+            `buckets`.
+    @note   The window is shorter than buckets*AOOSP_BUSPROF_BUCKETMS
+            when the current bucket is partial or the profiler was reset
+            more recently.
+*/
+aoresult_t aoosp_busprof_get(int buckets, aoosp_busprof_report_t * report) {
+  if( report==0 ) return aoresult_outargnull;
+  if( buckets<1 || buckets>AOOSP_BUSPROF_BUCKETS ) return aoresult_osp_arg;
+  if( !aoosp_busprof_started ) aoosp_busprof_reset();
+  memset( report, 0, sizeof *report );
+  uint32_t nowus = micros();
+  uint32_t curid = nowus / AOOSP_BUSPROF_BUCKETUS;
+  uint64_t busyns[AOOSP_BUSPROF_CATS] = {0};
+  uint64_t bytes[AOOSP_BUSPROF_CATS] = {0};
+  uint64_t gapns = 0;
+  uint32_t gapmaxus = 0;
+  for( int k=0; k<buckets; k++ ) {
+    const aoosp_busprof_bucket_t * b = &aoosp_busprof_ring[(curid-k) % AOOSP_BUSPROF_BUCKETS];
+    if( b->id!=curid-k ) continue;
+    for( int cat=0; cat<AOOSP_BUSPROF_CATS; cat++ ) {
+      busyns[cat] += b->busyns[cat];
+      bytes[cat] += b->bytes[cat];
+      report->cat[cat].telegrams += b->telegrams[cat];
+    }
+    report->gaps += b->gaps;
+    gapns += b->gapns;
+    if( b->gapmaxus>gapmaxus ) gapmaxus = b->gapmaxus;
+  }
+  // Window: from the start of the oldest bucket (or the reset) up to now
+  uint32_t windowus = curid>=(uint32_t)(buckets-1) ? nowus - (curid-(buckets-1))*AOOSP_BUSPROF_BUCKETUS : nowus;
+  if( nowus-aoosp_busprof_startus < windowus ) windowus = nowus-aoosp_busprof_startus;
+  report->windowus = windowus;
+  uint64_t totalns = 0;
+  for( int cat=0; cat<AOOSP_BUSPROF_CATS; cat++ ) {
+    aoosp_busprof_cat_t * c = &report->cat[cat];
+    uint64_t wirens = bytes[cat]*aoosp_busprof_bytens;
+    if( wirens>busyns[cat] ) wirens = busyns[cat];
+    c->busyus = (uint32_t)(busyns[cat]/1000);
+    c->wireus = (uint32_t)(wirens/1000);
+    c->waitus = c->busyus - c->wireus;
+    c->usage  = windowus ? (float)busyns[cat]/1000/windowus : 0;
+    totalns  += busyns[cat];
+  }
+  report->busyus    = (uint32_t)(totalns/1000);
+  report->usage     = windowus ? (float)totalns/1000/windowus : 0;
+  report->gapmeanus = report->gaps ? (uint32_t)(gapns/report->gaps/1000) : 0;
+  report->gapmaxus  = gapmaxus;
+  // Top consumers (insertion sort on busy time)
+  for( int i=0; i<AOOSP_BUSPROF_CATS; i++ ) {
+    int j = i;
+    while( j>0 && busyns[report->top[j-1]]<busyns[i] ) { report->top[j] = report->top[j-1]; j--; }
+    report->top[j] = i;
+  }
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Prints the profile of a sliding window to Serial.
+    @param  buckets
+            Number of most recent buckets in the window.
+    @note   One line per category with telegrams, ordered by usage.
+*/
+void aoosp_busprof_print(int buckets) {
+  aoosp_busprof_report_t r;
+  if( aoosp_busprof_get(buckets,&r)!=aoresult_ok ) return;
+  Serial.printf("busprof: window %lu us, busy %lu us (%.1f%%), %lu gaps mean %lu us max %lu us\n",
+    r.windowus, r.busyus, r.usage*100, r.gaps, r.gapmeanus, r.gapmaxus);
+  Serial.printf("  category  telegrams   busy_us   wire_us   wait_us  usage\n");
+  for( int i=0; i<AOOSP_BUSPROF_CATS; i++ ) {
+    const aoosp_busprof_cat_t * c = &r.cat[r.top[i]];
+    if( c->telegrams==0 ) continue;
+    Serial.printf("  %-8s %10lu %9lu %9lu %9lu %5.1f%%\n", aoosp_busprof_cat_str(r.top[i]), c->telegrams, c->busyus, c->wireus, c->waitus, c->usage*100);
+  }
+}
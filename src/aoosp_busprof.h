@@ -0,0 +1,94 @@
+// aoosp_busprof.h - bus utilization profiler: SPI time per category over sliding windows
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_BUSPROF_H_
+#define _AOOSP_BUSPROF_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// When set to 1, aoosp_send feeds the profiler (about 4 kB RAM); 0 (default) compiles that out. May also be set with -DAOOSP_BUSPROF_ENABLED=1
+#ifndef AOOSP_BUSPROF_ENABLED
+  #define AOOSP_BUSPROF_ENABLED 0
+#endif
+
+
+// Length of one bucket of the sliding window in ms (at most 4000, the ns counters are 32 bits)
+#define AOOSP_BUSPROF_BUCKETMS  100
+// Number of buckets kept; a window is the most recent 1..AOOSP_BUSPROF_BUCKETS buckets
+#define AOOSP_BUSPROF_BUCKETS   50
+
+
+// Categories telegrams are attributed to
+#define AOOSP_BUSPROF_CAT_PWM      0 // SETPWM(CHN), SYNC
+#define AOOSP_BUSPROF_CAT_DIAG     1 // status, temperature, LED and communication status, CLRERROR, ASKTINFO
+#define AOOSP_BUSPROF_CAT_I2C      2 // I2CREAD, I2CWRITE, READLAST, SETI2CCFG
+#define AOOSP_BUSPROF_CAT_I2CPOLL  3 // READI2CCFG (BUSY polling)
+#define AOOSP_BUSPROF_CAT_CONFIG   4 // all other telegrams (RESET, INIT, state changes, setup, OTP, ...)
+#define AOOSP_BUSPROF_CAT_RETRY    5 // only by caller context (see aoosp_busprof_ctx_set)
+#define AOOSP_BUSPROF_CAT_APP      6 // only by caller context, free for the application
+#define AOOSP_BUSPROF_CATS         7
+#define AOOSP_BUSPROF_CAT_AUTO     0xFF // context: derive the category from the TID
+
+
+// Profile of one category in a window
+typedef struct aoosp_busprof_cat_s {
+  uint32_t telegrams;    // Number of transfers
+  uint32_t busyus;       // Time in aospi (SPI transfer, including waiting for the response)
+  uint32_t wireus;       // Part of busyus the bytes are on the wire (bytes times aoosp_busprof_bytens_set)
+  uint32_t waitus;       // Rest of busyus: forwarding, execution and turnaround in the chain
+  float    usage;        // busyus as fraction of the window
+} aoosp_busprof_cat_t;
+
+
+// Profile of a window
+typedef struct aoosp_busprof_report_s {
+  uint32_t            windowus;                  // Length of the window (shorter when the profiler runs shorter)
+  uint32_t            busyus;                    // Time in aospi, all categories
+  float               usage;                     // busyus as fraction of the window
+  uint32_t            gaps;                      // Number of idle gaps between transfers
+  uint32_t            gapmeanus;                 // Mean idle gap
+  uint32_t            gapmaxus;                  // Longest idle gap
+  aoosp_busprof_cat_t cat[AOOSP_BUSPROF_CATS];   // Per category
+  uint8_t             top[AOOSP_BUSPROF_CATS];   // Categories ordered by busyus, largest first
+} aoosp_busprof_report_t;
+
+
+// Clears the profile (all buckets).
+void         aoosp_busprof_reset();
+// Sets the category for the following telegrams (AOOSP_BUSPROF_CAT_AUTO to derive it from the TID); returns the previous one.
+uint8_t      aoosp_busprof_ctx_set(uint8_t cat);
+// Sets the wire time per byte in ns used to split busy time in wire and wait (default AOOSP_TMODEL_BYTENS_DEFAULT).
+void         aoosp_busprof_bytens_set(uint32_t ns);
+// Returns the category of telegram `tid` (SR bit included or not).
+uint8_t      aoosp_busprof_tid2cat(uint8_t tid);
+// Returns the name of category `cat` ("pwm", "i2cpoll", ...).
+const char * aoosp_busprof_cat_str(uint8_t cat);
+// Records one transfer of `tid` with its sizes and aoosp_cycles() at start and end of aospi (called by aoosp_send).
+void         aoosp_busprof_record(uint8_t tid, uint8_t txsize, uint8_t rxsize, uint32_t c1, uint32_t c2);
+// Computes the profile of the most recent `buckets` buckets (the current one included).
+aoresult_t   aoosp_busprof_get(int buckets, aoosp_busprof_report_t * report);
+// Prints the profile of the most recent `buckets` buckets to Serial, categories by usage.
+void         aoosp_busprof_print(int buckets=AOOSP_BUSPROF_BUCKETS);
+
+
+#endif
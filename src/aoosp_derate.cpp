@@ -0,0 +1,246 @@
+// aoosp_derate.cpp - thermal derating of brightness per node or zone
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>         // memset
+#include <aoosp_send.h>     // AOOSP_STAT_FLAGS_OT
+#include <aoosp_sweep.h>    // aoosp_sweep_get
+#include <aoosp_therm.h>    // aoosp_therm_stats_get, aoosp_therm_hot_get
+#include <aoosp_derate.h>   // own API
+
+
+// Derating
+// ========
+// When a node exceeds its temperature limit, it sets OT and (depending on
+// its setup) goes to SLEEP: all or nothing. This controller instead scales
+// the brightness down smoothly when a node gets warm, before OT triggers.
+//
+// It sends no telegrams itself. The temperatures come from the data the
+// other services already collect: the per node table of aoosp_sweep (when
+// not older than AOOSP_DERATE_MAXAGE_MS) and the hot nodes of aoosp_therm
+// (while the chain is hot). A node without such data has an unknown
+// temperature and keeps its scale: the chain max of aoosp_therm is not used
+// as fallback, since one hot node would then dim the whole chain. The scale
+// is applied by the application in its frame pipeline: aoosp_derate_apply()
+// scales the PWM values it was going to send anyhow (e.g. with
+// aoosp_send_setpwmchn).
+//
+// Per node (or per zone, using the hottest member) the controller is an
+// integrator with asymmetric gain: above target the scale decreases by
+// AOOSP_DERATE_STEPDOWN per degree per update, below target it recovers
+// by AOOSP_DERATE_STEPUP per update; quick to protect, slow to recover, no
+// oscillation. A node reporting OT goes to the min scale immediately.
+// A zone has its own scale, copied to its members after every update.
+// Temperatures are raw (monotonic in Celsius, see aoosp_prt_temp_said).
+
+
+typedef struct aoosp_derate_zone_s {
+  uint16_t first;
+  uint16_t last;
+  uint16_t scale;     // Scale of the zone (its members get a copy)
+} aoosp_derate_zone_t;
+
+
+static uint16_t             aoosp_derate_scales[AOOSP_DERATE_NODES];
+static int8_t               aoosp_derate_zoneof[AOOSP_DERATE_NODES]; // -1 for no zone
+static aoosp_derate_zone_t  aoosp_derate_zones[AOOSP_DERATE_MAXZONES];
+static int                  aoosp_derate_numzones;
+static uint16_t             aoosp_derate_last;
+static uint8_t              aoosp_derate_target;
+static uint16_t             aoosp_derate_min;
+static aoosp_derate_stats_t aoosp_derate_stats;
+
+
+/*!
+    @brief  Configures the derating controller.
+    @param  last
+            The address of the last node in the chain.
+    @param  target
+            The (raw) temperature the controller regulates towards;
+            pick it safely below the OT threshold of the nodes.
+    @param  minscale
+            The lowest scale factor (AOOSP_DERATE_ONE is full brightness).
+    @note   All scales are set to AOOSP_DERATE_ONE, and all zones removed,
+            so every node is derated individually.
+*/
+void aoosp_derate_init(uint16_t last, uint8_t target, uint16_t minscale) {
+  if( last>=AOOSP_DERATE_NODES ) last = AOOSP_DERATE_NODES-1;
+  if( minscale>AOOSP_DERATE_ONE ) minscale = AOOSP_DERATE_ONE;
+  for( int n=0; n<AOOSP_DERATE_NODES; n++ ) aoosp_derate_scales[n] = AOOSP_DERATE_ONE;
+  memset( aoosp_derate_zoneof, -1, sizeof aoosp_derate_zoneof );
+  memset( &aoosp_derate_stats, 0, sizeof aoosp_derate_stats );
+  aoosp_derate_stats.minscale = AOOSP_DERATE_ONE;
+  aoosp_derate_numzones = 0;
+  aoosp_derate_last     = last;
+  aoosp_derate_target   = target;
+  aoosp_derate_min      = minscale;
+}
+
+
+/*!
+    @brief  Groups nodes in a zone; they get the same scale factor,
+            based on the hottest node of the zone.
+    @param  first
+            The address of the first node of the zone.
+    @param  last
+            The address of the last node of the zone.
+    @return aoresult_ok        if all ok,
+            aoresult_osp_addr  if the range is empty or outside the chain,
+            aoresult_osp_arg   if there are already AOOSP_DERATE_MAXZONES zones.
+    @note   Zones typically match a luminaire or module; a node in two
+            zones belongs to the last one.
+*/
+aoresult_t aoosp_derate_zone(uint16_t first, uint16_t last) {
+  if( first<1 || first>last || last>aoosp_derate_last ) return aoresult_osp_addr;
+  if( aoosp_derate_numzones>=AOOSP_DERATE_MAXZONES ) return aoresult_osp_arg;
+  aoosp_derate_zones[aoosp_derate_numzones].first = first;
+  aoosp_derate_zones[aoosp_derate_numzones].last  = last;
+  aoosp_derate_zones[aoosp_derate_numzones].scale = AOOSP_DERATE_ONE;
+  for( uint16_t n=first; n<=last; n++ ) aoosp_derate_zoneof[n] = aoosp_derate_numzones;
+  aoosp_derate_numzones++;
+  return aoresult_ok;
+}
+
+
+// Collects the temperature (and OT) of node `addr` from sweep and thermal monitor; returns -1 if unknown.
+static int aoosp_derate_temp(uint16_t addr, const aoosp_therm_stats_t * therm, int * ot) {
+  int      temp = -1;
+  uint8_t  t, stat;
+  uint32_t agems;
+  *ot = 0;
+  if( aoosp_sweep_get(addr,&t,&stat,&agems)==aoresult_ok && agems<=AOOSP_DERATE_MAXAGE_MS ) {
+    temp = t;
+    *ot  = (stat & AOOSP_STAT_FLAGS_OT)!=0;
+  }
+  if( therm->hot ) {
+    uint16_t a;
+    for( int ix=0; aoosp_therm_hot_get(ix,&a,&t)==aoresult_ok; ix++ )
+      if( a==addr && t>temp ) temp = t;
+  }
+  return temp;
+}
+
+
+// Returns the new scale for a node (or zone) with current `scale`, temperature `temp` and OT flag.
+static uint16_t aoosp_derate_control(uint16_t scale, int temp, int ot) {
+  int s = scale;
+  if( ot ) {
+    s = aoosp_derate_min;
+  } else if( temp>aoosp_derate_target ) {
+    s -= AOOSP_DERATE_STEPDOWN * (temp-aoosp_derate_target);
+  } else if( temp<aoosp_derate_target ) {
+    s += AOOSP_DERATE_STEPUP;
+  }
+  if( s<aoosp_derate_min  ) s = aoosp_derate_min;
+  if( s>AOOSP_DERATE_ONE  ) s = AOOSP_DERATE_ONE;
+  return s;
+}
+
+
+/*!
+    @brief  Updates the scale factors of all nodes.
+    @note   Sends no telegrams; uses the data of aoosp_sweep_step() and
+            aoosp_therm_poll(), so call it after those, e.g. once per frame.
+            Nodes (zones) without known temperature keep their scale.
+    @note   The control gains are per call, so call at a fixed rate.
+*/
+void aoosp_derate_update() {
+  aoosp_therm_stats_t therm;
+  aoosp_therm_stats_get(&therm);
+  int ztemp[AOOSP_DERATE_MAXZONES];
+  int zot  [AOOSP_DERATE_MAXZONES];
+  for( int z=0; z<aoosp_derate_numzones; z++ ) { ztemp[z]=-1; zot[z]=0; }
+
+  aoosp_derate_stats.updates++;
+  aoosp_derate_stats.unknown = 0;
+
+  // Nodes without zone are controlled directly; for zones collect the hottest
+  for( uint16_t n=1; n<=aoosp_derate_last; n++ ) {
+    int ot;
+    int temp = aoosp_derate_temp(n,&therm,&ot);
+    if( temp<0 ) aoosp_derate_stats.unknown++;
+    int z = aoosp_derate_zoneof[n];
+    if( z>=0 ) {
+      if( temp>ztemp[z] ) ztemp[z] = temp;
+      zot[z] |= ot;
+    } else if( temp>=0 ) {
+      aoosp_derate_scales[n] = aoosp_derate_control(aoosp_derate_scales[n],temp,ot);
+    }
+  }
+
+  // Control the zones
+  for( int z=0; z<aoosp_derate_numzones; z++ ) {
+    aoosp_derate_zone_t * Z = &aoosp_derate_zones[z];
+    if( ztemp[z]>=0 ) Z->scale = aoosp_derate_control(Z->scale,ztemp[z],zot[z]);
+    for( uint16_t n=Z->first; n<=Z->last; n++ )
+      if( aoosp_derate_zoneof[n]==z ) aoosp_derate_scales[n] = Z->scale;
+  }
+
+  // Stats
+  aoosp_derate_stats.derated  = 0;
+  aoosp_derate_stats.minscale = AOOSP_DERATE_ONE;
+  aoosp_derate_stats.minaddr  = 0;
+  for( uint16_t n=1; n<=aoosp_derate_last; n++ ) {
+    if( aoosp_derate_scales[n]<AOOSP_DERATE_ONE ) aoosp_derate_stats.derated++;
+    if( aoosp_derate_scales[n]<aoosp_derate_stats.minscale ) {
+      aoosp_derate_stats.minscale = aoosp_derate_scales[n];
+      aoosp_derate_stats.minaddr  = n;
+    }
+  }
+}
+
+
+/*!
+    @brief  Returns the scale factor of a node.
+    @param  addr
+            The address of the node.
+    @return The scale, AOOSP_DERATE_ONE for full brightness
+            (also for addresses outside the chain).
+*/
+uint16_t aoosp_derate_scale(uint16_t addr) {
+  if( addr>=AOOSP_DERATE_NODES ) return AOOSP_DERATE_ONE;
+  return aoosp_derate_scales[addr];
+}
+
+
+/*!
+    @brief  Scales a brightness value with the derating factor of a node.
+    @param  addr
+            The address of the node.
+    @param  value
+            The value, typically a PWM setting (e.g. red of setpwmchn).
+    @return The scaled value.
+    @note   Use in the frame pipeline, on the values about to be sent;
+            this adds no telegrams.
+*/
+uint16_t aoosp_derate_apply(uint16_t addr, uint16_t value) {
+  return ((uint32_t)value * aoosp_derate_scale(addr)) / AOOSP_DERATE_ONE;
+}
+
+
+/*!
+    @brief  Gets the statistics of the controller.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+*/
+void aoosp_derate_stats_get(aoosp_derate_stats_t * stats) {
+  if( stats ) *stats = aoosp_derate_stats;
+}
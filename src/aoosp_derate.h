@@ -0,0 +1,67 @@
+// aoosp_derate.h - thermal derating of brightness per node or zone
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_DERATE_H_
+#define _AOOSP_DERATE_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Number of nodes with a scale factor (addresses 000..AOOSP_DERATE_NODES-1)
+#define AOOSP_DERATE_NODES      1008
+// Max number of zones
+#define AOOSP_DERATE_MAXZONES   16
+// Scale factor for full brightness (scale factors are in 1/1024)
+#define AOOSP_DERATE_ONE        1024
+// Scale decrease per update, per (raw) degree above target
+#define AOOSP_DERATE_STEPDOWN   16
+// Scale increase per update when below target
+#define AOOSP_DERATE_STEPUP     4
+// Sweep entries older than this (ms) are not used
+#define AOOSP_DERATE_MAXAGE_MS  5000
+
+
+// Statistics of the controller (see aoosp_derate_stats_get)
+typedef struct aoosp_derate_stats_s {
+  uint32_t updates;     // Number of calls to aoosp_derate_update
+  uint16_t derated;     // Number of nodes with scale below AOOSP_DERATE_ONE (last update)
+  uint16_t unknown;     // Number of nodes without temperature (last update)
+  uint16_t minscale;    // Lowest scale of all nodes (last update)
+  uint16_t minaddr;     // Node with the lowest scale (last update)
+} aoosp_derate_stats_t;
+
+
+// Configures derating of nodes 1..last towards (raw) temperature `target`, down to `minscale`; removes zones.
+void       aoosp_derate_init(uint16_t last, uint8_t target, uint16_t minscale=AOOSP_DERATE_ONE/8);
+// Groups nodes first..last in a zone; all nodes in a zone get the same scale (based on the hottest).
+aoresult_t aoosp_derate_zone(uint16_t first, uint16_t last);
+// Updates the scale factors from the sweep and thermal monitor data (sends no telegrams).
+void       aoosp_derate_update();
+// Returns the scale factor of node `addr` (AOOSP_DERATE_ONE is no derating).
+uint16_t   aoosp_derate_scale(uint16_t addr);
+// Returns `value` (e.g. a PWM setting) of node `addr` scaled with its derating factor.
+uint16_t   aoosp_derate_apply(uint16_t addr, uint16_t value);
+// Gets the statistics.
+void       aoosp_derate_stats_get(aoosp_derate_stats_t * stats);
+
+
+#endif
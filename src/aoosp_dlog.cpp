@@ -0,0 +1,408 @@
+// aoosp_dlog.cpp - deferred formatting of the aoosp_send log: binary records in a lock-free ring
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <stdio.h>          // snprintf, sscanf
+#include <string.h>         // memcpy
+#include <Arduino.h>        // micros, Serial
+#include <aoosp_prt.h>      // aoosp_prt_xxx_r
+#include <aoosp_send.h>     // aoosp_cycles_per_us
+#include <aoosp_dlog.h>     // own API
+
+
+// Deferred log
+// ============
+// With aoosp_loglevel_args, every aoosp_send_xxx() used to make several
+// Serial.printf calls (with aoresult_to_str and aoosp_prt_bytes) between
+// the transfers, which multiplies the time of a telegram and distorts the
+// very timing one tries to debug. Now aoosp_send only captures a record:
+// a format id (which aoosp_send_xxx), the results, the arguments and
+// results as plain integers, and for aoosp_loglevel_tele the raw telegrams.
+// All formatting is in aoosp_dlog_format(), the single place that knows the
+// layout of the log lines; the results part, aoosp_dlog_format_results(), is
+// also used by the trace decoder.
+//
+// By default (immediate) the record is formatted and printed right away, so
+// the log looks as it always did. With aoosp_dlog_deferred_set(1) records are
+// written in place into a ring, and printed later by aoosp_dlog_flush() from a
+// low priority task or when the bus is idle. In raw mode the flush prints the
+// records as hex lines, which the host tool extras/host/aoosp_dlogdump formats
+// on a PC (it links this file, so the lines are the same).
+//
+// The ring has a single producer (the bus task, via aoosp_dlog_alloc and
+// aoosp_dlog_commit) and a single consumer (aoosp_dlog_pop or flush), which
+// may run on different cores; head and tail are published with
+// release/acquire ordering, so no lock is needed. When the ring is full the
+// record goes to a scratch record and is counted as dropped; the bus task
+// never waits for the log.
+
+
+static_assert( sizeof(aoosp_dlog_rec_t)==76, "aoosp_dlog_rec_t must not have padding (raw lines)" );
+
+
+static aoosp_dlog_rec_t   aoosp_dlog_ring[AOOSP_DLOG_RECS];
+static aoosp_dlog_rec_t   aoosp_dlog_scratch;   // immediate mode, or ring full
+static uint32_t           aoosp_dlog_head;      // written by producer only
+static uint32_t           aoosp_dlog_tail;      // written by consumer only
+static uint8_t            aoosp_dlog_deferred;
+static uint8_t            aoosp_dlog_rawhdr;    // header of raw lines printed
+static uint32_t           aoosp_dlog_dropseen;  // dropped count at the last flush
+static aoosp_dlog_stats_t aoosp_dlog_stats;
+
+
+/*!
+    @brief  Selects immediate or deferred printing of the aoosp_send log.
+    @param  deferred
+            When 0 (default), aoosp_send prints each log line right away.
+            When 1, aoosp_send only queues a record in the ring; the
+            application prints them with aoosp_dlog_flush().
+    @note   The amount of logging is still set with aoosp_loglevel_set().
+    @note   Clears the ring and the statistics; must not run concurrently
+            with aoosp_send or aoosp_dlog_flush.
+*/
+void aoosp_dlog_deferred_set(int deferred) {
+  aoosp_dlog_head     = 0;
+  aoosp_dlog_tail     = 0;
+  aoosp_dlog_rawhdr   = 0;
+  aoosp_dlog_dropseen = 0;
+  memset( &aoosp_dlog_stats, 0, sizeof aoosp_dlog_stats );
+  aoosp_dlog_deferred = deferred!=0;
+}
+
+
+/*!
+    @brief  Returns whether the aoosp_send log is deferred.
+    @return 1 when deferred, 0 when immediate.
+*/
+int aoosp_dlog_deferred_get() {
+  return aoosp_dlog_deferred;
+}
+
+
+/*!
+    @brief  Returns a record for aoosp_send to fill.
+    @return The next free slot of the ring when deferred, so the record is
+            written in place. A scratch record when immediate or when the
+            ring is full.
+    @note   Must be followed by aoosp_dlog_commit() (on the same task).
+*/
+aoosp_dlog_rec_t * aoosp_dlog_alloc() {
+  if( aoosp_dlog_deferred ) {
+    uint32_t head = aoosp_dlog_head;
+    uint32_t tail = __atomic_load_n(&aoosp_dlog_tail, __ATOMIC_ACQUIRE);
+    if( head-tail < AOOSP_DLOG_RECS ) return &aoosp_dlog_ring[head % AOOSP_DLOG_RECS];
+  }
+  return &aoosp_dlog_scratch;
+}
+
+
+/*!
+    @brief  Completes a record returned by aoosp_dlog_alloc().
+    @param  rec
+            The record.
+    @note   Deferred: publishes the record to the consumer (or counts it
+            as dropped when the ring was full). Immediate: formats the
+            record and prints it to Serial.
+*/
+void aoosp_dlog_commit(aoosp_dlog_rec_t * rec) {
+  if( rec!=&aoosp_dlog_scratch ) {
+    uint32_t head = aoosp_dlog_head+1;
+    __atomic_store_n(&aoosp_dlog_head, head, __ATOMIC_RELEASE);
+    uint32_t used = head - __atomic_load_n(&aoosp_dlog_tail, __ATOMIC_ACQUIRE);
+    if( used > aoosp_dlog_stats.highwater ) aoosp_dlog_stats.highwater = used;
+    aoosp_dlog_stats.records++;
+  } else if( aoosp_dlog_deferred ) {
+    aoosp_dlog_stats.dropped++;
+  } else {
+    char line[AOOSP_DLOG_LINESIZE];
+    aoosp_dlog_format(rec, line, sizeof line);
+    Serial.printf("%s", line);
+  }
+}
+
+
+/*!
+    @brief  Returns the number of records waiting in the ring.
+    @return Number of records, at most AOOSP_DLOG_RECS.
+*/
+int aoosp_dlog_count() {
+  return __atomic_load_n(&aoosp_dlog_head, __ATOMIC_ACQUIRE) - aoosp_dlog_tail;
+}
+
+
+/*!
+    @brief  Removes the oldest record from the ring.
+    @param  rec
+            Output parameter receiving a copy of the record.
+    @return 1 when a record was removed, 0 when the ring is empty (or rec is NULL).
+    @note   Consumer side; run from one task only (e.g. the one calling flush).
+*/
+int aoosp_dlog_pop(aoosp_dlog_rec_t * rec) {
+  if( rec==0 ) return 0;
+  uint32_t tail = aoosp_dlog_tail;
+  uint32_t head = __atomic_load_n(&aoosp_dlog_head, __ATOMIC_ACQUIRE);
+  if( head==tail ) return 0;
+  *rec = aoosp_dlog_ring[tail % AOOSP_DLOG_RECS];
+  __atomic_store_n(&aoosp_dlog_tail, tail+1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+
+// Per format: the telegram ID (the name comes from aoosp_prt_tid), a suffix for the variants of one TID, and whether the telegram has a response (then the line has " ->" and results)
+typedef struct aoosp_dlog_fmtinfo_s { uint8_t tid; const char * suffix; uint8_t resp; } aoosp_dlog_fmtinfo_t;
+static const aoosp_dlog_fmtinfo_t aoosp_dlog_fmtinfo[aoosp_dlog_fmt_count] = {
+  {AOOSP_TID_RESET,"",0},        {AOOSP_TID_CLRERROR,"",0},     {AOOSP_TID_INITBIDIR,"",1},    {AOOSP_TID_INITLOOP,"",1},
+  {AOOSP_TID_GOSLEEP,"",0},      {AOOSP_TID_GOACTIVE,"",0},     {AOOSP_TID_GODEEPSLEEP,"",0},  {AOOSP_TID_IDENTIFY,"",1},
+  {AOOSP_TID_ASKTINFO,"",1},     {AOOSP_TID_ASKTINFO,"_ex",1},  {AOOSP_TID_READMULT,"",1},     {AOOSP_TID_SETMULT,"",0},
+  {AOOSP_TID_SYNC,"",0},         {AOOSP_TID_IDLE,"",0},         {AOOSP_TID_FOUNDRY,"",0},      {AOOSP_TID_CUST,"",0},
+  {AOOSP_TID_BURN,"",0},         {AOOSP_TID_I2CREAD,"",0},      {AOOSP_TID_I2CWRITE,"",0},     {AOOSP_TID_READLAST,"",1},
+  {AOOSP_TID_GOACTIVE_SR,"",1},  {AOOSP_TID_READSTAT,"",1},     {AOOSP_TID_READTEMPSTAT,"",1}, {AOOSP_TID_READCOMST,"",1},
+  {AOOSP_TID_READLEDST,"",1},    {AOOSP_TID_READLEDST,"chn",1}, {AOOSP_TID_READTEMP,"",1},     {AOOSP_TID_READSETUP,"",1},
+  {AOOSP_TID_SETSETUP,"",0},     {AOOSP_TID_READPWM,"",1},      {AOOSP_TID_READPWM,"chn",1},   {AOOSP_TID_SETPWM,"",0},
+  {AOOSP_TID_SETPWM,"chn",0},    {AOOSP_TID_READCURCHN,"",1},   {AOOSP_TID_SETCURCHN,"",0},    {AOOSP_TID_READI2CCFG,"",1},
+  {AOOSP_TID_SETI2CCFG,"",0},    {AOOSP_TID_READOTP,"",1},      {AOOSP_TID_SETOTP,"",0},       {AOOSP_TID_SETTESTDATA,"",0},
+  {AOOSP_TID_SETTESTPW,"",0},    {AOOSP_TID_SETTESTPW_SR,"",1},
+};
+
+
+/*!
+    @brief  Formats the results of a record, the part of the log line after " ->".
+    @param  rec
+            The record, e.g. from aoosp_dlog_pop() or aoosp_send_des_rec().
+    @param  buf
+            Buffer that receives the results.
+    @param  size
+            Size of buf in bytes.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   No newline; example " temp=0x8C=54 stat=0x40=sleep-tv-clou (25, sleep-ol-clou)".
+            SAID meaning first, RGBi meaning in parenthesis.
+    @note   Reentrant; also used by aoosp_trace_decode, so a trace shows the
+            fields of a response like the log does.
+*/
+int aoosp_dlog_format_results(const aoosp_dlog_rec_t * rec, char * buf, int size) {
+  int len = 0;
+  #define AOOSP_DLOG_APPEND(...) do { if( len<size-1 ) { int n=snprintf(buf+len, size-len, __VA_ARGS__); len+= n<size-len ? n : size-1-len; } } while(0)
+  if( buf==0 || size<=0 ) return 0;
+  buf[0] = '\0';
+  if( rec==0 || rec->fmt>=aoosp_dlog_fmt_count ) return 0;
+
+  const uint32_t * a = rec->arg;
+  char b1[48], b2[48]; // for the aoosp_prt_xxx_r conversions
+  aoosp_prt_bytes_r(b1, sizeof b1, rec->bytes, rec->bytesize); // byte array result
+  switch( rec->fmt ) {
+    case aoosp_dlog_fmt_initbidir   :
+    case aoosp_dlog_fmt_initloop    : aoosp_prt_stat_said_r(b1, sizeof b1, a[3]); aoosp_prt_stat_rgbi_r(b2, sizeof b2, a[3]);
+                                      AOOSP_DLOG_APPEND(" last=0x%03X=%d temp=0x%02X=%d stat=0x%02X=%s (%d, %s)", (unsigned)a[1], (int)a[1],
+                                        (unsigned)a[2], aoosp_prt_temp_said(a[2]), (unsigned)a[3], b1, aoosp_prt_temp_rgbi(a[2]), b2 ); break;
+    case aoosp_dlog_fmt_identify    : AOOSP_DLOG_APPEND(" id=0x%08lX", (unsigned long)a[1] ); break;
+    case aoosp_dlog_fmt_asktinfo    :
+    case aoosp_dlog_fmt_asktinfo_ex : AOOSP_DLOG_APPEND(" tmin=0x%02X=%d tmax=0x%02X=%d (%d, %d)", (unsigned)a[1], aoosp_prt_temp_said(a[1]),
+                                        (unsigned)a[2], aoosp_prt_temp_said(a[2]), aoosp_prt_temp_rgbi(a[1]), aoosp_prt_temp_rgbi(a[2]) ); break;
+    case aoosp_dlog_fmt_readmult    : AOOSP_DLOG_APPEND(" groups=0x%04X", (unsigned)a[1] ); break;
+    case aoosp_dlog_fmt_readlast    : AOOSP_DLOG_APPEND(" i2c %s", b1 ); break;
+    case aoosp_dlog_fmt_goactive_sr :
+    case aoosp_dlog_fmt_readtempstat:
+    case aoosp_dlog_fmt_settestpw_sr: aoosp_prt_stat_said_r(b1, sizeof b1, a[2]); aoosp_prt_stat_rgbi_r(b2, sizeof b2, a[2]);
+                                      AOOSP_DLOG_APPEND(" temp=0x%02X=%d stat=0x%02X=%s (%d, %s)", (unsigned)a[1], aoosp_prt_temp_said(a[1]),
+                                        (unsigned)a[2], b1, aoosp_prt_temp_rgbi(a[1]), b2 ); break;
+    case aoosp_dlog_fmt_readstat    : aoosp_prt_stat_said_r(b1, sizeof b1, a[1]); aoosp_prt_stat_rgbi_r(b2, sizeof b2, a[1]);
+                                      AOOSP_DLOG_APPEND(" stat=0x%02X=%s (%s)", (unsigned)a[1], b1, b2 ); break;
+    case aoosp_dlog_fmt_readcomst   : aoosp_prt_com_said_r(b1, sizeof b1, a[1]); aoosp_prt_com_rgbi_r(b2, sizeof b2, a[1]);
+                                      AOOSP_DLOG_APPEND(" com=0x%02X=%s (%s)", (unsigned)a[1], b1, b2 ); break;
+    case aoosp_dlog_fmt_readledst   :
+    case aoosp_dlog_fmt_readledstchn: aoosp_prt_ledst_r(b2, sizeof b2, a[1]);
+                                      AOOSP_DLOG_APPEND(" ledst=0x%02X=%s", (unsigned)a[1], b2 ); break;
+    case aoosp_dlog_fmt_readtemp    : AOOSP_DLOG_APPEND(" temp=0x%02X=%d (%d)", (unsigned)a[1], aoosp_prt_temp_said(a[1]), aoosp_prt_temp_rgbi(a[1]) ); break;
+    case aoosp_dlog_fmt_readsetup   : aoosp_prt_setup_r(b2, sizeof b2, a[1]);
+                                      AOOSP_DLOG_APPEND(" flags=0x%02X=%s", (unsigned)a[1], b2 ); break;
+    case aoosp_dlog_fmt_readpwm     : aoosp_prt_pwm_rgbi_r(b2, sizeof b2, a[1], a[2], a[3], a[4]);
+                                      AOOSP_DLOG_APPEND(" rgb=%s", b2 ); break;
+    case aoosp_dlog_fmt_readpwmchn  : aoosp_prt_pwm_said_r(b2, sizeof b2, a[2], a[3], a[4]);
+                                      AOOSP_DLOG_APPEND(" rgb=%s", b2 ); break;
+    case aoosp_dlog_fmt_readcurchn  : aoosp_prt_curchn_r(b2, sizeof b2, a[2]);
+                                      AOOSP_DLOG_APPEND(" flags=%s rcur=%X gcur=%X bcur=%X", b2, (unsigned)a[3], (unsigned)a[4], (unsigned)a[5] ); break;
+    case aoosp_dlog_fmt_readi2ccfg  : aoosp_prt_i2ccfg_r(b2, sizeof b2, a[1]);
+                                      AOOSP_DLOG_APPEND(" flags=0x%02X=%s speed=0x%02X=%d", (unsigned)a[1], b2, (unsigned)a[2], aoosp_prt_i2ccfg_speed(a[2]) ); break;
+    case aoosp_dlog_fmt_readotp     : AOOSP_DLOG_APPEND(" otp 0x%02X: %s", (unsigned)a[1], b1 ); break;
+    default                         : break;
+  }
+  #undef AOOSP_DLOG_APPEND
+  return len;
+}
+
+
+/*!
+    @brief  Formats a record as the log line of its aoosp_send_xxx().
+    @param  rec
+            The record, e.g. from aoosp_dlog_pop() or aoosp_dlog_parse().
+    @param  buf
+            Buffer that receives the line (AOOSP_DLOG_LINESIZE always fits).
+    @param  size
+            Size of buf in bytes.
+    @return Length of the line in buf (truncated to size-1 chars).
+    @note   The line ends with a newline; example
+              initbidir(0x001) -> last=0x004=4 temp=0x6F=25 stat=0x50=sleep-tV-clou (-6, sleep-oL-clou)
+    @note   Reentrant (uses the aoosp_prt_xxx_r variants), so it can run on
+            another task than aoosp_send.
+*/
+int aoosp_dlog_format(const aoosp_dlog_rec_t * rec, char * buf, int size) {
+  int len = 0;
+  #define AOOSP_DLOG_APPEND(...) do { if( len<size-1 ) { int n=snprintf(buf+len, size-len, __VA_ARGS__); len+= n<size-len ? n : size-1-len; } } while(0)
+  if( buf==0 || size<=0 ) return 0;
+  buf[0] = '\0';
+  if( rec==0 || rec->fmt>=aoosp_dlog_fmt_count ) return 0;
+
+  const uint32_t * a = rec->arg;
+  char b1[48], b2[48]; // for the aoosp_prt_xxx_r conversions
+  aoosp_prt_bytes_r(b1, sizeof b1, rec->bytes, rec->bytesize); // byte array as argument or as result
+
+  // Name and arguments
+  AOOSP_DLOG_APPEND("%s%s(0x%03X", aoosp_prt_tid(aoosp_dlog_fmtinfo[rec->fmt].tid), aoosp_dlog_fmtinfo[rec->fmt].suffix, (unsigned)a[0] );
+  switch( rec->fmt ) {
+    case aoosp_dlog_fmt_setmult     :
+    case aoosp_dlog_fmt_setsetup    : AOOSP_DLOG_APPEND(",0x%02X", (unsigned)a[1] ); break;
+    case aoosp_dlog_fmt_i2cread     : AOOSP_DLOG_APPEND(",0x%02X,0x%02X,%d", (unsigned)a[1], (unsigned)a[2], (int)a[3] ); break;
+    case aoosp_dlog_fmt_i2cwrite    : AOOSP_DLOG_APPEND(",0x%02X,0x%02X,%s", (unsigned)a[1], (unsigned)a[2], b1 ); break;
+    case aoosp_dlog_fmt_readpwmchn  :
+    case aoosp_dlog_fmt_readcurchn  : AOOSP_DLOG_APPEND(",%X", (unsigned)a[1] ); break;
+    case aoosp_dlog_fmt_setpwm      : AOOSP_DLOG_APPEND(",0x%04X,0x%04X,0x%04X,%X", (unsigned)a[1], (unsigned)a[2], (unsigned)a[3], (unsigned)a[4] ); break;
+    case aoosp_dlog_fmt_setpwmchn   : AOOSP_DLOG_APPEND(",%X,0x%04X,0x%04X,0x%04X", (unsigned)a[1], (unsigned)a[2], (unsigned)a[3], (unsigned)a[4] ); break;
+    case aoosp_dlog_fmt_setcurchn   : aoosp_prt_curchn_r(b2, sizeof b2, a[2]);
+                                      AOOSP_DLOG_APPEND(",%X,%s,%X,%X,%X", (unsigned)a[1], b2, (unsigned)a[3], (unsigned)a[4], (unsigned)a[5] ); break;
+    case aoosp_dlog_fmt_seti2ccfg   : AOOSP_DLOG_APPEND(",0x%02X,0x%02X", (unsigned)a[1], (unsigned)a[2] ); break;
+    case aoosp_dlog_fmt_readotp     : AOOSP_DLOG_APPEND(",0x%02X", (unsigned)a[1] ); break;
+    case aoosp_dlog_fmt_setotp      : AOOSP_DLOG_APPEND(",0x%02X,%s", (unsigned)a[1], b1 ); break;
+    case aoosp_dlog_fmt_settestdata : AOOSP_DLOG_APPEND(",0x%04X", (unsigned)a[1] ); break;
+    case aoosp_dlog_fmt_settestpw   :
+    case aoosp_dlog_fmt_settestpw_sr: AOOSP_DLOG_APPEND(",%s", b1 ); break;
+    default                         : break;
+  }
+  AOOSP_DLOG_APPEND(")");
+
+  // Telegram and errors
+  if( rec->raw ) { aoosp_prt_bytes_r(b2, sizeof b2, rec->tele, rec->telesize); AOOSP_DLOG_APPEND(" [tele %s]", b2 ); }
+  if( rec->con!=aoresult_ok ) AOOSP_DLOG_APPEND(" [constructor ERROR %s]", aoresult_to_str((aoresult_t)rec->con) );
+    else if( rec->spi!=aoresult_ok ) AOOSP_DLOG_APPEND(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)rec->spi) );
+    else if( rec->des!=aoresult_ok && aoosp_dlog_fmtinfo[rec->fmt].resp ) AOOSP_DLOG_APPEND(" [destructor ERROR %s]", aoresult_to_str((aoresult_t)rec->des) );
+  if( !aoosp_dlog_fmtinfo[rec->fmt].resp ) { AOOSP_DLOG_APPEND("\n"); return len; }
+
+  // Response and results
+  AOOSP_DLOG_APPEND(" ->");
+  if( rec->raw ) { aoosp_prt_bytes_r(b2, sizeof b2, rec->resp, rec->respsize); AOOSP_DLOG_APPEND(" [resp %s]", b2 ); }
+  len+= aoosp_dlog_format_results(rec, buf+len, size-len);
+  AOOSP_DLOG_APPEND("\n");
+  #undef AOOSP_DLOG_APPEND
+  return len;
+}
+
+
+/*!
+    @brief  Prints records from the ring to Serial, oldest first.
+    @param  max
+            The maximum number of records to print in this call.
+    @param  raw
+            When 0, prints the formatted log lines (aoosp_dlog_format).
+            When 1, prints one hex line per record, to be formatted on a
+            PC (see aoosp_dlog_parse); the first raw line gives cycles/us,
+              dlog cycles/us 240
+            followed by lines like
+              dlog 0001A2B3 02 ... (the 76 record bytes in hex).
+    @return The number of records printed.
+    @note   Call from a low priority task, or when the bus is idle; this
+            is where the time of logging is spent.
+    @note   Records dropped because the ring was full are reported with
+            a line "dlog dropped <n>".
+*/
+int aoosp_dlog_flush(int max, int raw) {
+  uint32_t t0us = micros();
+  uint32_t dropped = aoosp_dlog_stats.dropped;
+  if( dropped!=aoosp_dlog_dropseen ) {
+    Serial.printf("dlog dropped %lu\n", (unsigned long)(dropped-aoosp_dlog_dropseen) );
+    aoosp_dlog_dropseen = dropped;
+  }
+  if( raw && !aoosp_dlog_rawhdr ) {
+    Serial.printf("dlog cycles/us %lu\n", (unsigned long)aoosp_cycles_per_us() );
+    aoosp_dlog_rawhdr = 1;
+  }
+  aoosp_dlog_rec_t rec;
+  char             line[AOOSP_DLOG_LINESIZE];
+  int              count = 0;
+  while( count<max && aoosp_dlog_pop(&rec) ) {
+    if( raw ) {
+      const uint8_t * p = (const uint8_t *)&rec;
+      int len = snprintf(line, sizeof line, "dlog");
+      for( size_t i=0; i<sizeof rec; i++ ) {
+        line[len++] = ' ';
+        line[len++] = "0123456789ABCDEF"[p[i]>>4];
+        line[len++] = "0123456789ABCDEF"[p[i]&0xF];
+      }
+      line[len++] = '\n';
+      line[len] = '\0';
+    } else {
+      aoosp_dlog_format(&rec, line, sizeof line);
+    }
+    Serial.printf("%s", line);
+    count++;
+  }
+  aoosp_dlog_stats.printed += count;
+  aoosp_dlog_stats.flushus += micros() - t0us;
+  return count;
+}
+
+
+/*!
+    @brief  Parses one raw line of aoosp_dlog_flush() into a record.
+    @param  line
+            The line, "dlog" followed by the record bytes in hex.
+    @param  rec
+            Output parameter receiving the record.
+    @return aoresult_ok, aoresult_outargnull or aoresult_osp_arg (the
+            line is not a raw record, e.g. the header line).
+    @note   Used by host tools; the record bytes are little endian, as
+            on the ESP32 and on x86 hosts.
+*/
+aoresult_t aoosp_dlog_parse(const char * line, aoosp_dlog_rec_t * rec) {
+  if( line==0 || rec==0 ) return aoresult_outargnull;
+  if( strncmp(line, "dlog ", 5)!=0 ) return aoresult_osp_arg;
+  uint8_t * p   = (uint8_t *)rec;
+  int       pos = 4;
+  for( size_t i=0; i<sizeof *rec; i++ ) {
+    unsigned int byte;
+    int          len;
+    if( sscanf(line+pos, " %2x%n", &byte, &len)!=1 ) return aoresult_osp_arg;
+    p[i] = byte;
+    pos+= len;
+  }
+  if( rec->fmt>=aoosp_dlog_fmt_count ) return aoresult_osp_arg;
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Gets the statistics of the ring.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+    @note   `dropped` non-zero means the flush does not keep up with the
+            log rate; flush more often, or enlarge AOOSP_DLOG_RECS.
+*/
+void aoosp_dlog_stats_get(aoosp_dlog_stats_t * stats) {
+  if( stats ) *stats = aoosp_dlog_stats;
+}
@@ -0,0 +1,112 @@
+// aoosp_dlog.h - deferred formatting of the aoosp_send log: binary records in a lock-free ring
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_DLOG_H_
+#define _AOOSP_DLOG_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Number of records in the ring (power of 2; each record is 76 bytes)
+#define AOOSP_DLOG_RECS       64
+// Number of (scalar) arguments and results per record
+#define AOOSP_DLOG_ARGS       6
+// Maximum number of bytes of a byte array argument or result (e.g. OTP or I2C data)
+#define AOOSP_DLOG_BYTES      16
+// Size of a telegram in a record (OSP telegrams are at most 12 bytes)
+#define AOOSP_DLOG_TELESIZE   12
+// Buffer size that fits every formatted line (see aoosp_dlog_format)
+#define AOOSP_DLOG_LINESIZE   256
+
+
+// Format ids: one per logging aoosp_send_xxx(); determines name, arguments and results of the line.
+typedef enum aoosp_dlog_fmt_e {
+  aoosp_dlog_fmt_reset,        aoosp_dlog_fmt_clrerror,     aoosp_dlog_fmt_initbidir,    aoosp_dlog_fmt_initloop,
+  aoosp_dlog_fmt_gosleep,      aoosp_dlog_fmt_goactive,     aoosp_dlog_fmt_godeepsleep,  aoosp_dlog_fmt_identify,
+  aoosp_dlog_fmt_asktinfo,     aoosp_dlog_fmt_asktinfo_ex,  aoosp_dlog_fmt_readmult,     aoosp_dlog_fmt_setmult,
+  aoosp_dlog_fmt_sync,         aoosp_dlog_fmt_idle,         aoosp_dlog_fmt_foundry,      aoosp_dlog_fmt_cust,
+  aoosp_dlog_fmt_burn,         aoosp_dlog_fmt_i2cread,      aoosp_dlog_fmt_i2cwrite,     aoosp_dlog_fmt_readlast,
+  aoosp_dlog_fmt_goactive_sr,  aoosp_dlog_fmt_readstat,     aoosp_dlog_fmt_readtempstat, aoosp_dlog_fmt_readcomst,
+  aoosp_dlog_fmt_readledst,    aoosp_dlog_fmt_readledstchn, aoosp_dlog_fmt_readtemp,     aoosp_dlog_fmt_readsetup,
+  aoosp_dlog_fmt_setsetup,     aoosp_dlog_fmt_readpwm,      aoosp_dlog_fmt_readpwmchn,   aoosp_dlog_fmt_setpwm,
+  aoosp_dlog_fmt_setpwmchn,    aoosp_dlog_fmt_readcurchn,   aoosp_dlog_fmt_setcurchn,    aoosp_dlog_fmt_readi2ccfg,
+  aoosp_dlog_fmt_seti2ccfg,    aoosp_dlog_fmt_readotp,      aoosp_dlog_fmt_setotp,       aoosp_dlog_fmt_settestdata,
+  aoosp_dlog_fmt_settestpw,    aoosp_dlog_fmt_settestpw_sr,
+  aoosp_dlog_fmt_count // number of formats
+} aoosp_dlog_fmt_t;
+
+
+// One log record: everything an aoosp_send_xxx() log line shows, unformatted (76 bytes, no padding)
+typedef struct aoosp_dlog_rec_s {
+  uint32_t cycles;                         // Time stamp (aoosp_cycles) of the capture
+  uint8_t  fmt;                            // Format id (aoosp_dlog_fmt_t)
+  uint8_t  raw;                            // 1 when tele[] and resp[] hold the telegrams (aoosp_loglevel_tele)
+  uint8_t  con;                            // Constructor result (aoresult_t)
+  uint8_t  spi;                            // SPI result (aoresult_t)
+  uint8_t  des;                            // Destructor result (aoresult_t)
+  uint8_t  telesize;                       // Size of the telegram in tele[]
+  uint8_t  respsize;                       // Size of the response in resp[]
+  uint8_t  bytesize;                       // Size of the byte array in bytes[]
+  uint32_t arg[AOOSP_DLOG_ARGS];           // Arguments (arg[0] is the address) followed by results, see aoosp_dlog_format
+  uint8_t  tele[AOOSP_DLOG_TELESIZE];      // Raw telegram
+  uint8_t  resp[AOOSP_DLOG_TELESIZE];      // Raw response
+  uint8_t  bytes[AOOSP_DLOG_BYTES];        // Byte array argument or result
+} aoosp_dlog_rec_t;
+
+
+// Statistics of the ring (see aoosp_dlog_stats_get)
+typedef struct aoosp_dlog_stats_s {
+  uint32_t records;     // Number of records queued
+  uint32_t dropped;     // Number of records dropped (ring full)
+  uint32_t printed;     // Number of records printed by aoosp_dlog_flush
+  uint32_t flushus;     // Time spent in aoosp_dlog_flush (us)
+  uint16_t highwater;   // Max number of records waiting in the ring
+} aoosp_dlog_stats_t;
+
+
+// When 1, aoosp_send queues log records in the ring (print them with aoosp_dlog_flush); when 0 (default) they are printed immediately.
+void       aoosp_dlog_deferred_set(int deferred);
+// Returns 1 when logging is deferred.
+int        aoosp_dlog_deferred_get();
+
+// Returns a record to fill (a free ring slot, or a scratch record when immediate or full); called by aoosp_send.
+aoosp_dlog_rec_t * aoosp_dlog_alloc();
+// Queues (deferred) or prints (immediate) the record returned by aoosp_dlog_alloc; called by aoosp_send.
+void       aoosp_dlog_commit(aoosp_dlog_rec_t * rec);
+
+// Returns the number of records waiting in the ring.
+int        aoosp_dlog_count();
+// Removes the oldest record from the ring into `rec`; returns 1, or 0 when the ring is empty.
+int        aoosp_dlog_pop(aoosp_dlog_rec_t * rec);
+// Formats `rec` as the aoosp_send log line (with '\n') into buf of `size` bytes; returns the length (reentrant).
+int        aoosp_dlog_format(const aoosp_dlog_rec_t * rec, char * buf, int size);
+// Formats only the results of `rec` (the part after " ->", no '\n') into buf of `size` bytes; returns the length (reentrant).
+int        aoosp_dlog_format_results(const aoosp_dlog_rec_t * rec, char * buf, int size);
+// Prints at most `max` records (call from a low priority task or when idle); raw prints hex lines for aoosp_dlog_parse; returns records printed.
+int        aoosp_dlog_flush(int max=AOOSP_DLOG_RECS, int raw=0);
+// Parses one raw line of aoosp_dlog_flush into `rec`; returns aoresult_osp_arg for other lines (e.g. in extras/host/aoosp_dlogdump).
+aoresult_t aoosp_dlog_parse(const char * line, aoosp_dlog_rec_t * rec);
+// Gets the statistics.
+void       aoosp_dlog_stats_get(aoosp_dlog_stats_t * stats);
+
+
+#endif
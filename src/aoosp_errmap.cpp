@@ -0,0 +1,160 @@
+// aoosp_errmap.cpp - per flag bit sets of node status over the address space
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>       // memset
+#include <aoosp_errmap.h> // own API
+
+
+// Error map
+// =========
+// Dashboards ask questions like "which nodes have OT", "how many have UV" or
+// "any CE since last clear". Looping over per-node status bytes for that is
+// slow on long chains. This module maintains, for each of the 8 bits of the
+// status byte (AOOSP_STAT_FLAGS_XXX), a set of 1024 bits; bit `addr` tells
+// if the flag was set in the last status received from node `addr`.
+// Next to that "current" set, there is a "sticky" set per flag, which
+// accumulates the flag until aoosp_errmap_clear().
+//
+// The sets are updated by aoosp_send, from every response that contains a
+// status byte: INITBIDIR, INITLOOP (status of the last node), READSTAT,
+// READTEMPSTAT, GOACTIVE_SR and SETTESTPW_SR. The queries take a mask of
+// flags, so a set is the union over the flags in the mask; they operate on
+// 32 words, using popcount and count-trailing-zeros.
+//
+// Note that the map only knows what has been received; nodes that have not
+// been read are not in any set. Call aoosp_errmap_reset() after a chain
+// reset, since all the stored statuses are then stale.
+
+
+static uint32_t aoosp_errmap_cur   [8][AOOSP_ERRMAP_WORDS];
+static uint32_t aoosp_errmap_sticky[8][AOOSP_ERRMAP_WORDS];
+
+
+/*!
+    @brief  Records the status of a node in the error map.
+    @param  addr
+            The address of the node that sent the status.
+    @param  stat
+            The status byte (AOOSP_STAT_FLAGS_XXX).
+    @note   Called by aoosp_send after every successful status-bearing
+            response; applications typically do not call this.
+*/
+void aoosp_errmap_update(uint16_t addr, uint8_t stat) {
+  if( addr>=AOOSP_ERRMAP_BITS ) return;
+  uint16_t w   = addr/32;
+  uint32_t bit = 1UL << (addr%32);
+  for( int f=0; f<8; f++ ) {
+    if( stat & (1<<f) ) {
+      aoosp_errmap_cur   [f][w] |=  bit;
+      aoosp_errmap_sticky[f][w] |=  bit;
+    } else {
+      aoosp_errmap_cur   [f][w] &= ~bit;
+    }
+  }
+}
+
+
+/*!
+    @brief  Clears the sticky sets; the current sets are unchanged.
+    @note   Typically called after reporting, "any CE since last clear".
+*/
+void aoosp_errmap_clear() {
+  memset( aoosp_errmap_sticky, 0, sizeof aoosp_errmap_sticky );
+}
+
+
+/*!
+    @brief  Clears all sets, current and sticky.
+    @note   Call after a chain reset (e.g. aoosp_exec_resetinit()).
+*/
+void aoosp_errmap_reset() {
+  memset( aoosp_errmap_cur   , 0, sizeof aoosp_errmap_cur    );
+  memset( aoosp_errmap_sticky, 0, sizeof aoosp_errmap_sticky );
+}
+
+
+// Returns word `w` of the union of the sets of the flags in `mask`.
+static uint32_t aoosp_errmap_word(uint8_t mask, uint16_t w, int sticky) {
+  uint32_t (*sets)[AOOSP_ERRMAP_WORDS] = sticky ? aoosp_errmap_sticky : aoosp_errmap_cur;
+  uint32_t word = 0;
+  for( int f=0; f<8; f++ ) if( mask & (1<<f) ) word |= sets[f][w];
+  return word;
+}
+
+
+/*!
+    @brief  Counts the nodes that have any of the flags in `mask` set.
+    @param  mask
+            Combination of AOOSP_STAT_FLAGS_XXX (e.g. AOOSP_STAT_FLAGS_OT).
+    @param  sticky
+            If 0, uses the flags of the last received status,
+            otherwise the flags seen since aoosp_errmap_clear().
+    @return The number of nodes (0..1024).
+*/
+int aoosp_errmap_count(uint8_t mask, int sticky) {
+  int count = 0;
+  for( uint16_t w=0; w<AOOSP_ERRMAP_WORDS; w++ )
+    count += __builtin_popcount( aoosp_errmap_word(mask,w,sticky) );
+  return count;
+}
+
+
+/*!
+    @brief  Finds the next node that has any of the flags in `mask` set.
+    @param  mask
+            Combination of AOOSP_STAT_FLAGS_XXX (e.g. AOOSP_STAT_FLAGS_UV).
+    @param  from
+            The address to start searching (inclusive).
+    @param  sticky
+            If 0, uses the flags of the last received status,
+            otherwise the flags seen since aoosp_errmap_clear().
+    @return The lowest address >= from in the set, or -1 if there is none.
+    @note   Iterate over a set with
+            `for( int a=aoosp_errmap_next(m); a>=0; a=aoosp_errmap_next(m,a+1) )`.
+*/
+int aoosp_errmap_next(uint8_t mask, uint16_t from, int sticky) {
+  if( from>=AOOSP_ERRMAP_BITS ) return -1;
+  uint16_t w    = from/32;
+  uint32_t word = aoosp_errmap_word(mask,w,sticky) & (~0UL << (from%32));
+  while( word==0 ) {
+    if( ++w>=AOOSP_ERRMAP_WORDS ) return -1;
+    word = aoosp_errmap_word(mask,w,sticky);
+  }
+  return w*32 + __builtin_ctz(word);
+}
+
+
+/*!
+    @brief  Tests if a node has any of the flags in `mask` set.
+    @param  addr
+            The address of the node.
+    @param  mask
+            Combination of AOOSP_STAT_FLAGS_XXX.
+    @param  sticky
+            If 0, uses the flags of the last received status,
+            otherwise the flags seen since aoosp_errmap_clear().
+    @return 1 if any flag is set, 0 otherwise (also for out of range addr).
+*/
+int aoosp_errmap_test(uint16_t addr, uint8_t mask, int sticky) {
+  if( addr>=AOOSP_ERRMAP_BITS ) return 0;
+  return ( aoosp_errmap_word(mask,addr/32,sticky) >> (addr%32) ) & 1;
+}
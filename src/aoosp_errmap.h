@@ -0,0 +1,55 @@
+// aoosp_errmap.h - per flag bit sets of node status over the address space
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_ERRMAP_H_
+#define _AOOSP_ERRMAP_H_
+
+
+#include <stdint.h>
+
+
+// When set to 1, aoosp_send updates the error map (about 2 kB RAM); 0 (default) compiles that out. May also be set with -DAOOSP_ERRMAP_ENABLED=1
+#ifndef AOOSP_ERRMAP_ENABLED
+  #define AOOSP_ERRMAP_ENABLED 0
+#endif
+
+
+// Number of bits in each set (covers all addresses 000..3FF)
+#define AOOSP_ERRMAP_BITS   1024
+// Number of 32-bit words in each set
+#define AOOSP_ERRMAP_WORDS  (AOOSP_ERRMAP_BITS/32)
+
+
+// Records status byte `stat` of node `addr` (called by aoosp_send for every status-bearing response).
+void aoosp_errmap_update(uint16_t addr, uint8_t stat);
+// Clears the sticky sets (flags seen since the last clear).
+void aoosp_errmap_clear();
+// Clears all sets (current and sticky), e.g. after a chain reset.
+void aoosp_errmap_reset();
+
+// Returns the number of nodes with any of the flags in `mask` set (current, or sticky since last clear).
+int  aoosp_errmap_count(uint8_t mask, int sticky=0);
+// Returns the lowest address >= `from` with any of the flags in `mask` set, or -1 if none.
+int  aoosp_errmap_next(uint8_t mask, uint16_t from=0, int sticky=0);
+// Returns 1 if the flags in `mask` of node `addr` are (any) set, else 0.
+int  aoosp_errmap_test(uint16_t addr, uint8_t mask, int sticky=0);
+
+
+#endif
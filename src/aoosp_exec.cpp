@@ -20,11 +20,12 @@
  *****************************************************************************/
 
 
-#include <Arduino.h>    // Serial.printf
-#include <aospi.h>      // aospi_dirmux_set_loop
-#include <aoosp_send.h> // aoosp_send_reset, aoosp_send_initloop
-#include <aoosp.h>      // aoosp_said_testpw_get
-#include <aoosp_exec.h> // own API
+#include <Arduino.h>     // Serial.printf
+#include <aospi.h>       // aospi_dirmux_set_loop
+#include <aoosp_send.h>  // aoosp_send_reset, aoosp_send_initloop
+#include <aoosp_fault.h> // aoosp_fault_recovered
+#include <aoosp.h>       // aoosp_said_testpw_get
+#include <aoosp_exec.h>  // own API
 
 
 // Generic telegram field access macros
@@ -84,6 +85,9 @@ aoresult_t aoosp_exec_resetinit(uint16_t *last, int *loop) {
     aoosp_exec_resetinit_last_= last_;
     if( last ) *last= last_;
     if( loop ) *loop= 1;
+    #if AOOSP_FAULT_ENABLED
+    aoosp_fault_recovered(AOOSP_FAULT_REC_RESETINIT);
+    #endif
     return result;
   }
   if( result!=aoresult_spi_noclock ) return result;
@@ -100,6 +104,9 @@ aoresult_t aoosp_exec_resetinit(uint16_t *last, int *loop) {
     aoosp_exec_resetinit_last_= last_;
     if( last ) *last= last_;
     if( loop ) *loop= 0;
+    #if AOOSP_FAULT_ENABLED
+    aoosp_fault_recovered(AOOSP_FAULT_REC_RESETINIT);
+    #endif
     return result;
   }
   if( result!=aoresult_spi_noclock ) return result;
@@ -408,6 +415,39 @@ aoresult_t aoosp_exec_syncpinenable_set(uint16_t addr, int enable) {
 }
 
 
+/*!
+    @brief  Waits until the I2C transaction, mastered by the SAID with 
+            address `addr`, is completed (no longer busy).
+    @param  addr
+            The address to send the telegram to (unicast).
+    @return aoresult_ok             if the transaction completed with ACK
+            aoresult_dev_i2cnack    if the transaction completed with NACK
+            aoresult_dev_i2ctimeout if the transaction did not complete in time
+            other                   telegram error
+    @note   Polls the BUSY flag with READI2CCFG. Unlike a fixed delay, the
+            poll loop only waits (AOOSP_EXEC_I2C_POLL_US) while the bridge
+            is still busy. Since sending the READI2CCFG itself takes time,
+            a short I2C transaction is typically completed at the first poll.
+    @note   Gives up after AOOSP_EXEC_I2C_TIMEOUT_US.
+*/
+static aoresult_t aoosp_exec_i2cwait(uint16_t addr) {
+  aoresult_t result;
+  uint8_t    flags;
+  uint8_t    speed;
+  uint32_t   time0us = micros();
+  while( 1 ) {
+    result = aoosp_send_readi2ccfg(addr,&flags,&speed);
+    if( result!=aoresult_ok ) return result;
+    if( !(flags & AOOSP_I2CCFG_FLAGS_BUSY) ) break;
+    if( micros()-time0us > AOOSP_EXEC_I2C_TIMEOUT_US ) return aoresult_dev_i2ctimeout;
+    delayMicroseconds(AOOSP_EXEC_I2C_POLL_US);
+  }
+  // Was transaction successful
+  if( flags & AOOSP_I2CCFG_FLAGS_NACK ) return aoresult_dev_i2cnack;
+  return aoresult_ok;
+}
+
+
 /*!
     @brief  Writes `count` bytes from `buf`, into register `raddr` in I2C
             device `daddr7`, attached to OSP node `addr`.
@@ -432,19 +472,8 @@ aoresult_t aoosp_exec_i2cwrite8(uint16_t addr, uint8_t daddr7, uint8_t raddr, co
   aoresult_t result = aoosp_send_i2cwrite8(addr,daddr7,raddr,buf,count);
   if( result!=aoresult_ok ) return result;
   // Wait (with timeout) until I2C transaction is completed (not busy)
-  uint8_t flags=AOOSP_I2CCFG_FLAGS_BUSY;
-  uint8_t tries=10; // 10x 1ms
-  while( (flags&AOOSP_I2CCFG_FLAGS_BUSY) && (tries>0) ) {
-    uint8_t speed;
-    result = aoosp_send_readi2ccfg(addr,&flags,&speed);
-    if( result!=aoresult_ok ) return result;
-    delay(1);
-    tries--;
-  }
-  // Was transaction successful
-  if( flags & AOOSP_I2CCFG_FLAGS_BUSY ) return aoresult_dev_i2ctimeout;
-  if( flags & AOOSP_I2CCFG_FLAGS_NACK ) return aoresult_dev_i2cnack;
-  return aoresult_ok;
+  result = aoosp_exec_i2cwait(addr);
+  return result;
 }
 
 
@@ -473,19 +502,136 @@ aoresult_t aoosp_exec_i2cread8(uint16_t addr, uint8_t daddr7, uint8_t raddr, uin
   aoresult_t result = aoosp_send_i2cread8(addr,daddr7,raddr,count);
   if( result!=aoresult_ok ) return result;
   // Wait (with timeout) until I2C transaction is completed (not busy)
-  uint8_t flags=AOOSP_I2CCFG_FLAGS_BUSY;
-  uint8_t tries=10; // 10x 1ms
-  while( (flags&AOOSP_I2CCFG_FLAGS_BUSY) && (tries>0) ) {
-    uint8_t speed;
-    result = aoosp_send_readi2ccfg(addr,&flags,&speed);
-    if( result!=aoresult_ok ) return result;
-    delay(1);
-    tries--;
-  }
-  // Was transaction successful
-  if( flags & AOOSP_I2CCFG_FLAGS_BUSY ) return aoresult_dev_i2ctimeout;
-  if( flags & AOOSP_I2CCFG_FLAGS_NACK ) return aoresult_dev_i2cnack;
+  result = aoosp_exec_i2cwait(addr);
+  if( result!=aoresult_ok ) return result;
   // Get the read bytes
   result = aoosp_send_readlast(addr,buf,count);
   return result;
 }
+
+
+// Notes on I2C EEPROM
+// ===================
+//
+// - An I2C EEPROM (24Cxx family) is organized in pages (eg 8 bytes for 24C02, 16 for 24C04..24C16).
+// - A write transaction auto-increments the address, but wraps around within a page;
+//   so a write must not cross a page boundary.
+// - An I2CWRITE telegram carries 1, 2, 4 or 6 data bytes (telegram payload 3, 4, 6 or 8);
+//   so writes are chopped in chunks of those sizes that also respect the page boundaries.
+// - After a write transaction, the EEPROM starts an internal write cycle of several ms (tWR, max 5ms).
+//   During that cycle the EEPROM does not acknowledge its device address.
+// - "ACK polling": rather than waiting the worst case tWR, repeatedly address the EEPROM 
+//   until it acknowledges; the NACK flag of READI2CCFG reveals the outcome.
+// - A read transaction auto-increments the address across page boundaries ("sequential read");
+//   an I2CREAD telegram reads up to 8 bytes, so reads are chopped in chunks of 8.
+
+
+/*!
+    @brief  Waits until the I2C EEPROM `daddr7`, attached to OSP node 
+            `addr`, has completed its internal write cycle.
+    @param  addr
+            The address to send the telegram to (unicast).
+    @param  daddr7
+            The 7 bits I2C device address of the EEPROM.
+    @return aoresult_ok             if the EEPROM acknowledged (is ready)
+            aoresult_dev_i2ctimeout if the EEPROM did not acknowledge in time
+            other                   telegram error
+    @note   Implements "ACK polling": a one byte read is issued, and when 
+            the NACK flag of READI2CCFG is set, the EEPROM is still busy, 
+            and the read is retried. The read byte itself is discarded.
+    @note   Gives up after AOOSP_EXEC_I2CEEPROM_WRITE_US.
+*/
+aoresult_t aoosp_exec_i2ceeprom_ackpoll(uint16_t addr, uint8_t daddr7) {
+  aoresult_t result;
+  uint32_t   time0us = micros();
+  while( 1 ) {
+    result = aoosp_send_i2cread8(addr,daddr7,0x00,1);
+    if( result!=aoresult_ok ) return result;
+    result = aoosp_exec_i2cwait(addr);
+    if( result!=aoresult_dev_i2cnack ) return result; // aoresult_ok (EEPROM ready), or an error
+    if( micros()-time0us > AOOSP_EXEC_I2CEEPROM_WRITE_US ) return aoresult_dev_i2ctimeout;
+  }
+}
+
+
+/*!
+    @brief  Writes `count` bytes from `buf`, to memory location `raddr`
+            (and up) of I2C EEPROM `daddr7`, attached to OSP node `addr`.
+    @param  addr
+            The address to send the telegram to (unicast).
+    @param  daddr7
+            The 7 bits I2C device address of the EEPROM.
+    @param  raddr
+            The 8 bits memory address of the first byte to write.
+    @param  buf
+            Pointer to buffer containing the bytes to write to the EEPROM.
+    @param  count
+            The number of bytes to write; raddr+count may not exceed 256.
+    @param  pagesize
+            The page size of the EEPROM (see its datasheet, eg 8 or 16).
+    @return aoresult_ok if all ok, otherwise an error code.
+    @note   See aoosp_exec_i2cpower.
+    @note   The bytes are written in chunks that are as large as possible 
+            (max 6), but that do not cross a page boundary.
+    @note   After each chunk, the EEPROM write cycle is awaited with ACK 
+            polling (see aoosp_exec_i2ceeprom_ackpoll), not with a fixed delay.
+    @note   The current implementation only supports the 8 bit mode.
+*/
+aoresult_t aoosp_exec_i2ceeprom_write(uint16_t addr, uint8_t daddr7, uint8_t raddr, const uint8_t *buf, int count, uint8_t pagesize) {
+  if( buf==0 ) return aoresult_outargnull;
+  if( count<0 || raddr+count>256 || pagesize==0 ) return aoresult_osp_arg;
+  while( count>0 ) {
+    // Chunk must not cross page boundary, and must fit in an I2CWRITE telegram (1, 2, 4 or 6 bytes)
+    int chunk = pagesize - raddr%pagesize;
+    if( chunk>count ) chunk= count;
+    if( chunk>6 ) chunk= 6;
+    if( chunk==5 || chunk==3 ) chunk--;
+    // Write chunk
+    aoresult_t result = aoosp_send_i2cwrite8(addr,daddr7,raddr,buf,chunk);
+    if( result!=aoresult_ok ) return result;
+    result = aoosp_exec_i2cwait(addr);
+    if( result!=aoresult_ok ) return result;
+    // Wait for write cycle of EEPROM to complete
+    result = aoosp_exec_i2ceeprom_ackpoll(addr,daddr7);
+    if( result!=aoresult_ok ) return result;
+    // Next chunk
+    raddr += chunk;
+    buf   += chunk;
+    count -= chunk;
+  }
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Reads `count` bytes into `buf`, from memory location `raddr`
+            (and up) of I2C EEPROM `daddr7`, attached to OSP node `addr`.
+    @param  addr
+            The address to send the telegram to (unicast).
+    @param  daddr7
+            The 7 bits I2C device address of the EEPROM.
+    @param  raddr
+            The 8 bits memory address of the first byte to read.
+    @param  buf
+            Pointer to buffer to receive the bytes read from the EEPROM.
+    @param  count
+            The number of bytes to read; raddr+count may not exceed 256.
+    @return aoresult_ok if all ok, otherwise an error code.
+    @note   See aoosp_exec_i2cpower.
+    @note   Uses sequential reads of (max) 8 bytes, the maximum of one 
+            I2CREAD telegram; page boundaries are irrelevant for reads.
+    @note   The current implementation only supports the 8 bit mode.
+*/
+aoresult_t aoosp_exec_i2ceeprom_read(uint16_t addr, uint8_t daddr7, uint8_t raddr, uint8_t *buf, int count) {
+  if( buf==0 ) return aoresult_outargnull;
+  if( count<0 || raddr+count>256 ) return aoresult_osp_arg;
+  while( count>0 ) {
+    int chunk = count>8 ? 8 : count;
+    aoresult_t result = aoosp_exec_i2cread8(addr,daddr7,raddr,buf,chunk);
+    if( result!=aoresult_ok ) return result;
+    raddr += chunk;
+    buf   += chunk;
+    count -= chunk;
+  }
+  return aoresult_ok;
+}
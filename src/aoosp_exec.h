@@ -49,6 +49,13 @@ aoresult_t aoosp_exec_i2cwrite8(uint16_t addr, uint8_t daddr7, uint8_t raddr, co
 // Reads from an I2C device connected to a SAID with I2C bridge.
 aoresult_t aoosp_exec_i2cread8(uint16_t addr, uint8_t daddr7, uint8_t raddr, uint8_t *buf, uint8_t count);
 
+// Waits (ACK polling) until an I2C EEPROM has completed its write cycle.
+aoresult_t aoosp_exec_i2ceeprom_ackpoll(uint16_t addr, uint8_t daddr7);
+// Writes to an I2C EEPROM connected to a SAID with I2C bridge, in page aligned chunks.
+aoresult_t aoosp_exec_i2ceeprom_write(uint16_t addr, uint8_t daddr7, uint8_t raddr, const uint8_t *buf, int count, uint8_t pagesize);
+// Reads from an I2C EEPROM connected to a SAID with I2C bridge, using sequential reads.
+aoresult_t aoosp_exec_i2ceeprom_read(uint16_t addr, uint8_t daddr7, uint8_t raddr, uint8_t *buf, int count);
+
 
 // flags for aoosp_exec_otpdump determining what to print
 #define AOOSP_OTPDUMP_CUSTOMER_HEX    0x01
@@ -58,6 +65,11 @@ aoresult_t aoosp_exec_i2cread8(uint16_t addr, uint8_t daddr7, uint8_t raddr, uin
 #define AOOSP_OTPADDR_CUSTOMER_MIN    0x0D
 #define AOOSP_OTPADDR_CUSTOMER_MAX    0x20
 
+// timing for I2C transactions (see aoosp_exec_i2cwrite8/aoosp_exec_i2cread8)
+#define AOOSP_EXEC_I2C_POLL_US        100   // wait between two polls of the BUSY flag
+#define AOOSP_EXEC_I2C_TIMEOUT_US     10000 // max time an I2C transaction may be BUSY
+#define AOOSP_EXEC_I2CEEPROM_WRITE_US 10000 // max time an I2C EEPROM may NACK after a write (write cycle)
+
 
 #endif
 
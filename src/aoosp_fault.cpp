@@ -0,0 +1,322 @@
+// aoosp_fault.cpp - fault injection between aoosp_send and aospi, with time-to-recover statistics
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>       // memset, memcpy
+#include <aospi.h>        // aospi_tx, aospi_txrx, aospi_dirmux_is_loop
+#include <aoosp_crc.h>    // aoosp_crc
+#include <aoosp_send.h>   // aoosp_cycles
+#include <aoosp_fault.h>  // own API
+
+
+// Fault injection
+// ===============
+// examples/aoosp_error shows that one bad telegram is trapped; it does not
+// show how fast an application gets back to a working chain. This layer sits
+// between aoosp_send and aospi (aoosp_send calls aoosp_fault_spi instead of
+// aospi when AOOSP_FAULT_ENABLED), and corrupts transfers per a schedule of
+// rules: which fault, on which TID and address, from which transfer, how
+// often and how many times. When not armed, the cost is one test.
+//
+// Faults are emulated at the telegram level, so they also work on a real
+// chain: a TXCRC telegram really goes out with a bad CRC; DROP, RXCRC and
+// STATFLIP change the received response; BREAK suppresses telegrams to the
+// nodes behind the break and the responses that would have to pass it
+// (all in Loop; in BiDir those of INIT, group and broadcast telegrams). The
+// trace (aoosp_trace) records TX telegrams before injection (a TXCRC shows
+// the good CRC) and RX responses after it (as the application received them).
+//
+// An episode starts with the first injection, and ends with the first good
+// response (one not injected) after it: the RESPONSE time to recover. Within
+// an episode the application reports when its recovery logic succeeded
+// (aoosp_fault_recovered for RETRY or REINIT); aoosp_exec_resetinit reports
+// RESETINIT itself. Each kind is recorded once per episode, with the time
+// and the number of transfers since the first injection.
+
+
+typedef struct aoosp_fault_acc_s {
+  uint32_t count;
+  uint32_t minus;
+  uint32_t maxus;
+  uint64_t sumus;
+  uint64_t sumtransfers;
+} aoosp_fault_acc_t;
+
+
+static aoosp_fault_rule_t aoosp_fault_rules[AOOSP_FAULT_RULES];
+static uint32_t           aoosp_fault_matched[AOOSP_FAULT_RULES];  // matching transfers per rule
+static uint32_t           aoosp_fault_done[AOOSP_FAULT_RULES];     // injections per rule
+static int                aoosp_fault_rulenum;
+static uint8_t            aoosp_fault_armed;
+static uint32_t           aoosp_fault_transfers;
+static uint32_t           aoosp_fault_episodes;
+static uint32_t           aoosp_fault_injected[AOOSP_FAULT_KINDS];
+static aoosp_fault_acc_t  aoosp_fault_acc[AOOSP_FAULT_RECS];
+static uint8_t            aoosp_fault_pending;        // recovery kinds (bits) not yet recorded in the episode
+static uint8_t            aoosp_fault_open;           // an episode is open (no good response since its first injection)
+static uint32_t           aoosp_fault_onsetcycles;    // aoosp_cycles() of the first injection of the episode
+static uint32_t           aoosp_fault_onsettransfer;  // transfer number of the first injection of the episode
+
+
+static const char * const aoosp_fault_kind_names[AOOSP_FAULT_KINDS] = { "none", "txcrc", "rxcrc", "drop", "statflip", "break" };
+static const char * const aoosp_fault_rec_names[AOOSP_FAULT_RECS]   = { "response", "retry", "reinit", "resetinit" };
+
+
+/*!
+    @brief  Adds a rule to the fault schedule.
+    @param  rule
+            The rule (copied); see aoosp_fault_rule_t.
+    @return aoresult_ok, aoresult_outargnull, or aoresult_osp_arg for an
+            unknown kind or when the schedule is full.
+    @note   Rules are tried in the order they were added; the first one
+            that matches a transfer and is due injects.
+*/
+aoresult_t aoosp_fault_rule_add(const aoosp_fault_rule_t * rule) {
+  if( rule==0 ) return aoresult_outargnull;
+  if( rule->kind<1 || rule->kind>=AOOSP_FAULT_KINDS ) return aoresult_osp_arg;
+  if( aoosp_fault_rulenum==AOOSP_FAULT_RULES ) return aoresult_osp_arg;
+  aoosp_fault_rules[aoosp_fault_rulenum] = *rule;
+  aoosp_fault_matched[aoosp_fault_rulenum] = 0;
+  aoosp_fault_done[aoosp_fault_rulenum] = 0;
+  aoosp_fault_rulenum++;
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Removes all rules from the fault schedule.
+*/
+void aoosp_fault_rules_clear() {
+  aoosp_fault_rulenum = 0;
+}
+
+
+/*!
+    @brief  Starts injecting faults per the schedule.
+    @note   Resets the transfer counter (rule start), the per rule counts
+            and the statistics.
+*/
+void aoosp_fault_arm() {
+  aoosp_fault_armed = 0;
+  aoosp_fault_transfers = 0;
+  aoosp_fault_episodes = 0;
+  memset( aoosp_fault_matched, 0, sizeof aoosp_fault_matched );
+  memset( aoosp_fault_done, 0, sizeof aoosp_fault_done );
+  memset( aoosp_fault_injected, 0, sizeof aoosp_fault_injected );
+  memset( aoosp_fault_acc, 0, sizeof aoosp_fault_acc );
+  aoosp_fault_pending = 0;
+  aoosp_fault_open = 0;
+  aoosp_fault_armed = 1;
+}
+
+
+/*!
+    @brief  Stops injecting faults; rules and statistics are kept.
+*/
+void aoosp_fault_disarm() {
+  aoosp_fault_armed = 0;
+}
+
+
+// Records recovery kind `rec` for the current episode (once per episode)
+static void aoosp_fault_record(int rec) {
+  if( !(aoosp_fault_pending & (1<<rec)) ) return;
+  aoosp_fault_pending &= ~(1<<rec);
+  uint32_t us = (aoosp_cycles()-aoosp_fault_onsetcycles) / aoosp_cycles_per_us();
+  aoosp_fault_acc_t * acc = &aoosp_fault_acc[rec];
+  if( acc->count==0 || us<acc->minus ) acc->minus = us;
+  if( acc->count==0 || us>acc->maxus ) acc->maxus = us;
+  acc->count++;
+  acc->sumus += us;
+  acc->sumtransfers += aoosp_fault_transfers - aoosp_fault_onsettransfer;
+}
+
+
+/*!
+    @brief  Reports that recovery logic succeeded.
+    @param  rec
+            The kind of recovery: AOOSP_FAULT_REC_RETRY or
+            AOOSP_FAULT_REC_REINIT (the others are recorded automatically,
+            but may be reported too).
+    @note   Records the time since the first injection of the current
+            episode; has no effect when there was no injection since the
+            last report of this kind.
+*/
+void aoosp_fault_recovered(int rec) {
+  if( rec<0 || rec>=AOOSP_FAULT_RECS ) return;
+  aoosp_fault_record(rec);
+}
+
+
+/*!
+    @brief  Gets the fault injection statistics.
+    @param  stat
+            Receives transfers, episodes, injections per kind, and the time
+            to recover per recovery kind.
+*/
+void aoosp_fault_stat_get(aoosp_fault_stat_t * stat) {
+  if( stat==0 ) return;
+  stat->transfers = aoosp_fault_transfers;
+  stat->episodes  = aoosp_fault_episodes;
+  memcpy( stat->injected, aoosp_fault_injected, sizeof stat->injected );
+  for( int rec=0; rec<AOOSP_FAULT_RECS; rec++ ) {
+    const aoosp_fault_acc_t * acc = &aoosp_fault_acc[rec];
+    stat->ttr[rec].count     = acc->count;
+    stat->ttr[rec].minus     = acc->minus;
+    stat->ttr[rec].maxus     = acc->maxus;
+    stat->ttr[rec].meanus    = acc->count ? (uint32_t)(acc->sumus/acc->count) : 0;
+    stat->ttr[rec].transfers = acc->count ? (uint32_t)(acc->sumtransfers/acc->count) : 0;
+  }
+}
+
+
+/*!
+    @brief  Returns the name of a fault kind.
+    @param  kind
+            AOOSP_FAULT_xxx.
+    @return Name, e.g. "drop"; "?" for an unknown kind.
+*/
+const char * aoosp_fault_kind_str(int kind) {
+  if( kind<0 || kind>=AOOSP_FAULT_KINDS ) return "?";
+  return aoosp_fault_kind_names[kind];
+}
+
+
+/*!
+    @brief  Returns the name of a recovery kind.
+    @param  rec
+            AOOSP_FAULT_REC_xxx.
+    @return Name, e.g. "resetinit"; "?" for an unknown kind.
+*/
+const char * aoosp_fault_rec_str(int rec) {
+  if( rec<0 || rec>=AOOSP_FAULT_RECS ) return "?";
+  return aoosp_fault_rec_names[rec];
+}
+
+
+// === INJECTION ==========================================
+
+
+// Returns the index of the rule that injects into the transfer with `tid` to `addr`, or -1
+static int aoosp_fault_due(uint8_t tid, uint16_t addr) {
+  for( int ix=0; ix<aoosp_fault_rulenum; ix++ ) {
+    const aoosp_fault_rule_t * rule = &aoosp_fault_rules[ix];
+    if( aoosp_fault_transfers < rule->start ) continue;
+    if( rule->count!=0 && aoosp_fault_done[ix]>=rule->count ) continue;
+    if( rule->tid!=AOOSP_FAULT_ANYTID && rule->tid!=tid ) continue;
+    if( rule->kind!=AOOSP_FAULT_BREAK && rule->addr!=AOOSP_FAULT_ANYADDR && rule->addr!=addr ) continue;
+    uint32_t period = rule->period ? rule->period : 1;
+    if( aoosp_fault_matched[ix]++ % period != 0 ) continue;
+    return ix;
+  }
+  return -1;
+}
+
+
+// Counts an injection by rule `ix`, and opens an episode if none is open
+static void aoosp_fault_inject(int ix) {
+  aoosp_fault_done[ix]++;
+  aoosp_fault_injected[aoosp_fault_rules[ix].kind]++;
+  if( aoosp_fault_open ) return;
+  aoosp_fault_open = 1;
+  aoosp_fault_pending = (1<<AOOSP_FAULT_RECS)-1;
+  aoosp_fault_onsetcycles = aoosp_cycles();
+  aoosp_fault_onsettransfer = aoosp_fault_transfers;
+  aoosp_fault_episodes++;
+}
+
+
+/*!
+    @brief  Transfers a telegram, injecting faults per the schedule.
+    @param  tx
+            The telegram.
+    @param  txsize
+            Size of the telegram.
+    @param  rx
+            Buffer for the response, or 0 for telegrams without response.
+    @param  rxsize
+            Size of the response.
+    @return Result of aospi, or the result the fault causes (e.g.
+            aoresult_spi_noclock for a dropped response).
+    @note   Called by aoosp_send for every transfer (AOOSP_FAULT_ENABLED);
+            when not armed it is aospi_tx or aospi_txrx.
+*/
+aoresult_t aoosp_fault_spi(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize) {
+  if( !aoosp_fault_armed ) return rx ? aospi_txrx(tx,txsize,rx,rxsize) : aospi_tx(tx,txsize);
+
+  uint16_t addr = (tx[0]&0x0F)<<6 | tx[1]>>2;
+  uint8_t  tid  = tx[2]&0x7F;
+  int      ix   = aoosp_fault_due(tid, addr);
+  int      kind = ix<0 ? 0 : aoosp_fault_rules[ix].kind;
+  aoresult_t result;
+  aoosp_fault_transfers++;
+
+  if( kind==AOOSP_FAULT_TXCRC ) {
+    uint8_t buf[12];
+    int     size = txsize<(int)sizeof buf ? txsize : (int)sizeof buf;
+    memcpy( buf, tx, size );
+    buf[size-1] ^= 0xFF;
+    result = rx ? aospi_txrx(buf,size,rx,rxsize) : aospi_tx(buf,size);
+    aoosp_fault_inject(ix);
+    return result;
+  }
+
+  if( kind==AOOSP_FAULT_BREAK ) {
+    uint16_t brk   = aoosp_fault_rules[ix].addr;
+    int      multi = addr==0x000 || addr>=0x3F0 || tid==AOOSP_TID_INITBIDIR || tid==AOOSP_TID_INITLOOP; // broadcast, group or INIT
+    if( !multi && addr>=brk ) { // does not reach its node
+      aoosp_fault_inject(ix);
+      return rx ? aoresult_spi_noclock : aoresult_ok;
+    }
+    result = rx ? aospi_txrx(tx,txsize,rx,rxsize) : aospi_tx(tx,txsize);
+    if( rx && (multi || aospi_dirmux_is_loop()) ) { // response would pass the break
+      aoosp_fault_inject(ix);
+      return aoresult_spi_noclock;
+    }
+    kind = 0; // reached a node before the break, and came back
+  } else {
+    result = rx ? aospi_txrx(tx,txsize,rx,rxsize) : aospi_tx(tx,txsize);
+  }
+
+  if( rx && result==aoresult_ok ) {
+    if( kind==AOOSP_FAULT_DROP ) {
+      aoosp_fault_inject(ix);
+      return aoresult_spi_noclock;
+    }
+    if( kind==AOOSP_FAULT_RXCRC ) {
+      rx[rxsize-1] ^= 0xFF;
+      aoosp_fault_inject(ix);
+      return result;
+    }
+    if( kind==AOOSP_FAULT_STATFLIP && rxsize>=5 ) { // the status is the last payload byte (READSTAT, READTEMPSTAT, SR)
+      rx[rxsize-2] ^= aoosp_fault_rules[ix].mask;
+      rx[rxsize-1] = aoosp_crc(rx, rxsize-1);
+      aoosp_fault_inject(ix);
+      return result;
+    }
+    // A good response ends the episode
+    if( aoosp_fault_open ) {
+      aoosp_fault_record(AOOSP_FAULT_REC_RESPONSE);
+      aoosp_fault_open = 0;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,112 @@
+// aoosp_fault.h - fault injection between aoosp_send and aospi, with time-to-recover statistics
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_FAULT_H_
+#define _AOOSP_FAULT_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// When set to 1, aoosp_send transfers via the injection layer (about 0.5 kB RAM); 0 (default) transfers with aospi directly. May also be set with -DAOOSP_FAULT_ENABLED=1
+#ifndef AOOSP_FAULT_ENABLED
+  #define AOOSP_FAULT_ENABLED 0
+#endif
+
+
+// Maximum number of rules in the schedule
+#define AOOSP_FAULT_RULES       8
+
+
+// Fault kinds
+#define AOOSP_FAULT_TXCRC       1 // CRC of the telegram corrupted (nodes drop it and flag CE)
+#define AOOSP_FAULT_RXCRC       2 // CRC of the response corrupted (destruct fails with osp_crc)
+#define AOOSP_FAULT_DROP        3 // response dropped (spi_noclock); the telegram is executed
+#define AOOSP_FAULT_STATFLIP    4 // status byte of the response XORed with `mask` (CRC fixed, so it passes)
+#define AOOSP_FAULT_BREAK       5 // chain broken before node `addr`: telegrams to it and beyond are lost, responses in Loop too
+#define AOOSP_FAULT_KINDS       6 // kinds are 1..5
+
+
+// Filters of a rule
+#define AOOSP_FAULT_ANYTID      0xFF
+#define AOOSP_FAULT_ANYADDR     0xFFFF
+
+
+// One rule of the schedule; transfers are counted from aoosp_fault_arm() (the first is 0)
+typedef struct aoosp_fault_rule_s {
+  uint8_t  kind;          // AOOSP_FAULT_xxx
+  uint8_t  tid;           // Only telegrams with this TID (SR bit included), or AOOSP_FAULT_ANYTID
+  uint16_t addr;          // Only telegrams to this address, or AOOSP_FAULT_ANYADDR; for BREAK the first unreachable node
+  uint8_t  mask;          // Status bits to flip (STATFLIP)
+  uint32_t start;         // First transfer the rule applies to
+  uint32_t count;         // Number of injections, 0 for no limit
+  uint32_t period;        // Inject in every period-th matching transfer (0 or 1 for every one)
+} aoosp_fault_rule_t;
+
+
+// Recovery kinds of the time-to-recover statistics
+#define AOOSP_FAULT_REC_RESPONSE  0 // first good response after the fault (recorded by the layer)
+#define AOOSP_FAULT_REC_RETRY     1 // retry logic succeeded (reported with aoosp_fault_recovered)
+#define AOOSP_FAULT_REC_REINIT    2 // partial re-init succeeded (reported with aoosp_fault_recovered)
+#define AOOSP_FAULT_REC_RESETINIT 3 // aoosp_exec_resetinit() succeeded (recorded by aoosp_exec)
+#define AOOSP_FAULT_RECS          4
+
+
+// Time-to-recover statistics of one recovery kind; times from the first injection of an episode, in us
+typedef struct aoosp_fault_ttr_s {
+  uint32_t count;         // Recoveries
+  uint32_t minus;         // Shortest time to recover
+  uint32_t maxus;         // Longest time to recover
+  uint32_t meanus;        // Mean time to recover
+  uint32_t transfers;     // Mean number of transfers from the first injection up to the recovery
+} aoosp_fault_ttr_t;
+
+
+// Statistics since aoosp_fault_arm()
+typedef struct aoosp_fault_stat_s {
+  uint32_t          transfers;                 // Transfers seen
+  uint32_t          episodes;                  // Fault episodes (first injection up to the next good response)
+  uint32_t          injected[AOOSP_FAULT_KINDS]; // Injections per kind
+  aoosp_fault_ttr_t ttr[AOOSP_FAULT_RECS];     // Time to recover per recovery kind
+} aoosp_fault_stat_t;
+
+
+// Adds a rule to the schedule (the first matching rule of a transfer injects).
+aoresult_t   aoosp_fault_rule_add(const aoosp_fault_rule_t * rule);
+// Removes all rules.
+void         aoosp_fault_rules_clear();
+// Resets transfer counter and statistics, and starts injecting.
+void         aoosp_fault_arm();
+// Stops injecting (rules and statistics are kept).
+void         aoosp_fault_disarm();
+// Reports that recovery logic of kind `rec` (AOOSP_FAULT_REC_xxx) succeeded; records its time to recover.
+void         aoosp_fault_recovered(int rec);
+// Gets the statistics.
+void         aoosp_fault_stat_get(aoosp_fault_stat_t * stat);
+// Returns the name of fault kind `kind` ("txcrc", "drop", ...).
+const char * aoosp_fault_kind_str(int kind);
+// Returns the name of recovery kind `rec` ("response", "retry", "reinit", "resetinit").
+const char * aoosp_fault_rec_str(int rec);
+// Transfers a telegram via aospi, injecting faults per the schedule (called by aoosp_send).
+aoresult_t   aoosp_fault_spi(const uint8_t * tx, int txsize, uint8_t * rx, int rxsize);
+
+
+#endif
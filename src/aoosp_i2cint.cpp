@@ -0,0 +1,239 @@
+// aoosp_i2cint.cpp - dispatches edges on the INT line of I2C bridges (adaptive polling)
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>       // micros
+#include <string.h>        // memset
+#include <aoosp_send.h>    // aoosp_send_readi2ccfg
+#include <aoosp_exec.h>    // aoosp_exec_i2cenable_get
+#include <aoosp_i2cint.h>  // own API
+
+
+// INT dispatcher
+// ==============
+// A SAID with I2C bridge has an INT input pin; its level is visible as flag
+// AOOSP_I2CCFG_FLAGS_INT in the I2C configuration (READI2CCFG). There is no
+// way for a SAID to signal the MCU, so the MCU must poll. Polling one SAID 
+// in a tight loop (as in the aoosp_i2c example) wastes bus time and does not 
+// scale to many SAIDs.
+//
+// This module tracks the INT line of a set of bridges. Each bridge has its 
+// own poll period. When an edge is detected the period drops to the minimum
+// AOOSP_I2CINT_PERIOD_MIN_US (activity is expected to continue, e.g. a button 
+// press is followed by a release). Every poll without an edge doubles the 
+// period, up to AOOSP_I2CINT_PERIOD_MAX_US. Idle bridges thus cost little bus 
+// time, while active bridges are tracked with low latency.
+//
+// The application calls aoosp_i2cint_poll(budgetus) once per frame with
+// the bus time it can spare for diagnostics. Due bridges are polled, most
+// overdue first, until the budget is spent. Bridges that did not fit remain 
+// due and are served first in the next call.
+//
+// The detection latency of an edge is not known exactly: the edge happened
+// somewhere between the previous poll and the current poll. The dispatcher
+// reports the upper bound: the time between those two polls.
+//
+// A bridge whose poll fails (e.g. an unplugged board) is treated as a poll
+// without edge: it backs off, the error is counted, and the dispatcher
+// continues with the next bridge. A dead bridge thus ends up at the slowest
+// period, and does not starve the others.
+
+
+// Administration of one bridge
+typedef struct aoosp_i2cint_bridge_s {
+  uint16_t          addr;     // OSP address of the SAID with the I2C bridge
+  int8_t            level;    // Last seen level of INT (0 or 1), -1 for unknown (not yet polled)
+  uint32_t          lastus;   // Time of last poll
+  uint32_t          periodus; // Current poll period
+  aoosp_i2cint_cb_t cb;       // Callback for edges (may be NULL)
+} aoosp_i2cint_bridge_t;
+
+
+static aoosp_i2cint_bridge_t aoosp_i2cint_bridges[AOOSP_I2CINT_MAXBRIDGES];
+static int                   aoosp_i2cint_count;
+static aoosp_i2cint_stats_t  aoosp_i2cint_stats;
+static uint32_t              aoosp_i2cint_polltimeus = 100; // Estimate of the bus time of one poll (updated with measurements)
+
+
+/*!
+    @brief  Removes all bridges from the dispatcher and clears the statistics.
+*/
+void aoosp_i2cint_clear() {
+  aoosp_i2cint_count = 0;
+  aoosp_i2cint_stats_reset();
+}
+
+
+/*!
+    @brief  Adds the I2C bridge in the SAID with address `addr` to the 
+            dispatcher.
+    @param  addr
+            The address of the SAID (unicast).
+    @param  cb
+            The function called when an edge is detected on the INT line
+            of this SAID (may be NULL).
+    @return aoresult_ok        if all ok,
+            aoresult_osp_addr  if addr is not unicast,
+            aoresult_osp_arg   if there are already AOOSP_I2CINT_MAXBRIDGES bridges.
+    @note   The caller must ensure addr is a SAID with an I2C bridge;
+            see aoosp_i2cint_scan() for a version that checks.
+    @note   Adding an already added addr replaces its callback.
+    @note   The bridge is due immediately; the first poll establishes the
+            level of INT and does not trigger the callback.
+*/
+aoresult_t aoosp_i2cint_add(uint16_t addr, aoosp_i2cint_cb_t cb) {
+  if( !AOOSP_ADDR_ISUNICAST(addr) ) return aoresult_osp_addr;
+  // Already present?
+  for( int i=0; i<aoosp_i2cint_count; i++ ) {
+    if( aoosp_i2cint_bridges[i].addr==addr ) { aoosp_i2cint_bridges[i].cb= cb; return aoresult_ok; }
+  }
+  if( aoosp_i2cint_count==AOOSP_I2CINT_MAXBRIDGES ) return aoresult_osp_arg;
+  aoosp_i2cint_bridge_t * b = &aoosp_i2cint_bridges[aoosp_i2cint_count++];
+  b->addr     = addr;
+  b->level    = -1;
+  b->periodus = AOOSP_I2CINT_PERIOD_MIN_US;
+  b->lastus   = micros() - b->periodus; // due now
+  b->cb       = cb;
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Adds all SAIDs with an I2C bridge, with addresses 1 up to 
+            and including `last`, to the dispatcher.
+    @param  last
+            The address of the last node in the chain, 
+            e.g. from aoosp_exec_resetinit().
+    @param  cb
+            The function called when an edge is detected on the INT line
+            of any of the added SAIDs (may be NULL).
+    @param  count
+            Optional output parameter returning the number of bridges added.
+    @return aoresult_ok if all ok, otherwise an error code.
+    @note   Sends an IDENTIFY to every node, and a READOTP to every SAID.
+            So this is a (slow) one time setup function.
+    @note   Does not power the I2C bus, see aoosp_exec_i2cpower().
+*/
+aoresult_t aoosp_i2cint_scan(uint16_t last, aoosp_i2cint_cb_t cb, int * count) {
+  aoresult_t result;
+  if( count ) *count= 0;
+  for( uint16_t addr=AOOSP_ADDR_UNICASTMIN; addr<=last && addr<=AOOSP_ADDR_UNICASTMAX; addr++ ) {
+    uint32_t id;
+    result= aoosp_send_identify(addr,&id);
+    if( result!=aoresult_ok ) return result;
+    if( !AOOSP_IDENTIFY_IS_SAID(id) ) continue;
+    int enable;
+    result= aoosp_exec_i2cenable_get(addr,&enable);
+    if( result!=aoresult_ok ) return result;
+    if( !enable ) continue;
+    result= aoosp_i2cint_add(addr,cb);
+    if( result!=aoresult_ok ) return result;
+    if( count ) (*count)++;
+  }
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Polls the INT line of the bridges that are due, most overdue
+            first, and calls their callback when an edge is detected.
+    @param  budgetus
+            The bus time (in us) that may be spent in this call.
+    @return aoresult_ok if all ok, otherwise the first error code (of 
+            READI2CCFG); the other due bridges are still polled.
+    @note   Intended to be called once per frame, with the time left in 
+            the frame for diagnostics as budget.
+    @note   A poll is only started when it is expected to fit in the 
+            remaining budget; the expectation is based on measured 
+            poll times.
+    @note   The callbacks are called from within this function; their
+            execution time counts against the budget.
+*/
+aoresult_t aoosp_i2cint_poll(uint32_t budgetus) {
+  aoresult_t firstresult = aoresult_ok;
+  uint32_t   startus = micros();
+  while( 1 ) {
+    uint32_t nowus = micros();
+    if( nowus-startus+aoosp_i2cint_polltimeus > budgetus ) break; // next poll would not fit
+    // Find most overdue bridge
+    aoosp_i2cint_bridge_t * due = 0;
+    int32_t                 dueus = 0;
+    for( int i=0; i<aoosp_i2cint_count; i++ ) {
+      aoosp_i2cint_bridge_t * b = &aoosp_i2cint_bridges[i];
+      int32_t overdueus = (int32_t)(nowus - b->lastus - b->periodus);
+      if( overdueus>=dueus ) { due= b; dueus= overdueus; }
+    }
+    if( due==0 ) break; // nothing due
+    // Poll it
+    uint8_t flags, speed;
+    aoresult_t result= aoosp_send_readi2ccfg(due->addr,&flags,&speed);
+    uint32_t endus = micros();
+    aoosp_i2cint_stats.polls++;
+    aoosp_i2cint_stats.busyus += endus-nowus;
+    if( result!=aoresult_ok ) {
+      // Failed poll (time not representative for polltimeus): back off, keep level, try the next bridge
+      aoosp_i2cint_stats.errors++;
+      if( firstresult==aoresult_ok ) firstresult= result;
+      due->lastus = endus;
+      due->periodus *= 2;
+      if( due->periodus>AOOSP_I2CINT_PERIOD_MAX_US ) due->periodus= AOOSP_I2CINT_PERIOD_MAX_US;
+      continue;
+    }
+    aoosp_i2cint_polltimeus = endus-nowus;
+    int level = (flags & AOOSP_I2CCFG_FLAGS_INT) != 0;
+    uint32_t latencyus = endus - due->lastus;
+    due->lastus = endus;
+    if( due->level>=0 && level!=due->level ) {
+      // Edge: track statistics, poll fast, and dispatch
+      aoosp_i2cint_stats.edges++;
+      aoosp_i2cint_stats.latencysumus += latencyus;
+      if( latencyus>aoosp_i2cint_stats.latencymaxus ) aoosp_i2cint_stats.latencymaxus= latencyus;
+      due->periodus = AOOSP_I2CINT_PERIOD_MIN_US;
+      due->level = level;
+      if( due->cb ) due->cb(due->addr,level,latencyus);
+    } else {
+      // No edge: back off
+      due->periodus *= 2;
+      if( due->periodus>AOOSP_I2CINT_PERIOD_MAX_US ) due->periodus= AOOSP_I2CINT_PERIOD_MAX_US;
+      due->level = level;
+    }
+  }
+  return firstresult;
+}
+
+
+/*!
+    @brief  Gets the statistics of the dispatcher.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+    @note   The average detection latency is latencysumus/edges.
+*/
+void aoosp_i2cint_stats_get(aoosp_i2cint_stats_t * stats) {
+  if( stats ) *stats = aoosp_i2cint_stats;
+}
+
+
+/*!
+    @brief  Resets the statistics of the dispatcher (not the bridges).
+*/
+void aoosp_i2cint_stats_reset() {
+  memset( &aoosp_i2cint_stats, 0, sizeof aoosp_i2cint_stats );
+}
@@ -0,0 +1,66 @@
+// aoosp_i2cint.h - dispatches edges on the INT line of I2C bridges (adaptive polling)
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_I2CINT_H_
+#define _AOOSP_I2CINT_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Max number of I2C bridges (SAIDs) tracked by the dispatcher
+#define AOOSP_I2CINT_MAXBRIDGES     16
+// Poll period of a bridge with a recent edge (fastest)
+#define AOOSP_I2CINT_PERIOD_MIN_US  2000
+// Poll period of a bridge without recent edges (slowest)
+#define AOOSP_I2CINT_PERIOD_MAX_US  64000
+
+
+// Signature of the callback called on an edge of the INT line of `addr`; `latencyus` is the upper bound of the detection latency.
+typedef void (*aoosp_i2cint_cb_t)(uint16_t addr, int level, uint32_t latencyus);
+
+
+// Statistics of the dispatcher (see aoosp_i2cint_stats_get)
+typedef struct aoosp_i2cint_stats_s {
+  uint32_t polls;           // Number of READI2CCFG telegrams sent
+  uint32_t edges;           // Number of edges detected (and callbacks invoked)
+  uint32_t errors;          // Number of failed polls (the bridge backs off)
+  uint32_t busyus;          // Total bus time spent on polling
+  uint32_t latencymaxus;    // Worst detection latency (time between the last poll before and the poll at the edge)
+  uint32_t latencysumus;    // Sum of all detection latencies (divide by edges for average)
+} aoosp_i2cint_stats_t;
+
+
+// Removes all bridges from the dispatcher and clears the statistics.
+void       aoosp_i2cint_clear();
+// Adds the I2C bridge in SAID `addr` to the dispatcher; `cb` is called on edges of its INT line.
+aoresult_t aoosp_i2cint_add(uint16_t addr, aoosp_i2cint_cb_t cb);
+// Adds all SAIDs with I2C bridge in the chain (1..last) to the dispatcher.
+aoresult_t aoosp_i2cint_scan(uint16_t last, aoosp_i2cint_cb_t cb, int * count=0);
+// Polls the INT line of the bridges that are due, but spends at most `budgetus` of bus time.
+aoresult_t aoosp_i2cint_poll(uint32_t budgetus);
+// Gets the statistics, including the achieved detection latency.
+void       aoosp_i2cint_stats_get(aoosp_i2cint_stats_t * stats);
+// Resets the statistics.
+void       aoosp_i2cint_stats_reset();
+
+
+#endif
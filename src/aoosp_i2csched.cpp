@@ -0,0 +1,286 @@
+// aoosp_i2csched.cpp - schedules periodic sensor reads over I2C bridges
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>         // micros
+#include <string.h>          // memset
+#include <aoosp_send.h>      // aoosp_send_i2cread8, aoosp_send_readi2ccfg, aoosp_send_readlast
+#include <aoosp_i2csched.h>  // own API
+
+
+// Scheduler
+// =========
+// Sensors (ambient light, temperature) behind I2C bridges are read at fixed
+// rates. Each periodic read is a task with a period and a (relative) deadline.
+// A task is released every period; the sample must be delivered before
+// release+deadline, otherwise it counts as missed.
+//
+// An I2C read is three telegrams: I2CREAD (starts the I2C transaction),
+// READI2CCFG (polls for completion) and READLAST (gets the bytes). The I2C
+// transaction itself runs on the SAID, and takes far longer than the 
+// telegrams (about 1ms at 100kHz for 8 bytes). A naive loop waits for every 
+// transaction. This scheduler instead issues an I2CREAD on every bridge that 
+// has a due task, and only then starts polling and collecting. So the I2C 
+// transactions on different bridges overlap with each other, and with the 
+// OSP telegrams. A bridge runs only one transaction at a time, so tasks on 
+// the same bridge are serialized.
+//
+// The application calls aoosp_i2csched_run(budgetus) once per frame. Due tasks 
+// are issued in deadline order (earliest deadline first). Transactions that 
+// are not completed when the budget is spent stay in flight, and are 
+// collected in the next call. Samples are time stamped with the issue time,
+// and delivered into a ring buffer; see aoosp_i2csched_get().
+//
+// A transaction still BUSY at its deadline is delivered as I2C timeout, but
+// the bridge is still working on it. Such a bridge stays blocked (no new
+// I2CREAD) until a READI2CCFG at the start of a later run shows BUSY clear.
+
+
+// Administration of one task
+typedef struct aoosp_i2csched_task_s {
+  uint16_t               addr;       // OSP address of the SAID with the I2C bridge
+  uint8_t                daddr7;     // I2C device address
+  uint8_t                raddr;      // I2C register address
+  uint8_t                count;      // Number of bytes to read (1..8)
+  uint8_t                inflight;   // I2CREAD is issued, but not yet collected
+  uint8_t                timedout;   // Delivered as timeout while the bridge was still BUSY
+  uint32_t               periodus;   // Period
+  uint32_t               deadlineus; // Deadline (relative to release)
+  uint32_t               releaseus;  // Release time of the current (or next) job
+  uint32_t               issueus;    // Time the in flight I2CREAD was issued
+  aoosp_i2csched_stats_t stats;      // Statistics (overruns not used per task)
+} aoosp_i2csched_task_t;
+
+
+static aoosp_i2csched_task_t   aoosp_i2csched_tasks[AOOSP_I2CSCHED_MAXTASKS];
+static int                     aoosp_i2csched_numtasks;
+static aoosp_i2csched_sample_t aoosp_i2csched_ring[AOOSP_I2CSCHED_RINGSIZE];
+static int                     aoosp_i2csched_ringhead; // Index of the oldest sample
+static int                     aoosp_i2csched_ringsize; // Number of samples in the ring
+static uint32_t                aoosp_i2csched_overruns;
+
+
+/*!
+    @brief  Removes all tasks, flushes the ring buffer and clears the statistics.
+*/
+void aoosp_i2csched_clear() {
+  aoosp_i2csched_numtasks = 0;
+  aoosp_i2csched_ringhead = 0;
+  aoosp_i2csched_ringsize = 0;
+  aoosp_i2csched_overruns = 0;
+}
+
+
+/*!
+    @brief  Registers a periodic read ("task") of `count` bytes, from register 
+            `raddr` of I2C device `daddr7`, attached to SAID `addr`.
+    @param  addr
+            The address of the SAID with the I2C bridge (unicast).
+    @param  daddr7
+            The 7 bits I2C device address.
+    @param  raddr
+            The 8 bits register address.
+    @param  count
+            The number of bytes to read (1..8).
+    @param  periodus
+            The period of the read (e.g. 100000 for 10Hz).
+    @param  deadlineus
+            The time after release within which the sample must be 
+            delivered (typically at most periodus).
+    @param  task
+            Optional output parameter returning the task id; 
+            it is also stored in every sample.
+    @return aoresult_ok if all ok, aoresult_osp_addr or aoresult_osp_arg 
+            for illegal arguments, aoresult_osp_arg if there are already 
+            AOOSP_I2CSCHED_MAXTASKS tasks.
+    @note   The first release is immediate.
+    @note   See aoosp_exec_i2cpower() for powering the I2C bus.
+*/
+aoresult_t aoosp_i2csched_add(uint16_t addr, uint8_t daddr7, uint8_t raddr, uint8_t count, uint32_t periodus, uint32_t deadlineus, int * task) {
+  if( !AOOSP_ADDR_ISUNICAST(addr) ) return aoresult_osp_addr;
+  if( daddr7>127 || count<1 || count>8 || periodus==0 || deadlineus==0 ) return aoresult_osp_arg;
+  if( aoosp_i2csched_numtasks==AOOSP_I2CSCHED_MAXTASKS ) return aoresult_osp_arg;
+  aoosp_i2csched_task_t * t = &aoosp_i2csched_tasks[aoosp_i2csched_numtasks];
+  memset( t, 0, sizeof *t );
+  t->addr       = addr;
+  t->daddr7     = daddr7;
+  t->raddr      = raddr;
+  t->count      = count;
+  t->periodus   = periodus;
+  t->deadlineus = deadlineus;
+  t->releaseus  = micros();
+  if( task ) *task = aoosp_i2csched_numtasks;
+  aoosp_i2csched_numtasks++;
+  return aoresult_ok;
+}
+
+
+// Appends a sample to the ring buffer (dropping the oldest when full)
+static aoosp_i2csched_sample_t * aoosp_i2csched_ring_put() {
+  if( aoosp_i2csched_ringsize==AOOSP_I2CSCHED_RINGSIZE ) {
+    aoosp_i2csched_ringhead = (aoosp_i2csched_ringhead+1) % AOOSP_I2CSCHED_RINGSIZE;
+    aoosp_i2csched_ringsize--;
+    aoosp_i2csched_overruns++;
+  }
+  int ix = (aoosp_i2csched_ringhead+aoosp_i2csched_ringsize) % AOOSP_I2CSCHED_RINGSIZE;
+  aoosp_i2csched_ringsize++;
+  return &aoosp_i2csched_ring[ix];
+}
+
+
+// Delivers the sample of task `t` (with result `result`, data in `buf`), and advances the release
+static void aoosp_i2csched_deliver(aoosp_i2csched_task_t * t, aoresult_t result, const uint8_t * buf) {
+  uint32_t nowus = micros();
+  aoosp_i2csched_sample_t * s = aoosp_i2csched_ring_put();
+  s->timeus = t->issueus;
+  s->task   = t - aoosp_i2csched_tasks;
+  s->count  = t->count;
+  s->result = result;
+  if( buf ) memcpy( s->data, buf, t->count );
+  t->inflight = 0;
+  t->stats.samples++;
+  if( result!=aoresult_ok ) t->stats.errors++;
+  if( nowus - t->releaseus > t->deadlineus ) t->stats.missed++;
+  // Next release; releases that already passed are skipped (and missed)
+  t->releaseus += t->periodus;
+  while( (int32_t)(nowus - t->releaseus) >= (int32_t)t->periodus ) {
+    t->releaseus += t->periodus;
+    t->stats.missed++;
+  }
+}
+
+
+// Returns 1 iff a transaction is in flight (or timed out and not yet seen ended) on the bridge of SAID addr
+static int aoosp_i2csched_bridgebusy(uint16_t addr) {
+  for( int i=0; i<aoosp_i2csched_numtasks; i++ ) {
+    aoosp_i2csched_task_t * t = &aoosp_i2csched_tasks[i];
+    if( (t->inflight || t->timedout) && t->addr==addr ) return 1;
+  }
+  return 0;
+}
+
+
+/*!
+    @brief  Issues the reads that are due, and collects the reads that are
+            completed, spending at most `budgetus`.
+    @param  budgetus
+            The time (in us) that may be spent in this call.
+    @return aoresult_ok if all ok, otherwise an error code of a telegram
+            (an I2C NACK or timeout is not an error of this function;
+            it is reported as result in the sample).
+    @note   Intended to be called once per frame.
+    @note   Order of work: first recheck bridges with a timed out 
+            transaction, then issue I2CREAD on all free bridges with 
+            due tasks (earliest deadline first), then poll and collect in
+            flight transactions until all are collected or budget is spent.
+    @note   A bridge that keeps BUSY set (e.g. a hung I2C bus) gets no new
+            I2CREAD; its tasks are counted as missed once it recovers.
+*/
+aoresult_t aoosp_i2csched_run(uint32_t budgetus) {
+  aoresult_t result;
+  uint32_t   startus = micros();
+
+  // Recheck: a bridge with a timed out transaction is free once BUSY is clear
+  for( int i=0; i<aoosp_i2csched_numtasks && micros()-startus < budgetus; i++ ) {
+    aoosp_i2csched_task_t * t = &aoosp_i2csched_tasks[i];
+    if( !t->timedout ) continue;
+    uint8_t flags, speed;
+    result = aoosp_send_readi2ccfg(t->addr,&flags,&speed);
+    if( result!=aoresult_ok ) return result;
+    if( !(flags & AOOSP_I2CCFG_FLAGS_BUSY) ) t->timedout = 0;
+  }
+
+  // Issue: earliest deadline first, at most one transaction per bridge
+  while( micros()-startus < budgetus ) {
+    uint32_t nowus = micros();
+    aoosp_i2csched_task_t * best = 0;
+    for( int i=0; i<aoosp_i2csched_numtasks; i++ ) {
+      aoosp_i2csched_task_t * t = &aoosp_i2csched_tasks[i];
+      if( t->inflight || (int32_t)(nowus - t->releaseus) < 0 ) continue; // busy or not yet released
+      if( best && (int32_t)(t->releaseus+t->deadlineus - best->releaseus-best->deadlineus) >= 0 ) continue; // later deadline
+      if( aoosp_i2csched_bridgebusy(t->addr) ) continue;
+      best = t;
+    }
+    if( best==0 ) break;
+    result = aoosp_send_i2cread8(best->addr,best->daddr7,best->raddr,best->count);
+    if( result!=aoresult_ok ) return result;
+    best->inflight = 1;
+    best->issueus = micros();
+  }
+
+  // Collect: poll all in flight transactions, until none left or budget spent
+  int inflight = 1;
+  while( inflight && micros()-startus < budgetus ) {
+    inflight = 0;
+    for( int i=0; i<aoosp_i2csched_numtasks && micros()-startus < budgetus; i++ ) {
+      aoosp_i2csched_task_t * t = &aoosp_i2csched_tasks[i];
+      if( !t->inflight ) continue;
+      uint8_t flags, speed;
+      result = aoosp_send_readi2ccfg(t->addr,&flags,&speed);
+      if( result!=aoresult_ok ) return result;
+      if( flags & AOOSP_I2CCFG_FLAGS_BUSY ) {
+        if( micros()-t->issueus > t->deadlineus ) { aoosp_i2csched_deliver(t,aoresult_dev_i2ctimeout,0); t->timedout = 1; }
+        else inflight = 1;
+        continue;
+      }
+      if( flags & AOOSP_I2CCFG_FLAGS_NACK ) { aoosp_i2csched_deliver(t,aoresult_dev_i2cnack,0); continue; }
+      uint8_t buf[8];
+      result = aoosp_send_readlast(t->addr,buf,t->count);
+      if( result!=aoresult_ok ) return result;
+      aoosp_i2csched_deliver(t,aoresult_ok,buf);
+    }
+  }
+
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Gets the oldest sample from the ring buffer (and removes it).
+    @param  sample
+            Output parameter receiving the sample.
+    @return 1 if a sample was returned, 0 if the ring buffer is empty.
+*/
+int aoosp_i2csched_get(aoosp_i2csched_sample_t * sample) {
+  if( sample==0 || aoosp_i2csched_ringsize==0 ) return 0;
+  *sample = aoosp_i2csched_ring[aoosp_i2csched_ringhead];
+  aoosp_i2csched_ringhead = (aoosp_i2csched_ringhead+1) % AOOSP_I2CSCHED_RINGSIZE;
+  aoosp_i2csched_ringsize--;
+  return 1;
+}
+
+
+/*!
+    @brief  Gets the statistics of a task.
+    @param  task
+            The id of the task, as returned by aoosp_i2csched_add().
+    @param  stats
+            Output parameter receiving the statistics.
+    @return aoresult_ok if all ok, aoresult_osp_arg for an unknown task.
+    @note   The `overruns` field is for the ring buffer, so shared by all tasks.
+*/
+aoresult_t aoosp_i2csched_stats_get(int task, aoosp_i2csched_stats_t * stats) {
+  if( stats==0 ) return aoresult_outargnull;
+  if( task<0 || task>=aoosp_i2csched_numtasks ) return aoresult_osp_arg;
+  *stats = aoosp_i2csched_tasks[task].stats;
+  stats->overruns = aoosp_i2csched_overruns;
+  return aoresult_ok;
+}
@@ -0,0 +1,66 @@
+// aoosp_i2csched.h - schedules periodic sensor reads over I2C bridges
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_I2CSCHED_H_
+#define _AOOSP_I2CSCHED_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Max number of periodic reads (tasks) that can be registered
+#define AOOSP_I2CSCHED_MAXTASKS   32
+// Number of samples the ring buffer can hold (oldest are dropped on overflow)
+#define AOOSP_I2CSCHED_RINGSIZE   64
+
+
+// One sample delivered by the scheduler
+typedef struct aoosp_i2csched_sample_s {
+  uint32_t   timeus;   // Time (micros) the I2C read was issued
+  uint8_t    task;     // The task (id from aoosp_i2csched_add) that produced this sample
+  uint8_t    count;    // Number of bytes in data
+  uint8_t    data[8];  // The bytes read from the I2C device
+  aoresult_t result;   // aoresult_ok, or the error of the read (data then invalid)
+} aoosp_i2csched_sample_t;
+
+
+// Statistics per task (see aoosp_i2csched_stats_get)
+typedef struct aoosp_i2csched_stats_s {
+  uint32_t samples;    // Number of samples delivered (including those with an error)
+  uint32_t missed;     // Number of releases whose sample was not delivered before the deadline (or skipped)
+  uint32_t errors;     // Number of samples with an error result
+  uint32_t overruns;   // Number of samples dropped because the ring buffer was full (all tasks)
+} aoosp_i2csched_stats_t;
+
+
+// Removes all tasks, flushes the ring buffer and clears the statistics.
+void       aoosp_i2csched_clear();
+// Registers a periodic read of `count` bytes of register `raddr` of I2C device `daddr7` at SAID `addr`.
+aoresult_t aoosp_i2csched_add(uint16_t addr, uint8_t daddr7, uint8_t raddr, uint8_t count, uint32_t periodus, uint32_t deadlineus, int * task=0);
+// Issues and collects the reads that are due, spending at most `budgetus`.
+aoresult_t aoosp_i2csched_run(uint32_t budgetus);
+// Gets the oldest sample from the ring buffer, returns 0 if the ring buffer is empty.
+int        aoosp_i2csched_get(aoosp_i2csched_sample_t * sample);
+// Gets the statistics of task `task`.
+aoresult_t aoosp_i2csched_stats_get(int task, aoosp_i2csched_stats_t * stats);
+
+
+#endif
@@ -0,0 +1,181 @@
+// aoosp_linkstat.cpp - communication error statistics per node and per hop
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>         // memset
+#include <aoosp_linkstat.h> // own API
+
+
+// Link statistics
+// ===============
+// A degrading connector first shows up as sporadic CRC failures in responses,
+// as CE (communication error) flags in the status of nodes, and as missing
+// responses. This module aggregates those per node, and estimates per hop.
+//
+// The send path (aoosp_send, every telegram with a response) only increments
+// raw 16 bit counters (aoosp_linkstat_count and aoosp_linkstat_count_ce,
+// inline). The application periodically calls aoosp_linkstat_update(); it
+// folds the counters into exponentially decayed rates and clears them.
+// The counters must not overflow between updates (65535 telegrams per node).
+//
+// A telegram to node n, and its response, travel over hops 1..n (BiDir),
+// so when hop k has error rate p_k, the transport error rate (decode plus
+// timeout) seen at node n is about p_1+...+p_n. The rate of hop n is thus
+// estimated as the increase of that rate compared to the nearest preceding
+// node with traffic. The CE flag is raised by a node that received a bad
+// telegram, so the CE rate of node n is attributed to hop n directly.
+// In Loop mode the response also crosses the hops after n; the estimate
+// then blames the first hop where errors appear, which is usually right.
+
+
+aoosp_linkstat_count_t  aoosp_linkstat_counts[AOOSP_LINKSTAT_NODES];
+static float            aoosp_linkstat_tele   [AOOSP_LINKSTAT_NODES]; // decayed counts
+static float            aoosp_linkstat_decode [AOOSP_LINKSTAT_NODES];
+static float            aoosp_linkstat_timeout[AOOSP_LINKSTAT_NODES];
+static float            aoosp_linkstat_ce     [AOOSP_LINKSTAT_NODES];
+static uint32_t         aoosp_linkstat_errors [AOOSP_LINKSTAT_NODES];
+
+
+/*!
+    @brief  Folds the raw counters (incremented by aoosp_send) into the
+            decayed rates, and clears the raw counters.
+    @note   Call periodically, e.g. once per second; the decay is per call
+            (see AOOSP_LINKSTAT_DECAY).
+*/
+void aoosp_linkstat_update() {
+  const float a = 1.0f / (1<<AOOSP_LINKSTAT_DECAY);
+  for( int n=0; n<AOOSP_LINKSTAT_NODES; n++ ) {
+    aoosp_linkstat_count_t * c = &aoosp_linkstat_counts[n];
+    if( c->tele==0 && aoosp_linkstat_tele[n]==0 ) continue; // never used
+    aoosp_linkstat_tele   [n] += (c->tele    - aoosp_linkstat_tele   [n]) * a;
+    aoosp_linkstat_decode [n] += (c->decode  - aoosp_linkstat_decode [n]) * a;
+    aoosp_linkstat_timeout[n] += (c->timeout - aoosp_linkstat_timeout[n]) * a;
+    aoosp_linkstat_ce     [n] += (c->ce      - aoosp_linkstat_ce     [n]) * a;
+    aoosp_linkstat_errors [n] += c->decode + c->timeout + c->ce;
+    memset( c, 0, sizeof *c );
+  }
+}
+
+
+/*!
+    @brief  Clears all counters and rates.
+*/
+void aoosp_linkstat_reset() {
+  memset( aoosp_linkstat_counts , 0, sizeof aoosp_linkstat_counts  );
+  memset( aoosp_linkstat_tele   , 0, sizeof aoosp_linkstat_tele    );
+  memset( aoosp_linkstat_decode , 0, sizeof aoosp_linkstat_decode  );
+  memset( aoosp_linkstat_timeout, 0, sizeof aoosp_linkstat_timeout );
+  memset( aoosp_linkstat_ce     , 0, sizeof aoosp_linkstat_ce      );
+  memset( aoosp_linkstat_errors , 0, sizeof aoosp_linkstat_errors  );
+}
+
+
+/*!
+    @brief  Gets the (decayed) error rates of a node.
+    @param  addr
+            The address of the node.
+    @param  stat
+            Output parameter receiving the rates; the rates are fractions
+            of the telegrams sent to the node (0 when no telegrams).
+    @return aoresult_ok if all ok, otherwise an error code.
+*/
+aoresult_t aoosp_linkstat_get(uint16_t addr, aoosp_linkstat_t * stat) {
+  if( stat==0 ) return aoresult_outargnull;
+  if( addr>=AOOSP_LINKSTAT_NODES ) return aoresult_osp_addr;
+  float tele = aoosp_linkstat_tele[addr];
+  stat->tele    = tele;
+  stat->decode  = tele>0 ? aoosp_linkstat_decode [addr]/tele : 0;
+  stat->timeout = tele>0 ? aoosp_linkstat_timeout[addr]/tele : 0;
+  stat->ce      = tele>0 ? aoosp_linkstat_ce     [addr]/tele : 0;
+  stat->errors  = aoosp_linkstat_errors[addr];
+  return aoresult_ok;
+}
+
+
+// Returns the transport error rate (decode plus timeout) of node `n`, or -1 if it has no traffic.
+static float aoosp_linkstat_transport(uint16_t n) {
+  float tele = aoosp_linkstat_tele[n];
+  if( tele<=0 ) return -1;
+  return (aoosp_linkstat_decode[n] + aoosp_linkstat_timeout[n]) / tele;
+}
+
+
+// Returns the hop rate of node `n`, given its transport rate `here` (>=0) and that of the nearest preceding node with traffic `prev`.
+static float aoosp_linkstat_hoprate(uint16_t n, float here, float prev) {
+  float rate = here>prev ? here-prev : 0;
+  return rate + aoosp_linkstat_ce[n]/aoosp_linkstat_tele[n];
+}
+
+
+/*!
+    @brief  Estimates the error rate of the hop into a node.
+    @param  addr
+            The address of the node; the hop is the link from node addr-1
+            (or from the MCU for node 001) to node addr.
+    @return Estimated fraction of telegrams corrupted on this hop
+            (0 when there is no traffic to the node).
+    @note   Increase of the transport error rate compared to the nearest
+            preceding node with traffic, plus the CE rate of the node.
+*/
+float aoosp_linkstat_hop(uint16_t addr) {
+  if( addr>=AOOSP_LINKSTAT_NODES ) return 0;
+  float here = aoosp_linkstat_transport(addr);
+  if( here<0 ) return 0;
+  float prev = 0;
+  for( int n=addr-1; n>0; n-- ) {
+    float r = aoosp_linkstat_transport(n);
+    if( r>=0 ) { prev=r; break; }
+  }
+  return aoosp_linkstat_hoprate(addr,here,prev);
+}
+
+
+/*!
+    @brief  Finds the hops with the highest estimated error rate.
+    @param  addrs
+            Output array receiving the node addresses of the hops (see
+            aoosp_linkstat_hop()), worst first.
+    @param  rates
+            Output array receiving the estimated error rates.
+    @param  size
+            The size of the output arrays.
+    @return The number of hops written (only hops with a rate above 0).
+*/
+int aoosp_linkstat_worst(uint16_t * addrs, float * rates, int size) {
+  if( addrs==0 || rates==0 ) return 0;
+  int   count = 0;
+  float prev  = 0;
+  for( uint16_t n=1; n<AOOSP_LINKSTAT_NODES; n++ ) {
+    float here = aoosp_linkstat_transport(n);
+    if( here<0 ) continue;
+    float rate = aoosp_linkstat_hoprate(n,here,prev);
+    prev = here;
+    if( rate<=0 ) continue;
+    // Insertion in sorted (descending) list of at most size entries
+    int i = count<size ? count++ : size;
+    while( i>0 && rates[i-1]<rate ) {
+      if( i<size ) { rates[i]=rates[i-1]; addrs[i]=addrs[i-1]; }
+      i--;
+    }
+    if( i<size ) { rates[i]=rate; addrs[i]=n; }
+  }
+  return count;
+}
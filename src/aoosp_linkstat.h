@@ -0,0 +1,85 @@
+// aoosp_linkstat.h - communication error statistics per node and per hop
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_LINKSTAT_H_
+#define _AOOSP_LINKSTAT_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// When set to 1, aoosp_send counts communication errors per node and hop (about 28 kB RAM); 0 (default) compiles that out. May also be set with -DAOOSP_LINKSTAT_ENABLED=1
+#ifndef AOOSP_LINKSTAT_ENABLED
+  #define AOOSP_LINKSTAT_ENABLED 0
+#endif
+
+
+// Number of nodes with statistics (addresses 000..AOOSP_LINKSTAT_NODES-1)
+#define AOOSP_LINKSTAT_NODES    1008
+// Decay of the rates per aoosp_linkstat_update(): new = old + (count-old)/2^AOOSP_LINKSTAT_DECAY
+#define AOOSP_LINKSTAT_DECAY    4
+
+
+// Raw counters of one node, incremented in the send path, consumed by aoosp_linkstat_update()
+typedef struct aoosp_linkstat_count_s {
+  uint16_t tele;        // Telegrams with response sent to node
+  uint16_t decode;      // Responses failing destruct (crc, size, psi, preamble, tid)
+  uint16_t timeout;     // Responses missing (SPI error)
+  uint16_t ce;          // Responses with AOOSP_STAT_FLAGS_CE set
+} aoosp_linkstat_count_t;
+extern aoosp_linkstat_count_t aoosp_linkstat_counts[AOOSP_LINKSTAT_NODES];
+
+
+// Error rates of one node (errors per telegram, exponentially decayed)
+typedef struct aoosp_linkstat_s {
+  float    tele;        // Telegrams per update (decayed)
+  float    decode;      // Fraction of responses failing destruct
+  float    timeout;     // Fraction of responses missing
+  float    ce;          // Fraction of responses with the CE flag
+  uint32_t errors;      // Total errors (decode, timeout and ce) since reset
+} aoosp_linkstat_t;
+
+
+// Counts a telegram to `addr` and its outcome (called by aoosp_send; only increments).
+static inline void aoosp_linkstat_count(uint16_t addr, aoresult_t spi_result, aoresult_t des_result) {
+  if( addr>=AOOSP_LINKSTAT_NODES ) return;
+  aoosp_linkstat_counts[addr].tele++;
+  if( spi_result!=aoresult_ok ) aoosp_linkstat_counts[addr].timeout++;
+  else if( des_result!=aoresult_ok && des_result!=aoresult_outargnull ) aoosp_linkstat_counts[addr].decode++;
+}
+// Counts a response of `addr` with the CE flag (bit 3) in `stat` set (called by aoosp_send; only increments).
+static inline void aoosp_linkstat_count_ce(uint16_t addr, uint8_t stat) {
+  if( addr<AOOSP_LINKSTAT_NODES && (stat & 0x08) ) aoosp_linkstat_counts[addr].ce++;
+}
+
+// Folds the raw counters into the decayed rates; call periodically (e.g. every second).
+void       aoosp_linkstat_update();
+// Clears counters and rates.
+void       aoosp_linkstat_reset();
+// Gets the rates of node `addr`.
+aoresult_t aoosp_linkstat_get(uint16_t addr, aoosp_linkstat_t * stat);
+// Returns the estimated error rate of the hop into node `addr` (from node addr-1, or the MCU for 001).
+float      aoosp_linkstat_hop(uint16_t addr);
+// Finds the (at most `size`) hops with the highest error rate, worst first; returns the number found.
+int        aoosp_linkstat_worst(uint16_t * addrs, float * rates, int size);
+
+
+#endif
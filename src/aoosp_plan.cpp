@@ -0,0 +1,138 @@
+// aoosp_plan.cpp - frame rate capacity planner for an OSP chain
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <aoosp_send.h>     // AOOSP_ADDR_xxx
+#include <aoosp_tmodel.h>   // aoosp_tmodel_predict_chain
+#include <aoosp_plan.h>     // own API
+
+
+// Capacity planner
+// ================
+// Before installing, the question is whether a chain can sustain a frame
+// rate (e.g. 50 or 100 fps) with the channels in use and some diagnostics.
+// The planner counts the telegrams of one frame, and sums their bus time as
+// predicted by the timing model (aoosp_tmodel) for the chain to plan. The
+// frame consists of the PWM updates (depending on the strategy), `diag`
+// status reads (READSTAT, at an average distance: half the chain), and
+// optionally a broadcast SYNC.
+//
+// The strategies show the gains for a sample workload. With `dirty` only
+// the changed channels are sent. With `groups` all nodes of a group show
+// the same color, so one telegram per group (and channel) suffices; groups
+// are assumed to contain both SAIDs and RGBIs. With `broadcast` the whole
+// chain shows the same color.
+//
+// The planner only accounts for bus time; the CPU time to compute a frame
+// is not included (see the aoosp_benchtele example to measure that).
+
+
+// Telegram sizes (bytes) and TIDs (aoosp_send.h), as made by the aoosp_con_xxx() functions in aoosp_send.cpp
+#define AOOSP_PLAN_SETPWMCHN_TX   12  // SAID: payload of 8 bytes
+#define AOOSP_PLAN_SETPWM_TX      10  // RGBI: payload of 6 bytes
+#define AOOSP_PLAN_SETPWM_TID     AOOSP_TID_SETPWM
+#define AOOSP_PLAN_READSTAT_TX    4
+#define AOOSP_PLAN_READSTAT_RX    5
+#define AOOSP_PLAN_READSTAT_TID   AOOSP_TID_READSTAT
+#define AOOSP_PLAN_SYNC_TX        4
+#define AOOSP_PLAN_SYNC_TID       AOOSP_TID_SYNC
+
+
+static const char * aoosp_plan_strategy_names[AOOSP_PLAN_STRATEGY_COUNT] = { "all", "dirty", "groups", "broadcast" };
+
+
+/*!
+    @brief  Returns the name of a strategy.
+    @param  strategy
+            The strategy.
+    @return "all", "dirty", "groups", "broadcast", or "unknown".
+*/
+const char * aoosp_plan_strategy_str(aoosp_plan_strategy_t strategy) {
+  if( (unsigned)strategy>=AOOSP_PLAN_STRATEGY_COUNT ) return "unknown";
+  return aoosp_plan_strategy_names[strategy];
+}
+
+
+// Number of items (out of n) that change when pct percent change, rounded up
+static uint32_t aoosp_plan_part(uint32_t n, int pct) {
+  return ( n*pct + 99 ) / 100;
+}
+
+
+/*!
+    @brief  Plans one frame.
+    @param  chain
+            The chain and its workload.
+    @param  strategy
+            How the PWM updates of a frame are sent.
+    @param  param
+            For aoosp_plan_strategy_dirty the percentage (0..100) of
+            channels that change per frame, for aoosp_plan_strategy_groups
+            the number of groups (1..15); ignored otherwise.
+    @param  fps
+            The target frame rate for usage and headroom.
+    @param  plan
+            Output parameter receiving the plan.
+    @param  model
+            The timing model; 0 for the current one (aoosp_tmodel_get).
+    @return aoresult_ok, or aoresult_outargnull, or aoresult_osp_arg when
+            the chain or param is out of range.
+    @note   The chain is at most AOOSP_ADDR_UNICASTMAX nodes.
+*/
+aoresult_t aoosp_plan_frame(const aoosp_plan_chain_t * chain, aoosp_plan_strategy_t strategy, int param, float fps, aoosp_plan_t * plan, const aoosp_tmodel_t * model) {
+  if( chain==0 || plan==0 ) return aoresult_outargnull;
+  uint32_t nodes = chain->saids + chain->rgbis;
+  if( nodes==0 || nodes>AOOSP_ADDR_UNICASTMAX ) return aoresult_osp_arg;
+  if( chain->saids>0 && (chain->chans<1 || chain->chans>3) ) return aoresult_osp_arg;
+  if( (unsigned)strategy>=AOOSP_PLAN_STRATEGY_COUNT ) return aoresult_osp_arg;
+  if( strategy==aoosp_plan_strategy_dirty && (param<0 || param>100) ) return aoresult_osp_arg;
+  if( strategy==aoosp_plan_strategy_groups && (param<1 || param>AOOSP_ADDR_GROUP14-AOOSP_ADDR_GROUP0+1) ) return aoresult_osp_arg;
+  aoosp_tmodel_t current;
+  if( model==0 ) { aoosp_tmodel_get(&current); model = &current; }
+
+  // Count the PWM telegrams per node type
+  uint32_t chn = chain->saids ? chain->chans : 0; // SETPWMCHN per SAID "unit"
+  uint32_t rgb = chain->rgbis ? 1 : 0;            // SETPWM per RGBI "unit"
+  uint32_t nchn, nrgb;
+  switch( strategy ) {
+    case aoosp_plan_strategy_dirty     : nchn = aoosp_plan_part(chain->saids*chn,param); nrgb = aoosp_plan_part(chain->rgbis,param); break;
+    case aoosp_plan_strategy_groups    : nchn = param*chn;                               nrgb = param*rgb;                           break;
+    case aoosp_plan_strategy_broadcast : nchn = chn;                                     nrgb = rgb;                                 break;
+    default                            : nchn = chain->saids*chn;                        nrgb = chain->rgbis;                        break;
+  }
+
+  // Predict bus time (PWM telegrams have no response, so their address does not matter)
+  uint16_t last = nodes;
+  uint16_t mid  = (nodes+1)/2;
+  uint64_t ns = 0;
+  ns+= (uint64_t)nchn * aoosp_tmodel_predict_chain(model, last, chain->loop, AOOSP_PLAN_SETPWM_TID, 1, AOOSP_PLAN_SETPWMCHN_TX, 0);
+  ns+= (uint64_t)nrgb * aoosp_tmodel_predict_chain(model, last, chain->loop, AOOSP_PLAN_SETPWM_TID, 1, AOOSP_PLAN_SETPWM_TX, 0);
+  ns+= (uint64_t)chain->diag * aoosp_tmodel_predict_chain(model, last, chain->loop, AOOSP_PLAN_READSTAT_TID, mid, AOOSP_PLAN_READSTAT_TX, AOOSP_PLAN_READSTAT_RX);
+  if( chain->sync ) ns+= aoosp_tmodel_predict_chain(model, last, chain->loop, AOOSP_PLAN_SYNC_TID, AOOSP_ADDR_BROADCAST, AOOSP_PLAN_SYNC_TX, 0);
+
+  plan->telegrams = nchn + nrgb + chain->diag + (chain->sync?1:0);
+  plan->bytes     = nchn*AOOSP_PLAN_SETPWMCHN_TX + nrgb*AOOSP_PLAN_SETPWM_TX + chain->diag*(AOOSP_PLAN_READSTAT_TX+AOOSP_PLAN_READSTAT_RX) + (chain->sync?AOOSP_PLAN_SYNC_TX:0);
+  plan->framens   = ns>UINT32_MAX ? UINT32_MAX : ns;
+  plan->fpsmax    = ns ? 1e9f/ns : 0;
+  plan->usage     = ns*fps/1e9f;
+  plan->headroom  = 1-plan->usage;
+  return aoresult_ok;
+}
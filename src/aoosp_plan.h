@@ -0,0 +1,68 @@
+// aoosp_plan.h - frame rate capacity planner for an OSP chain
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_PLAN_H_
+#define _AOOSP_PLAN_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+#include <aoosp_tmodel.h>
+
+
+// Description of a chain and its per frame workload
+typedef struct aoosp_plan_chain_s {
+  uint16_t saids;        // Number of SAIDs (each updated with SETPWMCHN per channel)
+  uint16_t rgbis;        // Number of RGBIs (each updated with SETPWM)
+  uint8_t  chans;        // Channels in use per SAID (1..3)
+  uint8_t  diag;         // Diagnostics budget: status reads (READSTAT) per frame
+  uint8_t  sync;         // 1 when each frame is latched with a broadcast SYNC
+  uint8_t  loop;         // 1 for Loop, 0 for BiDir
+} aoosp_plan_chain_t;
+
+
+// How the frame is sent
+typedef enum aoosp_plan_strategy_e {
+  aoosp_plan_strategy_all,        // Every channel of every node, every frame
+  aoosp_plan_strategy_dirty,      // Only the channels that changed (param: percentage that changes per frame)
+  aoosp_plan_strategy_groups,     // One telegram per group and channel (param: number of groups, 1..15)
+  aoosp_plan_strategy_broadcast,  // One telegram per channel for the whole chain
+} aoosp_plan_strategy_t;
+#define AOOSP_PLAN_STRATEGY_COUNT 4
+
+
+// Result of planning one frame
+typedef struct aoosp_plan_s {
+  uint32_t telegrams;    // Telegrams per frame
+  uint32_t bytes;        // Bytes on the bus per frame (telegrams and responses)
+  uint32_t framens;      // Predicted bus time per frame
+  float    fpsmax;       // Achievable frame rate (bus time only)
+  float    usage;        // Bus utilization at the target frame rate (above 1 is not sustainable)
+  float    headroom;     // 1-usage: fraction of the bus time left at the target frame rate
+} aoosp_plan_t;
+
+
+// Returns the name of a strategy, e.g. "dirty".
+const char * aoosp_plan_strategy_str(aoosp_plan_strategy_t strategy);
+// Plans one frame of `chain` sent with `strategy` (`param` see aoosp_plan_strategy_t) at `fps`, using `model` (0 for the current one).
+aoresult_t   aoosp_plan_frame(const aoosp_plan_chain_t * chain, aoosp_plan_strategy_t strategy, int param, float fps, aoosp_plan_t * plan, const aoosp_tmodel_t * model=0);
+
+
+#endif
@@ -20,8 +20,8 @@
  *****************************************************************************/
 
 
-#include <stdio.h>     // snprintf
-#include <aoosp_prt.h> // own API
+#include <aoosp_send.h> // AOOSP_TID_xxx
+#include <aoosp_prt.h>  // own API
 
 
 // Tables that map bit fields to human readable strings.
@@ -51,10 +51,40 @@ static const char * aoosp_prt_i2ccfg_flags[]      = { "itnb", "itnB", "itNb", "i
 // This means that only one such function can be used at a time.
 // For example this will not work: 
 //   printf("%s-%s", aoosp_prt_stat_rgbi(x), aoosp_prt_stat_said(x) ).
+// The _r variants (e.g. aoosp_prt_stat_rgbi_r) write into a buffer of the
+// caller instead, so they may be used several times in one printf and from
+// several tasks. The _str variants return a constant string from the tables
+// above. None of them use snprintf.
 #define AOOSP_PRT_BUF_SIZE 48
 static char aoosp_prt_buf[AOOSP_PRT_BUF_SIZE];
 
 
+// Helpers for the _r variants: each appends to buf (of size bytes) at
+// position len and returns the new len. They never write beyond buf[size-2],
+// so that aoosp_prt_end() can always terminate the string.
+static const char aoosp_prt_hex[] = "0123456789ABCDEF";
+
+static inline int aoosp_prt_put_c(char * buf, int size, int len, char c) {
+  if( len<size-1 ) buf[len++] = c;
+  return len;
+}
+
+static inline int aoosp_prt_put_s(char * buf, int size, int len, const char * s) {
+  while( *s && len<size-1 ) buf[len++] = *s++;
+  return len;
+}
+
+static inline int aoosp_prt_put_x4(char * buf, int size, int len, uint16_t val) {
+  for( int shift=12; shift>=0; shift-=4 ) len = aoosp_prt_put_c(buf, size, len, aoosp_prt_hex[(val>>shift)&0xF] );
+  return len;
+}
+
+static inline int aoosp_prt_end(char * buf, int size, int len) {
+  if( size>0 ) buf[len] = '\0';
+  return len;
+}
+
+
 
 /*!
     @brief  Converts RGBi raw temperature to Celsius.
@@ -82,6 +112,37 @@ int aoosp_prt_temp_said(uint8_t temp) {
 }
 
 
+/*!
+    @brief  Converts a node state to a constant string.
+    @param  stat
+            Status byte reported by a node.
+    @return One of uninitialized, sleep, active, deepsleep.
+            Inspects bit 7 and 6 of stat.
+            example "active".
+    @note   Reentrant; the string is a table entry (do not modify).
+*/
+const char * aoosp_prt_stat_state_str(uint8_t stat) {
+  return aoosp_prt_stat_names[BITS_SLICE(stat,6,8)];
+}
+
+
+/*!
+    @brief  Converts a node state to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  stat
+            Status byte reported by a node.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_stat_state().
+*/
+int aoosp_prt_stat_state_r(char * buf, int size, uint8_t stat) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_stat_state_str(stat) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a node state to a string.
     @param  stat
@@ -93,11 +154,38 @@ int aoosp_prt_temp_said(uint8_t temp) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_stat_state(uint8_t stat) {
-  snprintf( aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s", aoosp_prt_stat_names[BITS_SLICE(stat,6,8)] );
+  aoosp_prt_stat_state_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, stat);
   return aoosp_prt_buf;
 }
 
 
+// Status byte with the flags46 table as the only difference between RGBi and SAID.
+static int aoosp_prt_stat_r(char * buf, int size, uint8_t stat, const char * flags46[]) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_stat_names[BITS_SLICE(stat,6,8)] );
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_s(buf, size, len, flags46[BITS_SLICE(stat,4,6)] );
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_s(buf, size, len, aoosp_prt_stat_flags04[BITS_SLICE(stat,0,4)] );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
+/*!
+    @brief  Converts an RGBi status byte to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  stat
+            Status byte reported by a RGBi node.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_stat_rgbi().
+*/
+int aoosp_prt_stat_rgbi_r(char * buf, int size, uint8_t stat) {
+  return aoosp_prt_stat_r(buf, size, stat, aoosp_prt_stat_flags46_rgbi);
+}
+
+
 /*!
     @brief  Converts an RGBi status byte to a string.
     @param  stat
@@ -112,12 +200,27 @@ char * aoosp_prt_stat_state(uint8_t stat) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_stat_rgbi(uint8_t stat) {
-  snprintf( aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s-%s-%s",
-    aoosp_prt_stat_names[BITS_SLICE(stat,6,8)], aoosp_prt_stat_flags46_rgbi[BITS_SLICE(stat,4,6)], aoosp_prt_stat_flags04[BITS_SLICE(stat,0,4)] );
+  aoosp_prt_stat_rgbi_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, stat);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts an SAID status byte to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  stat
+            Status byte reported by a SAID node.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_stat_said().
+*/
+int aoosp_prt_stat_said_r(char * buf, int size, uint8_t stat) {
+  return aoosp_prt_stat_r(buf, size, stat, aoosp_prt_stat_flags46_said);
+}
+
+
 /*!
     @brief  Converts an SAID status byte to a string.
     @param  stat
@@ -132,12 +235,39 @@ char * aoosp_prt_stat_rgbi(uint8_t stat) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_stat_said(uint8_t stat) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s-%s-%s",
-    aoosp_prt_stat_names[BITS_SLICE(stat,6,8)], aoosp_prt_stat_flags46_said[BITS_SLICE(stat,4,6)], aoosp_prt_stat_flags04[BITS_SLICE(stat,0,4)] );
+  aoosp_prt_stat_said_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, stat);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts a LED status byte to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  ledst
+            LED status byte reported by an OSP node.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_ledst().
+*/
+int aoosp_prt_ledst_r(char * buf, int size, uint8_t ledst) {
+  //  7  6  5  4   3  2  1  0
+  // RVS RO GO BO RVS RS GS BS (red, green blue x open short)
+  #define oO(pos) ((ledst & (1<<(pos))) ? 'O' : 'o' )
+  #define sS(pos) ((ledst & (1<<(pos))) ? 'S' : 's' )
+  int len = 0;
+  for( int pos=6; pos>=4; pos-- ) { // red, green, blue
+    if( pos<6 ) len = aoosp_prt_put_c(buf, size, len, '-');
+    len = aoosp_prt_put_c(buf, size, len, oO(pos) );
+    len = aoosp_prt_put_c(buf, size, len, sS(pos-4) );
+  }
+  #undef oO
+  #undef sS
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a LED status byte to a string.
     @param  ledst
@@ -150,16 +280,44 @@ char * aoosp_prt_stat_said(uint8_t stat) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_ledst(uint8_t ledst) {
-  //  7  6  5  4   3  2  1  0
-  // RVS RO GO BO RVS RS GS BS (red, green blue x open short)
-  #define oO(pos) ((ledst & (1<<(pos))) ? 'O' : 'o' )
-  #define sS(pos) ((ledst & (1<<(pos))) ? 'S' : 's' )
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%c%c-%c%c-%c%c",
-    /*red*/ oO(6), sS(2), /*grn*/ oO(5), sS(1), /*blu*/ oO(4), sS(0) );
+  aoosp_prt_ledst_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, ledst);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts an RGBi PWM quartet to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  red
+            The 15 bit PWM setting for the red driver.
+    @param  green
+            The 15 bit PWM setting for the green driver.
+    @param  blue
+            The 15 bit PWM setting for the blue driver.
+    @param  daytimes
+            The 3 bit flags signaling day time for red (MSB), green and blue (LSB).
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_pwm_rgbi().
+*/
+int aoosp_prt_pwm_rgbi_r(char * buf, int size, uint16_t red, uint16_t green, uint16_t blue, uint8_t daytimes) {
+  int len = aoosp_prt_put_c(buf, size, 0, aoosp_prt_hex[BITS_SLICE(daytimes,2,3)] );
+  len = aoosp_prt_put_c(buf, size, len, '.');
+  len = aoosp_prt_put_x4(buf, size, len, red);
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_c(buf, size, len, aoosp_prt_hex[BITS_SLICE(daytimes,1,2)] );
+  len = aoosp_prt_put_c(buf, size, len, '.');
+  len = aoosp_prt_put_x4(buf, size, len, green);
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_c(buf, size, len, aoosp_prt_hex[BITS_SLICE(daytimes,0,1)] );
+  len = aoosp_prt_put_c(buf, size, len, '.');
+  len = aoosp_prt_put_x4(buf, size, len, blue);
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts an RGBi PWM quartet (from READPWM) to a string.
     @param  red
@@ -182,12 +340,36 @@ char * aoosp_prt_ledst(uint8_t ledst) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_pwm_rgbi(uint16_t red, uint16_t green, uint16_t blue, uint8_t daytimes) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%X.%04X-%X.%04X-%X.%04X",
-    BITS_SLICE(daytimes,2,3), red, BITS_SLICE(daytimes,1,2), green, BITS_SLICE(daytimes,0,1), blue );
+  aoosp_prt_pwm_rgbi_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, red, green, blue, daytimes);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts an SAID PWM triplet to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  red
+            The 16 bit PWM setting for the red driver.
+    @param  green
+            The 16 bit PWM setting for the green driver.
+    @param  blue
+            The 16 bit PWM setting for the blue driver.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_pwm_said().
+*/
+int aoosp_prt_pwm_said_r(char * buf, int size, uint16_t red, uint16_t green, uint16_t blue) {
+  int len = aoosp_prt_put_x4(buf, size, 0, red);
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_x4(buf, size, len, green);
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_x4(buf, size, len, blue);
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts an SAID PWM triplet (from READPWMCHN) to a string.
     @param  red
@@ -207,11 +389,41 @@ char * aoosp_prt_pwm_rgbi(uint16_t red, uint16_t green, uint16_t blue, uint8_t d
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_pwm_said(uint16_t red, uint16_t green, uint16_t blue) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%04X-%04X-%04X", red, green, blue );
+  aoosp_prt_pwm_said_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, red, green, blue);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts a communication settings to a constant string for SIO1.
+    @param  com
+            The communication setting.
+    @return One of (for SIO1) lvds, eol, mcu, can.
+            example "lvds".
+    @note   Reentrant; the string is a table entry (do not modify).
+*/
+const char * aoosp_prt_com_sio1_str(uint8_t com) {
+  return aoosp_prt_com_names[BITS_SLICE(com,0,2)];
+}
+
+
+/*!
+    @brief  Converts a communication settings to a string for SIO1 in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  com
+            The communication setting.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_com_sio1().
+*/
+int aoosp_prt_com_sio1_r(char * buf, int size, uint8_t com) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_com_sio1_str(com) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a communication settings to a string for SIO1.
     @param  com
@@ -222,11 +434,41 @@ char * aoosp_prt_pwm_said(uint16_t red, uint16_t green, uint16_t blue) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_com_sio1(uint8_t com) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s", aoosp_prt_com_names[BITS_SLICE(com,0,2)] );
+  aoosp_prt_com_sio1_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, com);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts a communication settings to a constant string for SIO2.
+    @param  com
+            The communication setting.
+    @return One of (for SIO2) lvds, eol, mcu, can.
+            Example "lvds".
+    @note   Reentrant; the string is a table entry (do not modify).
+*/
+const char * aoosp_prt_com_sio2_str(uint8_t com) {
+  return aoosp_prt_com_names[BITS_SLICE(com,2,4)];
+}
+
+
+/*!
+    @brief  Converts a communication settings to a string for SIO2 in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  com
+            The communication setting.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_com_sio2().
+*/
+int aoosp_prt_com_sio2_r(char * buf, int size, uint8_t com) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_com_sio2_str(com) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a communication settings to a string for SIO2.
     @param  com
@@ -237,11 +479,30 @@ char * aoosp_prt_com_sio1(uint8_t com) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_com_sio2(uint8_t com) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s", aoosp_prt_com_names[BITS_SLICE(com,2,4)] );
+  aoosp_prt_com_sio2_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, com);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts an RGBi communication settings to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  com
+            The 4 bit communication setting.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_com_rgbi().
+*/
+int aoosp_prt_com_rgbi_r(char * buf, int size, uint8_t com) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_com_sio2_str(com) );
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_s(buf, size, len, aoosp_prt_com_sio1_str(com) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts an RGBi communication settings to a string.
     @param  com
@@ -255,12 +516,32 @@ char * aoosp_prt_com_sio2(uint8_t com) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_com_rgbi(uint8_t com) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s-%s",
-    aoosp_prt_com_names[BITS_SLICE(com,2,4)], aoosp_prt_com_names[BITS_SLICE(com,0,2)]  );
+  aoosp_prt_com_rgbi_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, com);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts an SAID communication settings to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  com
+            The 6 bit communication setting.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_com_said().
+*/
+int aoosp_prt_com_said_r(char * buf, int size, uint8_t com) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_com_sio2_str(com) );
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_s(buf, size, len, BITS_SLICE(com,4,5)?"loop":"bidir" );
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_s(buf, size, len, aoosp_prt_com_sio1_str(com) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts an SAID communication settings to a string.
     @param  com
@@ -275,12 +556,30 @@ char * aoosp_prt_com_rgbi(uint8_t com) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_com_said(uint8_t com) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s-%s-%s",
-    aoosp_prt_com_names[BITS_SLICE(com,2,4)], BITS_SLICE(com,4,5)?"loop":"bidir", aoosp_prt_com_names[BITS_SLICE(com,0,2)]  );
+  aoosp_prt_com_said_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, com);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts an OSP setup byte to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  flags
+            The 8 bit setup byte.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_setup().
+*/
+int aoosp_prt_setup_r(char * buf, int size, uint8_t flags) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_setup_flags48[BITS_SLICE(flags,4,8)] );
+  len = aoosp_prt_put_c(buf, size, len, '-');
+  len = aoosp_prt_put_s(buf, size, len, aoosp_prt_stat_flags04[BITS_SLICE(flags,0,4)] );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts an OSP setup byte to a string.
     @param  flags
@@ -293,12 +592,39 @@ char * aoosp_prt_com_said(uint8_t com) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_setup(uint8_t flags) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s-%s",
-    aoosp_prt_setup_flags48[BITS_SLICE(flags,4,8)], aoosp_prt_stat_flags04[BITS_SLICE(flags,0,4)]  );
+  aoosp_prt_setup_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, flags);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts a byte array (like a telegram) to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  bytes
+            A pointer to a sequence of bytes.
+    @param  count
+            Number of bytes to include in the string.
+    @return Length of the string in buf.
+    @note   Reentrant variant of aoosp_prt_bytes().
+    @note   Bytes that do not fit completely are left out;
+            a buf of 3*count chars fits all.
+*/
+int aoosp_prt_bytes_r(char * buf, int size, const void * bytes, int count) {
+  int len = 0;
+  for( int i=0; i<count; i++ ) {
+    if( len+(i>0)+2 > size-1 ) break;
+    uint8_t b = ((const uint8_t*)bytes)[i];
+    if( i>0 ) buf[len++] = ' ';
+    buf[len++] = aoosp_prt_hex[b>>4];
+    buf[len++] = aoosp_prt_hex[b&0xF];
+  }
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a byte array (like a telegram) to a string.
     @param  buf
@@ -312,18 +638,42 @@ char * aoosp_prt_setup(uint8_t flags) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_bytes(const void * buf, int size ) {
-  char * p = aoosp_prt_buf;
-  int remain = AOOSP_PRT_BUF_SIZE;
-  for( int i=0; i<size && 3*i<AOOSP_PRT_BUF_SIZE-1; i++ ) {
-    int num = snprintf(p, remain, "%02X ", ((uint8_t*)buf)[i] );
-    p+=num;
-    remain-=num;
-  }
-  if( size>0 ) *(p-1)='\0'; // overwrite last space
+  aoosp_prt_bytes_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, buf, size);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts a channel current setting to a constant string.
+    @param  flags
+            The 4 bit channel current setting.
+    @return A string consisting of flags; 1 char for 
+            Reserved, Sync enabled, Hybrid PWM, Dithering enabled
+            Example "rshd".
+    @note   Reentrant; the string is a table entry (do not modify).
+*/
+const char * aoosp_prt_curchn_str(uint8_t flags) {
+  return aoosp_prt_curchn_flags[BITS_SLICE(flags,0,4)];
+}
+
+
+/*!
+    @brief  Converts a channel current setting to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  flags
+            The 4 bit channel current setting.
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_curchn().
+*/
+int aoosp_prt_curchn_r(char * buf, int size, uint8_t flags) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_curchn_str(flags) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a channel current setting to a string.
     @param  flags
@@ -335,11 +685,42 @@ char * aoosp_prt_bytes(const void * buf, int size ) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_curchn(uint8_t flags) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s", aoosp_prt_curchn_flags[flags] );
+  aoosp_prt_curchn_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, flags);
   return aoosp_prt_buf;
 }
 
 
+/*!
+    @brief  Converts a SAID I2C configuration to a constant string.
+    @param  flags
+            The 4 bit I2C configuration .
+    @return A string consisting of flags; 1 char for 
+            Interrupt, Twelve bit addressing, Nack/ack, I2C transaction Busy
+            Example "itnb".
+    @note   Reentrant; the string is a table entry (do not modify).
+*/
+const char * aoosp_prt_i2ccfg_str(uint8_t flags) {
+  return aoosp_prt_i2ccfg_flags[BITS_SLICE(flags,0,4)];
+}
+
+
+/*!
+    @brief  Converts a SAID I2C configuration to a string in a caller buffer.
+    @param  buf
+            Buffer that receives the string.
+    @param  size
+            Size of buf in bytes (including the terminating zero).
+    @param  flags
+            The 4 bit I2C configuration .
+    @return Length of the string in buf (truncated to size-1 chars).
+    @note   Reentrant variant of aoosp_prt_i2ccfg().
+*/
+int aoosp_prt_i2ccfg_r(char * buf, int size, uint8_t flags) {
+  int len = aoosp_prt_put_s(buf, size, 0, aoosp_prt_i2ccfg_str(flags) );
+  return aoosp_prt_end(buf, size, len);
+}
+
+
 /*!
     @brief  Converts a SAID I2C configuration to a string.
     @param  flags
@@ -351,7 +732,7 @@ char * aoosp_prt_curchn(uint8_t flags) {
     @note   Only use one char* returning pretty print function at a time.
 */
 char * aoosp_prt_i2ccfg(uint8_t flags) {
-  snprintf(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, "%s", aoosp_prt_i2ccfg_flags[flags] );
+  aoosp_prt_i2ccfg_r(aoosp_prt_buf, AOOSP_PRT_BUF_SIZE, flags);
   return aoosp_prt_buf;
 }
 
@@ -383,3 +764,58 @@ char * aoosp_prt_i2ccfg(uint8_t flags) {
 int aoosp_prt_i2ccfg_speed(uint8_t speed) {
   return 19230*1000 / ((int)(speed)*8+3) / 2;
 }
+
+
+/*!
+    @brief  Converts a telegram ID to its name.
+    @param  tid
+            The 7 bit telegram ID (see AOOSP_TID_xxx in aoosp_send.h).
+    @return The name of the telegram in lower case, as in aoosp_send_xxx()
+            (example "readtempstat"), or 0 for TIDs the library does not send.
+    @note   This is the one TID to name table of the library (used by the
+            log, the trace decoder and the statistics modules).
+    @note   Reentrant; the string is constant (do not modify).
+*/
+const char * aoosp_prt_tid(uint8_t tid) {
+  switch( tid ) {
+    case AOOSP_TID_RESET        : return "reset";
+    case AOOSP_TID_CLRERROR     : return "clrerror";
+    case AOOSP_TID_INITBIDIR    : return "initbidir";
+    case AOOSP_TID_INITLOOP     : return "initloop";
+    case AOOSP_TID_GOSLEEP      : return "gosleep";
+    case AOOSP_TID_GOACTIVE     : return "goactive";
+    case AOOSP_TID_GODEEPSLEEP  : return "godeepsleep";
+    case AOOSP_TID_IDENTIFY     : return "identify";
+    case AOOSP_TID_ASKTINFO     : return "asktinfo";
+    case AOOSP_TID_READMULT     : return "readmult";
+    case AOOSP_TID_SETMULT      : return "setmult";
+    case AOOSP_TID_SYNC         : return "sync";
+    case AOOSP_TID_IDLE         : return "idle";
+    case AOOSP_TID_FOUNDRY      : return "foundry";
+    case AOOSP_TID_CUST         : return "cust";
+    case AOOSP_TID_BURN         : return "burn";
+    case AOOSP_TID_I2CREAD      : return "i2cread";
+    case AOOSP_TID_I2CWRITE     : return "i2cwrite";
+    case AOOSP_TID_READLAST     : return "readlast";
+    case AOOSP_TID_GOACTIVE_SR  : return "goactive_sr";
+    case AOOSP_TID_READSTAT     : return "readstat";
+    case AOOSP_TID_READTEMPSTAT : return "readtempstat";
+    case AOOSP_TID_READCOMST    : return "readcomst";
+    case AOOSP_TID_READLEDST    : return "readledst";
+    case AOOSP_TID_READTEMP     : return "readtemp";
+    case AOOSP_TID_READSETUP    : return "readsetup";
+    case AOOSP_TID_SETSETUP     : return "setsetup";
+    case AOOSP_TID_READPWM      : return "readpwm";
+    case AOOSP_TID_SETPWM       : return "setpwm";
+    case AOOSP_TID_READCURCHN   : return "readcurchn";
+    case AOOSP_TID_SETCURCHN    : return "setcurchn";
+    case AOOSP_TID_READI2CCFG   : return "readi2ccfg";
+    case AOOSP_TID_SETI2CCFG    : return "seti2ccfg";
+    case AOOSP_TID_READOTP      : return "readotp";
+    case AOOSP_TID_SETOTP       : return "setotp";
+    case AOOSP_TID_SETTESTDATA  : return "settestdata";
+    case AOOSP_TID_SETTESTPW    : return "settestpw";
+    case AOOSP_TID_SETTESTPW_SR : return "settestpw_sr";
+    default                     : return 0;
+  }
+}
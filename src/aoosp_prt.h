@@ -63,6 +63,33 @@ char * aoosp_prt_curchn(uint8_t flags);
 char * aoosp_prt_i2ccfg(uint8_t flags);        
 // Converts a SAID I2C bus speed to bits/second.
 int    aoosp_prt_i2ccfg_speed(uint8_t speed);   
+// Converts a telegram ID to its name (example "readtempstat"); 0 for TIDs the library does not send.
+const char * aoosp_prt_tid(uint8_t tid);
+
+
+// Reentrant variants: format into buf (size bytes, always zero terminated when
+// size>0) and return the string length. No snprintf, no shared buffer.
+int    aoosp_prt_stat_state_r(char * buf, int size, uint8_t stat);
+int    aoosp_prt_stat_rgbi_r (char * buf, int size, uint8_t stat);
+int    aoosp_prt_stat_said_r (char * buf, int size, uint8_t stat);
+int    aoosp_prt_ledst_r     (char * buf, int size, uint8_t ledst);
+int    aoosp_prt_pwm_rgbi_r  (char * buf, int size, uint16_t red, uint16_t green, uint16_t blue, uint8_t daytimes);
+int    aoosp_prt_pwm_said_r  (char * buf, int size, uint16_t red, uint16_t green, uint16_t blue);
+int    aoosp_prt_com_sio1_r  (char * buf, int size, uint8_t com);
+int    aoosp_prt_com_sio2_r  (char * buf, int size, uint8_t com);
+int    aoosp_prt_com_rgbi_r  (char * buf, int size, uint8_t com);
+int    aoosp_prt_com_said_r  (char * buf, int size, uint8_t com);
+int    aoosp_prt_setup_r     (char * buf, int size, uint8_t flags);
+int    aoosp_prt_bytes_r     (char * buf, int size, const void * bytes, int count);
+int    aoosp_prt_curchn_r    (char * buf, int size, uint8_t flags);
+int    aoosp_prt_i2ccfg_r    (char * buf, int size, uint8_t flags);
+
+// Lookup variants for fixed vocabulary fields: return a constant table string (reentrant).
+const char * aoosp_prt_stat_state_str(uint8_t stat);
+const char * aoosp_prt_com_sio1_str(uint8_t com);
+const char * aoosp_prt_com_sio2_str(uint8_t com);
+const char * aoosp_prt_curchn_str(uint8_t flags);
+const char * aoosp_prt_i2ccfg_str(uint8_t flags);
 
 
 #endif
@@ -20,11 +20,18 @@
  *****************************************************************************/
 
 
-#include <Arduino.h>    // Serial.printf
-#include <aospi.h>      // aospi_tx, aospi_txrx
-#include <aoosp_crc.h>  // aoosp_crc
-#include <aoosp_prt.h>  // aoosp_prt_bytes() for logging
-#include <aoosp_send.h> // own API
+#include <Arduino.h>        // Serial.printf
+#include <aospi.h>          // aospi_tx, aospi_txrx
+#include <aoosp_crc.h>      // aoosp_crc
+#include <aoosp_dlog.h>     // aoosp_dlog_alloc, aoosp_dlog_commit for logging
+#include <aoosp_errmap.h>   // aoosp_errmap_update
+#include <aoosp_tseries.h>  // aoosp_tseries_add
+#include <aoosp_linkstat.h> // aoosp_linkstat_count
+#include <aoosp_tidstat.h>  // aoosp_tidstat_record
+#include <aoosp_trace.h>    // aoosp_trace_record
+#include <aoosp_fault.h>    // aoosp_fault_spi
+#include <aoosp_busprof.h>  // aoosp_busprof_record
+#include <aoosp_send.h>     // own API
 
 
 // Definition of a telegram
@@ -60,6 +67,12 @@ typedef struct aoosp_tele_s { uint8_t data[AOOSP_TELE_MAXSIZE]; uint8_t size; }
 //   initloop(0x001) 
 //     [tele A0 04 03 86] -> [resp A0 09 03 00 50 63] 
 //     last=0x02=2 temp=0x00=-86 stat=0x50=SLEEP:tV:clou (-126, SLEEP:oL:clou)
+//
+// The aoosp_send_xxx() functions do not format: they fill a binary record
+// (format id, arguments and results, raw telegrams) with aoosp_send_log()
+// and hand it to aoosp_dlog_commit(). The module aoosp_dlog formats it, either
+// right away, or deferred (aoosp_dlog_deferred_set) when a low priority task
+// calls aoosp_dlog_flush(), so that logging costs the bus task only a copy.
 
 
 #ifndef AOOSP_LOG_ENABLED
@@ -82,7 +95,8 @@ static aoosp_loglevel_t aoosp_loglevel = aoosp_loglevel_none;
             aoosp_loglevel_none - Nothing is logged (default)
             aoosp_loglevel_args - Logging of sent and received telegram arguments
             aoosp_loglevel_tele - Also logs raw (sent and received) telegram bytes
-    @note   Logging means "print to Serial".
+    @note   Logging means "print to Serial", immediately or deferred
+            (see aoosp_dlog_deferred_set).
     @note   If arguments are logged, by default the SAID interpretation is shown,
             the RGBI interpretation is appended in parenthesis.
     @note   Current log level is observable via aoosp_loglevel_get().
@@ -102,9 +116,197 @@ aoosp_loglevel_t aoosp_loglevel_get() {
   return aoosp_loglevel;
 }
 
+
+// Starts the log record of an aoosp_send_xxx() with format `fmt` (resp is NULL for telegrams without response); the caller sets the arguments and commits
+static inline aoosp_dlog_rec_t * aoosp_send_log(uint8_t fmt, const aoosp_tele_t * tele, const aoosp_tele_t * resp, aoresult_t con_result, aoresult_t spi_result, aoresult_t des_result) {
+  aoosp_dlog_rec_t * rec = aoosp_dlog_alloc();
+  rec->cycles   = aoosp_cycles();
+  rec->fmt      = fmt;
+  rec->raw      = aoosp_loglevel >= aoosp_loglevel_tele;
+  rec->con      = con_result;
+  rec->spi      = spi_result;
+  rec->des      = des_result;
+  rec->bytesize = 0;
+  rec->telesize = 0;
+  rec->respsize = 0;
+  if( rec->raw && con_result==aoresult_ok ) { // otherwise tele and resp are not initialized
+    rec->telesize = tele->size<AOOSP_DLOG_TELESIZE ? tele->size : AOOSP_DLOG_TELESIZE;
+    memcpy( rec->tele, tele->data, rec->telesize );
+    rec->respsize = resp==0 ? 0 : resp->size<AOOSP_DLOG_TELESIZE ? resp->size : AOOSP_DLOG_TELESIZE;
+    if( resp ) memcpy( rec->resp, resp->data, rec->respsize );
+  }
+  return rec;
+}
+
+
+// Adds the byte array argument or result `buf` of `size` bytes to log record `rec` (truncated to AOOSP_DLOG_BYTES)
+static inline void aoosp_send_log_bytes(aoosp_dlog_rec_t * rec, const void * buf, int size) {
+  if( buf==0 || size<0 ) size = 0;
+  if( size>AOOSP_DLOG_BYTES ) size = AOOSP_DLOG_BYTES;
+  rec->bytesize = size;
+  if( size>0 ) memcpy( rec->bytes, buf, size );
+}
+
 #endif // AOOSP_LOG_ENABLED
 
 
+// === INSTRUMENTATION ====================================
+
+
+// Instrumentation
+// ===============
+// Every aoosp_send_xxx() calls aoosp_send_begin() before constructing the
+// telegram, transfers it with aoosp_send_tx() or aoosp_send_txrx() (wrappers
+// around aospi), and calls aoosp_send_end() after destructing the response.
+// These are the single points where the send path is observed; they are
+// inline, and compile to nothing (respectively to the plain aospi call)
+// when the observers are disabled (AOOSP_TIDSTAT_ENABLED, AOOSP_HOOKS_ENABLED,
+// AOOSP_TRACE_ENABLED, AOOSP_BUSPROF_ENABLED).
+// Telegrams are not sent concurrently, so the time stamps are file static.
+//
+// The hooks (see aoosp_hooks_set) are called in the wrappers: the pre-send
+// hook right before aospi, the post-receive hook right after it. The time
+// stamps passed to the post-receive hook enclose the aospi call only, so
+// they are exact even when the pre-send hook takes time (and the hook time
+// is not added to any phase of aoosp_tidstat). Keep hooks short, they run
+// on the bus task. With AOOSP_HOOKS_ENABLED every transfer is time stamped
+// (two aoosp_cycles() reads), even when no hook is set; hence the hooks are
+// compiled out by default.
+//
+// The trace recorder (aoosp_trace) is called at the same two points, after
+// the pre-send hook and before the post-receive hook, so a trace shows the
+// telegrams exactly as they went over SPI, even if a hook is in use.
+// With AOOSP_FAULT_ENABLED the transfer goes via aoosp_fault_spi, which
+// passes it to aospi unchanged unless a fault schedule is armed.
+
+
+#define AOOSP_SEND_TIMED ( AOOSP_TIDSTAT_ENABLED || AOOSP_HOOKS_ENABLED || AOOSP_TRACE_ENABLED || AOOSP_BUSPROF_ENABLED )
+
+
+#if AOOSP_TIDSTAT_ENABLED
+static uint32_t aoosp_send_c0; // cycles at start of construct
+#endif
+#if AOOSP_SEND_TIMED
+static uint32_t aoosp_send_cc; // cycles at end of construct
+static uint32_t aoosp_send_c1; // cycles at start of SPI
+static uint32_t aoosp_send_c2; // cycles at end of SPI
+#endif
+
+
+#if AOOSP_HOOKS_ENABLED
+static aoosp_hook_pretx_t  aoosp_hook_pretx;
+static aoosp_hook_postrx_t aoosp_hook_postrx;
+
+
+/*!
+    @brief  Sets the hooks called around every SPI transfer of aoosp_send_xxx().
+    @param  pretx
+            Called just before a telegram is sent, with the encoded telegram,
+            its TID and a time stamp (aoosp_cycles). May be NULL.
+    @param  postrx
+            Called just after the transfer, with the response (size 0 for
+            telegrams without response), the TID, the time stamps (aoosp_cycles)
+            of start and end of the transfer, and the SPI result. May be NULL.
+    @note   Time stamps are CPU cycles on ESP32 (CCOUNT), ns on a Linux host;
+            see aoosp_cycles_per_us().
+    @note   The hooks run on the bus task; keep them short.
+    @note   Compiled out when AOOSP_HOOKS_ENABLED is 0 (default); the
+            stub in aoosp_send.h then ignores the hooks.
+*/
+void aoosp_hooks_set(aoosp_hook_pretx_t pretx, aoosp_hook_postrx_t postrx) {
+  aoosp_hook_pretx  = pretx;
+  aoosp_hook_postrx = postrx;
+}
+
+
+/*!
+    @brief  Gets the hooks set with aoosp_hooks_set().
+    @param  pretx
+            Output parameter receiving the pre-send hook (may be NULL).
+    @param  postrx
+            Output parameter receiving the post-receive hook (may be NULL).
+    @note   Allows a module to install its own hooks temporarily, and
+            restore the ones of the application afterwards.
+*/
+void aoosp_hooks_get(aoosp_hook_pretx_t * pretx, aoosp_hook_postrx_t * postrx) {
+  if( pretx  ) *pretx  = aoosp_hook_pretx;
+  if( postrx ) *postrx = aoosp_hook_postrx;
+}
+#endif // AOOSP_HOOKS_ENABLED
+
+
+// Marks the start of an aoosp_send_xxx()
+static inline void aoosp_send_begin() {
+  #if AOOSP_TIDSTAT_ENABLED
+  aoosp_send_c0 = aoosp_cycles();
+  #endif
+}
+
+
+// Sends telegram `tele`, and receives response `resp` if not NULL (resp->size must be set)
+static inline aoresult_t aoosp_send_spi(aoosp_tele_t * tele, aoosp_tele_t * resp) {
+  #if AOOSP_SEND_TIMED
+  aoosp_send_cc = aoosp_send_c1 = aoosp_cycles();
+  #endif
+  #if AOOSP_HOOKS_ENABLED
+  if( aoosp_hook_pretx ) {
+    aoosp_hook_pretx(tele->data, tele->size, BITS_SLICE(tele->data[2],0,7), aoosp_send_cc);
+    aoosp_send_c1 = aoosp_cycles();
+  }
+  #endif
+  #if AOOSP_TRACE_ENABLED
+  aoosp_trace_record(AOOSP_TRACE_TX, tele->data, tele->size, aoresult_ok, aoosp_send_cc);
+  aoosp_send_c1 = aoosp_cycles();
+  #endif
+  #if AOOSP_FAULT_ENABLED
+  aoresult_t result = aoosp_fault_spi(tele->data,tele->size,resp?resp->data:0,resp?resp->size:0);
+  #else
+  aoresult_t result = resp ? aospi_txrx(tele->data,tele->size,resp->data,resp->size) : aospi_tx(tele->data,tele->size);
+  #endif
+  #if AOOSP_SEND_TIMED
+  aoosp_send_c2 = aoosp_cycles();
+  #endif
+  #if AOOSP_TRACE_ENABLED
+  aoosp_trace_record(AOOSP_TRACE_RX, resp?resp->data:0, resp&&result==aoresult_ok?resp->size:0, result, aoosp_send_c2);
+  #endif
+  #if AOOSP_HOOKS_ENABLED
+  if( aoosp_hook_postrx ) aoosp_hook_postrx(resp?resp->data:0, resp&&result==aoresult_ok?resp->size:0, BITS_SLICE(tele->data[2],0,7), aoosp_send_c1, aoosp_send_c2, result);
+  #endif
+  return result;
+}
+
+
+// Sends telegram `tele` (without response)
+static inline aoresult_t aoosp_send_tx(aoosp_tele_t * tele) {
+  return aoosp_send_spi(tele,0);
+}
+
+
+// Sends telegram `tele` and receives response `resp` (resp->size must be set)
+static inline aoresult_t aoosp_send_txrx(aoosp_tele_t * tele, aoosp_tele_t * resp) {
+  return aoosp_send_spi(tele,resp);
+}
+
+
+// Marks the end of an aoosp_send_xxx() that sent `tele` and received `resp` (0 if no response)
+static inline void aoosp_send_end(const aoosp_tele_t * tele, const aoosp_tele_t * resp, aoresult_t result, aoresult_t con_result, aoresult_t spi_result) {
+  #if AOOSP_TIDSTAT_ENABLED
+  uint32_t c3 = aoosp_cycles();
+  if( con_result!=aoresult_ok ) {
+    aoosp_tidstat_record(AOOSP_TIDSTAT_NOTID, 0, 0, result, c3-aoosp_send_c0, AOOSP_TIDSTAT_SKIPPED, AOOSP_TIDSTAT_SKIPPED);
+  } else {
+    uint8_t rxsize = resp && spi_result==aoresult_ok ? resp->size : 0;
+    uint32_t descycles = rxsize ? c3-aoosp_send_c2 : AOOSP_TIDSTAT_SKIPPED;
+    aoosp_tidstat_record(BITS_SLICE(tele->data[2],0,7), tele->size, rxsize, result, aoosp_send_cc-aoosp_send_c0, aoosp_send_c2-aoosp_send_c1, descycles);
+  }
+  #endif
+  #if AOOSP_BUSPROF_ENABLED
+  if( con_result==aoresult_ok ) aoosp_busprof_record(BITS_SLICE(tele->data[2],0,7), tele->size, resp ? resp->size : 0, aoosp_send_c1, aoosp_send_c2);
+  #endif
+  (void)tele; (void)resp; (void)result; (void)con_result; (void)spi_result;
+}
+
+
 // === TELEGRAMS ==========================================
 
 
@@ -167,11 +369,14 @@ aoosp_loglevel_t aoosp_loglevel_get() {
 //   if(     result==aoresult_ok ) con_result= aoosp_con_xxx(...);
 //   if( con_result!=aoresult_ok ) result=con_result;
 //
-//   if(     result==aoresult_ok ) spi_result= aospi_txrx(...);
+//   if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(...);
 //   if( spi_result!=aoresult_ok ) result= spi_result;
 //
 //   if(     result==aoresult_ok ) des_result = aoosp_des_xxx(...)
 //   if( des_result!=aoresult_ok ) result=des_result;
+//
+// The steps are enclosed by aoosp_send_begin() and aoosp_send_end(),
+// see Instrumentation.
 
 
 // ==========================================================================
@@ -185,7 +390,7 @@ static aoresult_t aoosp_con_reset(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x00; // RESET
+  const uint8_t tid = AOOSP_TID_RESET;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -223,20 +428,20 @@ aoresult_t aoosp_send_reset(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_reset(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("reset(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
-  };
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_reset,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
+  }
   #endif // AOOSP_LOG_ENABLED
 
   return result;
@@ -254,7 +459,7 @@ static aoresult_t aoosp_con_clrerror(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x01; // CLRERROR
+  const uint8_t tid = AOOSP_TID_CLRERROR;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -288,20 +493,20 @@ aoresult_t aoosp_send_clrerror(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_clrerror(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("clrerror(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
-  };
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_clrerror,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
+  }
   #endif // AOOSP_LOG_ENABLED
 
   return result;
@@ -319,7 +524,7 @@ static aoresult_t aoosp_con_initbidir(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x02; // INITBIDIR
+  const uint8_t tid = AOOSP_TID_INITBIDIR;
   if( respsize ) *respsize = 4+2; // temp, stat
 
   // Build telegram
@@ -339,12 +544,12 @@ static aoresult_t aoosp_des_initbidir(aoosp_tele_t * tele, uint16_t * last, uint
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || last==0 || temp==0 || stat==0 ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x02      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size) != 0    ) return aoresult_osp_crc;
+  if( tele==0 || last==0 || temp==0 || stat==0           ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                          ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)               ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                 ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_INITBIDIR ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size) != 0              ) return aoresult_osp_crc;
 
   // Get fields
   *last = BITS_SLICE(tele->data[0],0,4)<<6 | BITS_SLICE(tele->data[1],2,8);
@@ -386,26 +591,31 @@ aoresult_t aoosp_send_initbidir(uint16_t addr, uint16_t * last, uint8_t * temp,
   aoresult_t    des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_initbidir(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_initbidir(&resp, last, temp, stat);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Record status in error map
+  #if AOOSP_ERRMAP_ENABLED
+  if(     result==aoresult_ok ) aoosp_errmap_update(*last,*stat);
+  #endif // AOOSP_ERRMAP_ENABLED
+
+  // Record temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok ) aoosp_tseries_add(*last,*temp);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("initbidir(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" last=0x%03X=%d temp=0x%02X=%d stat=0x%02X=%s",  *last, *last,
-      *temp, aoosp_prt_temp_said(*temp), *stat, aoosp_prt_stat_said(*stat) );
-    Serial.printf(" (%d, %s)\n",  aoosp_prt_temp_rgbi(*temp), aoosp_prt_stat_rgbi(*stat) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_initbidir,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*last; rec->arg[2]=*temp; rec->arg[3]=*stat;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -424,7 +634,7 @@ static aoresult_t aoosp_con_initloop(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x03; // INITLOOP
+  const uint8_t tid = AOOSP_TID_INITLOOP;
   if( respsize ) *respsize = 4+2; // temp, stat
 
   // Build telegram
@@ -444,12 +654,12 @@ static aoresult_t aoosp_des_initloop(aoosp_tele_t * tele, uint16_t * last, uint8
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || last==0 || temp==0 || stat==0 ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x03      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size) != 0    ) return aoresult_osp_crc;
+  if( tele==0 || last==0 || temp==0 || stat==0          ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_INITLOOP ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size) != 0             ) return aoresult_osp_crc;
 
   // Get fields
   *temp = tele->data[3];
@@ -490,26 +700,31 @@ aoresult_t aoosp_send_initloop(uint16_t addr, uint16_t * last, uint8_t * temp, u
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_initloop(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_initloop(&resp, last, temp, stat);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Record status in error map
+  #if AOOSP_ERRMAP_ENABLED
+  if(     result==aoresult_ok ) aoosp_errmap_update(*last,*stat);
+  #endif // AOOSP_ERRMAP_ENABLED
+
+  // Record temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok ) aoosp_tseries_add(*last,*temp);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("initloop(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" last=0x%03X=%d temp=0x%02X=%d stat=0x%02X=%s",  *last, *last,
-      *temp, aoosp_prt_temp_said(*temp), *stat, aoosp_prt_stat_said(*stat) );
-    Serial.printf(" (%d, %s)\n",  aoosp_prt_temp_rgbi(*temp), aoosp_prt_stat_rgbi(*stat) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_initloop,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*last; rec->arg[2]=*temp; rec->arg[3]=*stat;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -528,7 +743,7 @@ static aoresult_t aoosp_con_gosleep(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x04; // GOSLEEP
+  const uint8_t tid = AOOSP_TID_GOSLEEP;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -562,19 +777,19 @@ aoresult_t aoosp_send_gosleep(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_gosleep(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("gosleep(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_gosleep,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -593,7 +808,7 @@ static aoresult_t aoosp_con_goactive(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x05; // GOACTIVE
+  const uint8_t tid = AOOSP_TID_GOACTIVE;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -627,19 +842,19 @@ aoresult_t aoosp_send_goactive(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_goactive(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("goactive(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_goactive,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -658,7 +873,7 @@ static aoresult_t aoosp_con_godeepsleep(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x06; // GODEEPSLEEP
+  const uint8_t tid = AOOSP_TID_GODEEPSLEEP;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -692,19 +907,19 @@ aoresult_t aoosp_send_godeepsleep(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_godeepsleep(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("godeepsleep(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_godeepsleep,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -723,7 +938,7 @@ static aoresult_t aoosp_con_identify(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x07; // IDENTIFY
+  const uint8_t tid = AOOSP_TID_IDENTIFY;
   if( respsize ) *respsize = 4+4; // id
 
   // Build telegram
@@ -743,12 +958,12 @@ static aoresult_t aoosp_des_identify(aoosp_tele_t * tele, uint32_t * id) {
   // Set constants
   const uint8_t payloadsize = 4;
   // Check telegram consistency
-  if( tele==0 || id==0                         ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x07      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || id==0                                  ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_IDENTIFY ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0               ) return aoresult_osp_crc;
 
   // Get fields
   *id = (uint32_t)(tele->data[3])<<24 | (uint32_t)(tele->data[4])<<16 | (uint32_t)(tele->data[5])<<8 | (uint32_t)(tele->data[6]);
@@ -781,24 +996,26 @@ aoresult_t aoosp_send_identify(uint16_t addr, uint32_t * id) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_identify(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_identify(&resp, id);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("identify(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" id=0x%08lX\n",*id);
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_identify,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*id;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -820,7 +1037,7 @@ static aoresult_t aoosp_con_asktinfo(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x0A; // ASKTINFO
+  const uint8_t tid = AOOSP_TID_ASKTINFO;
   if( respsize ) *respsize = 4+2; //  tmin, tmax
 
   // Build telegram
@@ -840,12 +1057,12 @@ static aoresult_t aoosp_des_asktinfo(aoosp_tele_t * tele, uint8_t * tmin, uint8_
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || tmin==0 || tmax==0            ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x0A      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || tmin==0 || tmax==0                     ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_ASKTINFO ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0               ) return aoresult_osp_crc;
 
   // Get fields
   *tmax= tele->data[3];
@@ -888,25 +1105,31 @@ aoresult_t aoosp_send_asktinfo(uint16_t addr, uint8_t * tmin, uint8_t * tmax) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_asktinfo(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_asktinfo(&resp, tmin, tmax);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
+
+  // Record chain max temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok && addr==AOOSP_ADDR_UNICASTMIN ) aoosp_tseries_add(0,*tmax);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("asktinfo(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" tmin=0x%02X=%d tmax=0x%02X=%d", *tmin, aoosp_prt_temp_said(*tmin), *tmax, aoosp_prt_temp_said(*tmax) );
-    Serial.printf(" (%d, %d)\n", aoosp_prt_temp_rgbi(*tmin), aoosp_prt_temp_rgbi(*tmax) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_asktinfo,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*tmin; rec->arg[2]=*tmax;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -925,7 +1148,7 @@ static aoresult_t aoosp_con_asktinfo_init(aoosp_tele_t * tele, uint16_t addr, ui
 
   // Set constants
   const uint8_t payloadsize = 2; // initial tmin and tmax
-  const uint8_t tid = 0x0A; // ASKTINFO
+  const uint8_t tid = AOOSP_TID_ASKTINFO;
   if( respsize ) *respsize = 4+2; // tmin, tmax
 
   // Build telegram
@@ -972,25 +1195,26 @@ aoresult_t aoosp_send_asktinfo_init(uint16_t addr, uint8_t * tmin, uint8_t * tma
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_asktinfo_init(&tele,addr,*tmin,*tmax,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_asktinfo(&resp, tmin, tmax);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("asktinfo_ex(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" tmin=0x%02X=%d tmax=0x%02X=%d", *tmin, aoosp_prt_temp_said(*tmin), *tmax, aoosp_prt_temp_said(*tmax) );
-    Serial.printf(" (%d, %d)\n", aoosp_prt_temp_rgbi(*tmin), aoosp_prt_temp_rgbi(*tmax) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_asktinfo_ex,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*tmin; rec->arg[2]=*tmax;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1021,7 +1245,7 @@ static aoresult_t aoosp_con_readmult(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x0C; // READMULT
+  const uint8_t tid = AOOSP_TID_READMULT;
   if( respsize ) *respsize = 4+2; // groups
 
   // Build telegram
@@ -1041,12 +1265,12 @@ static aoresult_t aoosp_des_readmult(aoosp_tele_t * tele, uint16_t *groups ) {
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || groups==0                     ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x0C      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || groups==0                              ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READMULT ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0               ) return aoresult_osp_crc;
 
   // Get fields
   *groups= (tele->data[3] << 8) | (tele->data[4] << 0);
@@ -1078,24 +1302,26 @@ aoresult_t aoosp_send_readmult(uint16_t addr, uint16_t *groups ) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readmult(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readmult(&resp, groups);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readmult(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" groups=0x%04X\n", *groups );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readmult,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*groups;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1115,7 +1341,7 @@ static aoresult_t aoosp_con_setmult(aoosp_tele_t * tele, uint16_t addr, uint16_t
 
   // Set constants
   const uint8_t payloadsize = 2;
-  const uint8_t tid = 0x0D; // SETMULT
+  const uint8_t tid = AOOSP_TID_SETMULT;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -1153,19 +1379,19 @@ aoresult_t aoosp_send_setmult(uint16_t addr, uint16_t groups) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_setmult(&tele, addr, groups);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("setmult(0x%03X,0x%02X)",addr,groups);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_setmult,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=groups;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1188,7 +1414,7 @@ static aoresult_t aoosp_con_sync(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x0F; // SYNC
+  const uint8_t tid = AOOSP_TID_SYNC;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -1220,20 +1446,20 @@ aoresult_t aoosp_send_sync(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_sync(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("sync(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
-  };
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_sync,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
+  }
   #endif // AOOSP_LOG_ENABLED
 
   return result;
@@ -1255,7 +1481,7 @@ static aoresult_t aoosp_con_idle(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x11; // IDLE
+  const uint8_t tid = AOOSP_TID_IDLE;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -1288,19 +1514,19 @@ aoresult_t aoosp_send_idle(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_idle(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("idle(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_idle,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1319,7 +1545,7 @@ static aoresult_t aoosp_con_foundry(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x12; // FOUNDRY
+  const uint8_t tid = AOOSP_TID_FOUNDRY;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -1352,19 +1578,19 @@ aoresult_t aoosp_send_foundry(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_foundry(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("foundry(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_foundry,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1383,7 +1609,7 @@ static aoresult_t aoosp_con_cust(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x13; // CUST
+  const uint8_t tid = AOOSP_TID_CUST;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -1416,19 +1642,19 @@ aoresult_t aoosp_send_cust(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_cust(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("cust(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_cust,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1447,7 +1673,7 @@ static aoresult_t aoosp_con_burn(aoosp_tele_t * tele, uint16_t addr) {
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x14; // BURN
+  const uint8_t tid = AOOSP_TID_BURN;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -1480,19 +1706,19 @@ aoresult_t aoosp_send_burn(uint16_t addr) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_burn(&tele,addr);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("burn(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n");
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_burn,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1520,7 +1746,7 @@ static aoresult_t aoosp_con_i2cread8(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 3;
-  const uint8_t tid = 0x18; // I2CREAD
+  const uint8_t tid = AOOSP_TID_I2CREAD;
   // if( respsize ) *respsize = 4+0; // nothing
 
   // Build telegram
@@ -1569,19 +1795,19 @@ aoresult_t aoosp_send_i2cread8(uint16_t addr, uint8_t daddr7, uint8_t raddr, uin
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_i2cread8(&tele,addr,daddr7,raddr,count);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("i2cread(0x%03X,0x%02X,0x%02X,%d)",addr,daddr7,raddr,count );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_i2cread,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=daddr7; rec->arg[2]=raddr; rec->arg[3]=count;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1605,7 +1831,7 @@ static aoresult_t aoosp_con_i2cwrite8(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 2+count; // daddr, raddr and buf size (count)
-  const uint8_t tid = 0x19; // I2CWRITE
+  const uint8_t tid = AOOSP_TID_I2CWRITE;
   // if( respsize ) *respsize = 4+0; // nothing
 
   // Build telegram
@@ -1655,19 +1881,20 @@ aoresult_t aoosp_send_i2cwrite8(uint16_t addr, uint8_t daddr7, uint8_t raddr, co
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_i2cwrite8(&tele,addr,daddr7,raddr,buf,count);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("i2cwrite(0x%03X,0x%02X,0x%02X,%s)",addr,daddr7,raddr,aoosp_prt_bytes(buf,count));
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_i2cwrite,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=daddr7; rec->arg[2]=raddr;
+    aoosp_send_log_bytes(rec,buf,count);
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1693,7 +1920,7 @@ static aoresult_t aoosp_con_readlast(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x1E; // READLAST
+  const uint8_t tid = AOOSP_TID_READLAST;
   if( respsize ) *respsize = 4+8; // i2c read buffer
 
   // Build telegram
@@ -1713,13 +1940,13 @@ static aoresult_t aoosp_des_readlast(aoosp_tele_t * tele, uint8_t * buf, int siz
   // Set constants
   const uint8_t payloadsize = 8;
   // Check telegram consistency
-  if( tele==0 || buf==0                        ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x1E      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
-  if( size<1 || size>8                         ) return aoresult_osp_arg;
+  if( tele==0 || buf==0                                 ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READLAST ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0               ) return aoresult_osp_crc;
+  if( size<1 || size>8                                  ) return aoresult_osp_arg;
 
   // Get fields
   for( int i=0; i<size; i++ ) buf[i] = tele->data[11-size+i];
@@ -1753,24 +1980,27 @@ aoresult_t aoosp_send_readlast(uint16_t addr, uint8_t * buf, int size) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readlast(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readlast(&resp, buf, size);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readlast(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" i2c %s\n", aoosp_prt_bytes(buf,size) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readlast,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr;
+    aoosp_send_log_bytes(rec,buf,size);
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1798,7 +2028,7 @@ static aoresult_t aoosp_con_goactive_sr(aoosp_tele_t * tele, uint16_t addr, uint
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x25; // GOACTIVE_SR
+  const uint8_t tid = AOOSP_TID_GOACTIVE_SR;
   if( respsize ) *respsize = 4+2; // temp,stat
 
   // Build telegram
@@ -1818,12 +2048,12 @@ static aoresult_t aoosp_des_goactive_sr(aoosp_tele_t * tele, uint8_t * temp, uin
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || stat==0                       ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x25      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || stat==0                                   ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                            ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)                 ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                   ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_GOACTIVE_SR ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                  ) return aoresult_osp_crc;
 
   // Get fields
   *temp = tele->data[3];
@@ -1856,25 +2086,37 @@ aoresult_t aoosp_send_goactive_sr(uint16_t addr, uint8_t * temp, uint8_t * stat)
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_goactive_sr(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_goactive_sr(&resp, temp, stat);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  if(     result==aoresult_ok ) aoosp_linkstat_count_ce(addr,*stat);
+  #endif // AOOSP_LINKSTAT_ENABLED
+
+  // Record status in error map
+  #if AOOSP_ERRMAP_ENABLED
+  if(     result==aoresult_ok ) aoosp_errmap_update(addr,*stat);
+  #endif // AOOSP_ERRMAP_ENABLED
+
+  // Record temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok ) aoosp_tseries_add(addr,*temp);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("goactive_sr(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" temp=0x%02X=%d stat=0x%02X=%s", *temp, aoosp_prt_temp_said(*temp), *stat, aoosp_prt_stat_said(*stat) );
-    Serial.printf(" (%d, %s)\n",  aoosp_prt_temp_rgbi(*temp), aoosp_prt_stat_rgbi(*stat) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_goactive_sr,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*temp; rec->arg[2]=*stat;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -1916,7 +2158,7 @@ static aoresult_t aoosp_con_readstat(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x40; // READSTAT
+  const uint8_t tid = AOOSP_TID_READSTAT;
   if( respsize ) *respsize = 4+1; //  stat
 
   // Build telegram
@@ -1936,12 +2178,12 @@ static aoresult_t aoosp_des_readstat(aoosp_tele_t * tele, uint8_t * stat) {
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || stat==0                       ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x40      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || stat==0                                ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READSTAT ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0               ) return aoresult_osp_crc;
 
   // Get fields
   *stat = tele->data[3];
@@ -1971,25 +2213,32 @@ aoresult_t aoosp_send_readstat(uint16_t addr, uint8_t * stat) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readstat(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readstat(&resp, stat);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  if(     result==aoresult_ok ) aoosp_linkstat_count_ce(addr,*stat);
+  #endif // AOOSP_LINKSTAT_ENABLED
+
+  // Record status in error map
+  #if AOOSP_ERRMAP_ENABLED
+  if(     result==aoresult_ok ) aoosp_errmap_update(addr,*stat);
+  #endif // AOOSP_ERRMAP_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readstat(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" stat=0x%02X=%s", *stat, aoosp_prt_stat_said(*stat) );
-    Serial.printf(" (%s)\n", aoosp_prt_stat_rgbi(*stat) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readstat,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*stat;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2012,7 +2261,7 @@ static aoresult_t aoosp_con_readtempstat(aoosp_tele_t * tele, uint16_t addr, uin
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x42; // READTEMPSTAT
+  const uint8_t tid = AOOSP_TID_READTEMPSTAT;
   if( respsize ) *respsize = 4+2; // temp, stat
 
   // Build telegram
@@ -2032,12 +2281,12 @@ static aoresult_t aoosp_des_readtempstat(aoosp_tele_t * tele, uint8_t * temp, ui
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || temp==0 || stat==0            ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x42      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || temp==0 || stat==0                         ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                             ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)                  ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                    ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READTEMPSTAT ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                   ) return aoresult_osp_crc;
 
   // Get fields
   *temp = tele->data[3];
@@ -2072,25 +2321,37 @@ aoresult_t aoosp_send_readtempstat(uint16_t addr, uint8_t * temp, uint8_t * stat
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readtempstat(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readtempstat(&resp, temp, stat);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  if(     result==aoresult_ok ) aoosp_linkstat_count_ce(addr,*stat);
+  #endif // AOOSP_LINKSTAT_ENABLED
+
+  // Record status in error map
+  #if AOOSP_ERRMAP_ENABLED
+  if(     result==aoresult_ok ) aoosp_errmap_update(addr,*stat);
+  #endif // AOOSP_ERRMAP_ENABLED
+
+  // Record temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok ) aoosp_tseries_add(addr,*temp);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readtempstat(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" temp=0x%02X=%d stat=0x%02X=%s", *temp, aoosp_prt_temp_said(*temp), *stat, aoosp_prt_stat_said(*stat) );
-    Serial.printf(" (%d, %s)\n",  aoosp_prt_temp_rgbi(*temp), aoosp_prt_stat_rgbi(*stat) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readtempstat,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*temp; rec->arg[2]=*stat;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2113,7 +2374,7 @@ static aoresult_t aoosp_con_readcomst(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x44; // READCOMST
+  const uint8_t tid = AOOSP_TID_READCOMST;
   if( respsize ) *respsize = 4+1; // comst
 
   // Build telegram
@@ -2133,12 +2394,12 @@ static aoresult_t aoosp_des_readcomst(aoosp_tele_t * tele, uint8_t * com) {
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || com==0                        ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x44      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || com==0                                  ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                          ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)               ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                 ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READCOMST ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                ) return aoresult_osp_crc;
 
   // Get fields
   *com= tele->data[3];
@@ -2170,25 +2431,26 @@ aoresult_t aoosp_send_readcomst(uint16_t addr, uint8_t * com) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readcomst(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readcomst(&resp, com);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readcomst(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" com=0x%02X=%s", *com, aoosp_prt_com_said(*com) );
-    Serial.printf(" (%s)\n", aoosp_prt_com_rgbi(*com) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readcomst,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*com;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2211,7 +2473,7 @@ static aoresult_t aoosp_con_readledst(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x46; // READLEDST
+  const uint8_t tid = AOOSP_TID_READLEDST;
   if( respsize ) *respsize = 4+1; // ledst
 
   // Build telegram
@@ -2231,12 +2493,12 @@ static aoresult_t aoosp_des_readledst(aoosp_tele_t * tele, uint8_t * ledst) {
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || ledst==0                      ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x46      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || ledst==0                                ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                          ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)               ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                 ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READLEDST ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                ) return aoresult_osp_crc;
 
   // Get fields
   *ledst = tele->data[3];
@@ -2276,24 +2538,26 @@ aoresult_t aoosp_send_readledst(uint16_t addr, uint8_t * ledst) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readledst(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readledst(&resp, ledst);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readledst(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" ledst=0x%02X=%s\n", *ledst, aoosp_prt_ledst(*ledst) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readledst,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*ledst;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2313,7 +2577,7 @@ static aoresult_t aoosp_con_readledstchn(aoosp_tele_t * tele, uint16_t addr, uin
 
   // Set constants
   const uint8_t payloadsize = 1;
-  const uint8_t tid = 0x46; // READLEDST
+  const uint8_t tid = AOOSP_TID_READLEDST;
   if( respsize ) *respsize = 4+1; // ledst
 
   // Build telegram
@@ -2335,12 +2599,12 @@ static aoresult_t aoosp_des_readledstchn(aoosp_tele_t * tele, uint8_t * ledst) {
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || ledst==0                      ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x46      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || ledst==0                                ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                          ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)               ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                 ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READLEDST ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                ) return aoresult_osp_crc;
 
   // Get fields
   *ledst = tele->data[3];
@@ -2378,24 +2642,26 @@ aoresult_t aoosp_send_readledstchn(uint16_t addr, uint8_t chn, uint8_t * ledst)
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readledstchn(&tele,addr,chn,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readledstchn(&resp, ledst);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readledstchn(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" ledst=0x%02X=%s\n", *ledst, aoosp_prt_ledst(*ledst) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readledstchn,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*ledst;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2418,7 +2684,7 @@ static aoresult_t aoosp_con_readtemp(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x48; // READTEMP
+  const uint8_t tid = AOOSP_TID_READTEMP;
   if( respsize ) *respsize = 4+1; // temp
 
   // Build telegram
@@ -2438,12 +2704,12 @@ static aoresult_t aoosp_des_readtemp(aoosp_tele_t * tele, uint8_t * temp) {
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || temp==0                       ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x48      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || temp==0                                ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                         ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)              ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READTEMP ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0               ) return aoresult_osp_crc;
 
   // Get fields
   *temp = tele->data[3];
@@ -2474,25 +2740,31 @@ aoresult_t aoosp_send_readtemp(uint16_t addr, uint8_t * temp) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readtemp(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readtemp(&resp, temp);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
+
+  // Record temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok ) aoosp_tseries_add(addr,*temp);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readtemp(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" temp=0x%02X=%d", *temp, aoosp_prt_temp_said(*temp) );
-    Serial.printf(" (%d)\n", aoosp_prt_temp_rgbi(*temp) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readtemp,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*temp;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2517,7 +2789,7 @@ static aoresult_t aoosp_con_readsetup(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x4C; // READSETUP
+  const uint8_t tid = AOOSP_TID_READSETUP;
   if( respsize ) *respsize = 4+1; // flags
 
   // Build telegram
@@ -2537,12 +2809,12 @@ static aoresult_t aoosp_des_readsetup(aoosp_tele_t * tele, uint8_t *flags ) {
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || flags==0                      ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x4C      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || flags==0                                ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                          ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)               ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                 ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READSETUP ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                ) return aoresult_osp_crc;
 
   // Get fields
   *flags= tele->data[3];
@@ -2572,24 +2844,26 @@ aoresult_t aoosp_send_readsetup(uint16_t addr, uint8_t *flags ) {
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readsetup(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readsetup(&resp, flags);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readsetup(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" flags=0x%02X=%s\n", *flags, aoosp_prt_setup(*flags) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readsetup,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*flags;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2608,7 +2882,7 @@ static aoresult_t aoosp_con_setsetup(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 1;
-  const uint8_t tid = 0x4D; // SETSETUP
+  const uint8_t tid = AOOSP_TID_SETSETUP;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -2645,19 +2919,19 @@ aoresult_t aoosp_send_setsetup(uint16_t addr, uint8_t flags) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_setsetup(&tele, addr, flags);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("setsetup(0x%03X,0x%02X)",addr,flags);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_setsetup,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=flags;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2676,7 +2950,7 @@ static aoresult_t aoosp_con_readpwm(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x4E; // READPWM
+  const uint8_t tid = AOOSP_TID_READPWM;
   if( respsize ) *respsize = 4+6; // red, green, blue
 
   // Build telegram
@@ -2701,7 +2975,7 @@ static aoresult_t aoosp_des_readpwm(aoosp_tele_t * tele, uint16_t *red, uint16_t
   if( tele->size!=4+payloadsize                               ) return aoresult_osp_size;
   if( TELEPSI(tele)!=SIZE2PSI(payloadsize)                    ) return aoresult_osp_psi;
   if( BITS_SLICE(tele->data[0],4,8)!=0xA                      ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x4E                     ) return aoresult_osp_tid;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READPWM        ) return aoresult_osp_tid;
   if( aoosp_crc(tele->data,tele->size)!=0                     ) return aoresult_osp_crc;
 
   // Get fields
@@ -2746,24 +3020,26 @@ aoresult_t aoosp_send_readpwm(uint16_t addr, uint16_t *red, uint16_t *green, uin
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readpwm(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readpwm(&resp, red, green, blue, daytimes);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readpwm(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" rgb=%s\n", aoosp_prt_pwm_rgbi(*red,*green,*blue,*daytimes) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readpwm,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*red; rec->arg[2]=*green; rec->arg[3]=*blue; rec->arg[4]=*daytimes;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2783,7 +3059,7 @@ static aoresult_t aoosp_con_readpwmchn(aoosp_tele_t * tele, uint16_t addr, uint8
 
   // Set constants
   const uint8_t payloadsize = 1;
-  const uint8_t tid = 0x4E; // READPWMCHN
+  const uint8_t tid = AOOSP_TID_READPWM; // READPWMCHN
   if( respsize ) *respsize = 4+6; // red, green, blue
 
   // Build telegram
@@ -2806,12 +3082,12 @@ static aoresult_t aoosp_des_readpwmchn(aoosp_tele_t * tele, uint16_t *red, uint1
   // Set constants
   const uint8_t payloadsize = 6;
   // Check telegram consistency
-  if( tele==0 || red==0 || green==0 || blue==0 ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x4E      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || red==0 || green==0 || blue==0         ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                        ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)             ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA               ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READPWM ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0              ) return aoresult_osp_crc;
 
   // Get fields
   *red  = tele->data[3]<<8 | tele->data[4] ;
@@ -2855,24 +3131,26 @@ aoresult_t aoosp_send_readpwmchn(uint16_t addr, uint8_t chn, uint16_t *red, uint
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readpwmchn(&tele,addr,chn,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readpwmchn(&resp, red, green, blue);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readpwmchn(0x%03X,%X)",addr,chn);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" rgb=%s\n", aoosp_prt_pwm_said(*red,*green,*blue) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readpwmchn,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=chn; rec->arg[2]=*red; rec->arg[3]=*green; rec->arg[4]=*blue;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2895,7 +3173,7 @@ static aoresult_t aoosp_con_setpwm(aoosp_tele_t * tele, uint16_t addr, uint16_t
 
   // Set constants
   const uint8_t payloadsize = 6;
-  const uint8_t tid = 0x4F; // SETPWM
+  const uint8_t tid = AOOSP_TID_SETPWM;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -2949,19 +3227,19 @@ aoresult_t aoosp_send_setpwm(uint16_t addr, uint16_t red, uint16_t green, uint16
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_setpwm(&tele, addr, red, green, blue, daytimes);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("setpwm(0x%03X,0x%04X,0x%04X,0x%04X,%X)",addr,red,green,blue,daytimes);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_setpwm,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=red; rec->arg[2]=green; rec->arg[3]=blue; rec->arg[4]=daytimes;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -2981,7 +3259,7 @@ static aoresult_t aoosp_con_setpwmchn(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 8;
-  const uint8_t tid = 0x4F; // SETPWMCHN (same SETPWM of OSP V1)
+  const uint8_t tid = AOOSP_TID_SETPWM; // SETPWMCHN (same SETPWM of OSP V1)
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -3040,19 +3318,19 @@ aoresult_t aoosp_send_setpwmchn(uint16_t addr, uint8_t chn, uint16_t red, uint16
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_setpwmchn(&tele, addr, chn, red, green, blue);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("setpwmchn(0x%03X,%X,0x%04X,0x%04X,0x%04X)",addr,chn,red,green,blue);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_setpwmchn,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=chn; rec->arg[2]=red; rec->arg[3]=green; rec->arg[4]=blue;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3072,7 +3350,7 @@ static aoresult_t aoosp_con_readcurchn(aoosp_tele_t * tele, uint16_t addr, uint8
 
   // Set constants
   const uint8_t payloadsize = 1;
-  const uint8_t tid = 0x50; // READCURCHN
+  const uint8_t tid = AOOSP_TID_READCURCHN;
   if( respsize ) *respsize = 4+2; // 3*4 PWM bits, 4 flags
 
   // Build telegram
@@ -3098,7 +3376,7 @@ static aoresult_t aoosp_des_readcurchn(aoosp_tele_t * tele, uint8_t *flags, uint
   if( tele->size!=4+payloadsize                            ) return aoresult_osp_size;
   if( TELEPSI(tele)!=SIZE2PSI(payloadsize)                 ) return aoresult_osp_psi;
   if( BITS_SLICE(tele->data[0],4,8)!=0xA                   ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x50                  ) return aoresult_osp_tid;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READCURCHN  ) return aoresult_osp_tid;
   if( aoosp_crc(tele->data,tele->size)!=0                  ) return aoresult_osp_crc;
 
   // Get fields
@@ -3141,24 +3419,26 @@ aoresult_t aoosp_send_readcurchn(uint16_t addr, uint8_t chn, uint8_t *flags, uin
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readcurchn(&tele,addr,chn,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readcurchn(&resp, flags, rcur, gcur, bcur);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readcurchn(0x%03X,%X)",addr,chn);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" flags=%s rcur=%X gcur=%X bcur=%X\n", aoosp_prt_curchn(*flags), *rcur,*gcur,*bcur );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readcurchn,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=chn; rec->arg[2]=*flags; rec->arg[3]=*rcur; rec->arg[4]=*gcur; rec->arg[5]=*bcur;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3185,7 +3465,7 @@ static aoresult_t aoosp_con_setcurchn(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 3;
-  const uint8_t tid = 0x51; // SETCURCHN
+  const uint8_t tid = AOOSP_TID_SETCURCHN;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -3234,19 +3514,19 @@ aoresult_t aoosp_send_setcurchn(uint16_t addr, uint8_t chn, uint8_t flags, uint8
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_setcurchn(&tele, addr, chn, flags, rcur, gcur, bcur);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("setcurchn(0x%03X,%X,%s,%X,%X,%X)",addr,chn,aoosp_prt_curchn(flags),rcur,gcur,bcur);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_setcurchn,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=chn; rec->arg[2]=flags; rec->arg[3]=rcur; rec->arg[4]=gcur; rec->arg[5]=bcur;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3272,7 +3552,7 @@ static aoresult_t aoosp_con_readi2ccfg(aoosp_tele_t * tele, uint16_t addr, uint8
 
   // Set constants
   const uint8_t payloadsize = 0;
-  const uint8_t tid = 0x56; // READI2CCFG
+  const uint8_t tid = AOOSP_TID_READI2CCFG;
   if( respsize ) *respsize = 4+1; // flags:speed
 
   // Build telegram
@@ -3292,12 +3572,12 @@ static aoresult_t aoosp_des_readi2ccfg(aoosp_tele_t * tele, uint8_t *flags, uint
   // Set constants
   const uint8_t payloadsize = 1;
   // Check telegram consistency
-  if( tele==0 || flags==0 || speed==0          ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x56      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || flags==0 || speed==0                     ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                           ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)                ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                  ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READI2CCFG ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                 ) return aoresult_osp_crc;
 
   // Get fields
   *flags = BITS_SLICE(tele->data[3],4,8);
@@ -3333,24 +3613,26 @@ aoresult_t aoosp_send_readi2ccfg(uint16_t addr, uint8_t *flags, uint8_t *speed )
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readi2ccfg(&tele,addr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readi2ccfg(&resp, flags, speed);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readi2ccfg(0x%03X)",addr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" flags=0x%02X=%s speed=0x%02X=%d\n", *flags, aoosp_prt_i2ccfg(*flags), *speed, aoosp_prt_i2ccfg_speed(*speed) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readi2ccfg,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*flags; rec->arg[2]=*speed;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3372,7 +3654,7 @@ static aoresult_t aoosp_con_seti2ccfg(aoosp_tele_t * tele, uint16_t addr, uint8_
 
   // Set constants
   const uint8_t payloadsize = 1;
-  const uint8_t tid = 0x57; // SETI2CCFG
+  const uint8_t tid = AOOSP_TID_SETI2CCFG;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -3414,19 +3696,19 @@ aoresult_t aoosp_send_seti2ccfg(uint16_t addr, uint8_t flags, uint8_t speed ) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_seti2ccfg(&tele, addr, flags, speed);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("seti2ccfg(0x%03X,0x%02X,0x%02X)",addr,flags,speed);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_seti2ccfg,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=flags; rec->arg[2]=speed;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3446,7 +3728,7 @@ static aoresult_t aoosp_con_readotp(aoosp_tele_t * tele, uint16_t addr, uint8_t
 
   // Set constants
   const uint8_t payloadsize = 1;
-  const uint8_t tid = 0x58; // READOTP
+  const uint8_t tid = AOOSP_TID_READOTP;
   if( respsize ) *respsize = 4+8; // otp row
 
   // Build telegram
@@ -3468,13 +3750,13 @@ static aoresult_t aoosp_des_readotp(aoosp_tele_t * tele, uint8_t * buf, int size
   // Set constants
   const uint8_t payloadsize = 8;
   // Check telegram consistency
-  if( tele==0 || buf==0                        ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x58      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
-  if( size<1 || size>8                         ) return aoresult_osp_arg;
+  if( tele==0 || buf==0                                ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                        ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)             ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA               ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_READOTP ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0              ) return aoresult_osp_crc;
+  if( size<1 || size>8                                 ) return aoresult_osp_arg;
 
   // Get fields
   // OSP telegrams are big endian, C byte arrays are little endian, so reverse.
@@ -3516,24 +3798,27 @@ aoresult_t aoosp_send_readotp(uint16_t addr, uint8_t otpaddr, uint8_t * buf, int
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_readotp(&tele,addr,otpaddr,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_readotp(&resp, buf, size);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  #endif // AOOSP_LINKSTAT_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("readotp(0x%03X,0x%02X)",addr,otpaddr);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" otp 0x%02X: %s\n", otpaddr, aoosp_prt_bytes(buf,size) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_readotp,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=otpaddr;
+    aoosp_send_log_bytes(rec,buf,size);
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3566,7 +3851,7 @@ static aoresult_t aoosp_con_setotp(aoosp_tele_t * tele, uint16_t addr, uint8_t o
 
   // Set constants
   const uint8_t payloadsize = 8; // 1 for otp target address, 7 for data
-  const uint8_t tid = 0x59; // SETOTP
+  const uint8_t tid = AOOSP_TID_SETOTP;
   // if( respsize ) *respsize = 4+0; // nothing
 
   // Build telegram
@@ -3623,19 +3908,20 @@ aoresult_t aoosp_send_setotp(uint16_t addr, uint8_t otpaddr, uint8_t * buf, int
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_setotp(&tele,addr,otpaddr,buf,size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("setotp(0x%03X,0x%02X,%s)",addr,otpaddr,aoosp_prt_bytes(buf,size) );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_setotp,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=otpaddr;
+    aoosp_send_log_bytes(rec,buf,size);
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3658,7 +3944,7 @@ static aoresult_t aoosp_con_settestdata(aoosp_tele_t * tele, uint16_t addr, uint
 
   // Set constants
   const uint8_t payloadsize = 2;
-  const uint8_t tid = 0x5B; // SETTESTDATA
+  const uint8_t tid = AOOSP_TID_SETTESTDATA;
   //if( respsize ) *respsize = 4+0;
 
   // Build telegram
@@ -3699,19 +3985,19 @@ aoresult_t aoosp_send_settestdata(uint16_t addr, uint16_t data ) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_settestdata(&tele, addr, data);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("settestdata(0x%03X,0x%04X)",addr,data);
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_settestdata,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr; rec->arg[1]=data;
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3738,7 +4024,7 @@ static aoresult_t aoosp_con_settestpw(aoosp_tele_t * tele, uint16_t addr, uint64
 
   // Set constants
   const uint8_t payloadsize = 6;
-  const uint8_t tid = 0x5F; // SETTESTPW
+  const uint8_t tid = AOOSP_TID_SETTESTPW;
   // if( respsize ) *respsize = 4+0; // nothing
 
   // Build telegram
@@ -3787,19 +4073,20 @@ aoresult_t aoosp_send_settestpw(uint16_t addr, uint64_t pw) {
   aoresult_t   spi_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_settestpw(&tele,addr,pw);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_tx(tele.data,tele.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_tx(&tele);
   if( spi_result!=aoresult_ok ) result= spi_result;
+  aoosp_send_end(&tele,0,result,con_result,spi_result);
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("settestpw(0x%03X,%s)",addr,aoosp_prt_bytes(&pw,6) );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-    Serial.printf("\n" );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_settestpw,&tele,0,con_result,spi_result,aoresult_ok);
+    rec->arg[0]=addr;
+    aoosp_send_log_bytes(rec,&pw,6);
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
@@ -3844,7 +4131,7 @@ static aoresult_t aoosp_con_settestpw_sr(aoosp_tele_t * tele, uint16_t addr, uin
 
   // Set constants
   const uint8_t payloadsize = 6;
-  const uint8_t tid = 0x7F; // SETTESTPW_SR
+  const uint8_t tid = AOOSP_TID_SETTESTPW_SR;
   if( respsize ) *respsize = 4+2; // temp,stat
 
   // Build telegram
@@ -3866,12 +4153,12 @@ static aoresult_t aoosp_des_settestpw_sr(aoosp_tele_t * tele, uint8_t * temp, ui
   // Set constants
   const uint8_t payloadsize = 2;
   // Check telegram consistency
-  if( tele==0 || stat==0                       ) return aoresult_outargnull;
-  if( tele->size!=4+payloadsize                ) return aoresult_osp_size;
-  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)     ) return aoresult_osp_psi;
-  if( BITS_SLICE(tele->data[0],4,8)!=0xA       ) return aoresult_osp_preamble;
-  if( BITS_SLICE(tele->data[2],0,7)!=0x7F      ) return aoresult_osp_tid;
-  if( aoosp_crc(tele->data,tele->size)!=0      ) return aoresult_osp_crc;
+  if( tele==0 || stat==0                                    ) return aoresult_outargnull;
+  if( tele->size!=4+payloadsize                             ) return aoresult_osp_size;
+  if( TELEPSI(tele)!=SIZE2PSI(payloadsize)                  ) return aoresult_osp_psi;
+  if( BITS_SLICE(tele->data[0],4,8)!=0xA                    ) return aoresult_osp_preamble;
+  if( BITS_SLICE(tele->data[2],0,7)!=AOOSP_TID_SETTESTPW_SR ) return aoresult_osp_tid;
+  if( aoosp_crc(tele->data,tele->size)!=0                   ) return aoresult_osp_crc;
 
   // Get fields
   *temp = tele->data[3];
@@ -3916,28 +4203,108 @@ aoresult_t aoosp_send_settestpw_sr(uint16_t addr, uint64_t pw, uint8_t * temp, u
   aoresult_t   des_result= aoresult_ok;
 
   // Construct, send and optionally destruct
+  aoosp_send_begin();
   if(     result==aoresult_ok ) con_result= aoosp_con_settestpw_sr(&tele,addr,pw,&resp.size);
   if( con_result!=aoresult_ok ) result=con_result;
-  if(     result==aoresult_ok ) spi_result= aospi_txrx(tele.data,tele.size,resp.data,resp.size);
+  if(     result==aoresult_ok ) spi_result= aoosp_send_txrx(&tele,&resp);
   if( spi_result!=aoresult_ok ) result= spi_result;
   if(     result==aoresult_ok ) des_result = aoosp_des_settestpw_sr(&resp, temp, stat);
   if( des_result!=aoresult_ok ) result=des_result;
+  aoosp_send_end(&tele,&resp,result,con_result,spi_result);
+
+  // Count communication errors
+  #if AOOSP_LINKSTAT_ENABLED
+  if( con_result==aoresult_ok ) aoosp_linkstat_count(addr,spi_result,des_result);
+  if(     result==aoresult_ok ) aoosp_linkstat_count_ce(addr,*stat);
+  #endif // AOOSP_LINKSTAT_ENABLED
+
+  // Record status in error map
+  #if AOOSP_ERRMAP_ENABLED
+  if(     result==aoresult_ok ) aoosp_errmap_update(addr,*stat);
+  #endif // AOOSP_ERRMAP_ENABLED
+
+  // Record temperature in time-series store
+  #if AOOSP_TSERIES_ENABLED
+  if(     result==aoresult_ok ) aoosp_tseries_add(addr,*temp);
+  #endif // AOOSP_TSERIES_ENABLED
 
   // Log
   #if AOOSP_LOG_ENABLED
   if( aoosp_loglevel >= aoosp_loglevel_args ) {
-    Serial.printf("settestpw_sr(0x%03X,%s)",addr,aoosp_prt_bytes(&pw,6) );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [tele %s]",aoosp_prt_bytes(tele.data,tele.size));
-    if( con_result!=aoresult_ok ) Serial.printf(" [constructor ERROR %s]", aoresult_to_str(con_result) );
-      else if( spi_result!=aoresult_ok ) Serial.printf(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)spi_result) );
-      else if( des_result!=aoresult_ok ) Serial.printf(" [destructor ERROR %s]", aoresult_to_str(des_result) );
-    Serial.printf(" ->" );
-    if( aoosp_loglevel >= aoosp_loglevel_tele ) Serial.printf(" [resp %s]",aoosp_prt_bytes(resp.data,resp.size));
-    Serial.printf(" temp=0x%02X=%d stat=0x%02X=%s", *temp, aoosp_prt_temp_said(*temp), *stat, aoosp_prt_stat_said(*stat) );
-    Serial.printf(" (%d, %s)\n",  aoosp_prt_temp_rgbi(*temp), aoosp_prt_stat_rgbi(*stat) );
+    aoosp_dlog_rec_t * rec = aoosp_send_log(aoosp_dlog_fmt_settestpw_sr,&tele,&resp,con_result,spi_result,des_result);
+    rec->arg[0]=addr; rec->arg[1]=*temp; rec->arg[2]=*stat;
+    aoosp_send_log_bytes(rec,&pw,6);
+    aoosp_dlog_commit(rec);
   }
   #endif // AOOSP_LOG_ENABLED
 
   return result;
 }
 
+
+
+// ==========================================================================
+// Response decoder
+// ==========================================================================
+// Trace tools (aoosp_trace_decode) see only the raw bytes of a response. Rather
+// than knowing the field offsets again, they call aoosp_send_des_rec(), which
+// runs the aoosp_des_xxx() of the telegram ID and stores the results in a log
+// record, the way the aoosp_send_xxx() log them. The record is formatted with
+// aoosp_dlog_format_results(), so a trace shows the fields like the log does.
+
+
+/*!
+    @brief  Decodes a response telegram with the destructor of its TID.
+    @param  resp
+            The response bytes (preamble first).
+    @param  size
+            Number of bytes in resp.
+    @param  rec
+            Output parameter; fmt, arg[] and bytes[] are set as the
+            aoosp_send_xxx() receiving that response logs them, des
+            is the destructor result.
+    @return aoresult_outargnull, aoresult_osp_size (no telegram),
+            aoresult_osp_tid (no aoosp_send_xxx() receives this TID),
+            otherwise the destructor result (also in rec->des).
+    @note   arg[0] is the address from the response; arguments not in the
+            response (chn of READPWMCHN and READCURCHN, the OTP address of
+            READOTP) are 0. TID 4E decodes as READPWMCHN (SAID), 46 as
+            READLEDST, READLAST and READOTP as 8 bytes.
+*/
+aoresult_t aoosp_send_des_rec(const uint8_t * resp, int size, struct aoosp_dlog_rec_s * rec) {
+  if( resp==0 || rec==0 ) return aoresult_outargnull;
+  if( size<4 || size>AOOSP_TELE_MAXSIZE ) return aoresult_osp_size;
+  aoosp_tele_t tele;
+  memcpy( tele.data, resp, size );
+  tele.size = size;
+
+  memset( rec, 0, sizeof *rec );
+  rec->arg[0] = BITS_SLICE(resp[0],0,4)<<6 | BITS_SLICE(resp[1],2,8);
+  uint16_t   last, groups, red, green, blue;
+  uint8_t    temp, stat, tmin, tmax, val, flags, rcur, gcur, bcur;
+  uint32_t   id;
+  aoresult_t des;
+  switch( BITS_SLICE(resp[2],0,7) ) {
+    case AOOSP_TID_INITBIDIR   : rec->fmt = aoosp_dlog_fmt_initbidir;    des = aoosp_des_initbidir(&tele,&last,&temp,&stat);          rec->arg[1]=last; rec->arg[2]=temp; rec->arg[3]=stat; break;
+    case AOOSP_TID_INITLOOP    : rec->fmt = aoosp_dlog_fmt_initloop;     des = aoosp_des_initloop(&tele,&last,&temp,&stat);           rec->arg[1]=last; rec->arg[2]=temp; rec->arg[3]=stat; break;
+    case AOOSP_TID_IDENTIFY    : rec->fmt = aoosp_dlog_fmt_identify;     des = aoosp_des_identify(&tele,&id);                         rec->arg[1]=id; break;
+    case AOOSP_TID_ASKTINFO    : rec->fmt = aoosp_dlog_fmt_asktinfo;     des = aoosp_des_asktinfo(&tele,&tmin,&tmax);                 rec->arg[1]=tmin; rec->arg[2]=tmax; break;
+    case AOOSP_TID_READMULT    : rec->fmt = aoosp_dlog_fmt_readmult;     des = aoosp_des_readmult(&tele,&groups);                     rec->arg[1]=groups; break;
+    case AOOSP_TID_READLAST    : rec->fmt = aoosp_dlog_fmt_readlast;     des = aoosp_des_readlast(&tele,rec->bytes,8);                rec->bytesize=8; break;
+    case AOOSP_TID_GOACTIVE_SR : rec->fmt = aoosp_dlog_fmt_goactive_sr;  des = aoosp_des_goactive_sr(&tele,&temp,&stat);              rec->arg[1]=temp; rec->arg[2]=stat; break;
+    case AOOSP_TID_READSTAT    : rec->fmt = aoosp_dlog_fmt_readstat;     des = aoosp_des_readstat(&tele,&stat);                       rec->arg[1]=stat; break;
+    case AOOSP_TID_READTEMPSTAT: rec->fmt = aoosp_dlog_fmt_readtempstat; des = aoosp_des_readtempstat(&tele,&temp,&stat);             rec->arg[1]=temp; rec->arg[2]=stat; break;
+    case AOOSP_TID_READCOMST   : rec->fmt = aoosp_dlog_fmt_readcomst;    des = aoosp_des_readcomst(&tele,&val);                       rec->arg[1]=val; break;
+    case AOOSP_TID_READLEDST   : rec->fmt = aoosp_dlog_fmt_readledst;    des = aoosp_des_readledst(&tele,&val);                       rec->arg[1]=val; break;
+    case AOOSP_TID_READTEMP    : rec->fmt = aoosp_dlog_fmt_readtemp;     des = aoosp_des_readtemp(&tele,&temp);                       rec->arg[1]=temp; break;
+    case AOOSP_TID_READSETUP   : rec->fmt = aoosp_dlog_fmt_readsetup;    des = aoosp_des_readsetup(&tele,&flags);                     rec->arg[1]=flags; break;
+    case AOOSP_TID_READPWM     : rec->fmt = aoosp_dlog_fmt_readpwmchn;   des = aoosp_des_readpwmchn(&tele,&red,&green,&blue);         rec->arg[2]=red; rec->arg[3]=green; rec->arg[4]=blue; break;
+    case AOOSP_TID_READCURCHN  : rec->fmt = aoosp_dlog_fmt_readcurchn;   des = aoosp_des_readcurchn(&tele,&flags,&rcur,&gcur,&bcur);  rec->arg[2]=flags; rec->arg[3]=rcur; rec->arg[4]=gcur; rec->arg[5]=bcur; break;
+    case AOOSP_TID_READI2CCFG  : rec->fmt = aoosp_dlog_fmt_readi2ccfg;   des = aoosp_des_readi2ccfg(&tele,&flags,&val);               rec->arg[1]=flags; rec->arg[2]=val; break;
+    case AOOSP_TID_READOTP     : rec->fmt = aoosp_dlog_fmt_readotp;      des = aoosp_des_readotp(&tele,rec->bytes,8);                 rec->bytesize=8; break;
+    case AOOSP_TID_SETTESTPW_SR: rec->fmt = aoosp_dlog_fmt_settestpw_sr; des = aoosp_des_settestpw_sr(&tele,&temp,&stat);             rec->arg[1]=temp; rec->arg[2]=stat; break;
+    default                    : return aoresult_osp_tid;
+  }
+  rec->des = des;
+  return des;
+}
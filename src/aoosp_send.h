@@ -48,6 +48,54 @@
 #endif // AOOSP_LOG_ENABLED
 
 
+// Decodes response `resp` of `size` bytes with the aoosp_des_xxx() of its TID into log record `rec` (format, arg[], bytes[], des; see aoosp_dlog_format_results).
+// Inputs of the send function that are not in the response (e.g. chn) are 0; returns aoresult_osp_tid for TIDs without response.
+struct aoosp_dlog_rec_s;
+aoresult_t aoosp_send_des_rec(const uint8_t * resp, int size, struct aoosp_dlog_rec_s * rec);
+
+
+// === HOOKS ==============================================
+
+
+// When set to 1, aoosp_send time stamps every SPI transfer and calls the hooks (if set) around it; 0 (default) compiles that out, the hook functions are then stubs. May also be set with -DAOOSP_HOOKS_ENABLED=1
+#ifndef AOOSP_HOOKS_ENABLED
+  #define AOOSP_HOOKS_ENABLED 0
+#endif
+
+
+// Called just before telegram `tele` of `size` bytes with `tid` is sent; `cycles` is aoosp_cycles() at the call
+typedef void (*aoosp_hook_pretx_t)(const uint8_t * tele, int size, uint8_t tid, uint32_t cycles);
+// Called after the SPI transfer; `resp` is the response (size 0 if none), `txcycles` and `rxcycles` the aoosp_cycles() at start and end
+typedef void (*aoosp_hook_postrx_t)(const uint8_t * resp, int size, uint8_t tid, uint32_t txcycles, uint32_t rxcycles, aoresult_t result);
+#if AOOSP_HOOKS_ENABLED
+  // Sets the hooks called around every SPI transfer (0 removes one)
+  void aoosp_hooks_set(aoosp_hook_pretx_t pretx, aoosp_hook_postrx_t postrx);
+  // Gets the current hooks (e.g. to restore them after a temporary override)
+  void aoosp_hooks_get(aoosp_hook_pretx_t * pretx, aoosp_hook_postrx_t * postrx);
+#else
+  // Hooks compiled out: setting is ignored, getting returns none
+  static inline void aoosp_hooks_set(aoosp_hook_pretx_t pretx, aoosp_hook_postrx_t postrx) { (void)pretx; (void)postrx; }
+  static inline void aoosp_hooks_get(aoosp_hook_pretx_t * pretx, aoosp_hook_postrx_t * postrx) { if( pretx ) *pretx = 0; if( postrx ) *postrx = 0; }
+#endif // AOOSP_HOOKS_ENABLED
+
+
+// === CYCLES =============================================
+
+
+// Returns a free running cycle counter, used to time telegrams (wraps; use differences)
+// and cycles per microsecond: on ESP32 CPU cycles (CCOUNT), on a Linux host ns of the host clock
+// (host_ns of extras/host/Arduino.h: the steady clock, or a virtual one installed by a tool).
+#if defined(ARDUINO_ARCH_ESP32)
+  #include <Arduino.h> // ESP.getCycleCount, getCpuFrequencyMhz
+  static inline uint32_t aoosp_cycles()        { return ESP.getCycleCount(); }
+  static inline uint32_t aoosp_cycles_per_us() { return getCpuFrequencyMhz(); }
+#else
+  #include <Arduino.h> // host_ns
+  static inline uint32_t aoosp_cycles()        { return (uint32_t)host_ns(); }
+  static inline uint32_t aoosp_cycles_per_us() { return 1000; }
+#endif
+
+
 // === TELEGRAM ADDRESSES =================================
 
 
@@ -85,6 +133,53 @@
 #define AOOSP_ADDR_ISOK(addr)            ( AOOSP_ADDR_ISBROADCAST(addr) || AOOSP_ADDR_ISUNICAST(addr) || OAOSP_ADDR_ISMULTICAST(addr) )
 
 
+// === TELEGRAM IDS =======================================
+
+
+// The telegram ID (TID) is the 7 bit command code in byte 2 of every telegram (see aoosp_prt_tid() for the names).
+#define AOOSP_TID_RESET                  ( 0x00 )
+#define AOOSP_TID_CLRERROR               ( 0x01 )
+#define AOOSP_TID_INITBIDIR              ( 0x02 )
+#define AOOSP_TID_INITLOOP               ( 0x03 )
+#define AOOSP_TID_GOSLEEP                ( 0x04 )
+#define AOOSP_TID_GOACTIVE               ( 0x05 )
+#define AOOSP_TID_GODEEPSLEEP            ( 0x06 )
+#define AOOSP_TID_IDENTIFY               ( 0x07 )
+#define AOOSP_TID_ASKTINFO               ( 0x0A )
+#define AOOSP_TID_READMULT               ( 0x0C )
+#define AOOSP_TID_SETMULT                ( 0x0D )
+#define AOOSP_TID_SYNC                   ( 0x0F )
+#define AOOSP_TID_IDLE                   ( 0x11 )
+#define AOOSP_TID_FOUNDRY                ( 0x12 )
+#define AOOSP_TID_CUST                   ( 0x13 )
+#define AOOSP_TID_BURN                   ( 0x14 )
+#define AOOSP_TID_I2CREAD                ( 0x18 )
+#define AOOSP_TID_I2CWRITE               ( 0x19 )
+#define AOOSP_TID_READLAST               ( 0x1E )
+#define AOOSP_TID_GOACTIVE_SR            ( 0x25 )
+#define AOOSP_TID_READSTAT               ( 0x40 )
+#define AOOSP_TID_READTEMPSTAT           ( 0x42 )
+#define AOOSP_TID_READCOMST              ( 0x44 )
+#define AOOSP_TID_READLEDST              ( 0x46 )
+#define AOOSP_TID_READTEMP               ( 0x48 )
+#define AOOSP_TID_READSETUP              ( 0x4C )
+#define AOOSP_TID_SETSETUP               ( 0x4D )
+#define AOOSP_TID_READPWM                ( 0x4E )
+#define AOOSP_TID_SETPWM                 ( 0x4F )
+#define AOOSP_TID_READCURCHN             ( 0x50 )
+#define AOOSP_TID_SETCURCHN              ( 0x51 )
+#define AOOSP_TID_READI2CCFG             ( 0x56 )
+#define AOOSP_TID_SETI2CCFG              ( 0x57 )
+#define AOOSP_TID_READOTP                ( 0x58 )
+#define AOOSP_TID_SETOTP                 ( 0x59 )
+#define AOOSP_TID_SETTESTDATA            ( 0x5B )
+#define AOOSP_TID_SETTESTPW              ( 0x5F )
+#define AOOSP_TID_SETTESTPW_SR           ( 0x7F )
+
+// Many TIDs have a variant with status request (SR): the node then responds with its status.
+#define AOOSP_TID_SR                     ( 0x20 )
+
+
 // === TELEGRAMS ==========================================
 
 
@@ -0,0 +1,211 @@
+// aoosp_sweep.cpp - reads node status round robin, a few nodes per frame
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>      // micros, millis
+#include <string.h>       // memset
+#include <aoosp_send.h>   // aoosp_send_readtempstat
+#include <aoosp_sweep.h>  // own API
+
+
+// Sweep
+// =====
+// Reading READTEMPSTAT of all nodes in one go takes a large block of bus time
+// (1000 nodes is in the order of 100ms), so it is done rarely, and short
+// fault events are missed. The sweep instead reads a few (K) nodes per frame,
+// round robin, and keeps a table with the last temperature and status of
+// every node, together with the time it was read (so its age is known).
+//
+// The application configures the coverage time: the time in which all nodes
+// must be read once. The sweep measures the frame period (time between calls
+// of aoosp_sweep_step), and derives K = N * frame / coverage. The per frame
+// bus-time budget caps K; if the budget is too small the achieved coverage
+// time will be longer than configured; both are reported in the statistics.
+//
+// When the error flags (the status bits in the configured mask) of a node
+// change, the callback is invoked. The first read of a node (after init)
+// establishes the flags and does not invoke the callback.
+
+
+// Table entry for one node
+typedef struct aoosp_sweep_node_s {
+  uint8_t  temp;    // Raw temperature
+  uint8_t  stat;    // Status byte
+  uint8_t  valid;   // 1 if temp and stat are read
+  uint32_t timems;  // Time (millis) of read
+} aoosp_sweep_node_t;
+
+
+static aoosp_sweep_node_t  aoosp_sweep_nodes[AOOSP_SWEEP_MAXNODES+1]; // index 0 unused
+static uint16_t            aoosp_sweep_last;
+static uint16_t            aoosp_sweep_next;       // Next node to read
+static uint8_t             aoosp_sweep_mask;
+static aoosp_sweep_cb_t    aoosp_sweep_cb;
+static uint32_t            aoosp_sweep_startms;    // Start of the current sweep
+static uint32_t            aoosp_sweep_stepus;     // Time of the previous step (to measure frame period)
+static uint32_t            aoosp_sweep_frameus;    // Measured frame period (running average)
+static uint32_t            aoosp_sweep_readus;     // Measured time of one READTEMPSTAT (running average)
+static aoosp_sweep_stats_t aoosp_sweep_stats;
+
+
+/*!
+    @brief  Configures the sweep.
+    @param  last
+            The address of the last node in the chain,
+            e.g. from aoosp_exec_resetinit().
+    @param  coverms
+            The target time (in ms) for reading all nodes once.
+    @param  cb
+            Function called when the (masked) error flags of a node change
+            (may be NULL).
+    @param  mask
+            The status bits that are considered error flags
+            (combination of AOOSP_STAT_FLAGS_XXX).
+    @note   Clears the table and the statistics.
+*/
+void aoosp_sweep_init(uint16_t last, uint32_t coverms, aoosp_sweep_cb_t cb, uint8_t mask) {
+  if( last>AOOSP_SWEEP_MAXNODES ) last= AOOSP_SWEEP_MAXNODES;
+  memset( aoosp_sweep_nodes, 0, sizeof aoosp_sweep_nodes );
+  memset( &aoosp_sweep_stats, 0, sizeof aoosp_sweep_stats );
+  aoosp_sweep_last    = last;
+  aoosp_sweep_next    = AOOSP_ADDR_UNICASTMIN;
+  aoosp_sweep_mask    = mask;
+  aoosp_sweep_cb      = cb;
+  aoosp_sweep_startms = millis();
+  aoosp_sweep_stepus  = 0;
+  aoosp_sweep_frameus = 0;
+  aoosp_sweep_readus  = 100;
+  aoosp_sweep_stats.targetms = coverms;
+}
+
+
+/*!
+    @brief  Reads the next K nodes of the sweep with READTEMPSTAT, updates
+            the table and invokes the callback for changed error flags.
+    @param  budgetus
+            The bus time (in us) that may be spent in this call.
+    @return aoresult_ok if all ok, otherwise the error of the first
+            failing READTEMPSTAT (the sweep continues with the next node).
+    @note   Intended to be called once per frame.
+    @note   K is derived from the target coverage time and the measured
+            frame period, but capped by the budget.
+*/
+aoresult_t aoosp_sweep_step(uint32_t budgetus) {
+  aoresult_t firsterror = aoresult_ok;
+  if( aoosp_sweep_last==0 ) return aoresult_ok;
+  uint32_t startus = micros();
+
+  // Measure frame period (running average, weight 1/8)
+  if( aoosp_sweep_stepus!=0 ) {
+    uint32_t frameus = startus - aoosp_sweep_stepus;
+    aoosp_sweep_frameus = aoosp_sweep_frameus==0 ? frameus : aoosp_sweep_frameus + ((int32_t)frameus-(int32_t)aoosp_sweep_frameus)/8;
+  }
+  aoosp_sweep_stepus = startus;
+
+  // Nodes per frame needed to meet the coverage time (at least 1)
+  uint32_t kneeded = 1;
+  if( aoosp_sweep_frameus>0 && aoosp_sweep_stats.targetms>0 ) {
+    uint64_t num = (uint64_t)aoosp_sweep_last * aoosp_sweep_frameus;
+    uint64_t den = (uint64_t)aoosp_sweep_stats.targetms * 1000;
+    kneeded = (num + den - 1) / den;
+    if( kneeded<1 ) kneeded= 1;
+  }
+  aoosp_sweep_stats.kneeded = kneeded;
+
+  uint16_t k = 0;
+  while( k<kneeded && micros()-startus+aoosp_sweep_readus <= budgetus ) {
+    uint16_t addr = aoosp_sweep_next;
+    uint8_t  temp, stat;
+    uint32_t t0us = micros();
+    aoresult_t result = aoosp_send_readtempstat(addr, &temp, &stat);
+    uint32_t t1us = micros();
+    aoosp_sweep_readus += ((int32_t)(t1us-t0us) - (int32_t)aoosp_sweep_readus) / 8;
+    aoosp_sweep_stats.reads++;
+    k++;
+    if( result==aoresult_ok ) {
+      aoosp_sweep_node_t * n = &aoosp_sweep_nodes[addr];
+      uint8_t oldstat = n->stat;
+      int     first   = !n->valid;
+      n->temp   = temp;
+      n->stat   = stat;
+      n->valid  = 1;
+      n->timems = millis();
+      if( !first && ((oldstat^stat) & aoosp_sweep_mask) ) {
+        aoosp_sweep_stats.events++;
+        if( aoosp_sweep_cb ) aoosp_sweep_cb(addr, oldstat, stat);
+      }
+    } else {
+      aoosp_sweep_stats.errors++;
+      if( firsterror==aoresult_ok ) firsterror= result;
+    }
+    // Advance, wrapping around at the end of the chain
+    if( addr>=aoosp_sweep_last ) {
+      uint32_t nowms = millis();
+      aoosp_sweep_stats.coverms = nowms - aoosp_sweep_startms;
+      aoosp_sweep_stats.sweeps++;
+      aoosp_sweep_startms = nowms;
+      aoosp_sweep_next = AOOSP_ADDR_UNICASTMIN;
+    } else {
+      aoosp_sweep_next = addr+1;
+    }
+  }
+  aoosp_sweep_stats.k = k;
+
+  return firsterror;
+}
+
+
+/*!
+    @brief  Gets the table entry of a node.
+    @param  addr
+            The address of the node (1..last).
+    @param  temp
+            Output parameter returning the raw temperature.
+    @param  stat
+            Output parameter returning the status byte.
+    @param  agems
+            Output parameter returning the age (in ms) of temp and stat.
+    @return aoresult_ok        if all ok,
+            aoresult_osp_addr  if addr is not in the sweep,
+            aoresult_osp_arg   if the node is not (yet) read successfully.
+*/
+aoresult_t aoosp_sweep_get(uint16_t addr, uint8_t * temp, uint8_t * stat, uint32_t * agems) {
+  if( temp==0 || stat==0 || agems==0 ) return aoresult_outargnull;
+  if( addr<AOOSP_ADDR_UNICASTMIN || addr>aoosp_sweep_last ) return aoresult_osp_addr;
+  aoosp_sweep_node_t * n = &aoosp_sweep_nodes[addr];
+  if( !n->valid ) return aoresult_osp_arg;
+  *temp  = n->temp;
+  *stat  = n->stat;
+  *agems = millis() - n->timems;
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Gets the statistics of the sweep.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+    @note   Compare `coverms` (achieved) with `targetms` (configured);
+            when `k` stays below `kneeded` the budget is too small.
+*/
+void aoosp_sweep_stats_get(aoosp_sweep_stats_t * stats) {
+  if( stats ) *stats = aoosp_sweep_stats;
+}
@@ -0,0 +1,61 @@
+// aoosp_sweep.h - reads node status round robin, a few nodes per frame
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_SWEEP_H_
+#define _AOOSP_SWEEP_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+#include <aoosp_send.h> // AOOSP_ADDR_UNICASTMAX
+
+
+// Number of entries in the status table (addresses 001..AOOSP_SWEEP_MAXNODES)
+#define AOOSP_SWEEP_MAXNODES    AOOSP_ADDR_UNICASTMAX
+
+
+// Signature of the callback called when the error flags (masked) of node `addr` change from `oldstat` to `newstat`.
+typedef void (*aoosp_sweep_cb_t)(uint16_t addr, uint8_t oldstat, uint8_t newstat);
+
+
+// Statistics of the sweep (see aoosp_sweep_stats_get)
+typedef struct aoosp_sweep_stats_s {
+  uint32_t reads;       // Number of READTEMPSTAT telegrams sent
+  uint32_t errors;      // Number of READTEMPSTAT telegrams that failed
+  uint32_t events;      // Number of error flag changes reported
+  uint32_t sweeps;      // Number of completed sweeps (full coverage)
+  uint32_t coverms;     // Duration of the last completed sweep (achieved coverage time)
+  uint32_t targetms;    // Configured coverage time
+  uint16_t k;           // Number of nodes read in the last step
+  uint16_t kneeded;     // Number of nodes per step needed to meet the target coverage time
+} aoosp_sweep_stats_t;
+
+
+// Configures a sweep over nodes 1..last, covering all of them in `coverms`; clears the table and stats.
+void       aoosp_sweep_init(uint16_t last, uint32_t coverms, aoosp_sweep_cb_t cb=0, uint8_t mask=AOOSP_STAT_FLAGS_SAID_ERRORS);
+// Reads the next K nodes (K from the coverage time and frame rate, limited by `budgetus`).
+aoresult_t aoosp_sweep_step(uint32_t budgetus);
+// Gets the table entry for node `addr`: raw temperature, status, and age in ms.
+aoresult_t aoosp_sweep_get(uint16_t addr, uint8_t * temp, uint8_t * stat, uint32_t * agems);
+// Gets the statistics (including achieved coverage time).
+void       aoosp_sweep_stats_get(aoosp_sweep_stats_t * stats);
+
+
+#endif
@@ -0,0 +1,241 @@
+// aoosp_syncmeas.cpp - measures latency and skew of SYNC telegram versus SYNC pin
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>        // pinMode, digitalWrite, delayMicroseconds, sqrt
+#include <aoosp_send.h>     // aoosp_send_sync, aoosp_cycles
+#include <aoosp_syncmeas.h> // own API
+
+
+// SYNC measurement
+// ================
+// Nodes can activate staged PWM settings (channels with
+// AOOSP_CURCHN_FLAGS_SYNCEN) on a commit: a broadcast SYNC telegram, or a
+// pulse on their SYNC pin (when SYNC_PIN_EN is set in OTP, see
+// aoosp_exec_syncpinenable_set). The telegram travels the chain, so each
+// node activates one forwarding delay later than its predecessor; the pin
+// reaches all nodes at (nearly) the same time, but needs wiring.
+//
+// This module measures both. aoosp_syncmeas_commit() time stamps the
+// commit request and triggers it. An observer reports when each node
+// activated: on a target e.g. GPIO interrupts on loopback wires from LED
+// drivers (see example aoosp_syncmeas), on a PC a simulator (see
+// extras/host/aoosp_syncsim). aoosp_syncmeas_close() then adds the latency
+// (commit request to activation, per node) and the skew (last minus first
+// activation of the commit) to the statistics of the method.
+//
+// The spread of all latencies is not jitter: with the telegram node i
+// activates i-1 forwarding delays after node 1, so on a long chain the
+// spread mostly measures the chain. Jitter is the variation of a node from
+// commit to commit; it is taken from the first and the last activation of
+// each commit (on a chain the nearest and the farthest observed node).
+//
+// Only the first and last activation of a commit are kept, so any number
+// of nodes can be observed without memory per node.
+
+
+static int8_t   aoosp_syncmeas_pin = -1;
+static int8_t   aoosp_syncmeas_method = -1; // method of the open window, -1 when none
+static uint32_t aoosp_syncmeas_t0;          // time stamp of the commit request
+static uint32_t aoosp_syncmeas_first;       // earliest activation (relative to t0) in the window
+static uint32_t aoosp_syncmeas_last;        // latest activation (relative to t0) in the window
+static uint32_t aoosp_syncmeas_count;       // activations in the window
+
+
+// Running sums per method
+typedef struct aoosp_syncmeas_acc_s {
+  uint32_t commits, missed, observed;
+  uint32_t latmin, latmax, skewmin, skewmax;
+  double   latsum, latsum2, skewsum;
+  double   firstsum, firstsum2, lastsum, lastsum2; // first and last activation per commit (jitter)
+} aoosp_syncmeas_acc_t;
+#define AOOSP_SYNCMEAS_ACC_INIT { 0,0,0, UINT32_MAX,0,UINT32_MAX,0, 0,0,0, 0,0,0,0 }
+static aoosp_syncmeas_acc_t aoosp_syncmeas_acc[AOOSP_SYNCMEAS_METHODS] = { AOOSP_SYNCMEAS_ACC_INIT, AOOSP_SYNCMEAS_ACC_INIT };
+
+
+static const char * aoosp_syncmeas_names[AOOSP_SYNCMEAS_METHODS] = { "telegram", "pin" };
+
+
+/*!
+    @brief  Returns the name of a method.
+    @param  method
+            The method.
+    @return "telegram", "pin", or "unknown".
+*/
+const char * aoosp_syncmeas_method_str(aoosp_syncmeas_method_t method) {
+  if( (unsigned)method>=AOOSP_SYNCMEAS_METHODS ) return "unknown";
+  return aoosp_syncmeas_names[method];
+}
+
+
+/*!
+    @brief  Sets the GPIO wired to the SYNC pins of the nodes.
+    @param  pin
+            The GPIO (e.g. 9 on the OSP32 board, jumper J8), or -1 for none.
+    @note   The GPIO is configured as output, idle level high.
+*/
+void aoosp_syncmeas_pin_set(int pin) {
+  aoosp_syncmeas_pin = pin;
+  if( pin<0 ) return;
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, HIGH);
+}
+
+
+/*!
+    @brief  Clears all statistics.
+*/
+void aoosp_syncmeas_reset() {
+  const aoosp_syncmeas_acc_t init = AOOSP_SYNCMEAS_ACC_INIT;
+  for( int m=0; m<AOOSP_SYNCMEAS_METHODS; m++ ) aoosp_syncmeas_acc[m] = init;
+  aoosp_syncmeas_method = -1;
+}
+
+
+/*!
+    @brief  Time stamps a commit request and triggers it.
+    @param  method
+            aoosp_syncmeas_method_telegram sends a broadcast SYNC,
+            aoosp_syncmeas_method_pin pulses the SYNC pin.
+    @return aoresult_ok, or the result of aoosp_send_sync(), or
+            aoresult_osp_arg for an unknown method or when there is no pin
+            (aoosp_syncmeas_pin_set).
+    @note   Opens a measurement window; an open window of an earlier commit
+            is closed first. The time stamp is taken before the telegram is
+            constructed (or the pin is driven), so latency is end-to-end.
+*/
+aoresult_t aoosp_syncmeas_commit(aoosp_syncmeas_method_t method) {
+  if( (unsigned)method>=AOOSP_SYNCMEAS_METHODS ) return aoresult_osp_arg;
+  if( method==aoosp_syncmeas_method_pin && aoosp_syncmeas_pin<0 ) return aoresult_osp_arg;
+  aoosp_syncmeas_close();
+  aoosp_syncmeas_method = method;
+  aoosp_syncmeas_count = 0;
+  aoosp_syncmeas_first = UINT32_MAX;
+  aoosp_syncmeas_last = 0;
+  aoosp_syncmeas_t0 = aoosp_cycles();
+  if( method==aoosp_syncmeas_method_telegram ) return aoosp_send_sync(0x000);
+  // SYNC pin must be pulsed for at least 3 clock cycles of the device
+  digitalWrite(aoosp_syncmeas_pin, LOW);
+  delayMicroseconds(2);
+  digitalWrite(aoosp_syncmeas_pin, HIGH);
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Returns the time stamp of the last commit request.
+    @return aoosp_cycles() at the last aoosp_syncmeas_commit().
+    @note   Useful for simulators that compute activation times.
+*/
+uint32_t aoosp_syncmeas_committed() {
+  return aoosp_syncmeas_t0;
+}
+
+
+/*!
+    @brief  Records the activation of a node.
+    @param  addr
+            The address of the node (informational).
+    @param  cycles
+            aoosp_cycles() time stamp of the activation.
+    @note   Ignored when no measurement window is open. Not for use in an
+            ISR: let the ISR store the time stamp, and call this afterwards.
+*/
+void aoosp_syncmeas_observe(uint16_t addr, uint32_t cycles) {
+  (void)addr;
+  if( aoosp_syncmeas_method<0 ) return;
+  uint32_t lat = cycles - aoosp_syncmeas_t0;
+  aoosp_syncmeas_acc_t * acc = &aoosp_syncmeas_acc[aoosp_syncmeas_method];
+  if( lat<aoosp_syncmeas_first ) aoosp_syncmeas_first = lat;
+  if( lat>aoosp_syncmeas_last  ) aoosp_syncmeas_last = lat;
+  aoosp_syncmeas_count++;
+  acc->observed++;
+  if( lat<acc->latmin ) acc->latmin = lat;
+  if( lat>acc->latmax ) acc->latmax = lat;
+  acc->latsum += lat;
+  acc->latsum2+= (double)lat*lat;
+}
+
+
+/*!
+    @brief  Closes the measurement window of the last commit.
+    @note   Adds the skew, and the first and last activation, of the commit
+            to the statistics, or counts the commit as missed when no activation was observed. Does nothing
+            when no window is open.
+*/
+void aoosp_syncmeas_close() {
+  if( aoosp_syncmeas_method<0 ) return;
+  aoosp_syncmeas_acc_t * acc = &aoosp_syncmeas_acc[aoosp_syncmeas_method];
+  aoosp_syncmeas_method = -1;
+  acc->commits++;
+  if( aoosp_syncmeas_count==0 ) { acc->missed++; return; }
+  uint32_t skew = aoosp_syncmeas_last - aoosp_syncmeas_first;
+  if( skew<acc->skewmin ) acc->skewmin = skew;
+  if( skew>acc->skewmax ) acc->skewmax = skew;
+  acc->skewsum+= skew;
+  acc->firstsum += aoosp_syncmeas_first;
+  acc->firstsum2+= (double)aoosp_syncmeas_first*aoosp_syncmeas_first;
+  acc->lastsum  += aoosp_syncmeas_last;
+  acc->lastsum2 += (double)aoosp_syncmeas_last*aoosp_syncmeas_last;
+}
+
+
+// Standard deviation of n values, from their sum and sum of squares
+static float aoosp_syncmeas_std(double sum, double sum2, uint32_t n) {
+  if( n==0 ) return 0;
+  double mean = sum/n;
+  double var  = sum2/n - mean*mean;
+  return var>0 ? sqrt(var) : 0;
+}
+
+
+/*!
+    @brief  Gets the statistics of a method.
+    @param  method
+            The method.
+    @param  stat
+            Output parameter receiving the statistics.
+    @return aoresult_ok, or aoresult_outargnull, or aoresult_osp_arg for an
+            unknown method.
+    @note   Minimums are 0 when there are no observations.
+    @note   latspread is over all activations (all nodes of all commits);
+            jitter is per node over the commits (see top of this file).
+*/
+aoresult_t aoosp_syncmeas_get(aoosp_syncmeas_method_t method, aoosp_syncmeas_stat_t * stat) {
+  if( stat==0 ) return aoresult_outargnull;
+  if( (unsigned)method>=AOOSP_SYNCMEAS_METHODS ) return aoresult_osp_arg;
+  const aoosp_syncmeas_acc_t * acc = &aoosp_syncmeas_acc[method];
+  uint32_t skews = acc->commits - acc->missed;
+  stat->commits  = acc->commits;
+  stat->missed   = acc->missed;
+  stat->observed = acc->observed;
+  stat->latmin   = acc->observed ? acc->latmin : 0;
+  stat->latmax   = acc->latmax;
+  stat->latmean  = acc->observed ? acc->latsum/acc->observed : 0;
+  stat->latspread= aoosp_syncmeas_std(acc->latsum, acc->latsum2, acc->observed);
+  float jitfirst = aoosp_syncmeas_std(acc->firstsum, acc->firstsum2, skews);
+  float jitlast  = aoosp_syncmeas_std(acc->lastsum, acc->lastsum2, skews);
+  stat->jitter   = jitfirst>jitlast ? jitfirst : jitlast;
+  stat->skewmin  = skews ? acc->skewmin : 0;
+  stat->skewmax  = acc->skewmax;
+  stat->skewmean = skews ? acc->skewsum/skews : 0;
+  return aoresult_ok;
+}
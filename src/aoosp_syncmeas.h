@@ -0,0 +1,71 @@
+// aoosp_syncmeas.h - measures latency and skew of SYNC telegram versus SYNC pin
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_SYNCMEAS_H_
+#define _AOOSP_SYNCMEAS_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// How a commit (activation of staged PWM settings) is triggered
+typedef enum aoosp_syncmeas_method_e {
+  aoosp_syncmeas_method_telegram,  // Broadcast SYNC telegram
+  aoosp_syncmeas_method_pin,       // Pulse on the SYNC pin of the nodes (SYNC_PIN_EN in OTP)
+} aoosp_syncmeas_method_t;
+#define AOOSP_SYNCMEAS_METHODS 2
+
+
+// Statistics of one method; times are in cycles (see aoosp_cycles)
+typedef struct aoosp_syncmeas_stat_s {
+  uint32_t commits;      // Number of commits measured
+  uint32_t missed;       // Number of commits without any observed activation
+  uint32_t observed;     // Number of node activations observed
+  uint32_t latmin;       // Shortest latency (commit request to activation of a node)
+  uint32_t latmax;       // Longest latency
+  float    latmean;      // Mean latency
+  float    latspread;    // Standard deviation of all latencies (mostly the spread along the chain)
+  float    jitter;       // Standard deviation over the commits of the first or last activation (larger)
+  uint32_t skewmin;      // Smallest skew (last minus first activation of one commit)
+  uint32_t skewmax;      // Largest skew
+  float    skewmean;     // Mean skew
+} aoosp_syncmeas_stat_t;
+
+
+// Sets the GPIO wired to the SYNC pins of the nodes (-1 for none, default); configures it as output, idle high.
+void         aoosp_syncmeas_pin_set(int pin);
+// Time stamps a commit request and triggers it with `method`; opens a measurement window.
+aoresult_t   aoosp_syncmeas_commit(aoosp_syncmeas_method_t method);
+// Returns the aoosp_cycles() time stamp of the last commit request.
+uint32_t     aoosp_syncmeas_committed();
+// Records that node `addr` activated at aoosp_cycles() time stamp `cycles` (call from the observer, not from an ISR).
+void         aoosp_syncmeas_observe(uint16_t addr, uint32_t cycles);
+// Closes the measurement window of the last commit; adds its latency and skew to the statistics.
+void         aoosp_syncmeas_close();
+// Gets the statistics of `method`.
+aoresult_t   aoosp_syncmeas_get(aoosp_syncmeas_method_t method, aoosp_syncmeas_stat_t * stat);
+// Clears all statistics.
+void         aoosp_syncmeas_reset();
+// Returns the name of a method ("telegram" or "pin").
+const char * aoosp_syncmeas_method_str(aoosp_syncmeas_method_t method);
+
+
+#endif
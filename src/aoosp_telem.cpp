@@ -0,0 +1,305 @@
+// aoosp_telem.cpp - binary telemetry record stream with pluggable sink
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>      // micros, Serial
+#include <aoosp_crc.h>    // aoosp_crc
+#include <aoosp_sweep.h>  // aoosp_sweep_get
+#include <aoosp_telem.h>  // own API
+#if defined(__linux__)
+#include <unistd.h>       // write
+#endif
+
+
+// Telemetry
+// =========
+// Printing telemetry with Serial.printf is slow to produce (formatting on
+// the task that drives the bus) and slow to parse. This module writes
+// telemetry as compact binary records (see AOOSP_TELEM_xxx in the header)
+// into a ring buffer. Queuing a record is a copy of a dozen bytes; there is
+// no formatting on the target at all. A flush, called from another task or
+// when the bus task is idle, moves the bytes from the ring to a sink: Serial
+// (aoosp_telem_sink_serial), or on Linux host builds a file or socket
+// (aoosp_telem_sink_fd). The script extras/aoosp_telem.py converts the
+// stream to CSV or JSON on the host.
+//
+// The ring has a single producer (the queue functions) and a single consumer
+// (aoosp_telem_flush), which may run on different cores; head and tail are
+// published with release/acquire ordering, so no lock is needed. When the
+// ring is full, records are dropped (never partially queued), and the next
+// record that fits is preceded by a DROP record with the number dropped.
+
+
+static uint8_t             aoosp_telem_ring[AOOSP_TELEM_RINGSIZE];
+static uint32_t            aoosp_telem_head;  // written by producer only
+static uint32_t            aoosp_telem_tail;  // written by consumer only
+static uint32_t            aoosp_telem_drops; // dropped since the last DROP record
+static aoosp_telem_sink_t  aoosp_telem_sinkfn;
+static aoosp_telem_stats_t aoosp_telem_stats;
+
+
+/*!
+    @brief  Sets the sink, and clears the ring and the statistics.
+    @param  sink
+            The function that flush writes the bytes to,
+            e.g. aoosp_telem_sink_serial.
+    @note   Must not run concurrently with the queue or flush functions.
+*/
+void aoosp_telem_init(aoosp_telem_sink_t sink) {
+  aoosp_telem_sinkfn = sink;
+  aoosp_telem_head   = 0;
+  aoosp_telem_tail   = 0;
+  aoosp_telem_drops  = 0;
+  memset( &aoosp_telem_stats, 0, sizeof aoosp_telem_stats );
+}
+
+
+// Queues one record of `type` with payload; the u32 time stamp is prepended. Returns 1 if queued, 0 if dropped.
+static int aoosp_telem_put(uint8_t type, const uint8_t * payload, int size) {
+  uint8_t rec[3+4+36+1+3+4+4+1]; // room for a DROP record in front of the largest record
+  int     n = 0;
+  uint32_t now = micros();
+  if( aoosp_telem_drops>0 ) {
+    int m = n;
+    rec[n++] = AOOSP_TELEM_SYNC; rec[n++] = AOOSP_TELEM_DROP; rec[n++] = 8;
+    memcpy( &rec[n], &now, 4 ); n+=4;
+    memcpy( &rec[n], &aoosp_telem_drops, 4 ); n+=4;
+    rec[n] = aoosp_crc(&rec[m],n-m); n++;
+  }
+  int m = n;
+  rec[n++] = AOOSP_TELEM_SYNC; rec[n++] = type; rec[n++] = 4+size;
+  memcpy( &rec[n], &now, 4 ); n+=4;
+  memcpy( &rec[n], payload, size ); n+=size;
+  rec[n] = aoosp_crc(&rec[m],n-m); n++;
+
+  uint32_t head = aoosp_telem_head;
+  uint32_t tail = __atomic_load_n(&aoosp_telem_tail, __ATOMIC_ACQUIRE);
+  uint32_t used = head - tail;
+  if( used + n > AOOSP_TELEM_RINGSIZE ) {
+    aoosp_telem_drops++;
+    aoosp_telem_stats.dropped++;
+    return 0;
+  }
+  for( int i=0; i<n; i++ ) aoosp_telem_ring[(head+i) % AOOSP_TELEM_RINGSIZE] = rec[i];
+  __atomic_store_n(&aoosp_telem_head, head+n, __ATOMIC_RELEASE);
+  if( used+n > aoosp_telem_stats.highwater ) aoosp_telem_stats.highwater = used+n;
+  aoosp_telem_drops = 0;
+  aoosp_telem_stats.records++;
+  aoosp_telem_stats.queued += n;
+  return 1;
+}
+
+
+/*!
+    @brief  Queues a node table row.
+    @param  addr
+            The address of the node.
+    @param  temp
+            The raw temperature of the node.
+    @param  stat
+            The status byte of the node.
+    @param  agems
+            The age of temp and stat in ms.
+    @return 1 if queued, 0 if dropped because the ring is full.
+*/
+int aoosp_telem_node(uint16_t addr, uint8_t temp, uint8_t stat, uint32_t agems) {
+  uint8_t p[8];
+  memcpy( &p[0], &addr, 2 );
+  p[2] = temp;
+  p[3] = stat;
+  memcpy( &p[4], &agems, 4 );
+  return aoosp_telem_put(AOOSP_TELEM_NODE, p, sizeof p);
+}
+
+
+/*!
+    @brief  Queues a status change of a node.
+    @param  addr
+            The address of the node.
+    @param  oldstat
+            The previous status byte.
+    @param  newstat
+            The new status byte.
+    @return 1 if queued, 0 if dropped because the ring is full.
+    @note   Fits the callback of aoosp_sweep_init().
+*/
+int aoosp_telem_stat(uint16_t addr, uint8_t oldstat, uint8_t newstat) {
+  uint8_t p[4];
+  memcpy( &p[0], &addr, 2 );
+  p[2] = oldstat;
+  p[3] = newstat;
+  return aoosp_telem_put(AOOSP_TELEM_STAT, p, sizeof p);
+}
+
+
+/*!
+    @brief  Queues a temperature sample of a node.
+    @param  addr
+            The address of the node.
+    @param  temp
+            The raw temperature.
+    @return 1 if queued, 0 if dropped because the ring is full.
+*/
+int aoosp_telem_temp(uint16_t addr, uint8_t temp) {
+  uint8_t p[3];
+  memcpy( &p[0], &addr, 2 );
+  p[2] = temp;
+  return aoosp_telem_put(AOOSP_TELEM_TEMP, p, sizeof p);
+}
+
+
+/*!
+    @brief  Queues a raw data sample.
+    @param  addr
+            The address of the node the data belongs to.
+    @param  id
+            An application defined identifier of the data, e.g. a task
+            of aoosp_i2csched.
+    @param  data
+            The bytes of the sample.
+    @param  count
+            The number of bytes (0..32).
+    @return 1 if queued, 0 if dropped (ring full, or count too large).
+*/
+int aoosp_telem_data(uint16_t addr, uint8_t id, const uint8_t * data, int count) {
+  if( count<0 || count>32 || (count>0 && data==0) ) return 0;
+  uint8_t p[3+32];
+  memcpy( &p[0], &addr, 2 );
+  p[2] = id;
+  if( count>0 ) memcpy( &p[3], data, count );
+  return aoosp_telem_put(AOOSP_TELEM_DATA, p, 3+count);
+}
+
+
+/*!
+    @brief  Queues the aoosp_sweep table rows of a range of nodes.
+    @param  first
+            The address of the first node.
+    @param  last
+            The address of the last node.
+    @return The number of rows queued (nodes not yet read are skipped).
+    @note   4 kB ring holds about 200 rows; flush in between for long chains.
+*/
+int aoosp_telem_table(uint16_t first, uint16_t last) {
+  int count = 0;
+  for( uint16_t addr=first; addr<=last; addr++ ) {
+    uint8_t  temp, stat;
+    uint32_t agems;
+    if( aoosp_sweep_get(addr,&temp,&stat,&agems)!=aoresult_ok ) continue;
+    count += aoosp_telem_node(addr,temp,stat,agems);
+  }
+  return count;
+}
+
+
+/*!
+    @brief  Writes bytes from the ring to the sink.
+    @param  maxbytes
+            The maximum number of bytes to write in this call.
+    @return The number of bytes written.
+    @note   Stops early when the sink accepts fewer bytes than offered.
+    @note   Call from another task than the bus task, or when the bus is idle.
+*/
+int aoosp_telem_flush(int maxbytes) {
+  if( aoosp_telem_sinkfn==0 ) return 0;
+  uint32_t t0us = micros();
+  uint32_t tail = aoosp_telem_tail;
+  uint32_t head = __atomic_load_n(&aoosp_telem_head, __ATOMIC_ACQUIRE);
+  int      total= 0;
+  while( head!=tail && total<maxbytes ) {
+    // Contiguous part of the ring
+    uint32_t ix  = tail % AOOSP_TELEM_RINGSIZE;
+    int      len = head - tail;
+    if( len > AOOSP_TELEM_RINGSIZE - (int)ix ) len = AOOSP_TELEM_RINGSIZE - ix;
+    if( len > maxbytes - total ) len = maxbytes - total;
+    int n = aoosp_telem_sinkfn(&aoosp_telem_ring[ix], len);
+    if( n<=0 ) break;
+    tail  += n;
+    total += n;
+    __atomic_store_n(&aoosp_telem_tail, tail, __ATOMIC_RELEASE);
+    if( n<len ) break;
+  }
+  aoosp_telem_stats.written += total;
+  aoosp_telem_stats.flushus += micros() - t0us;
+  return total;
+}
+
+
+/*!
+    @brief  Gets the statistics of the writer.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+    @note   `written` over time gives the throughput of the sink,
+            `flushus` the CPU time spent to achieve it.
+*/
+void aoosp_telem_stats_get(aoosp_telem_stats_t * stats) {
+  if( stats ) *stats = aoosp_telem_stats;
+}
+
+
+/*!
+    @brief  Sink writing to Serial.
+    @param  buf
+            The bytes to write.
+    @param  size
+            The number of bytes to write.
+    @return The number of bytes written; never blocks, so this may be
+            less than size (limited by the Serial transmit buffer).
+    @note   Serial then carries binary data only; do not mix with prints.
+*/
+int aoosp_telem_sink_serial(const uint8_t * buf, int size) {
+  int n = Serial.availableForWrite();
+  if( n>size ) n = size;
+  if( n<=0 ) return 0;
+  return Serial.write(buf,n);
+}
+
+
+#if defined(__linux__)
+static int aoosp_telem_fd = -1;
+
+
+/*!
+    @brief  Sets the file descriptor used by aoosp_telem_sink_fd.
+    @param  fd
+            A file descriptor of an open file, pipe or (connected) socket.
+    @note   Only in host builds on Linux.
+*/
+void aoosp_telem_sink_fd_set(int fd) {
+  aoosp_telem_fd = fd;
+}
+
+
+/*!
+    @brief  Sink writing to a file descriptor (file, pipe or socket).
+    @param  buf
+            The bytes to write.
+    @param  size
+            The number of bytes to write.
+    @return The number of bytes written (0 on error, or no descriptor set).
+    @note   Only in host builds on Linux.
+*/
+int aoosp_telem_sink_fd(const uint8_t * buf, int size) {
+  if( aoosp_telem_fd<0 ) return 0;
+  ssize_t n = write(aoosp_telem_fd, buf, size);
+  return n>0 ? (int)n : 0;
+}
+#endif
@@ -0,0 +1,84 @@
+// aoosp_telem.h - binary telemetry record stream with pluggable sink
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_TELEM_H_
+#define _AOOSP_TELEM_H_
+
+
+#include <stdint.h>
+
+
+// Size of the record ring buffer in bytes (power of 2)
+#define AOOSP_TELEM_RINGSIZE  4096
+
+
+// Record layout: sync, type, payload size, payload (little endian), crc (aoosp_crc over all preceding bytes)
+#define AOOSP_TELEM_SYNC      0xA5
+// Record types; all payloads start with a u32 time stamp (micros)
+#define AOOSP_TELEM_NODE      0x01 // u16 addr, u8 temp, u8 stat, u32 age in ms (node table row)
+#define AOOSP_TELEM_STAT      0x02 // u16 addr, u8 old stat, u8 new stat (status change)
+#define AOOSP_TELEM_TEMP      0x03 // u16 addr, u8 temp (temperature sample)
+#define AOOSP_TELEM_DATA      0x04 // u16 addr, u8 id, u8[] data (raw sample, e.g. I2C sensor)
+#define AOOSP_TELEM_DROP      0x05 // u32 number of records dropped (ring full) before this one
+
+
+// Signature of a sink: writes (at most) `size` bytes from `buf`, returns number of bytes written.
+typedef int (*aoosp_telem_sink_t)(const uint8_t * buf, int size);
+
+
+// Statistics of the writer (see aoosp_telem_stats_get)
+typedef struct aoosp_telem_stats_s {
+  uint32_t records;     // Number of records queued
+  uint32_t dropped;     // Number of records dropped (ring full)
+  uint32_t queued;      // Number of bytes queued
+  uint32_t written;     // Number of bytes written to the sink
+  uint32_t flushus;     // Time spent in aoosp_telem_flush (us)
+  uint16_t highwater;   // Max number of bytes waiting in the ring
+} aoosp_telem_stats_t;
+
+
+// Sets the sink and clears ring and statistics.
+void aoosp_telem_init(aoosp_telem_sink_t sink);
+// Queues a node table row; returns 1 if queued, 0 if dropped (these functions run on the bus task; they only copy).
+int  aoosp_telem_node(uint16_t addr, uint8_t temp, uint8_t stat, uint32_t agems);
+// Queues a status change.
+int  aoosp_telem_stat(uint16_t addr, uint8_t oldstat, uint8_t newstat);
+// Queues a temperature sample.
+int  aoosp_telem_temp(uint16_t addr, uint8_t temp);
+// Queues a raw data sample of `count` (at most 32) bytes.
+int  aoosp_telem_data(uint16_t addr, uint8_t id, const uint8_t * data, int count);
+// Queues a node row for each node first..last in the aoosp_sweep table; returns the number queued.
+int  aoosp_telem_table(uint16_t first, uint16_t last);
+// Writes at most `maxbytes` from the ring to the sink (call from another task, or when idle); returns bytes written.
+int  aoosp_telem_flush(int maxbytes=AOOSP_TELEM_RINGSIZE);
+// Gets the statistics.
+void aoosp_telem_stats_get(aoosp_telem_stats_t * stats);
+
+// Sink writing to Serial (without blocking)
+int  aoosp_telem_sink_serial(const uint8_t * buf, int size);
+#if defined(__linux__)
+// Sets the file descriptor (file or socket) for aoosp_telem_sink_fd (host builds).
+void aoosp_telem_sink_fd_set(int fd);
+// Sink writing to the file descriptor set with aoosp_telem_sink_fd_set (host builds).
+int  aoosp_telem_sink_fd(const uint8_t * buf, int size);
+#endif
+
+
+#endif
@@ -0,0 +1,229 @@
+// aoosp_therm.cpp - monitors chain temperature with ASKTINFO, drills down to hot nodes
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>      // micros
+#include <string.h>       // memset
+#include <aoosp_send.h>   // aoosp_send_asktinfo, aoosp_send_readtemp
+#include <aoosp_therm.h>  // own API
+
+
+// Thermal monitor
+// ===============
+// The ASKTINFO telegram is a "serial cast" (see example aoosp_tinfo): sent to
+// node a, it travels to the end of the chain, and every node on the way mins
+// and maxes its own temperature into the payload. The response thus contains
+// the min and max temperature of nodes a..last, at the cost of one telegram,
+// independent of the chain length. Reading every node with READTEMP costs 
+// one telegram per node.
+//
+// The monitor polls with ASKTINFO to node 001 (the whole chain) and keeps 
+// running statistics. Steady state monitoring is thus one telegram per poll.
+//
+// Only when the chain max crosses the threshold, the monitor drills down to
+// find the hot nodes. Let M(a) be the max reported by ASKTINFO sent to a.
+// M is non-increasing in a, so a bisection on a finds the highest address h
+// with M(h)>=threshold; h is a hot node (it is hotter than all nodes after it).
+// Then the bisection is repeated on 1..h-1 with the temperature of h (plus 1) 
+// as level; this finds the next node that is hotter still. This continues 
+// until the chain max is reached. Every found node is confirmed with a 
+// targeted READTEMP. The cost is O(k log N) telegrams for k found nodes.
+//
+// The drill down finds the hottest node and the hot nodes that are hotter
+// than all nodes after them. A hot node followed by an even hotter node 
+// is not reported (it is in the shadow of the hotter one).
+//
+// Temperatures are raw (as reported by the nodes); ASKTINFO is intended for 
+// chains with SAIDs only. Use aoosp_prt_temp_said() to convert to Celsius.
+
+
+static uint16_t            aoosp_therm_last;
+static uint8_t             aoosp_therm_threshold;
+static uint8_t             aoosp_therm_hysteresis;
+static uint32_t            aoosp_therm_drillus;     // Time of last drill down
+static aoosp_therm_stats_t aoosp_therm_stats;
+static int                 aoosp_therm_hotcount;
+static uint16_t            aoosp_therm_hotaddr[AOOSP_THERM_MAXHOT];
+static uint8_t             aoosp_therm_hottemp[AOOSP_THERM_MAXHOT];
+
+
+/*!
+    @brief  Configures the thermal monitor.
+    @param  last
+            The address of the last node in the chain, 
+            e.g. from aoosp_exec_resetinit().
+    @param  threshold
+            The raw temperature at or above which the chain is hot.
+    @param  hysteresis
+            The chain is no longer hot when the max drops below
+            threshold-hysteresis.
+    @note   Clears the statistics and the hot nodes.
+*/
+void aoosp_therm_init(uint16_t last, uint8_t threshold, uint8_t hysteresis) {
+  aoosp_therm_last       = last;
+  aoosp_therm_threshold  = threshold;
+  aoosp_therm_hysteresis = hysteresis;
+  aoosp_therm_hotcount   = 0;
+  aoosp_therm_stats_reset();
+}
+
+
+/*!
+    @brief  Sends one ASKTINFO (to the whole chain) and updates the 
+            statistics. When the chain max crosses the threshold, drills 
+            down to the hot nodes.
+    @param  hot
+            Optional output parameter returning whether the chain is hot.
+    @return aoresult_ok if all ok, otherwise an error code.
+    @note   A drill down happens when the chain becomes hot, and repeats
+            every AOOSP_THERM_REDRILL_US as long as the chain stays hot.
+*/
+aoresult_t aoosp_therm_poll(int * hot) {
+  uint8_t tmin, tmax;
+  aoresult_t result = aoosp_send_asktinfo(AOOSP_ADDR_UNICASTMIN, &tmin, &tmax);
+  if( result!=aoresult_ok ) return result;
+
+  // Update statistics
+  aoosp_therm_stats_t * s = &aoosp_therm_stats;
+  if( s->polls==0 ) { s->tminlow= tmin; s->tmaxhigh= tmax; s->tmaxavg16= tmax*16; }
+  s->polls++;
+  s->tmin = tmin;
+  s->tmax = tmax;
+  if( tmin<s->tminlow  ) s->tminlow= tmin;
+  if( tmax>s->tmaxhigh ) s->tmaxhigh= tmax;
+  s->tmaxavg16 += ((int)tmax*16 - (int)s->tmaxavg16) / 8; // exponential moving average, weight 1/8
+
+  // Hot state (with hysteresis), and drill down on rising edge or periodically while hot
+  int drill = 0;
+  if( !s->hot && tmax>=aoosp_therm_threshold ) { s->hot= 1; drill= 1; }
+  else if( s->hot && tmax+aoosp_therm_hysteresis<aoosp_therm_threshold ) { s->hot= 0; aoosp_therm_hotcount= 0; }
+  else if( s->hot && micros()-aoosp_therm_drillus>AOOSP_THERM_REDRILL_US ) drill= 1;
+  if( hot ) *hot = s->hot;
+  if( drill ) return aoosp_therm_drill();
+  return aoresult_ok;
+}
+
+
+// Returns the highest address h in lo..hi with ASKTINFO(h).tmax>=level, given that this holds for lo.
+static aoresult_t aoosp_therm_bisect(uint16_t lo, uint16_t hi, uint8_t level, uint16_t * addr) {
+  while( lo<hi ) {
+    uint16_t mid = (lo+hi+1)/2;
+    uint8_t tmin, tmax;
+    aoresult_t result = aoosp_send_asktinfo(mid, &tmin, &tmax);
+    aoosp_therm_stats.drilltele++;
+    if( result!=aoresult_ok ) return result;
+    if( tmax>=level ) lo= mid; else hi= mid-1;
+  }
+  *addr = lo;
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Locates the hot nodes: the hottest node and the nodes above 
+            threshold that are hotter than all nodes after them.
+    @return aoresult_ok if all ok, otherwise an error code.
+    @note   Uses ASKTINFO bisection, and confirms each found node 
+            with READTEMP; cost is O(k log N) telegrams for k nodes.
+    @note   The result is available via aoosp_therm_hot_count() and
+            aoosp_therm_hot_get(); ordered from high to low address 
+            (so increasing temperature).
+*/
+aoresult_t aoosp_therm_drill() {
+  aoresult_t result;
+  uint8_t    tmin, tmax;
+  aoosp_therm_drillus = micros();
+  aoosp_therm_stats.drills++;
+  aoosp_therm_hotcount = 0;
+
+  // Chain max
+  result = aoosp_send_asktinfo(AOOSP_ADDR_UNICASTMIN, &tmin, &tmax);
+  aoosp_therm_stats.drilltele++;
+  if( result!=aoresult_ok ) return result;
+
+  int      level = aoosp_therm_threshold;
+  uint16_t hi    = aoosp_therm_last;
+  while( level<=tmax && hi>=AOOSP_ADDR_UNICASTMIN && aoosp_therm_hotcount<AOOSP_THERM_MAXHOT ) {
+    // Find the highest node in 1..hi at or above level
+    uint16_t addr;
+    result = aoosp_therm_bisect(AOOSP_ADDR_UNICASTMIN, hi, level, &addr);
+    if( result!=aoresult_ok ) return result;
+    // Confirm with a targeted read
+    uint8_t temp;
+    result = aoosp_send_readtemp(addr, &temp);
+    aoosp_therm_stats.drilltele++;
+    if( result!=aoresult_ok ) return result;
+    aoosp_therm_hotaddr[aoosp_therm_hotcount] = addr;
+    aoosp_therm_hottemp[aoosp_therm_hotcount] = temp;
+    aoosp_therm_hotcount++;
+    // Next: a node before addr that is hotter still
+    level = ( temp>=level ? temp : level ) + 1;
+    hi = addr-1;
+  }
+
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Returns the number of hot nodes found by the last drill down.
+    @return Number of hot nodes (0 when the chain is not hot).
+*/
+int aoosp_therm_hot_count() {
+  return aoosp_therm_hotcount;
+}
+
+
+/*!
+    @brief  Gets a hot node found by the last drill down.
+    @param  ix
+            Index of the hot node (0..aoosp_therm_hot_count()-1).
+    @param  addr
+            Output parameter returning the address of the hot node.
+    @param  temp
+            Output parameter returning its raw temperature (from READTEMP).
+    @return aoresult_ok if all ok, aoresult_osp_arg if ix is out of range.
+*/
+aoresult_t aoosp_therm_hot_get(int ix, uint16_t * addr, uint8_t * temp) {
+  if( addr==0 || temp==0 ) return aoresult_outargnull;
+  if( ix<0 || ix>=aoosp_therm_hotcount ) return aoresult_osp_arg;
+  *addr = aoosp_therm_hotaddr[ix];
+  *temp = aoosp_therm_hottemp[ix];
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Gets the statistics of the thermal monitor.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+*/
+void aoosp_therm_stats_get(aoosp_therm_stats_t * stats) {
+  if( stats ) *stats = aoosp_therm_stats;
+}
+
+
+/*!
+    @brief  Resets the statistics of the thermal monitor.
+*/
+void aoosp_therm_stats_reset() {
+  memset( &aoosp_therm_stats, 0, sizeof aoosp_therm_stats );
+}
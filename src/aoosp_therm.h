@@ -0,0 +1,65 @@
+// aoosp_therm.h - monitors chain temperature with ASKTINFO, drills down to hot nodes
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_THERM_H_
+#define _AOOSP_THERM_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Max number of hot nodes recorded by a drill down
+#define AOOSP_THERM_MAXHOT      8
+// Min time between two drill downs while the chain stays hot
+#define AOOSP_THERM_REDRILL_US  1000000
+
+
+// Statistics of the thermal monitor (temperatures are raw, see aoosp_prt_temp_said)
+typedef struct aoosp_therm_stats_s {
+  uint32_t polls;       // Number of polls (ASKTINFO telegrams on the whole chain)
+  uint32_t drills;      // Number of drill downs
+  uint32_t drilltele;   // Number of telegrams sent for drill downs
+  uint8_t  tmin;        // Chain min temperature of last poll
+  uint8_t  tmax;        // Chain max temperature of last poll
+  uint8_t  tminlow;     // Lowest chain min temperature since stats reset
+  uint8_t  tmaxhigh;    // Highest chain max temperature since stats reset
+  uint16_t tmaxavg16;   // Running average of the chain max temperature (times 16, so 4 fractional bits)
+  uint8_t  hot;         // 1 iff chain max temperature is above threshold (with hysteresis)
+} aoosp_therm_stats_t;
+
+
+// Configures the monitor for a chain of `last` nodes, with raw threshold and hysteresis; clears stats and hot nodes.
+void       aoosp_therm_init(uint16_t last, uint8_t threshold, uint8_t hysteresis=2);
+// Sends one ASKTINFO to update the statistics; drills down when the max crosses the threshold.
+aoresult_t aoosp_therm_poll(int * hot=0);
+// Locates the hot nodes (using ASKTINFO bisection and READTEMP), irrespective of the last poll.
+aoresult_t aoosp_therm_drill();
+// Returns the number of hot nodes found by the last drill down.
+int        aoosp_therm_hot_count();
+// Gets hot node `ix` (0..aoosp_therm_hot_count()-1) found by the last drill down.
+aoresult_t aoosp_therm_hot_get(int ix, uint16_t * addr, uint8_t * temp);
+// Gets the statistics.
+void       aoosp_therm_stats_get(aoosp_therm_stats_t * stats);
+// Resets the statistics.
+void       aoosp_therm_stats_reset();
+
+
+#endif
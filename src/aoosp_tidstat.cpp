@@ -0,0 +1,162 @@
+// aoosp_tidstat.cpp - per telegram type counters and latency histograms
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>         // memset
+#include <aoosp_tidstat.h>  // own API
+
+
+// Telegram statistics
+// ===================
+// aospi only counts telegrams sent and received. This module keeps, per
+// telegram ID (TID), the number of telegrams, responses, errors (per aoresult
+// code) and bytes, and a latency histogram for each of the three phases of
+// aoosp_send_xxx(): construct, SPI transfer and destruct.
+//
+// The histograms have logarithmic buckets: bucket b counts durations from
+// 2^b up to 2^(b+1) cycles (see aoosp_cycles; CPU cycles on ESP32, ns on a
+// Linux host). A bucket index is one count-leading-zeros instruction, so
+// recording costs a few dozen cycles per telegram.
+//
+// Slots are assigned to TIDs on first use; when all slots are taken, the
+// remaining TIDs share the last slot (reported as AOOSP_TIDSTAT_OTHER).
+// Telegrams that fail construction have no TID; they are recorded under
+// AOOSP_TIDSTAT_NOTID.
+
+
+static aoosp_tidstat_t aoosp_tidstat_slots[AOOSP_TIDSTAT_SLOTS];
+static uint8_t         aoosp_tidstat_slotof[256]; // slot+1 per TID, 0 for none
+static int             aoosp_tidstat_used;        // number of slots in use
+
+
+// Returns the histogram bucket for a duration of `cycles`.
+static inline int aoosp_tidstat_bucket(uint32_t cycles) {
+  int b = cycles<2 ? 0 : 31-__builtin_clz(cycles);
+  return b<AOOSP_TIDSTAT_BUCKETS ? b : AOOSP_TIDSTAT_BUCKETS-1;
+}
+
+
+// Adds a duration to the histogram of phase `ph` of slot `s`.
+static inline void aoosp_tidstat_add(aoosp_tidstat_t * s, int ph, uint32_t cycles) {
+  if( cycles==AOOSP_TIDSTAT_SKIPPED ) return;
+  s->hist[ph][aoosp_tidstat_bucket(cycles)]++;
+  if( cycles>s->max[ph] ) s->max[ph]= cycles;
+}
+
+
+/*!
+    @brief  Records the statistics of one telegram.
+    @param  tid
+            The telegram ID, or AOOSP_TIDSTAT_NOTID when construction failed.
+    @param  txsize
+            The number of bytes sent (0 if not sent).
+    @param  rxsize
+            The number of bytes received (0 if none).
+    @param  result
+            The (accumulated) result of aoosp_send_xxx().
+    @param  concycles
+            The duration of construction.
+    @param  spicycles
+            The duration of the SPI transfer, or AOOSP_TIDSTAT_SKIPPED.
+    @param  descycles
+            The duration of destruction, or AOOSP_TIDSTAT_SKIPPED.
+    @note   Called by aoosp_send; applications typically do not call this.
+*/
+void aoosp_tidstat_record(uint8_t tid, uint8_t txsize, uint8_t rxsize, aoresult_t result, uint32_t concycles, uint32_t spicycles, uint32_t descycles) {
+  int ix = aoosp_tidstat_slotof[tid];
+  if( ix==0 ) {
+    // Assign a slot; the last one is shared by all remaining TIDs
+    if( aoosp_tidstat_used<AOOSP_TIDSTAT_SLOTS-1 ) {
+      ix = ++aoosp_tidstat_used;
+      aoosp_tidstat_slots[ix-1].tid = tid;
+    } else {
+      ix = AOOSP_TIDSTAT_SLOTS;
+      aoosp_tidstat_used = AOOSP_TIDSTAT_SLOTS;
+      aoosp_tidstat_slots[ix-1].tid = AOOSP_TIDSTAT_OTHER;
+    }
+    aoosp_tidstat_slotof[tid] = ix;
+  }
+  aoosp_tidstat_t * s = &aoosp_tidstat_slots[ix-1];
+
+  if( spicycles!=AOOSP_TIDSTAT_SKIPPED ) s->sent++;
+  if( rxsize>0 ) s->responses++;
+  if( result!=aoresult_ok ) {
+    s->errors++;
+    int code = result<AOOSP_TIDSTAT_ERRCODES ? result : AOOSP_TIDSTAT_ERRCODES-1;
+    s->errcodes[code]++;
+  }
+  s->txbytes += txsize;
+  s->rxbytes += rxsize;
+  aoosp_tidstat_add(s, AOOSP_TIDSTAT_CON, concycles);
+  aoosp_tidstat_add(s, AOOSP_TIDSTAT_SPI, spicycles);
+  aoosp_tidstat_add(s, AOOSP_TIDSTAT_DES, descycles);
+}
+
+
+/*!
+    @brief  Lists the TIDs that have statistics.
+    @param  tids
+            Output array receiving the TIDs, in order of first use.
+    @param  size
+            The size of the output array.
+    @return The number of TIDs written.
+    @note   The list may contain AOOSP_TIDSTAT_NOTID and AOOSP_TIDSTAT_OTHER.
+*/
+int aoosp_tidstat_tids(uint8_t * tids, int size) {
+  if( tids==0 ) return 0;
+  int n = aoosp_tidstat_used<size ? aoosp_tidstat_used : size;
+  for( int i=0; i<n; i++ ) tids[i] = aoosp_tidstat_slots[i].tid;
+  return n;
+}
+
+
+/*!
+    @brief  Gets a snapshot of the statistics of one TID.
+    @param  tid
+            The telegram ID (e.g. AOOSP_TID_SETPWM, also for SETPWMCHN;
+            aoosp_prt_tid() converts it to a name),
+            or AOOSP_TIDSTAT_NOTID or AOOSP_TIDSTAT_OTHER.
+    @param  snapshot
+            Output parameter receiving a copy of the statistics.
+    @return aoresult_ok      if all ok,
+            aoresult_osp_tid if the TID has no statistics (not sent since reset).
+    @note   Convert cycles to us with aoosp_cycles_per_us().
+*/
+aoresult_t aoosp_tidstat_get(uint8_t tid, aoosp_tidstat_t * snapshot) {
+  if( snapshot==0 ) return aoresult_outargnull;
+  for( int i=0; i<aoosp_tidstat_used; i++ ) {
+    if( aoosp_tidstat_slots[i].tid==tid ) {
+      *snapshot = aoosp_tidstat_slots[i];
+      return aoresult_ok;
+    }
+  }
+  return aoresult_osp_tid;
+}
+
+
+/*!
+    @brief  Clears all statistics (and frees all slots).
+*/
+void aoosp_tidstat_reset() {
+  memset( aoosp_tidstat_slots , 0, sizeof aoosp_tidstat_slots  );
+  memset( aoosp_tidstat_slotof, 0, sizeof aoosp_tidstat_slotof );
+  aoosp_tidstat_used = 0;
+}
@@ -0,0 +1,79 @@
+// aoosp_tidstat.h - per telegram type counters and latency histograms
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_TIDSTAT_H_
+#define _AOOSP_TIDSTAT_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// When set to 1, aoosp_send collects per telegram statistics and reads the cycle counter (about 11 kB RAM); 0 (default) compiles that out. May also be set with -DAOOSP_TIDSTAT_ENABLED=1
+#ifndef AOOSP_TIDSTAT_ENABLED
+  #define AOOSP_TIDSTAT_ENABLED 0
+#endif
+
+
+// Number of distinct TIDs with statistics; further TIDs are accumulated in the last slot (tid AOOSP_TIDSTAT_OTHER)
+#define AOOSP_TIDSTAT_SLOTS     32
+// Number of latency buckets; bucket b counts durations of [2^b,2^(b+1)) cycles, the last bucket also all longer
+#define AOOSP_TIDSTAT_BUCKETS   20
+// Number of error counters; entry c counts result code c, the last entry also all higher codes
+#define AOOSP_TIDSTAT_ERRCODES  32
+// TID used for telegrams that failed construction (TID unknown)
+#define AOOSP_TIDSTAT_NOTID     0x80
+// TID used for the slot accumulating TIDs that did not get a slot of their own
+#define AOOSP_TIDSTAT_OTHER     0xFF
+// Marks a phase that did not run (e.g. no SPI when construction failed)
+#define AOOSP_TIDSTAT_SKIPPED   0xFFFFFFFF
+
+
+// Phases of sending a telegram (index in hist[] and max[])
+#define AOOSP_TIDSTAT_CON       0 // construct
+#define AOOSP_TIDSTAT_SPI       1 // SPI transfer (aospi_tx or aospi_txrx)
+#define AOOSP_TIDSTAT_DES       2 // destruct
+
+
+// Statistics of one TID (snapshot, see aoosp_tidstat_get); durations are in cycles (see aoosp_cycles)
+typedef struct aoosp_tidstat_s {
+  uint8_t  tid;                                   // Telegram ID, AOOSP_TID_xxx (or AOOSP_TIDSTAT_NOTID, AOOSP_TIDSTAT_OTHER)
+  uint32_t sent;                                  // Number of telegrams sent (SPI attempted)
+  uint32_t responses;                             // Number of responses received (SPI ok)
+  uint32_t errors;                                // Number of telegrams with a result other than aoresult_ok
+  uint16_t errcodes[AOOSP_TIDSTAT_ERRCODES];      // Number of errors per aoresult code
+  uint32_t txbytes;                               // Number of bytes sent
+  uint32_t rxbytes;                               // Number of bytes received
+  uint32_t hist[3][AOOSP_TIDSTAT_BUCKETS];        // Latency histogram per phase (AOOSP_TIDSTAT_CON, _SPI, _DES)
+  uint32_t max[3];                                // Longest duration per phase
+} aoosp_tidstat_t;
+
+
+// Records one telegram (called by aoosp_send; cycles of a phase that did not run are AOOSP_TIDSTAT_SKIPPED).
+void       aoosp_tidstat_record(uint8_t tid, uint8_t txsize, uint8_t rxsize, aoresult_t result, uint32_t concycles, uint32_t spicycles, uint32_t descycles);
+// Lists the TIDs with statistics (at most `size`); returns the number listed.
+int        aoosp_tidstat_tids(uint8_t * tids, int size);
+// Gets a snapshot of the statistics of `tid`.
+aoresult_t aoosp_tidstat_get(uint8_t tid, aoosp_tidstat_t * snapshot);
+// Clears all statistics.
+void       aoosp_tidstat_reset();
+
+
+#endif
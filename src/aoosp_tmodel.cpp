@@ -0,0 +1,370 @@
+// aoosp_tmodel.cpp - timing model of the OSP chain, calibrated from measurements
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <string.h>         // memset
+#include <math.h>           // sqrt
+#include <aoosp_send.h>     // aoosp_send_xxx, aoosp_hooks_set, aoosp_cycles
+#include <aoosp_tmodel.h>   // own API
+
+
+// Timing model
+// ============
+// aoosp_time.ino shows that a telegram sequence takes about twice as long
+// as the wire time of its bytes: there is time between telegrams, each node
+// forwards a telegram with a delay, and a node needs time to execute a
+// telegram before it responds. This module models the bus time of one
+// transfer (one aospi_tx or aospi_txrx) as
+//
+//   gap + txsize*byte                                  (telegram without response)
+//   gap + (txsize+rxsize)*byte + hops*hop + turn + exec(tid)   (with response)
+//
+// where hops is the number of nodes the telegram and its response pass:
+// 2*addr in BiDir (out and back), and last+1 in Loop (the whole ring,
+// independent of addr). turn is the turnaround of the direction mode (the
+// response time of the quickest telegram, READSTAT), and exec(tid) is the
+// additional execution time of a telegram type.
+//
+// aoosp_tmodel_calibrate() fits the parameters from a measurement sequence
+// on the real chain: telegrams without response (writes that restore the
+// value just read, so the chain state does not change) for gap and byte,
+// READSTAT at several addresses for hop and turn (in Loop hop can not be
+// separated from turn, it keeps its value, and turn absorbs the ring), and
+// other read telegrams for exec. The SPI time of each transfer is taken with
+// the aoosp_send hooks, so software overhead is excluded. A second pass
+// validates the fitted model and reports the prediction error.
+
+
+static aoosp_tmodel_t aoosp_tmodel;
+static uint16_t       aoosp_tmodel_last;
+static uint8_t        aoosp_tmodel_loop;
+
+
+/*!
+    @brief  Fills a model with the defaults.
+    @param  model
+            Output parameter receiving the default parameters.
+    @note   Wire time (AOOSP_TMODEL_BYTENS_DEFAULT), the time per transfer
+            seen with aoosp_time.ino (AOOSP_TMODEL_GAPNS_DEFAULT) and an
+            assumed forwarding delay (AOOSP_TMODEL_HOPNS_DEFAULT); turnaround
+            and execution times are 0. Planner and simulators start from
+            this, so they agree, and are not as optimistic as wire time only.
+*/
+void aoosp_tmodel_default(aoosp_tmodel_t * model) {
+  if( model==0 ) return;
+  memset( model, 0, sizeof *model );
+  model->bytens = AOOSP_TMODEL_BYTENS_DEFAULT;
+  model->gapns  = AOOSP_TMODEL_GAPNS_DEFAULT;
+  model->hopns  = AOOSP_TMODEL_HOPNS_DEFAULT;
+}
+
+
+/*!
+    @brief  Resets the model to the defaults for a chain.
+    @param  last
+            The address of the last node (number of nodes), e.g. from
+            aoosp_exec_resetinit().
+    @param  loop
+            1 when the chain is in Loop, 0 when in BiDir.
+    @note   The defaults are those of aoosp_tmodel_default(); use
+            aoosp_tmodel_calibrate() or aoosp_tmodel_set() for the chain at hand.
+*/
+void aoosp_tmodel_init(uint16_t last, int loop) {
+  aoosp_tmodel_default(&aoosp_tmodel);
+  aoosp_tmodel_last   = last;
+  aoosp_tmodel_loop   = loop!=0;
+}
+
+
+/*!
+    @brief  Gets a copy of the model parameters.
+    @param  model
+            Output parameter receiving the parameters.
+*/
+void aoosp_tmodel_get(aoosp_tmodel_t * model) {
+  if( model ) *model = aoosp_tmodel;
+}
+
+
+/*!
+    @brief  Sets the model parameters, e.g. from an earlier calibration.
+    @param  model
+            The parameters.
+    @note   The chain (last, loop) is the one of aoosp_tmodel_init().
+*/
+void aoosp_tmodel_set(const aoosp_tmodel_t * model) {
+  if( model ) aoosp_tmodel = *model;
+}
+
+
+/*!
+    @brief  Predicts the bus time of one transfer.
+    @param  tid
+            The telegram ID.
+    @param  addr
+            The destination address (unicast for telegrams with response).
+    @param  txsize
+            The size of the telegram in bytes.
+    @param  rxsize
+            The size of the response in bytes, or 0 for none.
+    @return The predicted duration of the aospi_tx or aospi_txrx in ns.
+*/
+uint32_t aoosp_tmodel_predict(uint8_t tid, uint16_t addr, int txsize, int rxsize) {
+  return aoosp_tmodel_predict_chain(&aoosp_tmodel, aoosp_tmodel_last, aoosp_tmodel_loop, tid, addr, txsize, rxsize);
+}
+
+
+/*!
+    @brief  Predicts the bus time of one transfer for a given model and chain.
+    @param  model
+            The model parameters (e.g. from aoosp_tmodel_get()).
+    @param  last
+            The address of the last node (number of nodes) of the chain.
+    @param  loop
+            1 when the chain is in Loop, 0 when in BiDir.
+    @param  tid
+            The telegram ID.
+    @param  addr
+            The destination address (unicast for telegrams with response).
+    @param  txsize
+            The size of the telegram in bytes.
+    @param  rxsize
+            The size of the response in bytes, or 0 for none.
+    @return The predicted duration of the aospi_tx or aospi_txrx in ns.
+    @note   Allows predictions for a chain other than the calibrated one,
+            e.g. to plan an installation.
+*/
+uint32_t aoosp_tmodel_predict_chain(const aoosp_tmodel_t * model, uint16_t last, int loop, uint8_t tid, uint16_t addr, int txsize, int rxsize) {
+  loop = loop!=0;
+  uint32_t ns = model->gapns + txsize*model->bytens;
+  if( rxsize>0 ) {
+    uint32_t hops = loop ? last+1 : 2*addr;
+    ns+= rxsize*model->bytens + hops*model->hopns + model->turnns[loop] + model->execns[tid&0x7F];
+  }
+  return ns;
+}
+
+
+// === CALIBRATION ========================================
+
+
+#if AOOSP_HOOKS_ENABLED
+
+
+// Read telegrams of the measurement sequence; the first (READSTAT) is the reference for hop and turn
+static const uint8_t aoosp_tmodel_tids[] = {
+  AOOSP_TID_READSTAT, AOOSP_TID_READTEMPSTAT, AOOSP_TID_READTEMP, AOOSP_TID_IDENTIFY, AOOSP_TID_READCOMST,
+  AOOSP_TID_READSETUP, AOOSP_TID_READMULT, AOOSP_TID_READPWM, AOOSP_TID_READCURCHN, AOOSP_TID_READOTP
+};
+#define AOOSP_TMODEL_TIDS ( sizeof aoosp_tmodel_tids / sizeof aoosp_tmodel_tids[0] )
+
+
+// Sums for the least squares fits; x is hops, b bytes (tx+rx), t measured ns
+typedef struct aoosp_tmodel_acc_s {
+  uint32_t n;
+  double   sx, sb, st, sxx, sxt, sxb;
+} aoosp_tmodel_acc_t;
+
+
+static aoosp_tmodel_acc_t aoosp_tmodel_rd[AOOSP_TMODEL_TIDS]; // read telegrams (with response), per TID
+static aoosp_tmodel_acc_t aoosp_tmodel_wr;                    // write telegrams (no response); x is also bytes
+static uint16_t           aoosp_tmodel_addr;                  // destination of the telegram being measured
+static uint8_t            aoosp_tmodel_txsize;                // size of the telegram being measured
+static uint8_t            aoosp_tmodel_validating;            // 0: accumulate, 1: validate
+static double             aoosp_tmodel_err2;                  // validation: sum of squared errors
+static uint32_t           aoosp_tmodel_errmax;                // validation: largest absolute error
+static uint32_t           aoosp_tmodel_nval;                  // validation: number of transfers
+
+
+static void aoosp_tmodel_pretx(const uint8_t * tele, int size, uint8_t tid, uint32_t cycles) {
+  (void)tele; (void)tid; (void)cycles;
+  aoosp_tmodel_txsize = size;
+}
+
+
+static void aoosp_tmodel_postrx(const uint8_t * resp, int size, uint8_t tid, uint32_t txcycles, uint32_t rxcycles, aoresult_t result) {
+  (void)resp;
+  if( result!=aoresult_ok ) return;
+  double t = (rxcycles-txcycles) * 1000.0 / aoosp_cycles_per_us();
+  if( aoosp_tmodel_validating ) {
+    double err = t - aoosp_tmodel_predict(tid, aoosp_tmodel_addr, aoosp_tmodel_txsize, size);
+    aoosp_tmodel_err2+= err*err;
+    if( fabs(err)>aoosp_tmodel_errmax ) aoosp_tmodel_errmax = fabs(err);
+    aoosp_tmodel_nval++;
+    return;
+  }
+  aoosp_tmodel_acc_t * acc = 0;
+  double x = 0;
+  double b = aoosp_tmodel_txsize + size;
+  if( size==0 ) {
+    acc = &aoosp_tmodel_wr;
+    x = b;
+  } else {
+    for( size_t i=0; i<AOOSP_TMODEL_TIDS; i++ ) if( aoosp_tmodel_tids[i]==tid ) acc = &aoosp_tmodel_rd[i];
+    x = aoosp_tmodel_loop ? aoosp_tmodel_last+1 : 2*aoosp_tmodel_addr;
+  }
+  if( acc==0 ) return;
+  acc->n++;
+  acc->sx += x;   acc->sb += b;   acc->st += t;
+  acc->sxx+= x*x; acc->sxt+= x*t; acc->sxb+= x*b;
+}
+
+
+// The measurement sequence for node `addr`: reads, and writes that restore the value read
+static void aoosp_tmodel_sequence(uint16_t addr) {
+  uint8_t  stat, temp, com, flags, rcur, gcur, bcur, buf[8];
+  uint16_t groups, red, green, blue;
+  uint32_t id;
+  aoosp_tmodel_addr = addr;
+  aoosp_send_readstat(addr, &stat);
+  aoosp_send_readtempstat(addr, &temp, &stat);
+  aoosp_send_readtemp(addr, &temp);
+  aoosp_send_identify(addr, &id);
+  aoosp_send_readcomst(addr, &com);
+  if( aoosp_send_readsetup(addr, &flags)==aoresult_ok ) aoosp_send_setsetup(addr, flags);
+  if( aoosp_send_readmult(addr, &groups)==aoresult_ok ) aoosp_send_setmult(addr, groups);
+  if( aoosp_send_readpwmchn(addr, 0, &red, &green, &blue)==aoresult_ok ) aoosp_send_setpwmchn(addr, 0, red, green, blue);
+  aoosp_send_readcurchn(addr, 0, &flags, &rcur, &gcur, &bcur);
+  aoosp_send_readotp(addr, 0x0D, buf, sizeof buf);
+}
+
+
+// Runs the measurement sequence `reps` times over a spread of addresses
+static void aoosp_tmodel_measure(int reps) {
+  uint16_t last = aoosp_tmodel_last;
+  uint16_t addrs[5] = { 1, (uint16_t)(last/4), (uint16_t)(last/2), (uint16_t)(3*last/4), last };
+  for( int r=0; r<reps; r++ ) {
+    uint16_t prev = 0;
+    for( int i=0; i<5; i++ ) {
+      if( addrs[i]<=prev ) continue; // skip duplicates (short chains)
+      aoosp_tmodel_sequence(addrs[i]);
+      prev = addrs[i];
+    }
+  }
+}
+
+
+/*!
+    @brief  Fits the model parameters from measurements on the chain.
+    @param  reps
+            Number of repetitions of the measurement sequence (more
+            repetitions average out more noise).
+    @param  fit
+            Optional output parameter receiving the fit quality.
+    @return aoresult_ok, or aoresult_sys_id when there were no usable READSTAT
+            measurements (no chain, or not initialized), or aoresult_osp_arg
+            when the hooks are compiled out (AOOSP_HOOKS_ENABLED).
+    @note   Call aoosp_tmodel_init() first (chain length and direction).
+            The chain must be initialized (addresses assigned). The sequence
+            only reads, and writes back the values just read (setup, groups,
+            PWM of channel 0), so the chain state does not change.
+    @note   Temporarily replaces the aoosp_send hooks (restored on exit).
+    @note   Execution times are relative to READSTAT; only the read telegrams
+            of the sequence get one (others are 0).
+*/
+aoresult_t aoosp_tmodel_calibrate(int reps, aoosp_tmodel_fit_t * fit) {
+  aoosp_hook_pretx_t  pretx;
+  aoosp_hook_postrx_t postrx;
+  aoosp_hooks_get(&pretx, &postrx);
+  aoosp_hooks_set(aoosp_tmodel_pretx, aoosp_tmodel_postrx);
+
+  // Measure
+  memset( aoosp_tmodel_rd, 0, sizeof aoosp_tmodel_rd );
+  memset( &aoosp_tmodel_wr, 0, sizeof aoosp_tmodel_wr );
+  aoosp_tmodel_validating = 0;
+  aoosp_tmodel_measure(reps);
+  aoosp_hooks_set(pretx, postrx);
+  if( aoosp_tmodel_rd[0].n==0 ) return aoresult_sys_id;
+
+  // Fit byte and gap from the writes: t = gap + b*byte (keep byte when all writes have the same size)
+  aoosp_tmodel_t m = aoosp_tmodel;
+  const aoosp_tmodel_acc_t * wr = &aoosp_tmodel_wr;
+  double byte = m.bytens, gap = 0;
+  if( wr->n>0 ) {
+    double den = wr->n*wr->sxx - wr->sx*wr->sx;
+    if( den>0 ) {
+      double slope = (wr->n*wr->sxt - wr->sx*wr->st) / den;
+      if( slope>0 ) byte = slope;
+    }
+    gap = (wr->st - byte*wr->sx) / wr->n;
+    if( gap<0 ) gap = 0;
+  }
+
+  // Residual of a read after gap and bytes: R = t - gap - b*byte; sums of R and x*R per TID
+  #define AOOSP_TMODEL_SR(a)  ( (a)->st  - (a)->n*gap - byte*(a)->sb  )
+  #define AOOSP_TMODEL_SXR(a) ( (a)->sxt - (a)->sx*gap - byte*(a)->sxb )
+
+  // Fit hop and turn from READSTAT: R = x*hop + turn (in Loop x is constant, keep hop)
+  double hop = m.hopns;
+  const aoosp_tmodel_acc_t * rs = &aoosp_tmodel_rd[0];
+  double den = rs->n*rs->sxx - rs->sx*rs->sx;
+  if( !aoosp_tmodel_loop && den>0 ) {
+    hop = (rs->n*AOOSP_TMODEL_SXR(rs) - rs->sx*AOOSP_TMODEL_SR(rs)) / den;
+    if( hop<0 ) hop = 0;
+  }
+  double turn = (AOOSP_TMODEL_SR(rs) - hop*rs->sx) / rs->n;
+  if( turn<0 ) turn = 0;
+
+  // Execution time of the other reads: what is left after hops and turn
+  memset( m.execns, 0, sizeof m.execns );
+  for( size_t i=1; i<AOOSP_TMODEL_TIDS; i++ ) {
+    const aoosp_tmodel_acc_t * acc = &aoosp_tmodel_rd[i];
+    if( acc->n==0 ) continue;
+    double exec = (AOOSP_TMODEL_SR(acc) - hop*acc->sx) / acc->n - turn;
+    m.execns[aoosp_tmodel_tids[i]] = exec>0 ? exec+0.5 : 0;
+  }
+  m.bytens = byte+0.5;
+  m.gapns  = gap+0.5;
+  m.hopns  = hop+0.5;
+  m.turnns[aoosp_tmodel_loop] = turn+0.5;
+  aoosp_tmodel = m;
+
+  // Validate: run the sequence again, now comparing against the prediction
+  if( fit ) {
+    aoosp_tmodel_err2 = 0;
+    aoosp_tmodel_errmax = 0;
+    aoosp_tmodel_nval = 0;
+    aoosp_tmodel_validating = 1;
+    aoosp_hooks_set(aoosp_tmodel_pretx, aoosp_tmodel_postrx);
+    aoosp_tmodel_measure(reps);
+    aoosp_hooks_set(pretx, postrx);
+    fit->samples   = wr->n + rs->n;
+    for( size_t i=1; i<AOOSP_TMODEL_TIDS; i++ ) fit->samples += aoosp_tmodel_rd[i].n;
+    fit->validated = aoosp_tmodel_nval;
+    fit->rmsns     = aoosp_tmodel_nval ? sqrt(aoosp_tmodel_err2/aoosp_tmodel_nval)+0.5 : 0;
+    fit->maxns     = aoosp_tmodel_errmax;
+  }
+
+  return aoresult_ok;
+}
+
+
+#else
+
+
+aoresult_t aoosp_tmodel_calibrate(int reps, aoosp_tmodel_fit_t * fit) {
+  (void)reps; (void)fit;
+  Serial.printf("WARNING: aoosp_tmodel_calibrate() needs AOOSP_HOOKS_ENABLED set to 1 (aoosp_send.h)\n");
+  return aoresult_osp_arg;
+}
+
+
+#endif // AOOSP_HOOKS_ENABLED
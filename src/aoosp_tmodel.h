@@ -0,0 +1,72 @@
+// aoosp_tmodel.h - timing model of the OSP chain, calibrated from measurements
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_TMODEL_H_
+#define _AOOSP_TMODEL_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// Default wire time per byte: 8 bits at 2.4 MHz
+#define AOOSP_TMODEL_BYTENS_DEFAULT  3333
+// Default time per transfer: aoosp_time.ino (OSP32, 42 transfers in 4940us) leaves about 80us per transfer beyond the wire time
+#define AOOSP_TMODEL_GAPNS_DEFAULT   80000
+// Default forwarding delay of one node (an assumption; aoosp_tmodel_calibrate() fits it in BiDir)
+#define AOOSP_TMODEL_HOPNS_DEFAULT   200
+
+
+// Parameters of the timing model (all times in ns); see aoosp_tmodel_predict() for how they combine
+typedef struct aoosp_tmodel_s {
+  uint32_t bytens;       // Wire time per telegram byte (send and receive)
+  uint32_t gapns;        // Fixed time per transfer (SPI setup, inter telegram time)
+  uint32_t hopns;        // Forwarding delay of one node
+  uint32_t turnns[2];    // Response turnaround in BiDir [0] and Loop [1] (beyond hops, for READSTAT)
+  uint32_t execns[128];  // Execution time per TID before the node responds, relative to READSTAT
+} aoosp_tmodel_t;
+
+
+// Quality of a calibration (from a validation pass after the fit)
+typedef struct aoosp_tmodel_fit_s {
+  uint32_t samples;      // Number of transfers used for the fit
+  uint32_t validated;    // Number of transfers in the validation pass
+  uint32_t rmsns;        // Root mean square of prediction error in the validation pass
+  uint32_t maxns;        // Largest absolute prediction error in the validation pass
+} aoosp_tmodel_fit_t;
+
+
+// Fills `model` with the defaults (AOOSP_TMODEL_XXX_DEFAULT; turnaround and execution 0), shared by the tools.
+void       aoosp_tmodel_default(aoosp_tmodel_t * model);
+// Resets the model to the defaults (aoosp_tmodel_default) for a chain of `last` nodes in Loop (loop=1) or BiDir.
+void       aoosp_tmodel_init(uint16_t last, int loop);
+// Gets a copy of the model parameters (e.g. to store them).
+void       aoosp_tmodel_get(aoosp_tmodel_t * model);
+// Sets the model parameters (e.g. stored ones).
+void       aoosp_tmodel_set(const aoosp_tmodel_t * model);
+// Fits the model parameters from a measurement sequence on the (initialized) chain; `fit` (optional) receives the fit quality.
+aoresult_t aoosp_tmodel_calibrate(int reps=8, aoosp_tmodel_fit_t * fit=0);
+// Predicts the bus time in ns of one transfer (telegram `tid` of txsize bytes to `addr`, response of rxsize bytes or 0).
+uint32_t   aoosp_tmodel_predict(uint8_t tid, uint16_t addr, int txsize, int rxsize);
+// Same as aoosp_tmodel_predict(), but for `model` on a chain of `last` nodes in Loop (loop=1) or BiDir (e.g. for planning).
+uint32_t   aoosp_tmodel_predict_chain(const aoosp_tmodel_t * model, uint16_t last, int loop, uint8_t tid, uint16_t addr, int txsize, int rxsize);
+
+
+#endif
@@ -0,0 +1,276 @@
+// aoosp_trace.cpp - records telegrams into a RAM ring without formatting, for later dump
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>      // Serial
+#include <aoosp_prt.h>    // aoosp_prt_bytes, aoosp_prt_tid
+#include <aoosp_crc.h>    // aoosp_crc
+#include <aoosp_dlog.h>   // aoosp_dlog_format_results
+#include <aoosp_send.h>   // aoosp_cycles_per_us, aoosp_send_des_rec
+#include <aoosp_trace.h>  // own API
+
+
+// Trace
+// =====
+// Logging with aoosp_loglevel_tele formats every telegram with Serial.printf
+// while the bus is being driven; that changes the timing so much that it is
+// useless at frame rate. The trace recorder instead copies each telegram and
+// each response, with a time stamp (aoosp_cycles) and the SPI result, into a
+// preallocated ring of fixed size records. Recording is a test and a copy of
+// at most 20 bytes, so production traffic can be traced without perturbing it.
+//
+// Formatting happens later: aoosp_trace_dump() prints the ring, either raw
+// (one hex line per record), or decoded with aoosp_trace_decode(). The raw
+// lines can be captured from Serial and decoded on a PC by the host tool in
+// extras/host (aoosp_tracedump), which links this very file, so the PC uses
+// the same decoder (and CRC) as the target.
+//
+// The recorder runs on the task that sends telegrams. Dumping and getting
+// records should be done from the same task, or after aoosp_trace_stop().
+
+
+static aoosp_trace_rec_t aoosp_trace_ring[AOOSP_TRACE_RECS];
+static int               aoosp_trace_head;  // index where the next record is written
+static int               aoosp_trace_num;   // number of records in the ring
+static uint32_t          aoosp_trace_nlost; // records lost since start
+static uint8_t           aoosp_trace_on;    // recording
+static uint8_t           aoosp_trace_once;  // stop recording when full (instead of overwriting)
+
+
+/*!
+    @brief  Clears the ring and starts recording.
+    @param  once
+            When 0, the oldest records are overwritten when the ring is full
+            (the ring holds the most recent traffic); when 1 recording stops
+            when the ring is full (the ring holds the traffic after start).
+    @note   In both cases records not in the ring are counted as lost.
+*/
+void aoosp_trace_start(int once) {
+  aoosp_trace_on    = 0;
+  aoosp_trace_head  = 0;
+  aoosp_trace_num   = 0;
+  aoosp_trace_nlost = 0;
+  aoosp_trace_once  = once!=0;
+  aoosp_trace_on    = 1;
+}
+
+
+/*!
+    @brief  Stops recording; the records in the ring are kept.
+*/
+void aoosp_trace_stop() {
+  aoosp_trace_on = 0;
+}
+
+
+/*!
+    @brief  Returns the number of records in the ring.
+    @return Number of records, at most AOOSP_TRACE_RECS.
+*/
+int aoosp_trace_count() {
+  return aoosp_trace_num;
+}
+
+
+/*!
+    @brief  Returns the number of records lost since the last start.
+    @return Number of records overwritten, or not recorded because the
+            ring was full (once mode).
+*/
+uint32_t aoosp_trace_lost() {
+  return aoosp_trace_nlost;
+}
+
+
+/*!
+    @brief  Gets one record from the ring.
+    @param  ix
+            Index of the record; 0 is the oldest, aoosp_trace_count()-1 the newest.
+    @param  rec
+            Output parameter receiving a copy of the record.
+    @return aoresult_ok, aoresult_outargnull or aoresult_osp_arg (ix out of range).
+*/
+aoresult_t aoosp_trace_get(int ix, aoosp_trace_rec_t * rec) {
+  if( rec==0 ) return aoresult_outargnull;
+  if( ix<0 || ix>=aoosp_trace_num ) return aoresult_osp_arg;
+  int pos = aoosp_trace_head - aoosp_trace_num + ix;
+  if( pos<0 ) pos+= AOOSP_TRACE_RECS;
+  *rec = aoosp_trace_ring[pos];
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Records one telegram or response in the ring.
+    @param  dir
+            AOOSP_TRACE_TX or AOOSP_TRACE_RX.
+    @param  data
+            The telegram bytes (may be NULL when size is 0).
+    @param  size
+            The number of bytes in data.
+    @param  result
+            The SPI result (for RX).
+    @param  cycles
+            The time stamp (see aoosp_cycles).
+    @note   Called by aoosp_send; returns immediately when not recording.
+*/
+void aoosp_trace_record(uint8_t dir, const uint8_t * data, int size, aoresult_t result, uint32_t cycles) {
+  if( !aoosp_trace_on ) return;
+  if( aoosp_trace_num==AOOSP_TRACE_RECS ) {
+    aoosp_trace_nlost++;
+    if( aoosp_trace_once ) return;
+  } else {
+    aoosp_trace_num++;
+  }
+  aoosp_trace_rec_t * rec = &aoosp_trace_ring[aoosp_trace_head];
+  if( ++aoosp_trace_head==AOOSP_TRACE_RECS ) aoosp_trace_head = 0;
+  rec->cycles = cycles;
+  rec->dir    = dir;
+  rec->result = result;
+  rec->size   = size;
+  if( size>AOOSP_TRACE_DATASIZE ) size = AOOSP_TRACE_DATASIZE;
+  if( size>0 ) memcpy( rec->data, data, size );
+}
+
+
+/*!
+    @brief  Prints all records in the ring to Serial, oldest first.
+    @param  decode
+            When 0, prints raw lines (see aoosp_trace_parse), to be decoded
+            on a PC; when 1, prints the time (us since the first record)
+            and aoosp_trace_decode() of each record.
+    @note   Recording is paused during the dump.
+    @note   The first line gives cycles/us, records and lost, e.g.
+              trace cycles/us 240 records 512 lost 1024
+            followed by one line per record; raw lines look like
+              trace 0001A2B3 tx 00 04 A0 04 42 2F
+            with time stamp, direction, SPI result, size and bytes.
+*/
+void aoosp_trace_dump(int decode) {
+  uint8_t on = aoosp_trace_on;
+  aoosp_trace_on = 0;
+  Serial.printf("trace cycles/us %lu records %d lost %lu\n", (unsigned long)aoosp_cycles_per_us(), aoosp_trace_num, (unsigned long)aoosp_trace_nlost );
+  aoosp_trace_rec_t rec;
+  uint32_t c0 = 0;
+  for( int ix=0; aoosp_trace_get(ix,&rec)==aoresult_ok; ix++ ) {
+    if( ix==0 ) c0 = rec.cycles;
+    if( decode ) {
+      Serial.printf("%10.1f %s\n", (rec.cycles-c0)/(float)aoosp_cycles_per_us(), aoosp_trace_decode(&rec) );
+    } else {
+      int size = rec.size<AOOSP_TRACE_DATASIZE ? rec.size : AOOSP_TRACE_DATASIZE;
+      Serial.printf("trace %08lX %s %02X %02X%s%s\n", (unsigned long)rec.cycles, rec.dir==AOOSP_TRACE_TX?"tx":"rx", rec.result, rec.size, size?" ":"", size?aoosp_prt_bytes(rec.data,size):"" );
+    }
+  }
+  aoosp_trace_on = on;
+}
+
+
+/*!
+    @brief  Parses one raw line of aoosp_trace_dump() into a record.
+    @param  line
+            The line, e.g. "trace 0001A2B3 tx 00 04 A0 04 42 2F".
+    @param  rec
+            Output parameter receiving the record.
+    @return aoresult_ok, aoresult_outargnull or aoresult_osp_arg (the
+            line is not a raw trace record, e.g. the header line).
+    @note   Used by host tools; also compiles on the target.
+*/
+aoresult_t aoosp_trace_parse(const char * line, aoosp_trace_rec_t * rec) {
+  if( line==0 || rec==0 ) return aoresult_outargnull;
+  unsigned long cycles;
+  char          dir[3];
+  unsigned int  result, size;
+  int           pos;
+  if( sscanf(line, "trace %lx %2s %x %x%n", &cycles, dir, &result, &size, &pos)!=4 ) return aoresult_osp_arg;
+  if( strcmp(dir,"tx")!=0 && strcmp(dir,"rx")!=0 ) return aoresult_osp_arg;
+  if( size>255 ) return aoresult_osp_arg;
+  rec->cycles = cycles;
+  rec->dir    = dir[0]=='t' ? AOOSP_TRACE_TX : AOOSP_TRACE_RX;
+  rec->result = result;
+  rec->size   = size;
+  int n = size<AOOSP_TRACE_DATASIZE ? size : AOOSP_TRACE_DATASIZE;
+  for( int i=0; i<n; i++ ) {
+    unsigned int byte;
+    int          len;
+    if( sscanf(line+pos, "%x%n", &byte, &len)!=1 || byte>0xFF ) return aoresult_osp_arg;
+    rec->data[i] = byte;
+    pos+= len;
+  }
+  return aoresult_ok;
+}
+
+
+// Generic telegram field access macros
+#define BITS_MASK(n)          ( (1<<(n))-1 )                          // series of n bits: BITS_MASK(3)=0b111 (max n=31)
+#define BITS_SLICE(v,lo,hi)   ( ((v)>>(lo)) & BITS_MASK((hi)-(lo)) )  // takes bits [lo..hi) from v: BITS_SLICE(0b11101011,2,6)=0b1010
+
+
+#define AOOSP_TRACE_BUF_SIZE AOOSP_DLOG_LINESIZE
+static char aoosp_trace_buf[AOOSP_TRACE_BUF_SIZE];
+
+
+/*!
+    @brief  Converts a trace record to a human readable string.
+    @param  rec
+            The record, e.g. from aoosp_trace_get() or aoosp_trace_parse().
+    @return A string with direction, destination address, telegram name
+            (aoosp_prt_tid), the raw bytes, and for responses the fields as
+            decoded by the library (aoosp_send_des_rec, formatted like the
+            log by aoosp_dlog_format_results). Errors (SPI, preamble, size,
+            CRC) are appended.
+    @note   Example "rx 002 readtempstat A0 09 42 8C 40 65 temp=0x8C=54 stat=0x40=sleep-tv-clou (25, sleep-ol-clou)".
+    @note   Uses a static buffer (one string at a time), like aoosp_prt.
+*/
+char * aoosp_trace_decode(const aoosp_trace_rec_t * rec) {
+  char * buf = aoosp_trace_buf;
+  int    len = 0;
+  #define AOOSP_TRACE_APPEND(...) do { if( len<AOOSP_TRACE_BUF_SIZE ) len+= snprintf(buf+len, AOOSP_TRACE_BUF_SIZE-len, __VA_ARGS__); } while(0)
+  if( rec==0 ) return (char*)"";
+
+  const char * dir  = rec->dir==AOOSP_TRACE_TX ? "tx" : "rx";
+  int          size = rec->size<AOOSP_TRACE_DATASIZE ? rec->size : AOOSP_TRACE_DATASIZE;
+  const uint8_t * d = rec->data;
+  if( size<4 ) {
+    // No (complete) telegram, e.g. response of a telegram without response
+    AOOSP_TRACE_APPEND("%s %s", dir, size==0 ? "-" : aoosp_prt_bytes(d,size) );
+  } else {
+    uint16_t     addr = BITS_SLICE(d[0],0,4)<<6 | BITS_SLICE(d[1],2,8);
+    uint8_t      tid  = BITS_SLICE(d[2],0,7);
+    const char * name = aoosp_prt_tid(tid);
+    const char * sr   = "";
+    if( name==0 && (tid & AOOSP_TID_SR) ) { name = aoosp_prt_tid(tid & ~AOOSP_TID_SR); sr = "_sr"; } // _SR variant of a TID the library sends without SR
+    if( name ) AOOSP_TRACE_APPEND("%s %03X %s%s %s", dir, addr, name, sr, aoosp_prt_bytes(d,size) );
+    else AOOSP_TRACE_APPEND("%s %03X tid%02X %s", dir, addr, tid, aoosp_prt_bytes(d,size) );
+    // Fields of the response, decoded with the destructor of the library
+    aoosp_dlog_rec_t fields;
+    if( rec->dir==AOOSP_TRACE_RX && rec->size<=AOOSP_TRACE_DATASIZE && aoosp_send_des_rec(d,size,&fields)==aoresult_ok && len<AOOSP_TRACE_BUF_SIZE ) {
+      if( tid==AOOSP_TID_READOTP ) AOOSP_TRACE_APPEND(" otp %s", aoosp_prt_bytes(fields.bytes,fields.bytesize) ); // OTP address is not in the response
+      else len+= aoosp_dlog_format_results(&fields, buf+len, AOOSP_TRACE_BUF_SIZE-len);
+    }
+    // Checks
+    if( BITS_SLICE(d[0],4,8)!=0xA ) AOOSP_TRACE_APPEND(" [preamble ERROR]");
+    if( rec->size>AOOSP_TRACE_DATASIZE ) AOOSP_TRACE_APPEND(" [truncated]");
+    else if( aoosp_crc(d,size)!=0 ) AOOSP_TRACE_APPEND(" [crc ERROR]");
+  }
+  if( rec->result!=aoresult_ok ) AOOSP_TRACE_APPEND(" [SPI ERROR %s]", aoresult_to_str((aoresult_t)rec->result) );
+  #undef AOOSP_TRACE_APPEND
+  return buf;
+}
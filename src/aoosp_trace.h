@@ -0,0 +1,77 @@
+// aoosp_trace.h - records telegrams into a RAM ring without formatting, for later dump
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_TRACE_H_
+#define _AOOSP_TRACE_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// When set to 1, aoosp_send calls the trace recorder (about 10 kB RAM); 0 (default) compiles that out. May also be set with -DAOOSP_TRACE_ENABLED=1
+#ifndef AOOSP_TRACE_ENABLED
+  #define AOOSP_TRACE_ENABLED 0
+#endif
+
+
+// Number of records in the ring (each record is 20 bytes; a telegram with response takes two)
+#define AOOSP_TRACE_RECS        512
+// Maximum number of telegram bytes stored per record (longer telegrams are truncated; OSP telegrams are at most 12)
+#define AOOSP_TRACE_DATASIZE    12
+
+
+// Record directions
+#define AOOSP_TRACE_TX          0 // telegram sent
+#define AOOSP_TRACE_RX          1 // response received (size 0 for telegrams without response or when SPI failed)
+
+
+// One trace record
+typedef struct aoosp_trace_rec_s {
+  uint32_t cycles;                          // Time stamp (aoosp_cycles) of the SPI transfer start (TX) or end (RX)
+  uint8_t  dir;                             // AOOSP_TRACE_TX or AOOSP_TRACE_RX
+  uint8_t  result;                          // SPI result (aoresult_t) for RX, aoresult_ok for TX
+  uint8_t  size;                            // Telegram size (data[] holds at most AOOSP_TRACE_DATASIZE bytes)
+  uint8_t  data[AOOSP_TRACE_DATASIZE];      // Raw telegram bytes
+} aoosp_trace_rec_t;
+
+
+// Clears the ring and starts recording; with `once` recording stops when the ring is full, otherwise the oldest records are overwritten.
+void       aoosp_trace_start(int once=0);
+// Stops recording (the ring is kept).
+void       aoosp_trace_stop();
+// Returns the number of records in the ring.
+int        aoosp_trace_count();
+// Returns the number of records lost (overwritten, or not recorded in once mode) since start.
+uint32_t   aoosp_trace_lost();
+// Gets record `ix` from the ring (0 is the oldest).
+aoresult_t aoosp_trace_get(int ix, aoosp_trace_rec_t * rec);
+// Records one telegram or response (called by aoosp_send; returns immediately when not recording).
+void       aoosp_trace_record(uint8_t dir, const uint8_t * data, int size, aoresult_t result, uint32_t cycles);
+
+// Prints all records to Serial, one line per record; raw lines are the input for aoosp_trace_parse() (e.g. in extras/host/aoosp_tracedump).
+void       aoosp_trace_dump(int decode=0);
+// Parses one raw dump line into `rec`; returns aoresult_osp_arg for lines that are not trace records.
+aoresult_t aoosp_trace_parse(const char * line, aoosp_trace_rec_t * rec);
+// Converts a record to a string, responses decoded like the log (example "rx 002 readtempstat A0 09 42 8C 40 65 temp=0x8C=54 stat=0x40=sleep-tv-clou (25, sleep-ol-clou)").
+char *     aoosp_trace_decode(const aoosp_trace_rec_t * rec);
+
+
+#endif
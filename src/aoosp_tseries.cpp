@@ -0,0 +1,355 @@
+// aoosp_tseries.cpp - compressed temperature history per node
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+
+
+#include <Arduino.h>        // millis
+#include <string.h>         // memset
+#include <aoosp_tseries.h>  // own API
+
+
+// Time-series store
+// =================
+// Storing raw temperature bytes of 1000 nodes at 1Hz takes 3.6MB per hour.
+// Temperatures however change slowly, so this store encodes them: deltas
+// to the previous sample, and runs of unchanged samples. The encoded bytes
+// are kept in fixed size blocks, taken from one pool of AOOSP_TSERIES_BLOCKS
+// shared by all nodes; a node links its blocks from oldest to newest. A
+// stable node needs one block for days, a noisy one a block per minute, so
+// sharing keeps much more history in the same RAM than a ring per node.
+//
+// When the pool is exhausted, the oldest block of the node with the most
+// blocks is evicted (on a tie, the one with the oldest block). A busy (e.g.
+// noisy) node thus grows into the free pool, and then shortens its own
+// history, not the one of a quiet node: the pool is shared fairly. Every
+// node keeps at least its newest block as long as the pool has more blocks
+// than there are nodes with samples.
+//
+// Time is measured in ticks (millis()/tickms, see aoosp_tseries_init); a
+// node has at most one sample per tick. Every block has a header with the
+// tick and value of its first sample, the tick and value of its last sample
+// (to append), and the min and max of all its samples (for quick overviews).
+//
+// Encoding of the samples after the first one; every sample is one tick
+// after the previous one, unless preceded by a skip.
+//   00..3F      run of 1..64 samples equal to the previous one
+//   40..7F      one sample, delta -32..+31 (6 bit two's complement)
+//   80..BF      skip 1..64 ticks
+//   C0 vv       one sample with value vv
+//   C1 lo hi    run of 1..65535 samples equal to the previous one
+//   C2 lo hi    skip 1..65535 ticks
+// A run is extended in place, a short run grows into a long one.
+
+
+#define AOOSP_TSERIES_NONE  0xFFFF  // No block
+#define AOOSP_TSERIES_NOOP  0xFF    // No token yet
+
+
+typedef struct aoosp_tseries_block_s {
+  uint32_t t0;         // Tick of first sample
+  uint32_t t1;         // Tick of last sample
+  uint16_t owner;      // Node owning this block, or AOOSP_TSERIES_NONE when free
+  uint16_t next;       // Next (newer) block of owner, or next free block
+  uint16_t count;      // Number of samples
+  uint8_t  v0;         // Value of first sample
+  uint8_t  v1;         // Value of last sample
+  uint8_t  min;        // Minimum value in block
+  uint8_t  max;        // Maximum value in block
+  uint8_t  used;       // Number of bytes used in `data`
+  uint8_t  lastop;     // Index in `data` of last token, or AOOSP_TSERIES_NOOP
+  uint8_t  data[AOOSP_TSERIES_BLOCKSIZE];
+} aoosp_tseries_block_t;
+
+
+static aoosp_tseries_block_t aoosp_tseries_blocks[AOOSP_TSERIES_BLOCKS];
+static uint16_t              aoosp_tseries_first[AOOSP_TSERIES_NODES]; // Oldest block per node
+static uint16_t              aoosp_tseries_last [AOOSP_TSERIES_NODES]; // Newest block per node
+static uint16_t              aoosp_tseries_count[AOOSP_TSERIES_NODES]; // Number of blocks per node
+static uint16_t              aoosp_tseries_free;   // First free block
+static uint32_t              aoosp_tseries_tickms; // 0 when not initialized
+static aoosp_tseries_stats_t aoosp_tseries_stats;
+
+
+/*!
+    @brief  Clears the store and configures the tick.
+    @param  tickms
+            The duration of a tick in ms; a node has at most one sample per tick.
+    @note   Before the first call, samples passed to aoosp_tseries_add()
+            are ignored.
+*/
+void aoosp_tseries_init(uint32_t tickms) {
+  memset( aoosp_tseries_blocks, 0, sizeof aoosp_tseries_blocks );
+  for( int b=0; b<AOOSP_TSERIES_BLOCKS; b++ ) {
+    aoosp_tseries_blocks[b].owner = AOOSP_TSERIES_NONE;
+    aoosp_tseries_blocks[b].next  = b+1<AOOSP_TSERIES_BLOCKS ? b+1 : AOOSP_TSERIES_NONE;
+  }
+  for( int n=0; n<AOOSP_TSERIES_NODES; n++ ) aoosp_tseries_first[n] = aoosp_tseries_last[n] = AOOSP_TSERIES_NONE;
+  memset( aoosp_tseries_count, 0, sizeof aoosp_tseries_count );
+  memset( &aoosp_tseries_stats, 0, sizeof aoosp_tseries_stats );
+  aoosp_tseries_stats.memory = sizeof aoosp_tseries_blocks + sizeof aoosp_tseries_first + sizeof aoosp_tseries_last + sizeof aoosp_tseries_count;
+  aoosp_tseries_free   = 0;
+  aoosp_tseries_tickms = tickms>0 ? tickms : 1;
+}
+
+
+/*!
+    @brief  Returns the current tick.
+    @return millis()/tickms, with tickms from aoosp_tseries_init().
+*/
+uint32_t aoosp_tseries_tick() {
+  return aoosp_tseries_tickms ? millis()/aoosp_tseries_tickms : 0;
+}
+
+
+// Returns block `ix` (0 is the oldest) of node `n`, or 0 if there is no such block.
+static aoosp_tseries_block_t * aoosp_tseries_block(uint16_t n, int ix) {
+  if( ix<0 || ix>=aoosp_tseries_count[n] ) return 0;
+  uint16_t b = aoosp_tseries_first[n];
+  while( ix-->0 ) b = aoosp_tseries_blocks[b].next;
+  return &aoosp_tseries_blocks[b];
+}
+
+
+// Frees the oldest block of the node with the most blocks (on a tie, the one with the oldest block).
+static void aoosp_tseries_evict() {
+  uint16_t o = AOOSP_TSERIES_NONE;
+  for( uint16_t n=0; n<AOOSP_TSERIES_NODES; n++ ) {
+    if( aoosp_tseries_count[n]==0 ) continue;
+    if( o==AOOSP_TSERIES_NONE || aoosp_tseries_count[n]>aoosp_tseries_count[o] ) { o = n; continue; }
+    if( aoosp_tseries_count[n]==aoosp_tseries_count[o] && aoosp_tseries_blocks[aoosp_tseries_first[n]].t0<aoosp_tseries_blocks[aoosp_tseries_first[o]].t0 ) o = n;
+  }
+  uint16_t b = aoosp_tseries_first[o];
+  aoosp_tseries_block_t * O = &aoosp_tseries_blocks[b];
+  aoosp_tseries_first[o] = O->next;
+  if( aoosp_tseries_first[o]==AOOSP_TSERIES_NONE ) aoosp_tseries_last[o] = AOOSP_TSERIES_NONE;
+  aoosp_tseries_count[o]--;
+  aoosp_tseries_stats.samples -= O->count;
+  aoosp_tseries_stats.bytes   -= O->used;
+  aoosp_tseries_stats.blocks--;
+  aoosp_tseries_stats.evicted++;
+  O->owner = AOOSP_TSERIES_NONE;
+  O->next  = aoosp_tseries_free;
+  aoosp_tseries_free = b;
+}
+
+
+// Takes a block from the pool (evicting one when it is exhausted), and appends it to node `n` with sample (tick,v).
+static void aoosp_tseries_newblock(uint16_t n, uint32_t tick, uint8_t v) {
+  if( aoosp_tseries_free==AOOSP_TSERIES_NONE ) aoosp_tseries_evict();
+  uint16_t b = aoosp_tseries_free;
+  aoosp_tseries_block_t * B = &aoosp_tseries_blocks[b];
+  aoosp_tseries_free = B->next;
+  B->t0 = B->t1 = tick;
+  B->v0 = B->v1 = B->min = B->max = v;
+  B->owner  = n;
+  B->next   = AOOSP_TSERIES_NONE;
+  B->count  = 1;
+  B->used   = 0;
+  B->lastop = AOOSP_TSERIES_NOOP;
+  if( aoosp_tseries_last[n]==AOOSP_TSERIES_NONE ) aoosp_tseries_first[n] = b;
+  else aoosp_tseries_blocks[aoosp_tseries_last[n]].next = b;
+  aoosp_tseries_last[n] = b;
+  aoosp_tseries_count[n]++;
+  aoosp_tseries_stats.blocks++;
+  aoosp_tseries_stats.samples++;
+}
+
+
+// Appends sample (tick,v) to the newest block B, returns 0 if it does not fit.
+static int aoosp_tseries_append(aoosp_tseries_block_t * B, uint32_t tick, uint8_t v) {
+  uint32_t skip  = tick - B->t1 - 1;
+  int      delta = (int)v - (int)B->v1;
+  uint8_t  free  = AOOSP_TSERIES_BLOCKSIZE - B->used;
+  uint8_t  skipsize = skip==0 ? 0 : skip<=64 ? 1 : skip<=65535 ? 3 : 255;
+  uint8_t  used0 = B->used;
+
+  // Try to extend the last run
+  if( skip==0 && delta==0 && B->lastop!=AOOSP_TSERIES_NOOP ) {
+    uint8_t * op = &B->data[B->lastop];
+    if( *op<0x3F ) {
+      (*op)++;
+      goto appended;
+    }
+    if( *op==0x3F && free>=2 ) {
+      op[0]=0xC1; op[1]=65; op[2]=0; B->used+=2;
+      goto appended;
+    }
+    if( *op==0xC1 && (op[1]|op[2]<<8)<65535 ) {
+      uint16_t r = (op[1]|op[2]<<8) + 1; op[1]=r&0xFF; op[2]=r>>8;
+      goto appended;
+    }
+  }
+
+  // Skip and sample tokens
+  if( skipsize + (delta>=-32 && delta<=31 ? 1 : 2) > free ) return 0;
+  if( skip>0 && skip<=64 ) {
+    B->data[B->used++] = 0x80 | (skip-1);
+  } else if( skip>64 ) {
+    B->data[B->used++] = 0xC2; B->data[B->used++] = skip&0xFF; B->data[B->used++] = skip>>8;
+  }
+  B->lastop = B->used;
+  if( delta==0 ) {
+    B->data[B->used++] = 0x00;
+  } else if( delta>=-32 && delta<=31 ) {
+    B->data[B->used++] = 0x40 | (delta&0x3F);
+  } else {
+    B->data[B->used++] = 0xC0; B->data[B->used++] = v;
+  }
+
+appended:
+  aoosp_tseries_stats.bytes += B->used - used0;
+  B->t1 = tick;
+  B->v1 = v;
+  if( v<B->min ) B->min = v;
+  if( v>B->max ) B->max = v;
+  B->count++;
+  aoosp_tseries_stats.samples++;
+  return 1;
+}
+
+
+/*!
+    @brief  Adds a temperature sample of a node, time stamped with the current tick.
+    @param  addr
+            The address of the node (series 0 is used for the chain max).
+    @param  temp
+            The raw temperature.
+    @note   Called by aoosp_send for READTEMP, READTEMPSTAT, GOACTIVE_SR,
+            SETTESTPW_SR, INITBIDIR and INITLOOP (temperature of the last
+            node), and ASKTINFO to node 001 (chain max, series 0).
+    @note   Ignored before aoosp_tseries_init(); a second sample in the
+            same tick for the same node is dropped.
+*/
+void aoosp_tseries_add(uint16_t addr, uint8_t temp) {
+  if( aoosp_tseries_tickms==0 || addr>=AOOSP_TSERIES_NODES ) return;
+  uint32_t tick = millis()/aoosp_tseries_tickms;
+  aoosp_tseries_stats.added++;
+  aoosp_tseries_block_t * B = aoosp_tseries_last[addr]==AOOSP_TSERIES_NONE ? 0 : &aoosp_tseries_blocks[aoosp_tseries_last[addr]];
+  if( B ) {
+    if( (int32_t)(tick-B->t1)<=0 ) { aoosp_tseries_stats.dropped++; return; }
+    if( B->count<65535 && tick-B->t1<=65536 && aoosp_tseries_append(B,tick,temp) ) return;
+  }
+  aoosp_tseries_newblock(addr,tick,temp);
+}
+
+
+/*!
+    @brief  Gets the stored samples of a node in a tick range.
+    @param  addr
+            The address of the node (0 for chain max).
+    @param  fromtick
+            First tick of the range (inclusive).
+    @param  totick
+            Last tick of the range (inclusive).
+    @param  ticks
+            Output array receiving the ticks of the samples.
+    @param  temps
+            Output array receiving the raw temperatures of the samples.
+    @param  size
+            The size of the output arrays.
+    @param  count
+            Output parameter returning the number of samples written.
+    @return aoresult_ok if all ok, otherwise an error code.
+    @note   When count==size there may be more samples; call again with
+            fromtick one after the last returned tick.
+*/
+aoresult_t aoosp_tseries_query(uint16_t addr, uint32_t fromtick, uint32_t totick, uint32_t * ticks, uint8_t * temps, int size, int * count) {
+  if( ticks==0 || temps==0 || count==0 ) return aoresult_outargnull;
+  if( addr>=AOOSP_TSERIES_NODES ) return aoresult_osp_addr;
+  *count = 0;
+  if( aoosp_tseries_tickms==0 ) return aoresult_ok;
+  #define AOOSP_TSERIES_EMIT(t,v) do { if( (t)>=fromtick && (t)<=totick ) { if( *count>=size ) return aoresult_ok; ticks[*count]=(t); temps[*count]=(v); (*count)++; } } while(0)
+  for( uint16_t b=aoosp_tseries_first[addr]; b!=AOOSP_TSERIES_NONE; b=aoosp_tseries_blocks[b].next ) {
+    aoosp_tseries_block_t * B = &aoosp_tseries_blocks[b];
+    if( B->t1<fromtick ) continue;
+    if( B->t0>totick ) break;
+    uint32_t t = B->t0;
+    uint8_t  v = B->v0;
+    AOOSP_TSERIES_EMIT(t,v);
+    for( int i=0; i<B->used && t<=totick; ) {
+      uint8_t op = B->data[i++];
+      if( op<0x40 ) {
+        for( int r=0; r<=op; r++ ) { t++; AOOSP_TSERIES_EMIT(t,v); }
+      } else if( op<0x80 ) {
+        t++; v += (int8_t)(op<<2)>>2; AOOSP_TSERIES_EMIT(t,v);
+      } else if( op<0xC0 ) {
+        t += (op&0x3F)+1;
+      } else if( op==0xC0 ) {
+        t++; v = B->data[i++]; AOOSP_TSERIES_EMIT(t,v);
+      } else {
+        uint16_t n = B->data[i] | B->data[i+1]<<8; i+=2;
+        if( op==0xC1 ) { for( uint16_t r=0; r<n && t<=totick; r++ ) { t++; AOOSP_TSERIES_EMIT(t,v); } }
+        else t += n;
+      }
+    }
+  }
+  #undef AOOSP_TSERIES_EMIT
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Returns the number of blocks of a node.
+    @param  addr
+            The address of the node (0 for chain max).
+    @return The number of blocks (0 if the node has no samples).
+*/
+int aoosp_tseries_block_count(uint16_t addr) {
+  if( addr>=AOOSP_TSERIES_NODES ) return 0;
+  return aoosp_tseries_count[addr];
+}
+
+
+/*!
+    @brief  Gets the summary of one block of a node, without decoding it.
+    @param  addr
+            The address of the node (0 for chain max).
+    @param  ix
+            The index of the block, 0 is the oldest.
+    @param  t0
+            Output parameter returning the tick of the first sample.
+    @param  t1
+            Output parameter returning the tick of the last sample.
+    @param  min
+            Output parameter returning the lowest raw temperature in the block.
+    @param  max
+            Output parameter returning the highest raw temperature in the block.
+    @return aoresult_ok if all ok, aoresult_osp_arg if there is no block `ix`.
+*/
+aoresult_t aoosp_tseries_block_get(uint16_t addr, int ix, uint32_t * t0, uint32_t * t1, uint8_t * min, uint8_t * max) {
+  if( t0==0 || t1==0 || min==0 || max==0 ) return aoresult_outargnull;
+  if( addr>=AOOSP_TSERIES_NODES ) return aoresult_osp_addr;
+  aoosp_tseries_block_t * B = aoosp_tseries_tickms ? aoosp_tseries_block(addr,ix) : 0;
+  if( B==0 ) return aoresult_osp_arg;
+  *t0 = B->t0; *t1 = B->t1; *min = B->min; *max = B->max;
+  return aoresult_ok;
+}
+
+
+/*!
+    @brief  Gets the statistics of the store.
+    @param  stats
+            Output parameter receiving a copy of the statistics.
+    @note   `samples` versus `bytes` (plus block headers) gives the
+            compression; `memory` is the RAM reserved by the store.
+*/
+void aoosp_tseries_stats_get(aoosp_tseries_stats_t * stats) {
+  if( stats ) *stats = aoosp_tseries_stats;
+}
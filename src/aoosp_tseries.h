@@ -0,0 +1,77 @@
+// aoosp_tseries.h - compressed temperature history per node
+/*****************************************************************************
+ * Copyright 2024 by ams OSRAM AG                                            *
+ * All rights are reserved.                                                  *
+ *                                                                           *
+ * IMPORTANT - PLEASE READ CAREFULLY BEFORE COPYING, INSTALLING OR USING     *
+ * THE SOFTWARE.                                                             *
+ *                                                                           *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       *
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT         *
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS         *
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT  *
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT          *
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     *
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY     *
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT       *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE     *
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.      *
+ *****************************************************************************/
+#ifndef _AOOSP_TSERIES_H_
+#define _AOOSP_TSERIES_H_
+
+
+#include <stdint.h>
+#include <aoresult.h>
+
+
+// When set to 1, aoosp_send feeds temperatures to the time-series store (RAM see AOOSP_TSERIES_BLOCKS); 0 (default) compiles that out. May also be set with -DAOOSP_TSERIES_ENABLED=1
+#ifndef AOOSP_TSERIES_ENABLED
+  #define AOOSP_TSERIES_ENABLED 0
+#endif
+
+
+// Number of series; series `addr` holds node `addr` (higher addresses are ignored), series 0 the chain max (from ASKTINFO). May also be set with -D
+#ifndef AOOSP_TSERIES_NODES
+  #define AOOSP_TSERIES_NODES     256
+#endif
+// Number of blocks in the pool shared by all series; keep it well above NODES (RAM is BLOCKS*(20+BLOCKSIZE)+NODES*6, 28kB with the defaults). May also be set with -D
+#ifndef AOOSP_TSERIES_BLOCKS
+  #define AOOSP_TSERIES_BLOCKS    512
+#endif
+// Number of encoded bytes per block. May also be set with -D
+#ifndef AOOSP_TSERIES_BLOCKSIZE
+  #define AOOSP_TSERIES_BLOCKSIZE 32
+#endif
+
+
+// Statistics and memory use of the store (see aoosp_tseries_stats_get)
+typedef struct aoosp_tseries_stats_s {
+  uint32_t samples;    // Number of samples currently stored
+  uint32_t added;      // Number of samples added since init
+  uint32_t dropped;    // Number of samples dropped (same tick as previous sample of that node)
+  uint32_t evicted;    // Number of blocks evicted (oldest block of the node with the most blocks) to make room
+  uint16_t blocks;     // Number of blocks in use
+  uint32_t bytes;      // Number of encoded bytes in use (excluding block headers)
+  uint32_t memory;     // Total RAM of the store (blocks plus node index)
+} aoosp_tseries_stats_t;
+
+
+// Clears the store and sets the sample tick (in ms); before this call, samples are ignored.
+void       aoosp_tseries_init(uint32_t tickms=1000);
+// Returns the current tick (millis()/tickms); used as time stamp of samples.
+uint32_t   aoosp_tseries_tick();
+// Adds raw temperature `temp` of node `addr` with the current tick (called by aoosp_send).
+void       aoosp_tseries_add(uint16_t addr, uint8_t temp);
+// Gets the samples of node `addr` with ticks in [fromtick,totick], at most `size`.
+aoresult_t aoosp_tseries_query(uint16_t addr, uint32_t fromtick, uint32_t totick, uint32_t * ticks, uint8_t * temps, int size, int * count);
+// Returns the number of blocks of node `addr`.
+int        aoosp_tseries_block_count(uint16_t addr);
+// Gets tick range and min/max temperature of block `ix` (0 is oldest) of node `addr`.
+aoresult_t aoosp_tseries_block_get(uint16_t addr, int ix, uint32_t * t0, uint32_t * t1, uint8_t * min, uint8_t * max);
+// Gets the statistics, including memory use.
+void       aoosp_tseries_stats_get(aoosp_tseries_stats_t * stats);
+
+
+#endif